@@ -0,0 +1,373 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: AabbTree.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <DirectXMath.h>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "Graphics/FrustumCuller.h"
+
+// An axis aligned box by its corners.
+struct Aabb
+{
+    DirectX::XMFLOAT3 m_min;
+    DirectX::XMFLOAT3 m_max;
+};
+
+// What the tree hands out for an inserted box, stays the same until it is removed.
+using AabbProxy = uint32_t;
+constexpr AabbProxy INVALID_AABB_PROXY = ~0u;
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: AabbTree
+//
+// Desription
+//  : A dynamic bounding volume hierarchy over axis aligned boxes, for visibility, picking
+//    and proximity queries that don't have to look at every object of the scene.
+//
+//    Every object is a leaf, every inner node has two children and the box around both.
+//    Insert() walks down to the sibling that grows the tree's surface area the least and
+//    refits and rebalances the boxes on the way back up, Remove() does the same from the
+//    leaf's parent. A node whose children differ in height by more than one is rotated,
+//    so the tree stays close to log2(count) deep whatever order things arrive in.
+//
+//    Leaves store a fat box, the object's box grown by a margin and by where it is moving.
+//    Move() only touches the tree when the object has left its fat box, so objects that
+//    stay around the same place cost nothing to update.
+//
+//    The nodes sit in one array and refer to each other by index. What the queries walk
+//    (the box and the two children) is 32 bytes per node, two to a cache line, the links
+//    only insertions and removals need are kept apart in a second array.
+//
+//    The queries call back with the proxy of every leaf that passes, the callbacks of
+//    QueryFrustum() and QueryRegion() return false to stop the query early. QueryRay()
+//    visits the nearer child first and its callback returns how far the ray still has to
+//    go: the distance it was given to carry on, a hit's distance to only look for closer
+//    ones or zero to stop.
+//
+//    Queries only read the tree and can run on several threads at once, anything that
+//    changes it belongs to one thread.
+////////////////////////////////////////////////////////////////////////////////
+class AabbTree
+{
+public:
+    explicit AabbTree();
+    AabbTree(const AabbTree&) = delete;
+
+    void Reserve(unsigned int);
+    void Clear();
+
+    // The object's box, and anything the caller wants back with the proxy.
+    AabbProxy Insert(const Aabb&, uint32_t);
+    void Remove(AabbProxy);
+
+    // The new box, and how far the object moved since the last call to predict where it's going.
+    // True when the leaf had to be moved in the tree.
+    bool Move(AabbProxy, const Aabb&, const DirectX::XMFLOAT3&);
+
+    uint32_t GetUserData(AabbProxy) const;
+    Aabb GetFatAabb(AabbProxy) const;
+
+    // Leaves whose fat box is at least partly inside the frustum, function(proxy) returns false to stop.
+    template <typename Function>
+    void QueryFrustum(const Frustum&, const Function&) const;
+    // Leaves whose fat box overlaps the box, function(proxy) returns false to stop.
+    template <typename Function>
+    void QueryRegion(const Aabb&, const Function&) const;
+    // Leaves whose fat box the ray enters within maxDistance, nearest node first.
+    // function(proxy, entryDistance) returns how far the ray still has to look.
+    template <typename Function>
+    void QueryRay(const DirectX::XMFLOAT3&, const DirectX::XMFLOAT3&, float, const Function&) const;
+
+    unsigned int GetProxyCount() const;
+    // Zero when empty, one for a single leaf.
+    int GetHeight() const;
+    // Total surface area of the inner nodes over the root's, the lower the faster the queries.
+    float GetAreaRatio() const;
+
+    // Walks the whole tree checking the links, heights and boxes. For tests and benchmarks.
+    bool Validate() const;
+
+private:
+    // The part of a node the queries read. A leaf has no children.
+    struct Node
+    {
+        DirectX::XMFLOAT3 m_min;
+        uint32_t m_child1;
+        DirectX::XMFLOAT3 m_max;
+        uint32_t m_child2;
+    };
+
+    // The part only insertions and removals need.
+    struct NodeLinks
+    {
+        // The next free node while the node is free.
+        uint32_t m_parent;
+        // Zero for a leaf, -1 while the node is free.
+        int32_t m_height;
+        uint32_t m_userData;
+    };
+
+    static_assert(sizeof(Node) == 32, "Two query nodes have to fit a cache line");
+
+    static constexpr uint32_t kNullNode = ~0u;
+
+    // The fat box is the box grown by this on every side...
+    static constexpr float kFatMargin = 0.1f;
+    // ...and stretched along the displacement this many times.
+    static constexpr float kDisplacementMultiplier = 2.0f;
+
+    // Entries of a query's stack, the rotations keep the tree far shallower than this.
+    static constexpr unsigned int kQueryStackSize = 128;
+
+    uint32_t AllocateNode();
+    void FreeNode(uint32_t);
+
+    void InsertLeaf(uint32_t);
+    void RemoveLeaf(uint32_t);
+
+    // Refits and rebalances from the node up to the root.
+    void Refit(uint32_t);
+    uint32_t Balance(uint32_t);
+    uint32_t Rotate(uint32_t, uint32_t, uint32_t);
+
+    void SetUnion(uint32_t, uint32_t, uint32_t);
+
+    bool IsLeaf(uint32_t) const;
+
+    static float SurfaceArea(const DirectX::XMFLOAT3&, const DirectX::XMFLOAT3&);
+
+private:
+    std::vector<Node> m_nodes;
+    std::vector<NodeLinks> m_links;
+
+    uint32_t m_root;
+    uint32_t m_freeList;
+    unsigned int m_proxyCount;
+};
+
+//-----------------------------------------------------------------
+// Each plane a node is entirely in front of is dropped for its
+// children, a node in front of all of them reports its leaves
+// without testing anything else.
+//-----------------------------------------------------------------
+template <typename Function>
+void AabbTree::QueryFrustum(const Frustum& kFrustum, const Function& kFunction) const
+{
+    if (m_root == kNullNode)
+    {
+        return;
+    }
+
+    constexpr uint32_t kAllPlanes = (1u << Frustum::PlaneCount) - 1;
+
+    struct StackEntry
+    {
+        uint32_t m_node;
+        uint32_t m_planes;
+    };
+
+    StackEntry stack[kQueryStackSize];
+    unsigned int stackCount = 0;
+    stack[stackCount++] = { m_root, kAllPlanes };
+
+    while (stackCount > 0)
+    {
+        StackEntry entry = stack[--stackCount];
+        const Node& kNode = m_nodes[entry.m_node];
+
+        uint32_t planes = entry.m_planes;
+        bool outside = false;
+
+        if (planes != 0)
+        {
+            float centerX = (kNode.m_min.x + kNode.m_max.x) * 0.5f;
+            float centerY = (kNode.m_min.y + kNode.m_max.y) * 0.5f;
+            float centerZ = (kNode.m_min.z + kNode.m_max.z) * 0.5f;
+            float extentX = (kNode.m_max.x - kNode.m_min.x) * 0.5f;
+            float extentY = (kNode.m_max.y - kNode.m_min.y) * 0.5f;
+            float extentZ = (kNode.m_max.z - kNode.m_min.z) * 0.5f;
+
+            for (unsigned int p = 0; p < Frustum::PlaneCount; ++p)
+            {
+                if ((planes & (1u << p)) == 0)
+                {
+                    continue;
+                }
+
+                const DirectX::XMFLOAT4& kPlane = kFrustum.m_planes[p];
+                float distance = kPlane.x * centerX + kPlane.y * centerY + kPlane.z * centerZ + kPlane.w;
+                float radius = fabsf(kPlane.x) * extentX + fabsf(kPlane.y) * extentY + fabsf(kPlane.z) * extentZ;
+
+                if (distance + radius < 0.0f)
+                {
+                    outside = true;
+                    break;
+                }
+
+                if (distance - radius >= 0.0f)
+                {
+                    planes &= ~(1u << p);
+                }
+            }
+        }
+
+        if (outside)
+        {
+            continue;
+        }
+
+        if (kNode.m_child1 == kNullNode)
+        {
+            if (!kFunction(static_cast<AabbProxy>(entry.m_node)))
+            {
+                return;
+            }
+        }
+        else
+        {
+            stack[stackCount++] = { kNode.m_child1, planes };
+            stack[stackCount++] = { kNode.m_child2, planes };
+        }
+    }
+}
+
+template <typename Function>
+void AabbTree::QueryRegion(const Aabb& kRegion, const Function& kFunction) const
+{
+    if (m_root == kNullNode)
+    {
+        return;
+    }
+
+    uint32_t stack[kQueryStackSize];
+    unsigned int stackCount = 0;
+    stack[stackCount++] = m_root;
+
+    while (stackCount > 0)
+    {
+        uint32_t index = stack[--stackCount];
+        const Node& kNode = m_nodes[index];
+
+        if (kNode.m_max.x < kRegion.m_min.x || kNode.m_min.x > kRegion.m_max.x ||
+            kNode.m_max.y < kRegion.m_min.y || kNode.m_min.y > kRegion.m_max.y ||
+            kNode.m_max.z < kRegion.m_min.z || kNode.m_min.z > kRegion.m_max.z)
+        {
+            continue;
+        }
+
+        if (kNode.m_child1 == kNullNode)
+        {
+            if (!kFunction(static_cast<AabbProxy>(index)))
+            {
+                return;
+            }
+        }
+        else
+        {
+            stack[stackCount++] = kNode.m_child1;
+            stack[stackCount++] = kNode.m_child2;
+        }
+    }
+}
+
+//-----------------------------------------------------------------
+// Slab test against each node. The entry distance of both children
+// is computed before either is pushed, the farther one goes on the
+// stack first so the nearer one is visited first, and a node is
+// skipped when the ray was shortened below its entry distance
+// after it was pushed.
+//-----------------------------------------------------------------
+template <typename Function>
+void AabbTree::QueryRay(const DirectX::XMFLOAT3& kOrigin, const DirectX::XMFLOAT3& kDirection, float maxDistance, const Function& kFunction) const
+{
+    if (m_root == kNullNode)
+    {
+        return;
+    }
+
+    // Infinities for axis parallel rays, the slab test then only passes when the origin is inside the slab.
+    float inverseX = 1.0f / kDirection.x;
+    float inverseY = 1.0f / kDirection.y;
+    float inverseZ = 1.0f / kDirection.z;
+
+    auto entryDistance = [&](const Node& kNode, float limit)
+    {
+        float x1 = (kNode.m_min.x - kOrigin.x) * inverseX;
+        float x2 = (kNode.m_max.x - kOrigin.x) * inverseX;
+        float y1 = (kNode.m_min.y - kOrigin.y) * inverseY;
+        float y2 = (kNode.m_max.y - kOrigin.y) * inverseY;
+        float z1 = (kNode.m_min.z - kOrigin.z) * inverseZ;
+        float z2 = (kNode.m_max.z - kOrigin.z) * inverseZ;
+
+        // fmin/fmax drop the NaN of a zero direction on the box's face, the slab then counts as passed.
+        float enter = fmaxf(fmaxf(fminf(x1, x2), fminf(y1, y2)), fmaxf(fminf(z1, z2), 0.0f));
+        float exit = fminf(fminf(fmaxf(x1, x2), fmaxf(y1, y2)), fminf(fmaxf(z1, z2), limit));
+
+        // Negative when missed.
+        return (enter <= exit) ? enter : -1.0f;
+    };
+
+    struct StackEntry
+    {
+        uint32_t m_node;
+        float m_distance;
+    };
+
+    StackEntry stack[kQueryStackSize];
+    unsigned int stackCount = 0;
+
+    float rootDistance = entryDistance(m_nodes[m_root], maxDistance);
+    if (rootDistance < 0.0f)
+    {
+        return;
+    }
+    stack[stackCount++] = { m_root, rootDistance };
+
+    while (stackCount > 0)
+    {
+        StackEntry entry = stack[--stackCount];
+        if (entry.m_distance > maxDistance)
+        {
+            continue;
+        }
+
+        const Node& kNode = m_nodes[entry.m_node];
+
+        if (kNode.m_child1 == kNullNode)
+        {
+            maxDistance = kFunction(static_cast<AabbProxy>(entry.m_node), entry.m_distance);
+            if (maxDistance <= 0.0f)
+            {
+                return;
+            }
+            continue;
+        }
+
+        float distance1 = entryDistance(m_nodes[kNode.m_child1], maxDistance);
+        float distance2 = entryDistance(m_nodes[kNode.m_child2], maxDistance);
+
+        StackEntry nearer = { kNode.m_child1, distance1 };
+        StackEntry farther = { kNode.m_child2, distance2 };
+        if (distance2 >= 0.0f && (distance1 < 0.0f || distance2 < distance1))
+        {
+            nearer = { kNode.m_child2, distance2 };
+            farther = { kNode.m_child1, distance1 };
+        }
+
+        if (farther.m_distance >= 0.0f)
+        {
+            stack[stackCount++] = farther;
+        }
+        if (nearer.m_distance >= 0.0f)
+        {
+            stack[stackCount++] = nearer;
+        }
+    }
+}
@@ -3,41 +3,43 @@
 #include <d3dcompiler.h>
 #include <DirectXMath.h>
 
+#include "Graphics/RenderDevice.h"
+#include "Graphics/ConstantUploadRing.h"
+#include "Graphics/GeometryPool.h"
+#include "Graphics/ShaderConstants.h"
+
+/// The vertex shader reads the view constants (see ShaderConstants.h) from whatever is bound
+/// to their slot, only the object constants are set per draw here.
 class ColorShader
 {
-private:
-	/// Definition of cbuffer type that will be used with the vertex shader.
-	/// This typedef must be exactly the same as the one in the vertex shader
-	/// as the model data needs to math typedefs in the shader for proper rendering.
-	struct MatrixBuffer
-	{
-		DirectX::XMMATRIX m_world;
-		DirectX::XMMATRIX m_view;
-		DirectX::XMMATRIX m_projection;
-	};
-
 public:
 	ColorShader();
 	ColorShader(const ColorShader& kOther);
 	~ColorShader();
 
-	bool Initialize(ID3D11Device* pDevice, HWND hwnd);
+	bool Initialize(RenderDevice* pDevice, HWND hwnd);
 	void Shutdown();
-	// sets the shader parameters and then draws the prepared model vertieces using the shader.
-	bool Render(ID3D11DeviceContext* pDeviceContext, int indexCount, DirectX::XMMATRIX worldMatrix, DirectX::XMMATRIX viewMatrix, DirectX::XMMATRIX projectionMatrix);
+	// writes the object constants of one draw into the upload ring, call it between BeginUpload() and EndUpload().
+	bool WriteParameters(ConstantUploadRing& uploadRing, DirectX::XMMATRIX worldMatrix, ConstantAllocation& allocation);
+	// sets the shader parameters and then draws the model vertieces of the bound geometry pool using the shader.
+	bool Render(RenderContext* pDeviceContext, const GeometryRange& kGeometry, const ConstantAllocation& kParameters);
+	// draws instanceCount copies of the model, each with the world matrix and tint of its ModelInstance.
+	bool RenderInstanced(RenderContext* pDeviceContext, const GeometryRange& kGeometry, unsigned int instanceCount);
 
 private:
-	bool InitializeShader(ID3D11Device* pDevice, HWND hwnd, const WCHAR* pVertexShaderFile, const WCHAR* pPixelShaderFile);
+	bool InitializeShader(RenderDevice* pDevice, HWND hwnd, const WCHAR* pVertexShaderFile, const WCHAR* pPixelShaderFile);
+	bool InitializeInstancedShader(RenderDevice* pDevice, HWND hwnd, const WCHAR* pVertexShaderFile);
 	void ShutdownShader();
 	void OutputShaderErrorMessage(ID3D10Blob* pErrorMsg, HWND hwnd, const WCHAR* pShaderFileName);
 
-	bool SetShaderParameters(ID3D11DeviceContext* pDeviceContext, DirectX::XMMATRIX worldMatrix, DirectX::XMMATRIX viewMatrix, DirectX::XMMATRIX projectionMatrix);
-	void RenderShader(ID3D11DeviceContext* pDeviceContext, int indexCount);
+	void SetShaderParameters(RenderContext* pDeviceContext, const ConstantAllocation& kParameters);
+	void RenderShader(RenderContext* pDeviceContext, const GeometryRange& kGeometry);
 
 private:
 	ID3D11VertexShader* m_pVertexShader;
 	ID3D11PixelShader* m_pPixelShader;
 	ID3D11InputLayout* m_pLayout;
-	ID3D11Buffer* m_pMatrixBuffer;
+	ID3D11VertexShader* m_pInstancedVertexShader;
+	ID3D11InputLayout* m_pInstancedLayout;
 };
 
@@ -0,0 +1,93 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: CommandList.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <d3d11.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Graphics/RenderDevice.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: CommandList
+//
+// Desription
+//  : A RenderContext that records instead of drawing. Every call is packed into one
+//    growing block of memory and Execute() replays them in order onto any other
+//    context, so the same draw code records on a worker thread and replays on the
+//    render thread, whatever the backend.
+//
+//    The data a call points at is copied when it is recorded: views, buffers and
+//    constants windows, and the bytes given to UpdateSubresource(). The resources
+//    themselves are not referenced, they have to outlive the replay.
+//
+//    Map() can't be deferred and fails, write through the ConstantUploadRing before
+//    recording, or use UpdateSubresource(). GetData() and FinishCommandList() fail too.
+//
+//    A list belongs to one thread while it is recorded. Replaying only reads it.
+////////////////////////////////////////////////////////////////////////////////
+class CommandList : public RenderContext
+{
+public:
+    explicit CommandList();
+    CommandList(const CommandList&) = delete;
+
+    void ClearRenderTargetView(ID3D11RenderTargetView*, const FLOAT[4]) override;
+    void ClearDepthStencilView(ID3D11DepthStencilView*, UINT, FLOAT, UINT8) override;
+
+    void OMSetRenderTargets(UINT, ID3D11RenderTargetView* const*, ID3D11DepthStencilView*) override;
+    void OMSetDepthStencilState(ID3D11DepthStencilState*, UINT) override;
+    void RSSetState(ID3D11RasterizerState*) override;
+    void RSSetViewports(UINT, const D3D11_VIEWPORT*) override;
+
+    void IASetInputLayout(ID3D11InputLayout*) override;
+    void IASetVertexBuffers(UINT, UINT, ID3D11Buffer* const*, const UINT*, const UINT*) override;
+    void IASetIndexBuffer(ID3D11Buffer*, DXGI_FORMAT, UINT) override;
+    void IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY) override;
+
+    void VSSetShader(ID3D11VertexShader*, ID3D11ClassInstance* const*, UINT) override;
+    void PSSetShader(ID3D11PixelShader*, ID3D11ClassInstance* const*, UINT) override;
+    void VSSetConstantBuffers(UINT, UINT, ID3D11Buffer* const*) override;
+    void VSSetConstantBuffers1(UINT, UINT, ID3D11Buffer* const*, const UINT*, const UINT*) override;
+
+    HRESULT Map(ID3D11Resource*, UINT, D3D11_MAP, UINT, D3D11_MAPPED_SUBRESOURCE*) override;
+    void Unmap(ID3D11Resource*, UINT) override;
+    void UpdateSubresource(ID3D11Resource*, UINT, const D3D11_BOX*, const void*, UINT, UINT) override;
+
+    void DrawIndexed(UINT, UINT, INT) override;
+    void DrawIndexedInstanced(UINT, UINT, UINT, INT, UINT) override;
+
+    void End(ID3D11Asynchronous*) override;
+    HRESULT GetData(ID3D11Asynchronous*, void*, UINT, UINT) override;
+
+    HRESULT FinishCommandList(BOOL, ID3D11CommandList**) override;
+    void ExecuteCommandList(ID3D11CommandList*, BOOL) override;
+
+    // Nothing to finish, recorded flushes would only slow the replay down.
+    void Flush() override;
+
+    // Drops what was recorded and keeps the memory for the next frame.
+    void Reset();
+
+    // Replays every recorded call onto the context, in the order they were recorded.
+    void Execute(RenderContext*) const;
+
+    unsigned int GetCommandCount() const;
+    size_t GetByteCount() const;
+
+private:
+    enum class Command : uint32_t;
+
+    // Room for one command with extraBytes after its fixed part, returns the fixed part.
+    template<typename T>
+    T* Append(Command, size_t);
+
+private:
+    std::vector<uint8_t> m_data;
+    unsigned int m_commandCount;
+};
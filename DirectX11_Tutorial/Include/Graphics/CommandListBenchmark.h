@@ -0,0 +1,17 @@
+//////////////////////////////////////////////////////////////////////
+// Filename: CommandListBenchmark.h
+//////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <memory>
+
+#include "System/JobSystemBenchmark.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+// command_list_record : CommandListRecorder::Record() of 50000 draws into as many command lists
+//                       as the most threads, only the recording is timed.
+////////////////////////////////////////////////////////////////////////////////////////////////
+std::unique_ptr<JobSystemWorkload> CreateCommandListRecordWorkload();
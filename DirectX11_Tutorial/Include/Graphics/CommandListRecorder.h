@@ -0,0 +1,124 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: CommandListRecorder.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <d3d11.h>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Graphics/CommandList.h"
+#include "Graphics/RenderDevice.h"
+#include "Graphics/StateTrackingRenderContext.h"
+#include "System/JobSystem.h"
+
+struct CommandListRecorderStats
+{
+    // Of the last Record() and Submit().
+    uint64_t m_lists;
+    uint64_t m_commands;
+    uint64_t m_bytes;
+    uint64_t m_elidedBinds;
+    bool m_deferredContexts;
+    double m_recordSeconds;
+    double m_submitSeconds;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: CommandListRecorder
+//
+// Desription
+//  : Records a frame's draws into several CommandLists at once on the job system and
+//    submits them in a fixed order on the render thread.
+//
+//    Record() cuts [0, count) into contiguous ranges and list i always records range i,
+//    so what is submitted and in which order only depends on the count, not on which
+//    thread got which range. Each list is recorded through its own state tracker and
+//    starts out knowing nothing, so every list has to bind the state it draws with.
+//
+//    Submit() plays the lists onto the device context one after the other. On the
+//    hardware backend the lists are first replayed onto one deferred context each, in
+//    parallel, and the resulting ID3D11CommandLists executed in order. The other
+//    backends, and a frame that only needed one list, replay straight onto the context.
+//
+//    Record() and Submit() belong to the render thread.
+////////////////////////////////////////////////////////////////////////////////
+class CommandListRecorder
+{
+public:
+    explicit CommandListRecorder();
+    CommandListRecorder(const CommandListRecorder&) = delete;
+    ~CommandListRecorder();
+
+    // The device may be nullptr, Submit() then always replays. The count is the most lists a frame uses.
+    bool Initialize(RenderDevice*, unsigned int);
+    void Shutdown();
+
+    // Calls function(pContext, begin, end) for each list with its range of [0, count), with at
+    // least minimum items per list but the last. pJobSystem may be nullptr.
+    template <typename Function>
+    void Record(JobSystem*, unsigned int, unsigned int, const Function&);
+
+    // False when a deferred context couldn't finish its list, nothing has been submitted then.
+    bool Submit(RenderContext*, JobSystem*);
+
+    unsigned int GetListCount() const;
+    const CommandListRecorderStats& GetStats() const;
+
+private:
+    unsigned int BeginRecord(unsigned int, unsigned int);
+    void EndRecord(double);
+
+    bool SubmitDeferred(RenderContext*, JobSystem*);
+
+private:
+    std::vector<std::unique_ptr<CommandList>> m_lists;
+    std::vector<std::unique_ptr<StateTrackingRenderContext>> m_trackers;
+
+    // One per list when the device has them, empty otherwise.
+    std::vector<std::unique_ptr<RenderContext>> m_deferredContexts;
+    std::vector<ID3D11CommandList*> m_finishedLists;
+
+    unsigned int m_recordedLists;
+    CommandListRecorderStats m_stats;
+};
+
+template <typename Function>
+void CommandListRecorder::Record(JobSystem* pJobSystem, unsigned int count, unsigned int minimum, const Function& kFunction)
+{
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+    unsigned int listCount = BeginRecord(count, minimum);
+
+    auto recordList = [this, count, listCount, &kFunction](unsigned int list)
+    {
+        unsigned int begin = static_cast<unsigned int>(static_cast<uint64_t>(count) * list / listCount);
+        unsigned int end = static_cast<unsigned int>(static_cast<uint64_t>(count) * (list + 1) / listCount);
+        kFunction(static_cast<RenderContext*>(m_trackers[list].get()), begin, end);
+    };
+
+    if (listCount == 1 || !pJobSystem)
+    {
+        for (unsigned int list = 0; list < listCount; ++list)
+        {
+            recordList(list);
+        }
+    }
+    else
+    {
+        pJobSystem->ParallelFor(listCount, 1, [&recordList](unsigned int begin, unsigned int end)
+        {
+            for (unsigned int list = begin; list < end; ++list)
+            {
+                recordList(list);
+            }
+        });
+    }
+
+    EndRecord(std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count());
+}
@@ -0,0 +1,48 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: ConstantBlock.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <d3d11.h>
+#include <cstdint>
+#include <vector>
+
+#include "Graphics/RenderDevice.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: ConstantBlock
+//
+// Desription
+//  : A dynamic constant buffer of its own for constants that change rarely, like
+//    the per view ones in ShaderConstants.h. It keeps a copy of what
+//    it last uploaded and only maps the buffer when Update() is given something else,
+//    so a camera that doesn't move costs nothing.
+//
+//    Per draw constants change every draw and go through the ConstantUploadRing.
+////////////////////////////////////////////////////////////////////////////////
+class ConstantBlock
+{
+public:
+    explicit ConstantBlock();
+    ConstantBlock(const ConstantBlock&) = delete;
+    ~ConstantBlock();
+
+    bool Initialize(RenderDevice*, UINT);
+    void Shutdown();
+
+    // Copies the buffer's size worth of data when it differs from the last upload.
+    // False only when the buffer couldn't be mapped.
+    bool Update(RenderContext*, const void*);
+
+    ID3D11Buffer* GetBuffer() const;
+    uint64_t GetUploadCount() const;
+
+private:
+    ID3D11Buffer* m_pBuffer;
+    std::vector<uint8_t> m_uploaded;
+    bool m_uploadedValid;
+    uint64_t m_uploadCount;
+};
@@ -0,0 +1,128 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: ConstantUploadRing.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <d3d11.h>
+#include <cstdint>
+#include <vector>
+
+#include "Graphics/RenderDevice.h"
+
+// A window of the ring handed out by Allocate(). m_pData is only valid until EndUpload(),
+// the rest is what VSSetConstantBuffers1() takes. A zero m_constantCount means the window
+// is a buffer of its own, bind all of it with VSSetConstantBuffers().
+struct ConstantAllocation
+{
+    ID3D11Buffer* m_pBuffer;
+    UINT m_firstConstant;
+    UINT m_constantCount;
+    void* m_pData;
+};
+
+struct ConstantUploadRingStats
+{
+    uint64_t m_maps;
+    uint64_t m_allocations;
+    uint64_t m_bytesAllocated;
+    uint64_t m_failedAllocations;
+    // Allocations that didn't fit the frame's segment and got a buffer of their own.
+    uint64_t m_overflowAllocations;
+    // Times the segments were made bigger after a frame overflowed.
+    uint64_t m_growths;
+
+    // Times BeginUpload() found its segment still in use by the GPU and had to wait.
+    uint64_t m_fenceWaits;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: ConstantUploadRing
+//
+// Desription
+//  : One large dynamic constant buffer that the constants of every draw in a frame
+//    are packed into, so a frame maps it once instead of once per draw. Draws bind
+//    their window of it with VSSetConstantBuffers1().
+//
+//    The buffer is split into one segment per frame that can be in flight. A frame
+//    only writes its own segment, and an event query issued at the end of the frame
+//    tells when the GPU is done reading it. BeginUpload() waits for that before the
+//    segment is handed out again, so the buffer can be mapped with NO_OVERWRITE.
+//
+//    A frame that needs more than its segment gets a small buffer per draw for the rest,
+//    each mapped with DISCARD, and the segments are made big enough for it before the
+//    next frame. Without constant buffer offsetting or NO_OVERWRITE on constant buffers
+//    in the driver, every draw gets its own buffer that way.
+//
+//    A frame: BeginUpload(), Allocate() per draw, EndUpload(), the draws, EndFrame().
+//    D3D11 can't draw from a mapped buffer, so all writes happen before the draws.
+//    Everything here belongs to the render thread.
+////////////////////////////////////////////////////////////////////////////////
+class ConstantUploadRing
+{
+public:
+    // VSSetConstantBuffers1() windows start on a multiple of 16 constants.
+    static constexpr UINT kAlignment = 256;
+
+    explicit ConstantUploadRing();
+    ConstantUploadRing(const ConstantUploadRing&) = delete;
+    ~ConstantUploadRing();
+
+    // The bytes of a segment to start with, the segment count, and whether the driver can bind
+    // windows of a buffer and map constant buffers with NO_OVERWRITE.
+    bool Initialize(RenderDevice*, UINT, UINT, bool);
+    void Shutdown();
+
+    bool BeginUpload(RenderContext*);
+    // Only false when the device can't create or map a buffer.
+    bool Allocate(UINT, ConstantAllocation&);
+    void EndUpload(RenderContext*);
+
+    // Fences the frame's segment and moves on to the next one.
+    void EndFrame(RenderContext*);
+
+    UINT GetSegmentBytes() const;
+    const ConstantUploadRingStats& GetStats() const;
+
+private:
+    bool CreateRing(UINT);
+    void ReleaseRing();
+    void WaitForSegment(RenderContext*);
+    bool AllocateDrawBuffer(UINT, ConstantAllocation&);
+
+private:
+    RenderDevice* m_pDevice;
+    // The context of the upload in progress.
+    RenderContext* m_pUploadContext;
+    bool m_useRing;
+
+    ID3D11Buffer* m_pBuffer;
+    std::vector<ID3D11Query*> m_fences;
+    std::vector<bool> m_fencesIssued;
+
+    UINT m_segmentBytes;
+    UINT m_segmentCount;
+    UINT m_segment;
+
+    // Bytes of the current segment handed out so far.
+    UINT m_segmentOffset;
+    bool m_segmentReady;
+
+    bool m_everMapped;
+    uint8_t* m_pMappedData;
+
+    // What the frame has allocated, and what the biggest frame so far needed. The segments
+    // grow to that at the next BeginUpload().
+    UINT m_frameBytes;
+    UINT m_requiredSegmentBytes;
+
+    // Buffers of their own for the draws that don't go through the ring, reused every frame.
+    std::vector<ID3D11Buffer*> m_drawBuffers;
+    std::vector<UINT> m_drawBufferBytes;
+    unsigned int m_drawBuffersUsed;
+    unsigned int m_drawBuffersUnmapped;
+
+    ConstantUploadRingStats m_stats;
+};
@@ -0,0 +1,100 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: D3D11RenderDevice.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <d3d11_1.h>
+
+#include "Graphics/RenderDevice.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: D3D11RenderDevice
+//
+// Desription
+//  : Forwards to a hardware ID3D11Device. It does not own the device,
+//    the Direct3D class creates and releases it.
+////////////////////////////////////////////////////////////////////////////////
+class D3D11RenderDevice : public RenderDevice
+{
+public:
+    explicit D3D11RenderDevice(ID3D11Device*);
+
+    RenderBackend GetBackend() const override;
+
+    HRESULT CreateBuffer(const D3D11_BUFFER_DESC*, const D3D11_SUBRESOURCE_DATA*, ID3D11Buffer**) override;
+    HRESULT CreateVertexShader(const void*, SIZE_T, ID3D11ClassLinkage*, ID3D11VertexShader**) override;
+    HRESULT CreatePixelShader(const void*, SIZE_T, ID3D11ClassLinkage*, ID3D11PixelShader**) override;
+    HRESULT CreateInputLayout(const D3D11_INPUT_ELEMENT_DESC*, UINT, const void*, SIZE_T, ID3D11InputLayout**) override;
+    HRESULT CreateDepthStencilState(const D3D11_DEPTH_STENCIL_DESC*, ID3D11DepthStencilState**) override;
+    HRESULT CreateRasterizerState(const D3D11_RASTERIZER_DESC*, ID3D11RasterizerState**) override;
+    HRESULT CreateBlendState(const D3D11_BLEND_DESC*, ID3D11BlendState**) override;
+    HRESULT CreateSamplerState(const D3D11_SAMPLER_DESC*, ID3D11SamplerState**) override;
+    HRESULT CreateQuery(const D3D11_QUERY_DESC*, ID3D11Query**) override;
+    HRESULT CreateDeferredContext(UINT, RenderContext**) override;
+
+private:
+    ID3D11Device* m_pDevice;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: D3D11RenderContext
+//
+// Desription
+//  : Forwards to a hardware ID3D11DeviceContext. Non-owning, like D3D11RenderDevice,
+//    except for the deferred contexts D3D11RenderDevice::CreateDeferredContext() makes.
+//    The ID3D11DeviceContext1 of the same context binds constant buffers by offset. It is
+//    null on the 11.0 runtime, the constant upload ring then never hands out windows.
+////////////////////////////////////////////////////////////////////////////////
+class D3D11RenderContext : public RenderContext
+{
+public:
+    explicit D3D11RenderContext(ID3D11DeviceContext*, ID3D11DeviceContext1*);
+    // A deferred context, both released with the object. The flag is whether the driver
+    // has command lists of its own rather than the runtime emulating them.
+    D3D11RenderContext(ID3D11DeviceContext*, ID3D11DeviceContext1*, bool);
+    ~D3D11RenderContext() override;
+
+    void ClearRenderTargetView(ID3D11RenderTargetView*, const FLOAT[4]) override;
+    void ClearDepthStencilView(ID3D11DepthStencilView*, UINT, FLOAT, UINT8) override;
+
+    void OMSetRenderTargets(UINT, ID3D11RenderTargetView* const*, ID3D11DepthStencilView*) override;
+    void OMSetDepthStencilState(ID3D11DepthStencilState*, UINT) override;
+    void RSSetState(ID3D11RasterizerState*) override;
+    void RSSetViewports(UINT, const D3D11_VIEWPORT*) override;
+
+    void IASetInputLayout(ID3D11InputLayout*) override;
+    void IASetVertexBuffers(UINT, UINT, ID3D11Buffer* const*, const UINT*, const UINT*) override;
+    void IASetIndexBuffer(ID3D11Buffer*, DXGI_FORMAT, UINT) override;
+    void IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY) override;
+
+    void VSSetShader(ID3D11VertexShader*, ID3D11ClassInstance* const*, UINT) override;
+    void PSSetShader(ID3D11PixelShader*, ID3D11ClassInstance* const*, UINT) override;
+    void VSSetConstantBuffers(UINT, UINT, ID3D11Buffer* const*) override;
+    void VSSetConstantBuffers1(UINT, UINT, ID3D11Buffer* const*, const UINT*, const UINT*) override;
+
+    HRESULT Map(ID3D11Resource*, UINT, D3D11_MAP, UINT, D3D11_MAPPED_SUBRESOURCE*) override;
+    void Unmap(ID3D11Resource*, UINT) override;
+    void UpdateSubresource(ID3D11Resource*, UINT, const D3D11_BOX*, const void*, UINT, UINT) override;
+
+    void DrawIndexed(UINT, UINT, INT) override;
+    void DrawIndexedInstanced(UINT, UINT, UINT, INT, UINT) override;
+
+    void End(ID3D11Asynchronous*) override;
+    HRESULT GetData(ID3D11Asynchronous*, void*, UINT, UINT) override;
+
+    HRESULT FinishCommandList(BOOL, ID3D11CommandList**) override;
+    void ExecuteCommandList(ID3D11CommandList*, BOOL) override;
+
+    void Flush() override;
+
+private:
+    ID3D11DeviceContext* m_pDeviceContext;
+    ID3D11DeviceContext1* m_pDeviceContext1;
+    bool m_ownsDeviceContext;
+
+    // Deferred context on emulated command lists, see UpdateSubresource().
+    bool m_offsetUpdateSource;
+};
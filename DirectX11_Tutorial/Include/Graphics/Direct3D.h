@@ -23,6 +23,20 @@
 //////////////
 #include <d3d11.h>
 #include <DirectXMath.h>
+#include <memory>
+
+#include "Graphics/RenderDevice.h"
+#include "Graphics/FramePacer.h"
+#include "Graphics/PresentClock.h"
+#include "Graphics/SoftwareRenderContext.h"
+#include "Graphics/NullRenderContext.h"
+#include "Graphics/StateTrackingRenderContext.h"
+#include "Graphics/StateObjectCache.h"
+#include "Graphics/ConstantUploadRing.h"
+
+// What one frame may upload to the constant upload ring at first, 4096 draws of up to 256 bytes each.
+// The ring grows when a frame needs more.
+constexpr unsigned int CONSTANT_UPLOAD_FRAME_BYTES = 1 << 20;
 
 ////////////////////////////////////////////////////////////////////////////////
 // Class name: Direct3D
@@ -34,14 +48,34 @@ public:
     explicit Direct3D(const Direct3D&);
     ~Direct3D();
 
-    bool Initialize(int, int, bool, HWND, bool, float, float);                                                                         
+    bool Initialize(RenderBackend, JobSystem*, int, int, const FramePacingSettings&, HWND, bool, float, float);
     void Shutdown();
 
+    // Waits until the frame pacer lets the next frame start.
+    void BeginFrame();
+
     void BeginScene(float, float, float, float);
     void EndScene();
 
-    ID3D11Device* GetDevice();
-    ID3D11DeviceContext* GetDeviceContext();
+    // Binds the back and depth buffer, the viewport and the default depth stencil and rasterizer
+    // states. Any thread, as long as the context belongs to it.
+    void BindRenderTargets(RenderContext*);
+
+    const FramePacer& GetFramePacer() const;
+
+    // Rasterizer, depth stencil, blend and sampler states should be created through this.
+    StateObjectCache& GetStateObjectCache();
+
+    // Per draw constants are uploaded through this, EndScene() fences the frame's part of it.
+    ConstantUploadRing& GetConstantUploadRing();
+
+    RenderDevice* GetDevice();
+    RenderContext* GetDeviceContext();
+
+    // Only set when running on RenderBackend::Software.
+    SoftwareRenderContext* GetSoftwareRenderContext();
+    // Only set when running on RenderBackend::Null.
+    NullRenderContext* GetNullRenderContext();
 
     void GetProjectionMatrix(DirectX::XMMATRIX&);                                                                       
     void GetWorldMatrix(DirectX::XMMATRIX&);
@@ -50,18 +84,42 @@ public:
     void GetVideoCardInfo(char*, int&);
 
 private:
-    bool    m_vsyncEnabled;
+    bool InitializeHardwareDevice(int, int, HWND, bool);
+    bool InitializeSoftwareDevice(RenderBackend, JobSystem*, int, int);
+
+private:
+    FramePacingSettings m_pacingSettings;
+    double  m_refreshSeconds;
     int     m_videoCardMemory;
     char    m_videoCardDescription[128];
 
     IDXGISwapChain*             m_pSwapChain;
     ID3D11Device*               m_pDevice;
     ID3D11DeviceContext*        m_pDeviceContext;
+    ID3D11DeviceContext1*       m_pDeviceContext1;
     ID3D11RenderTargetView*     m_pRenderTargetView;
     ID3D11Texture2D*            m_pDepthStencilBuffer;
     ID3D11DepthStencilState*    m_pDepthStencilState;
     ID3D11DepthStencilView*     m_pDepthStencilView;
     ID3D11RasterizerState*      m_pRasterState;
+    // The driver binds windows of a constant buffer and maps them with NO_OVERWRITE.
+    bool                        m_constantBufferOffsetting;
+
+    std::unique_ptr<RenderDevice>   m_pRenderDevice;
+    std::unique_ptr<RenderContext>  m_pRenderContext;
+    SoftwareRenderContext*          m_pSoftwareRenderContext;
+    NullRenderContext*              m_pNullRenderContext;
+
+    // Everything is drawn through this, it drops binds of what is already bound.
+    std::unique_ptr<StateTrackingRenderContext> m_pStateTrackingContext;
+
+    StateObjectCache                m_stateObjectCache;
+    ConstantUploadRing              m_constantUploadRing;
+
+    std::unique_ptr<PresentClock>   m_pPresentClock;
+    FramePacer                      m_framePacer;
+
+    D3D11_VIEWPORT m_viewport;
 
     DirectX::XMMATRIX m_projectionMatrix;
     DirectX::XMMATRIX m_worldMatrix;
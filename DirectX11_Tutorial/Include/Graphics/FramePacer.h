@@ -0,0 +1,114 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: FramePacer.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <chrono>
+
+#include "Graphics/PresentClock.h"
+
+enum class PacingMode
+{
+    Uncapped,   // Start frames as soon as possible, present without waiting for a blank.
+    VSync,      // Present on the vertical blank, the queue of frames throttles the CPU.
+    FrameCap,   // Start frames no faster than m_frameCapHz, present without waiting.
+    JustInTime, // Present on the blank, but start each frame as late as it can while still making it.
+};
+
+struct FramePacingSettings
+{
+    PacingMode m_mode;
+    double m_frameCapHz;
+
+    // Frames the display may hold before Present() blocks.
+    unsigned int m_queuedFrames;
+
+    // Refresh rate of the simulated display used when there is no swap chain.
+    double m_simulatedRefreshHz;
+};
+
+// Timing of the last paced frame.
+struct FramePacingTiming
+{
+    // Present to present.
+    double m_frameSeconds;
+
+    // From handing the frame to the display until it is on screen.
+    double m_queuedLatencySeconds;
+    unsigned int m_queuedFrames;
+
+    // Time BeginFrame() held the frame back.
+    double m_waitSeconds;
+
+    // Time spent in PresentClock::Present().
+    double m_presentSeconds;
+};
+
+struct FramePacingStats
+{
+    unsigned long long m_frameCount;
+    double m_averageFrameSeconds;
+    double m_frameTimeVariance; // In seconds squared.
+    double m_averageQueuedLatencySeconds;
+    double m_maxQueuedLatencySeconds;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: FramePacer
+//
+// Desription
+//  : Decides when a frame starts and how it is presented.
+//
+//    BeginFrame() goes before the frame samples its input and waits for the
+//    frame's start time, EndFrame() presents through the PresentClock and
+//    records the frame time and how long the frame sits in the display queue.
+//
+//    Just in time keeps a running estimate of the frame cost and starts the
+//    frame that long (plus a margin) before the blank it is aimed at, so the
+//    input it reads is as fresh as possible when it reaches the screen.
+////////////////////////////////////////////////////////////////////////////////
+class FramePacer
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit FramePacer();
+    explicit FramePacer(const FramePacer&);
+    ~FramePacer();
+
+    void Initialize(PresentClock*, const FramePacingSettings&);
+
+    void BeginFrame();
+    void EndFrame();
+
+    PacingMode GetMode() const;
+    const FramePacingTiming& GetLastFrameTiming() const;
+    FramePacingStats GetStats() const;
+
+private:
+    // Owned by Direct3D.
+    PresentClock* m_pPresentClock;
+    FramePacingSettings m_settings;
+
+    Clock::time_point m_frameStartTime;
+    Clock::time_point m_lastPresentTime;
+    Clock::time_point m_lastDisplayTime;
+    bool m_hasPresented;
+
+    // Running estimate of BeginFrame() to EndFrame().
+    double m_frameCostSeconds;
+
+    FramePacingTiming m_lastFrameTiming;
+
+    // Welford's running mean and variance of the frame time.
+    unsigned long long m_frameCount;
+    double m_frameTimeMean;
+    double m_frameTimeM2;
+
+    unsigned long long m_latencyFrameCount;
+    double m_latencyTotalSeconds;
+    double m_latencyMaxSeconds;
+};
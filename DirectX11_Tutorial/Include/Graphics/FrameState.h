@@ -0,0 +1,67 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: FrameState.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <DirectXMath.h>
+#include <chrono>
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: FrameState
+//
+// Desription
+//  : Everything the render side needs from the scene update to draw one frame.
+//    Graphics keeps one per pipeline slot; the update writes a slot while the
+//    render thread submits another, and the two only meet at the hand-off in
+//    Graphics::Frame().
+////////////////////////////////////////////////////////////////////////////////
+struct FrameState
+{
+    unsigned long long m_frameIndex;
+
+    DirectX::XMFLOAT4X4 m_worldMatrix;
+    DirectX::XMFLOAT4X4 m_viewMatrix;
+
+    // Simulated time, blended like the rest of the scene.
+    float m_sceneSeconds;
+
+    // When the update for this frame started, for the update-to-submit latency.
+    std::chrono::steady_clock::time_point m_updateStartTime;
+
+    // How long Graphics::Update() took for this frame.
+    double m_updateSeconds;
+};
+
+// The simulated part of the scene, advanced in fixed steps by Graphics::Simulate().
+// The render gets a blend of the last two of these, see FixedTimestep.
+struct SceneState
+{
+    // Degrees for the rotation, like Camera::SetRotation.
+    DirectX::XMFLOAT3 m_cameraPosition;
+    DirectX::XMFLOAT3 m_cameraRotation;
+
+    // Radians around the view axis.
+    float m_modelRotation;
+
+    // Time simulated so far.
+    float m_sceneSeconds;
+};
+
+// CPU cost of the last frame submitted. Submit leaves out the time spent waiting in Present().
+struct FrameTimes
+{
+    double m_updateSeconds;
+    double m_submitSeconds;
+};
+
+// Update-to-submit latency of the frames submitted so far.
+struct FramePipelineStats
+{
+    unsigned int m_pipelineDepth;
+    unsigned long long m_frameCount;
+    double m_averageLatencySeconds;
+    double m_maxLatencySeconds;
+};
@@ -0,0 +1,114 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: FrustumCuller.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <DirectXMath.h>
+#include <cstdint>
+#include <vector>
+
+#include "System/JobSystem.h"
+
+// The six planes of a view frustum, a point p is inside a plane when
+// dot(plane.xyz, p) + plane.w >= 0. The xyz of every plane has unit length.
+struct Frustum
+{
+    enum Plane
+    {
+        Left,
+        Right,
+        Bottom,
+        Top,
+        Near,
+        Far,
+        PlaneCount,
+    };
+
+    DirectX::XMFLOAT4 m_planes[PlaneCount];
+};
+
+struct FrustumCullStats
+{
+    // Of the last Cull().
+    uint64_t m_tested;
+    uint64_t m_visible;
+    uint64_t m_chunks;
+    double m_cullSeconds;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: FrustumCuller
+//
+// Desription
+//  : Bounding volumes in structure of arrays form and a frustum test that runs over
+//    4 (SSE) or 8 (AVX) of them per instruction, spread over the job system.
+//
+//    Every volume is an axis aligned box given by its center and half extents, along
+//    with a sphere radius around the same center. Against each plane the volume is
+//    the tighter of the two: the box's projected radius or the sphere's. Both are
+//    conservative, so nothing visible is ever culled.
+//
+//    Volumes are referred to by the index Add() returned. Cull() hands back the
+//    indices of the visible ones in increasing order, whatever the thread count.
+//
+//    Add(), Set() and Cull() belong to one thread, the chunks of a Cull() are the
+//    only thing that runs on the job system.
+////////////////////////////////////////////////////////////////////////////////
+class FrustumCuller
+{
+public:
+    explicit FrustumCuller();
+    FrustumCuller(const FrustumCuller&) = delete;
+
+    // From a view times projection matrix, D3D clip space (z from 0 to 1).
+    static Frustum ExtractFrustum(DirectX::FXMMATRIX);
+
+    void Reserve(unsigned int);
+    void Clear();
+
+    // Center and half extents of the box. The sphere is the one around the box.
+    uint32_t Add(const DirectX::XMFLOAT3&, const DirectX::XMFLOAT3&);
+    // Center and radius of the sphere. The box is the one around the sphere.
+    uint32_t AddSphere(const DirectX::XMFLOAT3&, float);
+
+    // Moves a volume, the sphere is again the one around the box.
+    void Set(uint32_t, const DirectX::XMFLOAT3&, const DirectX::XMFLOAT3&);
+
+    // Replaces the contents of the vector with the visible indices. pJobSystem may be nullptr.
+    void Cull(const Frustum&, JobSystem*, std::vector<uint32_t>&);
+
+    unsigned int GetCount() const;
+    const FrustumCullStats& GetStats() const;
+
+private:
+    // Writes the visible indices of [begin, end) to pVisible and returns how many there are.
+    unsigned int CullRange(const Frustum&, unsigned int, unsigned int, uint32_t*) const;
+
+    void Resize(unsigned int);
+
+private:
+    // Volumes tested per chunk of a parallel cull.
+    static constexpr unsigned int kChunkSize = 16384;
+
+    // The arrays are padded to a multiple of this, so the last vector load stays in bounds.
+    static constexpr unsigned int kLaneCount = 8;
+
+    unsigned int m_count;
+
+    std::vector<float> m_centerX;
+    std::vector<float> m_centerY;
+    std::vector<float> m_centerZ;
+    std::vector<float> m_extentX;
+    std::vector<float> m_extentY;
+    std::vector<float> m_extentZ;
+    std::vector<float> m_radius;
+
+    // Every chunk writes its visible indices at its own offset, then they're packed.
+    std::vector<uint32_t> m_chunkVisible;
+    std::vector<unsigned int> m_chunkVisibleCounts;
+
+    FrustumCullStats m_stats;
+};
@@ -0,0 +1,16 @@
+//////////////////////////////////////////////////////////////////////
+// Filename: FrustumCullerBenchmark.h
+//////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <memory>
+
+#include "System/JobSystemBenchmark.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+// frustum_cull : FrustumCuller::Cull() of 1048576 boxes and spheres against one view.
+////////////////////////////////////////////////////////////////////////////////////////////////
+std::unique_ptr<JobSystemWorkload> CreateFrustumCullWorkload();
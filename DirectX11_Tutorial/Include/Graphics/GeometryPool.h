@@ -0,0 +1,120 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: GeometryPool.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <d3d11.h>
+#include <cstdint>
+#include <vector>
+
+#include "Graphics/RenderDevice.h"
+#include "System/RangeAllocator.h"
+
+// Where a mesh lives in the pool. Its indices are relative to its first vertex,
+// draw it with DrawIndexed(m_indexCount, m_startIndex, m_baseVertex).
+struct GeometryRange
+{
+    UINT m_baseVertex;
+    UINT m_vertexCount;
+    UINT m_startIndex;
+    UINT m_indexCount;
+};
+
+// Meshes are referred to by handle, Defragment() moves them around.
+using GeometryHandle = uint32_t;
+constexpr GeometryHandle INVALID_GEOMETRY_HANDLE = ~0u;
+
+struct GeometryPoolStats
+{
+    UINT m_meshCount;
+    UINT m_vertexCapacity;
+    UINT m_verticesUsed;
+    UINT m_vertexFreeRanges;
+    UINT m_largestVertexFreeRange;
+    UINT m_indexCapacity;
+    UINT m_indicesUsed;
+    UINT m_indexFreeRanges;
+    UINT m_largestIndexFreeRange;
+    uint64_t m_defragmentations;
+    uint64_t m_bytesUploaded;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: GeometryPool
+//
+// Desription
+//  : One large vertex buffer and one large index buffer that the static meshes are
+//    sub-allocated from, so every mesh of the pool draws with the same three IA binds
+//    and only the base vertex and start index change between draws.
+//
+//    Vertex and index ranges each come from a RangeAllocator. The pool keeps a system
+//    memory copy of both buffers: AddMesh() writes the copy, Bind() uploads the part
+//    that changed since the last upload with UpdateSubresource(). Defragment() packs
+//    the meshes to the front of the copy and re-uploads what moved. Indices are relative
+//    to the base vertex, so moving a mesh never rewrites its indices.
+//
+//    Every mesh in a pool has the same vertex stride and 32 bit indices, and is drawn
+//    as a triangle list. Everything but BindBuffers() belongs to the render thread.
+////////////////////////////////////////////////////////////////////////////////
+class GeometryPool
+{
+public:
+    explicit GeometryPool();
+    GeometryPool(const GeometryPool&) = delete;
+    ~GeometryPool();
+
+    // Vertex stride in bytes, then the vertex and index capacity.
+    bool Initialize(RenderDevice*, UINT, UINT, UINT);
+    void Shutdown();
+
+    // Packs the pool and tries again when the free space is there but in pieces.
+    bool AddMesh(const void*, UINT, const uint32_t*, UINT, GeometryHandle&);
+    void RemoveMesh(GeometryHandle);
+
+    // Only valid until the next AddMesh(), RemoveMesh() or Defragment().
+    const GeometryRange& GetRange(GeometryHandle) const;
+
+    // Uploads what changed and puts the pool's buffers on the input assembler.
+    void Bind(RenderContext*);
+    // Only puts the buffers on the input assembler, for command lists recorded on other
+    // threads once Bind() has uploaded everything on the render thread.
+    void BindBuffers(RenderContext*) const;
+
+    // Moves every mesh down to close the gaps, returns how many moved.
+    UINT Defragment();
+
+    GeometryPoolStats GetStats() const;
+
+private:
+    void MarkVerticesDirty(UINT, UINT);
+    void MarkIndicesDirty(UINT, UINT);
+    void Upload(RenderContext*);
+
+private:
+    ID3D11Buffer* m_pVertexBuffer;
+    ID3D11Buffer* m_pIndexBuffer;
+    UINT m_vertexStride;
+
+    std::vector<uint8_t> m_vertexData;
+    std::vector<uint32_t> m_indexData;
+
+    RangeAllocator m_vertexRanges;
+    RangeAllocator m_indexRanges;
+
+    // Indexed by handle, a removed mesh's handle goes on m_freeHandles for reuse.
+    std::vector<GeometryRange> m_meshes;
+    std::vector<bool> m_meshInUse;
+    std::vector<GeometryHandle> m_freeHandles;
+
+    // What the buffers are missing from the system memory copy, begin >= end when nothing.
+    UINT m_dirtyVertexBegin;
+    UINT m_dirtyVertexEnd;
+    UINT m_dirtyIndexBegin;
+    UINT m_dirtyIndexEnd;
+
+    uint64_t m_defragmentations;
+    uint64_t m_bytesUploaded;
+};
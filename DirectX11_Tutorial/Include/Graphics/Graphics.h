@@ -2,17 +2,72 @@
 
 #include <windows.h>
 #include <memory>
+#include <vector>
 
 #include "Graphics/Direct3D.h"
 #include "Graphics/Camera.h"
 #include "Graphics/Model.h"
 #include "Graphics/ColorShader.h"
+#include "Graphics/CommandListRecorder.h"
+#include "Graphics/AabbTree.h"
+#include "Graphics/OcclusionCuller.h"
+#include "Graphics/TransformHierarchy.h"
+#include "Graphics/ConstantBlock.h"
+#include "Graphics/GeometryPool.h"
+#include "Graphics/RenderQueue.h"
+#include "Graphics/FrameState.h"
+#include "System/JobSystem.h"
+#include "System/FixedTimestep.h"
 
 constexpr bool FULL_SCREEN = false;
 constexpr bool VSYNC_ENABLED = true;
+
+// Frames the display may queue before presenting blocks, 3 is what DXGI does by default.
+constexpr unsigned int DEFAULT_QUEUED_FRAMES = 3;
+// Refresh rate of the display simulated when there is no swap chain.
+constexpr double DEFAULT_SIMULATED_REFRESH_HZ = 60.0;
 constexpr float SCREEN_DEPTH = 1000.0f;
 constexpr float SCREEN_NEAR = 0.1f;
 
+// Frames in flight between the scene update and the render submission.
+// 1 updates and renders each frame back to back, 2 updates frame N+1 while frame N is submitted.
+constexpr unsigned int DEFAULT_PIPELINE_DEPTH = 2;
+
+// The scene is simulated at this rate whatever the render rate is.
+constexpr double DEFAULT_SIMULATION_RATE = 120.0;
+constexpr unsigned int MAX_SIMULATION_STEPS_PER_FRAME = 8;
+constexpr float MODEL_SPIN_SPEED = 0.5f; // Radians per second.
+// Room in the geometry pool that every static mesh is placed in.
+constexpr UINT GEOMETRY_POOL_VERTICES = 1 << 16;
+constexpr UINT GEOMETRY_POOL_INDICES = 3 << 16;
+
+// Fewest draws a command list is recorded with, below this one thread records the frame.
+constexpr unsigned int MIN_DRAWS_PER_COMMAND_LIST = 1024;
+
+// The occlusion culling's depth buffer is the screen size divided by this.
+constexpr unsigned int OCCLUSION_BUFFER_DIVISOR = 4;
+
+// Distance between the copies of the model in the -instances grid.
+constexpr float INSTANCE_GRID_SPACING = 2.5f;
+
+// What the command line sets up the renderer with.
+struct GraphicsSettings
+{
+    int m_screenWidth;
+    int m_screenHeight;
+    RenderBackend m_backend;
+
+    // See DEFAULT_PIPELINE_DEPTH and DEFAULT_SIMULATION_RATE.
+    unsigned int m_pipelineDepth;
+    double m_simulationRate;
+    FramePacingSettings m_pacing;
+
+    // Size of the model grid and whether it is drawn with one draw per copy instead of one
+    // instanced draw. Zero draws the single model.
+    unsigned int m_instanceCount;
+    bool m_separateDraws;
+};
+
 class Graphics
 {
 public:
@@ -20,17 +75,114 @@ public:
     explicit Graphics(const Graphics&);
     ~Graphics();
 
-    bool Initialize(int, int, HWND);
+    bool Initialize(HWND, JobSystem*, const GraphicsSettings&);
     void Shutdown();
+
+    // Render thread, before the frame reads its input.
+    void BeginFrame();
     bool Frame();
 
+    // Simulates every frame as if frameSeconds had passed, zero follows the real time.
+    // Call before the first frame.
+    void SetFixedFrameTime(double);
+
+    FramePipelineStats GetPipelineStats() const;
+    FixedTimestepStats GetSimulationStats() const;
+    FramePacingStats GetPacingStats() const;
+    const FrameTimes& GetLastFrameTimes() const;
+    // Only set when running on RenderBackend::Null. Read it once the frames are done.
+    const NullRenderContext* GetNullRenderContext() const;
+    // Only set when running on RenderBackend::Software.
+    const SoftwareRenderContext* GetSoftwareRenderContext() const;
+
 private:
-    bool Render();
+    // What a render queue entry points back to.
+    struct DrawPacket
+    {
+        enum class Kind
+        {
+            Model,
+            ModelInstances,
+        };
+
+        Kind m_kind;
+        Model* m_pModel;
+        // Only for Kind::Model. The copy of the grid it draws, or kSpinningModel.
+        uint32_t m_object;
+        ConstantAllocation m_parameters;
+    };
 
 private:
+    void Simulate(SceneState&, float);
+    void Update(FrameState&);
+    bool Render(const FrameState&);
+    bool Draw(RenderContext*, const DrawPacket&);
+
+    void StartUpdate();
+    void FinishUpdate();
+    static void UpdateJob(void*);
+
+private:
+    // Owned by System.
+    JobSystem* m_pJobSystem;
+
     std::unique_ptr<Direct3D> m_pDirect3D;
     std::unique_ptr<Camera> m_pCamera;
+    GeometryPool m_geometryPool;
     std::unique_ptr<Model> m_pModel;
     std::unique_ptr<ColorShader> m_pColorShader;
+
+    // Shared by every shader, see ShaderConstants.h. Render thread only.
+    ConstantBlock m_viewConstants;
+
+    // The bounds of everything that draws, only what is in view gets a draw packet.
+    AabbTree m_sceneTree;
+    AabbProxy m_modelProxy;
+    std::vector<uint32_t> m_visibleVolumes;
+    // The tree only knows the fat boxes. The candidates it finds are culled again by their
+    // own boxes, indexed by volume, in one batch of the SIMD culler.
+    std::vector<DirectX::XMFLOAT3> m_volumeCenters;
+    std::vector<DirectX::XMFLOAT3> m_volumeExtents;
+    FrustumCuller m_candidateCuller;
+    std::vector<uint32_t> m_frustumCandidates;
+    std::vector<uint32_t> m_frustumVisible;
+    // The model is drawn into it as an occluder, what is in view and behind it gets no packet.
+    OcclusionCuller m_occlusionCuller;
+    std::vector<Aabb> m_occludeeAabbs;
+    std::vector<uint32_t> m_unoccluded;
+
+    // The frame's draws, rebuilt and sorted by every Render().
+    RenderQueue m_renderQueue;
+    std::vector<DrawPacket> m_drawPackets;
+    // Records the sorted draws on the job system, one command list per thread.
+    CommandListRecorder m_commandRecorder;
+    // Where the instance grid's draw is sorted by depth from.
+    DirectX::XMFLOAT3 m_instanceGridCenter;
+    // The world matrices of the grid's copies when each one is a draw of its own.
+    std::vector<DirectX::XMFLOAT4X4> m_objectWorlds;
+
+    // Only touched by the update.
+    FixedTimestep m_timestep;
+    // The scene's root with the world matrix Direct3D starts with, and the model under it.
+    TransformHierarchy m_transforms;
+    TransformHandle m_rootTransform;
+    TransformHandle m_modelTransform;
+    SceneState m_previousScene;
+    SceneState m_currentScene;
+
+    // One slot per frame in flight. Frames are updated in order into slot
+    // (frame % depth), at most one update runs at a time and it never gets
+    // more than depth - 1 frames ahead of the render.
+    std::vector<FrameState> m_frameStates;
+    unsigned long long m_nextUpdateFrame;
+    unsigned long long m_nextRenderFrame;
+    JobCounter m_updateCounter;
+    bool m_updateRunning;
+
+    FrameTimes m_lastFrameTimes;
+
+    unsigned long long m_latencyFrameCount;
+    double m_latencyTotalSeconds;
+    double m_latencyMaxSeconds;
 };
 
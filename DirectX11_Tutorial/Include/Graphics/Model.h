@@ -2,38 +2,72 @@
 
 #include <d3d11.h>
 #include <DirectXMath.h>
+#include <cstdint>
+#include <vector>
+
+#include "Graphics/RenderDevice.h"
+#include "Graphics/GeometryPool.h"
+
+// One copy of the model in an instanced draw, read from the second vertex buffer.
+// This must match the per-instance part of the instanced layout in the ColorShader.
+// The world matrix isn't transposed, the shader puts it together from its rows.
+struct ModelInstance
+{
+	DirectX::XMFLOAT4X4 m_world;
+	DirectX::XMFLOAT4 m_tint;
+};
 
 // This is responsible for encapsulatin the geometry for 3D models.
+// The vertices and indices live in a GeometryPool shared with the other models,
+// bind the pool once and draw each model with the range from GetGeometry().
 class Model
 {
-private:
-	// This typedef must match the layout in the ColorShader
+public:
+	// This typedef must match the layout in the ColorShader, and is the vertex stride of the geometry pool.
 	struct Vertex
 	{
 		DirectX::XMFLOAT3 m_position;
 		DirectX::XMFLOAT4 m_color;
 	};
 
-public:
 	Model();
 	Model(const Model& kOther);
 	~Model();
 
-	bool Initialize(ID3D11Device* pDevice);
+	bool Initialize(GeometryPool* pGeometryPool);
 	void Shutdown();
-	void Render(ID3D11DeviceContext* pDeviceContext);
 
-	int GetIndexCount();
+	// Creates the per-instance vertex buffer, a batch can hold up to maxInstances.
+	bool InitializeInstances(RenderDevice* pDevice, unsigned int maxInstances);
+	// Replaces the batch of instances the next instanced draws use.
+	bool SetInstances(RenderContext* pDeviceContext, const ModelInstance* pInstances, unsigned int instanceCount);
+	// Puts the instance batch on the pipeline for ColorShader::RenderInstanced, next to the bound geometry pool.
+	void RenderInstanced(RenderContext* pDeviceContext);
+
+	const GeometryRange& GetGeometry() const;
+	GeometryHandle GetGeometryHandle() const;
+	unsigned int GetInstanceCount() const;
+	// The box around the vertices in model space, as a center and half extents.
+	void GetBounds(DirectX::XMFLOAT3& center, DirectX::XMFLOAT3& extents) const;
+	// A copy of the positions and indices on the CPU, for the occlusion culling to rasterize.
+	const std::vector<DirectX::XMFLOAT3>& GetPositions() const;
+	const std::vector<uint32_t>& GetIndices() const;
 
 private:
-	bool InitializeBuffers(ID3D11Device* pDevice);
+	bool InitializeBuffers(GeometryPool* pGeometryPool);
 	void ShutdownBuffers();
-	void RenderBuffers(ID3D11DeviceContext* pDeviceContext);
 
 private:
-	ID3D11Buffer* m_pVertexBuffer;
-	ID3D11Buffer* m_pIndexBuffer;
+	GeometryPool* m_pGeometryPool;
+	GeometryHandle m_geometry;
+	ID3D11Buffer* m_pInstanceBuffer;
 	int m_vertexCount;
 	int m_indexCount;
+	unsigned int m_maxInstanceCount;
+	unsigned int m_instanceCount;
+	DirectX::XMFLOAT3 m_boundsCenter;
+	DirectX::XMFLOAT3 m_boundsExtents;
+	std::vector<DirectX::XMFLOAT3> m_positions;
+	std::vector<uint32_t> m_indices;
 };
 
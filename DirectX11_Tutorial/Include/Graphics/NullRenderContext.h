@@ -0,0 +1,97 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: NullRenderContext.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <d3d11.h>
+#include <cstdint>
+
+#include "Graphics/RenderDevice.h"
+
+// What the null context has been asked to do since the last ResetCounters(), or over all frames.
+struct NullRenderCounters
+{
+    uint64_t m_clears;
+    uint64_t m_outputMergerBinds;
+    uint64_t m_rasterizerBinds;
+    uint64_t m_inputLayoutBinds;
+    uint64_t m_vertexBufferBinds;
+    uint64_t m_indexBufferBinds;
+    uint64_t m_topologyBinds;
+    uint64_t m_shaderBinds;
+    uint64_t m_constantBufferBinds;
+    uint64_t m_maps;
+    uint64_t m_unmaps;
+    uint64_t m_bytesMapped;
+    uint64_t m_updates;
+    uint64_t m_bytesUpdated;
+    uint64_t m_drawCalls;
+    uint64_t m_indicesSubmitted;
+    uint64_t m_instancesSubmitted;
+    uint64_t m_flushes;
+    uint64_t m_queries;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: NullRenderContext
+//
+// Desription
+//  : Accepts every call and only counts it, nothing is rasterized.
+//    Used with RenderBackend::Null to measure the CPU cost of the submission path
+//    on its own. Map() returns the system memory of the SoftwareBuffer so the
+//    caller's writes are real, they are just never read back.
+////////////////////////////////////////////////////////////////////////////////
+class NullRenderContext : public RenderContext
+{
+public:
+    NullRenderContext();
+
+    void ClearRenderTargetView(ID3D11RenderTargetView*, const FLOAT[4]) override;
+    void ClearDepthStencilView(ID3D11DepthStencilView*, UINT, FLOAT, UINT8) override;
+
+    void OMSetRenderTargets(UINT, ID3D11RenderTargetView* const*, ID3D11DepthStencilView*) override;
+    void OMSetDepthStencilState(ID3D11DepthStencilState*, UINT) override;
+    void RSSetState(ID3D11RasterizerState*) override;
+    void RSSetViewports(UINT, const D3D11_VIEWPORT*) override;
+
+    void IASetInputLayout(ID3D11InputLayout*) override;
+    void IASetVertexBuffers(UINT, UINT, ID3D11Buffer* const*, const UINT*, const UINT*) override;
+    void IASetIndexBuffer(ID3D11Buffer*, DXGI_FORMAT, UINT) override;
+    void IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY) override;
+
+    void VSSetShader(ID3D11VertexShader*, ID3D11ClassInstance* const*, UINT) override;
+    void PSSetShader(ID3D11PixelShader*, ID3D11ClassInstance* const*, UINT) override;
+    void VSSetConstantBuffers(UINT, UINT, ID3D11Buffer* const*) override;
+    void VSSetConstantBuffers1(UINT, UINT, ID3D11Buffer* const*, const UINT*, const UINT*) override;
+
+    HRESULT Map(ID3D11Resource*, UINT, D3D11_MAP, UINT, D3D11_MAPPED_SUBRESOURCE*) override;
+    void Unmap(ID3D11Resource*, UINT) override;
+    void UpdateSubresource(ID3D11Resource*, UINT, const D3D11_BOX*, const void*, UINT, UINT) override;
+
+    void DrawIndexed(UINT, UINT, INT) override;
+    void DrawIndexedInstanced(UINT, UINT, UINT, INT, UINT) override;
+
+    void End(ID3D11Asynchronous*) override;
+    HRESULT GetData(ID3D11Asynchronous*, void*, UINT, UINT) override;
+
+    HRESULT FinishCommandList(BOOL, ID3D11CommandList**) override;
+    void ExecuteCommandList(ID3D11CommandList*, BOOL) override;
+
+    void Flush() override;
+
+    const NullRenderCounters& GetCounters() const;
+    void ResetCounters();
+
+    // Adds the frame's counters to the totals and resets them, Direct3D calls it at the end of every frame.
+    void EndFrame();
+    const NullRenderCounters& GetTotals() const;
+    unsigned long long GetFrameCount() const;
+
+private:
+    NullRenderCounters m_counters;
+    NullRenderCounters m_totals;
+    unsigned long long m_frameCount;
+};
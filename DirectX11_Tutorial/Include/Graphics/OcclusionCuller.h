@@ -0,0 +1,147 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: OcclusionCuller.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <DirectXMath.h>
+#include <cstdint>
+#include <vector>
+
+#include "Graphics/AabbTree.h"
+#include "System/JobSystem.h"
+
+struct OcclusionCullStats
+{
+    // Of the last Rasterize().
+    uint64_t m_occluderTriangles;
+    uint64_t m_rasterizedTriangles; // In front of the near plane, on screen and facing the camera.
+    double m_rasterizeSeconds;
+    // Of the last Cull().
+    uint64_t m_tested;
+    uint64_t m_culled;
+    double m_testSeconds;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: OcclusionCuller
+//
+// Desription
+//  : A small software depth buffer that a few large occluder meshes are rasterized
+//    into on the CPU, so the boxes of what they hide can be dropped before they cost
+//    a draw.
+//
+//    The buffer is cut into tiles of 8x8 pixels, and each tile keeps the farthest depth
+//    in it. A box is projected to its screen rectangle and its nearest depth, and it is
+//    hidden when every tile under the rectangle is nearer than that. Only the tiles that
+//    don't decide it on their own have their pixels looked at.
+//
+//    Everything errs on the side of drawing. Pixels are covered only when their center is
+//    inside a triangle, with D3D's top-left rule for centers on an edge. Occluder triangles
+//    that face away or cross the near plane are skipped. Boxes that cross the near plane are
+//    always visible.
+//
+//    Rasterize() cuts the screen into bands of rows and rasterizes every band on the job
+//    system. The rows are filled 4 pixels at a time with SSE, and a box's corners are
+//    projected 4 at a time. The scalar code does the same arithmetic in the same order, so
+//    both give the same buffer bit for bit (RunOcclusionCullerCheck() compares them).
+//
+//    Depth is D3D's: 0 at the near plane and 1 at the far plane, with clockwise front
+//    faces. BeginFrame(), AddOccluder(), Rasterize() and Cull() belong to one thread.
+//    IsVisible() only reads and can run anywhere after Rasterize().
+////////////////////////////////////////////////////////////////////////////////
+class OcclusionCuller
+{
+public:
+    explicit OcclusionCuller();
+    OcclusionCuller(const OcclusionCuller&) = delete;
+
+    // Size of the depth buffer in pixels. The screen maps onto it whatever its own size is.
+    bool Initialize(unsigned int, unsigned int);
+    void Shutdown();
+
+    // Drops the occluders of the last frame. From a view times projection matrix.
+    void BeginFrame(DirectX::FXMMATRIX);
+
+    // Positions and triangle list indices of a mesh and its world matrix. The arrays are
+    // read by Rasterize() and have to stay alive until then.
+    void AddOccluder(const DirectX::XMFLOAT3*, unsigned int, const uint32_t*, unsigned int, DirectX::FXMMATRIX);
+
+    // Clears the buffer and rasterizes the occluders into it. pJobSystem may be nullptr.
+    void Rasterize(JobSystem*);
+
+    // False when the occluders hide all of the box.
+    bool IsVisible(const Aabb&) const;
+    // Replaces the contents of the vector with the indices of the boxes that are visible, in
+    // increasing order. pJobSystem may be nullptr.
+    void Cull(const Aabb*, unsigned int, JobSystem*, std::vector<uint32_t>&);
+
+    // False runs the scalar code even where SSE is there. For the checks.
+    void SetSimd(bool);
+    // Of a pixel after Rasterize(), 1 where no occluder covers it. For the checks.
+    float GetDepth(unsigned int, unsigned int) const;
+
+    unsigned int GetWidth() const;
+    unsigned int GetHeight() const;
+    const OcclusionCullStats& GetStats() const;
+
+private:
+    struct Occluder
+    {
+        const DirectX::XMFLOAT3* m_pPositions;
+        unsigned int m_positionCount;
+        const uint32_t* m_pIndices;
+        unsigned int m_indexCount;
+        DirectX::XMFLOAT4X4 m_worldViewProjection;
+    };
+
+    // A triangle in buffer pixels, with its depth as a plane over the buffer.
+    struct ScreenTriangle
+    {
+        float m_x[3];
+        float m_y[3];
+        float m_depthX;
+        float m_depthY;
+        float m_depthOrigin;
+        int m_minX;
+        int m_maxX;
+        int m_minY;
+        int m_maxY;
+    };
+
+    bool ProjectAabb(const Aabb&, float&, float&, float&, float&, float&) const;
+    void SetupTriangles(const Occluder&);
+    void RasterizeBand(unsigned int);
+    void RasterizeTriangle(const ScreenTriangle&, int, int);
+    void UpdateTiles(unsigned int, unsigned int);
+
+private:
+    static constexpr unsigned int kTileSize = 8;
+    // Tile rows per band of a parallel Rasterize().
+    static constexpr unsigned int kBandTileRows = 4;
+    // Boxes per job of a parallel Cull().
+    static constexpr unsigned int kCullChunkSize = 256;
+
+    unsigned int m_width;
+    unsigned int m_height;
+    // Rows are padded to a multiple of the tile size.
+    unsigned int m_stride;
+    unsigned int m_tileColumns;
+    unsigned int m_tileRows;
+
+    std::vector<float> m_depth;
+    std::vector<float> m_tileMaxDepth;
+
+    DirectX::XMFLOAT4X4 m_viewProjection;
+    std::vector<Occluder> m_occluders;
+    std::vector<DirectX::XMFLOAT4> m_projectedPositions;
+    std::vector<ScreenTriangle> m_triangles;
+
+    std::vector<uint8_t> m_visibleFlags;
+
+    bool m_simd;
+
+    OcclusionCullStats m_stats;
+};
@@ -0,0 +1,40 @@
+//////////////////////////////////////////////////////////////////////
+// Filename: OcclusionCullerBenchmark.h
+//////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <memory>
+
+#include "System/JobSystemBenchmark.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+// occlusion_cull : OcclusionCuller::Rasterize() of 500 boxes into a 480x270 buffer, then
+//                  Cull() of 10000 boxes against it.
+////////////////////////////////////////////////////////////////////////////////////////////////
+std::unique_ptr<JobSystemWorkload> CreateOcclusionCullWorkload();
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+// Checks what OcclusionCuller promises against a reference in doubles and writes how many
+// pixels and boxes broke each promise to stdout. True when none did.
+//
+//  simd_mismatches      : Pixels and boxes the SSE code on the job system and the scalar code
+//                         on the calling thread disagree on. Both runs are scalar in a build
+//                         without SSE.
+//  covered_outside      : Pixels covered although their center isn't in any triangle.
+//  uncovered_inside     : Pixels left at the far depth although their center is in a triangle.
+//  nearer_than_occluder : Pixels nearer than every triangle over their center.
+//  shared_edge_errors   : Pixels of a mesh, rasterized one triangle at a time, that no triangle
+//                         or more than one covered. The top-left rule gives each exactly one.
+//  back_face_errors     : Pixels covered by the same mesh facing away.
+//  hidden_errors        : Boxes Cull() dropped although they cross the near plane, are off
+//                         screen or a pixel under them is behind them.
+//
+// The scenes are streets of boxes like the occlusion_cull one with other seeds and a few boxes
+// around the camera, and meshes with their vertices on pixel centers and quarter pixels, so
+// that many centers are right on an edge. Only the centers and depths that floats can't tell
+// from an edge or a triangle's depth are left out of the reference's verdict.
+////////////////////////////////////////////////////////////////////////////////////////////////
+bool RunOcclusionCullerCheck();
@@ -0,0 +1,103 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: PresentClock.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <chrono>
+#include <deque>
+#include <d3d11.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: PresentClock
+//
+// Desription
+//  : Where finished frames go and when they show up. FramePacer only talks to
+//    the display through this, so the same pacing runs on a real swap chain
+//    and on a simulated display in a headless run.
+////////////////////////////////////////////////////////////////////////////////
+class PresentClock
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    virtual ~PresentClock() {}
+
+    // Time between two vertical blanks, zero when the display has none.
+    virtual double GetRefreshSeconds() const = 0;
+
+    // Hands the frame over. syncInterval 0 shows it right away, 1 on the next
+    // vertical blank. Blocks while the display already has as many frames
+    // queued as it allows. Returns when the frame is (expected to be) on screen.
+    virtual Clock::time_point Present(unsigned int) = 0;
+
+    // Frames handed over that aren't on screen yet.
+    virtual unsigned int GetQueuedFrameCount() const = 0;
+
+    // Sleeps most of the way and spins the last stretch, the scheduler
+    // alone overshoots by more than a millisecond.
+    static void SleepUntil(Clock::time_point);
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: SwapChainPresentClock
+//
+// Desription
+//  : Presents a DXGI swap chain. The device queues at most maxQueuedFrames
+//    frames, the display time comes from the swap chain frame statistics
+//    and falls back to the time Present() returned when they aren't available
+//    (windowed mode on older systems).
+////////////////////////////////////////////////////////////////////////////////
+class SwapChainPresentClock : public PresentClock
+{
+public:
+    explicit SwapChainPresentClock();
+    ~SwapChainPresentClock();
+
+    bool Initialize(IDXGISwapChain*, ID3D11Device*, double, unsigned int);
+
+    double GetRefreshSeconds() const override;
+    Clock::time_point Present(unsigned int) override;
+    unsigned int GetQueuedFrameCount() const override;
+
+private:
+    IDXGISwapChain* m_pSwapChain;
+    double m_refreshSeconds;
+    unsigned int m_queuedFrameCount;
+    LARGE_INTEGER m_performanceFrequency;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: SimulatedDisplay
+//
+// Desription
+//  : A display that only exists as a vertical blank every refreshSeconds from
+//    the moment it is created. A synced frame flips on the first blank after
+//    both its present and the previous flip, an unsynced one flips at once.
+//    Present() really sleeps while the queue is full, so a headless run is
+//    paced the same way a window would be.
+////////////////////////////////////////////////////////////////////////////////
+class SimulatedDisplay : public PresentClock
+{
+public:
+    explicit SimulatedDisplay(double, unsigned int);
+    ~SimulatedDisplay();
+
+    double GetRefreshSeconds() const override;
+    Clock::time_point Present(unsigned int) override;
+    unsigned int GetQueuedFrameCount() const override;
+
+private:
+    Clock::time_point NextVBlank(Clock::time_point) const;
+
+private:
+    double m_refreshSeconds;
+    unsigned int m_maxQueuedFrames;
+    Clock::time_point m_startTime;
+    Clock::time_point m_lastFlipTime;
+
+    // Flip times of the frames presented but not yet retired.
+    mutable std::deque<Clock::time_point> m_pendingFlips;
+};
@@ -0,0 +1,110 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: RenderDevice.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <d3d11.h>
+
+class RenderContext;
+
+////////////////////////////////////////////////////////////////////////////////
+// Which implementation sits behind the Direct3D class.
+//
+//  Hardware : D3D11CreateDeviceAndSwapChain with D3D_DRIVER_TYPE_HARDWARE.
+//  Software : Tile-binned multithreaded CPU rasterizer (no GPU, no window needed).
+//  Null     : Records every call into counters and draws nothing.
+////////////////////////////////////////////////////////////////////////////////
+enum class RenderBackend
+{
+    Hardware,
+    Software,
+    Null,
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: RenderDevice
+//
+// Desription
+//  : The subset of ID3D11Device the engine uses to create its resources.
+//    The signatures are kept identical to the D3D11 ones so call sites read the same.
+//
+//    Software backends don't run compiled shader bytecode. They take the HLSL entry
+//    point name (e.g. "ColorVertexShader") in place of the bytecode and bind the
+//    matching C++ implementation instead.
+////////////////////////////////////////////////////////////////////////////////
+class RenderDevice
+{
+public:
+    virtual ~RenderDevice() = default;
+
+    virtual RenderBackend GetBackend() const = 0;
+
+    virtual HRESULT CreateBuffer(const D3D11_BUFFER_DESC*, const D3D11_SUBRESOURCE_DATA*, ID3D11Buffer**) = 0;
+    virtual HRESULT CreateVertexShader(const void*, SIZE_T, ID3D11ClassLinkage*, ID3D11VertexShader**) = 0;
+    virtual HRESULT CreatePixelShader(const void*, SIZE_T, ID3D11ClassLinkage*, ID3D11PixelShader**) = 0;
+    virtual HRESULT CreateInputLayout(const D3D11_INPUT_ELEMENT_DESC*, UINT, const void*, SIZE_T, ID3D11InputLayout**) = 0;
+    virtual HRESULT CreateDepthStencilState(const D3D11_DEPTH_STENCIL_DESC*, ID3D11DepthStencilState**) = 0;
+    virtual HRESULT CreateRasterizerState(const D3D11_RASTERIZER_DESC*, ID3D11RasterizerState**) = 0;
+    virtual HRESULT CreateBlendState(const D3D11_BLEND_DESC*, ID3D11BlendState**) = 0;
+    virtual HRESULT CreateSamplerState(const D3D11_SAMPLER_DESC*, ID3D11SamplerState**) = 0;
+    virtual HRESULT CreateQuery(const D3D11_QUERY_DESC*, ID3D11Query**) = 0;
+
+    // The new context belongs to the caller, delete it when done. Backends without
+    // deferred contexts return E_NOTIMPL, record into a CommandList instead.
+    virtual HRESULT CreateDeferredContext(UINT, RenderContext**) = 0;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: RenderContext
+//
+// Desription
+//  : The subset of ID3D11DeviceContext (and ID3D11DeviceContext1) the engine uses
+//    to draw a frame. Flush() is where deferred backends (the software rasterizer)
+//    finish the frame.
+//
+//    FinishCommandList() and ExecuteCommandList() only do something on the hardware
+//    backend, the only one with deferred contexts.
+////////////////////////////////////////////////////////////////////////////////
+class RenderContext
+{
+public:
+    virtual ~RenderContext() = default;
+
+    virtual void ClearRenderTargetView(ID3D11RenderTargetView*, const FLOAT[4]) = 0;
+    virtual void ClearDepthStencilView(ID3D11DepthStencilView*, UINT, FLOAT, UINT8) = 0;
+
+    virtual void OMSetRenderTargets(UINT, ID3D11RenderTargetView* const*, ID3D11DepthStencilView*) = 0;
+    virtual void OMSetDepthStencilState(ID3D11DepthStencilState*, UINT) = 0;
+    virtual void RSSetState(ID3D11RasterizerState*) = 0;
+    virtual void RSSetViewports(UINT, const D3D11_VIEWPORT*) = 0;
+
+    virtual void IASetInputLayout(ID3D11InputLayout*) = 0;
+    virtual void IASetVertexBuffers(UINT, UINT, ID3D11Buffer* const*, const UINT*, const UINT*) = 0;
+    virtual void IASetIndexBuffer(ID3D11Buffer*, DXGI_FORMAT, UINT) = 0;
+    virtual void IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY) = 0;
+
+    virtual void VSSetShader(ID3D11VertexShader*, ID3D11ClassInstance* const*, UINT) = 0;
+    virtual void PSSetShader(ID3D11PixelShader*, ID3D11ClassInstance* const*, UINT) = 0;
+    virtual void VSSetConstantBuffers(UINT, UINT, ID3D11Buffer* const*) = 0;
+    // Binds a window of each buffer. The window starts and ends on a multiple of 16 constants (256 bytes).
+    virtual void VSSetConstantBuffers1(UINT, UINT, ID3D11Buffer* const*, const UINT*, const UINT*) = 0;
+
+    virtual HRESULT Map(ID3D11Resource*, UINT, D3D11_MAP, UINT, D3D11_MAPPED_SUBRESOURCE*) = 0;
+    virtual void Unmap(ID3D11Resource*, UINT) = 0;
+    // Only buffers are used with it, the box is a byte range of the buffer.
+    virtual void UpdateSubresource(ID3D11Resource*, UINT, const D3D11_BOX*, const void*, UINT, UINT) = 0;
+
+    virtual void DrawIndexed(UINT, UINT, INT) = 0;
+    virtual void DrawIndexedInstanced(UINT, UINT, UINT, INT, UINT) = 0;
+
+    virtual void End(ID3D11Asynchronous*) = 0;
+    virtual HRESULT GetData(ID3D11Asynchronous*, void*, UINT, UINT) = 0;
+
+    virtual HRESULT FinishCommandList(BOOL, ID3D11CommandList**) = 0;
+    virtual void ExecuteCommandList(ID3D11CommandList*, BOOL) = 0;
+
+    virtual void Flush() = 0;
+};
@@ -0,0 +1,110 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: RenderQueue.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstdint>
+#include <vector>
+
+#include "System/JobSystem.h"
+
+// Passes are drawn in this order, it is the top of every key.
+enum class RenderPass : uint32_t
+{
+    Opaque = 0,
+    Transparent = 1,
+};
+
+// A draw in the queue. m_packet is whatever the caller uses to find the draw again,
+// usually an index into its own array of draw packets.
+struct RenderQueueEntry
+{
+    uint64_t m_key;
+    uint32_t m_packet;
+    uint32_t m_padding;
+};
+
+struct RenderQueueStats
+{
+    uint64_t m_entries;
+    // Of the eight 8 bit digits, how many differed between the keys and had to be sorted.
+    uint64_t m_radixPasses;
+    uint64_t m_chunks;
+    double m_sortSeconds;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: RenderQueue
+//
+// Desription
+//  : The draws of a frame as 64 bit keys, sorted before they are submitted so that
+//    draws sharing a shader, state and mesh end up next to each other and opaque
+//    draws go front to back for early z.
+//
+//    Key layout, most significant bits first:
+//
+//      Opaque      : pass 4 | shader 10 | state 10 | mesh 16 | depth 24 (near first)
+//      Transparent : pass 4 | depth 24 (far first) | shader 10 | state 10 | mesh 16
+//
+//    Sort() is an LSD radix sort over 8 bit digits. Digits that are the same in every
+//    key are skipped, which is most of them when a frame has few shaders and states.
+//    It is stable, draws with equal keys stay in the order they were pushed. Large
+//    queues are split into one chunk per thread: each chunk counts its digits, a prefix
+//    sum over (digit, chunk) gives every chunk its own write offsets, and the chunks
+//    scatter in parallel.
+//
+//    Push() belongs to one thread, fill the queue from the render thread.
+////////////////////////////////////////////////////////////////////////////////
+class RenderQueue
+{
+public:
+    static constexpr unsigned int kPassBits = 4;
+    static constexpr unsigned int kShaderBits = 10;
+    static constexpr unsigned int kStateBits = 10;
+    static constexpr unsigned int kMeshBits = 16;
+    static constexpr unsigned int kDepthBits = 24;
+    static_assert(kPassBits + kShaderBits + kStateBits + kMeshBits + kDepthBits == 64, "The key fields have to fill the key");
+
+    // Below this many entries a sort isn't worth splitting across threads.
+    static constexpr unsigned int kParallelSortMinimum = 1 << 14;
+
+    explicit RenderQueue();
+    RenderQueue(const RenderQueue&) = delete;
+
+    // Depth is the view distance divided by the far plane, 0 to 1. Fields are cut to their bit count.
+    static uint64_t MakeOpaqueKey(uint32_t, uint32_t, uint32_t, float);
+    static uint64_t MakeTransparentKey(uint32_t, uint32_t, uint32_t, float);
+
+    void Reserve(unsigned int);
+    void Clear();
+    void Push(uint64_t, uint32_t);
+
+    // Splits the sort across the job system when there are enough entries, pJobSystem may be nullptr.
+    void Sort(JobSystem*);
+
+    const RenderQueueEntry* GetEntries() const;
+    unsigned int GetCount() const;
+    const RenderQueueStats& GetStats() const;
+
+private:
+    static uint32_t QuantizeDepth(float);
+
+    // One chunk sorts on the calling thread.
+    void RadixSort(JobSystem*, unsigned int);
+
+private:
+    static constexpr unsigned int kDigitBits = 8;
+    static constexpr unsigned int kDigitCount = 64 / kDigitBits;
+    static constexpr unsigned int kBucketCount = 1 << kDigitBits;
+
+    std::vector<RenderQueueEntry> m_entries;
+    std::vector<RenderQueueEntry> m_scratch;
+
+    // kDigitCount * kBucketCount counts per chunk.
+    std::vector<uint32_t> m_histograms;
+
+    RenderQueueStats m_stats;
+};
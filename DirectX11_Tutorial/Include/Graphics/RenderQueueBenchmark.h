@@ -0,0 +1,17 @@
+//////////////////////////////////////////////////////////////////////
+// Filename: RenderQueueBenchmark.h
+//////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <memory>
+
+#include "System/JobSystemBenchmark.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+// render_queue_sort : RenderQueue::Sort() of 100000 draws with random keys, only the sort is
+//                     timed.
+////////////////////////////////////////////////////////////////////////////////////////////////
+std::unique_ptr<JobSystemWorkload> CreateRenderQueueSortWorkload();
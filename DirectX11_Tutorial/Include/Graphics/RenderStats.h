@@ -0,0 +1,145 @@
+//////////////////////////////////////////////////////////////////////
+// Filename: RenderStats.h
+//////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <d3d11.h>
+#include <atomic>
+#include <cstdint>
+
+// What the submission path did in one frame.
+struct RenderFrameStats
+{
+    unsigned long long m_frameIndex;
+    uint64_t m_drawCalls;
+    uint64_t m_instances;
+    uint64_t m_indices;
+    uint64_t m_triangles;
+    uint64_t m_stateBinds;
+    uint64_t m_issuedStateBinds; // The binds that reached the backend, see StateTrackingRenderContext.
+    uint64_t m_constantBufferBytes;
+    uint64_t m_constantBufferMaps;
+    uint64_t m_geometryBytes; // Vertex and index data uploaded into the geometry pool.
+    uint64_t m_clears;
+    uint64_t m_frustumTested; // Scene tree candidates tested against the view, see FrustumCuller.
+    uint64_t m_frustumCulled; // Of those, the ones outside it.
+    uint64_t m_occlusionTested; // Boxes tested against the occluders, see OcclusionCuller.
+    uint64_t m_occlusionCulled; // Of those, the ones the occluders hid.
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: RenderStats
+//
+// Desription
+//  : Per frame counters of the render submission path. The code that issues the calls
+//    counts them (GeometryPool::Bind, ColorShader, Direct3D::BeginScene), so a change
+//    that adds a redundant bind or a draw shows up here before it shows up in the frame time.
+//
+//    Counting is a relaxed atomic add and may happen on any thread. BeginFrame() closes
+//    the frame being counted and keeps it in a history of the last kFrameHistory frames,
+//    the queries read that history and belong to the render thread (or run after it stopped).
+////////////////////////////////////////////////////////////////////////////////////////////////
+class RenderStats
+{
+public:
+    static constexpr unsigned int kFrameHistory = 1024;
+
+    static void BeginFrame();
+
+    static void AddDrawIndexed(D3D11_PRIMITIVE_TOPOLOGY topology, unsigned int indexCount)
+    {
+        AddDrawIndexedInstanced(topology, indexCount, 1);
+    }
+
+    static void AddDrawIndexedInstanced(D3D11_PRIMITIVE_TOPOLOGY topology, unsigned int indexCountPerInstance, unsigned int instanceCount)
+    {
+        s_drawCalls.fetch_add(1, std::memory_order_relaxed);
+        s_instances.fetch_add(instanceCount, std::memory_order_relaxed);
+        s_indices.fetch_add(static_cast<uint64_t>(indexCountPerInstance) * instanceCount, std::memory_order_relaxed);
+        s_triangles.fetch_add(GetTriangleCount(topology, indexCountPerInstance) * instanceCount, std::memory_order_relaxed);
+    }
+
+    static void AddStateBinds(unsigned int count)
+    {
+        s_stateBinds.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    static void AddIssuedStateBinds(unsigned int count)
+    {
+        s_issuedStateBinds.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    static void AddConstantBufferUpload(unsigned int byteCount)
+    {
+        s_constantBufferBytes.fetch_add(byteCount, std::memory_order_relaxed);
+    }
+
+    static void AddConstantBufferMap()
+    {
+        s_constantBufferMaps.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static void AddGeometryUpload(unsigned int byteCount)
+    {
+        s_geometryBytes.fetch_add(byteCount, std::memory_order_relaxed);
+    }
+
+    static void AddClears(unsigned int count)
+    {
+        s_clears.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    static void AddFrustumTests(unsigned int testedCount, unsigned int culledCount)
+    {
+        s_frustumTested.fetch_add(testedCount, std::memory_order_relaxed);
+        s_frustumCulled.fetch_add(culledCount, std::memory_order_relaxed);
+    }
+
+    static void AddOcclusionTests(unsigned int testedCount, unsigned int culledCount)
+    {
+        s_occlusionTested.fetch_add(testedCount, std::memory_order_relaxed);
+        s_occlusionCulled.fetch_add(culledCount, std::memory_order_relaxed);
+    }
+
+    // The frame being counted, finished frames have lower indices.
+    static unsigned long long GetFrameIndex();
+
+    // False once the frame has fallen out of the history or isn't finished yet.
+    static bool GetFrameStats(unsigned long long, RenderFrameStats&);
+    static bool GetLastFrameStats(RenderFrameStats&);
+
+    // Adds up the finished frames of the range that are still in the history, returns how many there were.
+    static unsigned long long GetSummary(unsigned long long, unsigned long long, RenderFrameStats&);
+
+private:
+    static uint64_t GetTriangleCount(D3D11_PRIMITIVE_TOPOLOGY topology, unsigned int indexCount)
+    {
+        switch (topology)
+        {
+        case D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST:
+            return indexCount / 3;
+        case D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP:
+            return (indexCount > 2) ? (indexCount - 2) : 0;
+        default:
+            return 0;
+        }
+    }
+
+    static std::atomic<uint64_t> s_drawCalls;
+    static std::atomic<uint64_t> s_instances;
+    static std::atomic<uint64_t> s_indices;
+    static std::atomic<uint64_t> s_triangles;
+    static std::atomic<uint64_t> s_stateBinds;
+    static std::atomic<uint64_t> s_issuedStateBinds;
+    static std::atomic<uint64_t> s_constantBufferBytes;
+    static std::atomic<uint64_t> s_constantBufferMaps;
+    static std::atomic<uint64_t> s_geometryBytes;
+    static std::atomic<uint64_t> s_clears;
+    static std::atomic<uint64_t> s_frustumTested;
+    static std::atomic<uint64_t> s_frustumCulled;
+    static std::atomic<uint64_t> s_occlusionTested;
+    static std::atomic<uint64_t> s_occlusionCulled;
+};
@@ -0,0 +1,23 @@
+//////////////////////////////////////////////////////////////////////
+// Filename: SceneQueryBenchmark.h
+//////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <string>
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+// Times the AabbTree queries against testing every object, on scenes of 10000, 100000 and
+// 1000000 boxes scattered at the same density, and writes the time of both, the speedup and
+// the hit counts to stdout and the results file. Runs on the calling thread only.
+//
+//  frustum : One view, the brute force is FrustumCuller::Cull() without the job system.
+//  region  : 100 boxes of 40 units a side, anything overlapping them.
+//  ray     : 100 rays of up to 500 units, the nearest box each one enters.
+//
+// Both sides test the trees' fat boxes, so they find the same objects. How long each tree
+// took to build and how deep it is are only printed.
+////////////////////////////////////////////////////////////////////////////////////////////////
+bool RunSceneQueryBenchmark(const std::string&);
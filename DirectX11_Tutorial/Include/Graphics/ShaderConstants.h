@@ -0,0 +1,110 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: ShaderConstants.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <d3d11.h>
+#include <DirectXMath.h>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+////////////////////////////////////////////////////////////////////////////////
+// The constant buffers every shader shares, split by how often they change.
+// The HLSL side is Src/Shaders/ShaderConstants.hlsli and has to match this file.
+//
+//  ViewConstants   : b1, written when the camera or the projection changes.
+//  ObjectConstants : b2, written per draw through the constant upload ring.
+//
+// b0 is kept for per frame constants, no shader needs any yet.
+//
+// Matrices are stored transposed, HLSL reads them column major.
+////////////////////////////////////////////////////////////////////////////////
+constexpr UINT VIEW_CONSTANTS_SLOT = 1;
+constexpr UINT OBJECT_CONSTANTS_SLOT = 2;
+
+struct ViewConstants
+{
+    DirectX::XMFLOAT4X4 m_view;
+    DirectX::XMFLOAT4X4 m_projection;
+    DirectX::XMFLOAT4X4 m_viewProjection;
+};
+
+struct ObjectConstants
+{
+    DirectX::XMFLOAT4X4 m_world;
+};
+
+// A variable of a cbuffer, under its HLSL name.
+struct ConstantField
+{
+    const char* m_pName;
+    UINT m_offset;
+    UINT m_size;
+};
+
+// What the C++ struct of a cbuffer looks like, for checking it against the HLSL one.
+struct ConstantBufferLayout
+{
+    const char* m_pName;
+    UINT m_slot;
+    UINT m_size;
+    const ConstantField* m_pFields;
+    UINT m_fieldCount;
+};
+
+//-----------------------------------------------------------------
+// HLSL packs cbuffer variables in order into 16 byte registers. A
+// variable that would straddle a register starts the next one, and
+// matrices always start a register. The size is rounded up to a
+// whole register. Padding in the C++ struct isn't listed.
+//-----------------------------------------------------------------
+constexpr bool IsHlslPacked(const ConstantBufferLayout& kLayout)
+{
+    UINT offset = 0;
+    for (UINT i = 0; i < kLayout.m_fieldCount; ++i)
+    {
+        const ConstantField& kField = kLayout.m_pFields[i];
+        if (kField.m_size >= 16 || (offset % 16) + kField.m_size > 16)
+        {
+            offset = (offset + 15) / 16 * 16;
+        }
+
+        if (kField.m_offset != offset)
+        {
+            return false;
+        }
+
+        offset += kField.m_size;
+    }
+
+    return kLayout.m_size == (offset + 15) / 16 * 16;
+}
+
+constexpr ConstantField VIEW_CONSTANT_FIELDS[] =
+{
+    { "viewMatrix", offsetof(ViewConstants, m_view), sizeof(DirectX::XMFLOAT4X4) },
+    { "projectionMatrix", offsetof(ViewConstants, m_projection), sizeof(DirectX::XMFLOAT4X4) },
+    { "viewProjectionMatrix", offsetof(ViewConstants, m_viewProjection), sizeof(DirectX::XMFLOAT4X4) },
+};
+
+constexpr ConstantField OBJECT_CONSTANT_FIELDS[] =
+{
+    { "worldMatrix", offsetof(ObjectConstants, m_world), sizeof(DirectX::XMFLOAT4X4) },
+};
+
+constexpr ConstantBufferLayout VIEW_CONSTANTS_LAYOUT = { "ViewConstants", VIEW_CONSTANTS_SLOT, sizeof(ViewConstants), VIEW_CONSTANT_FIELDS, static_cast<UINT>(std::size(VIEW_CONSTANT_FIELDS)) };
+constexpr ConstantBufferLayout OBJECT_CONSTANTS_LAYOUT = { "ObjectConstants", OBJECT_CONSTANTS_SLOT, sizeof(ObjectConstants), OBJECT_CONSTANT_FIELDS, static_cast<UINT>(std::size(OBJECT_CONSTANT_FIELDS)) };
+
+static_assert(IsHlslPacked(VIEW_CONSTANTS_LAYOUT), "ViewConstants doesn't follow the HLSL packing rules");
+static_assert(IsHlslPacked(OBJECT_CONSTANTS_LAYOUT), "ObjectConstants doesn't follow the HLSL packing rules");
+
+// Checks the cbuffers of a compiled shader against the layouts it is meant to use: every layout
+// has to be there with the same slot, size and name, offset and size of every variable, and the
+// shader can't use any other cbuffer. The compiler drops a cbuffer the shader never reads, so
+// only list the ones it reads. Software backends have no bytecode to check, their shaders read
+// these structs directly.
+bool CheckConstantBufferLayouts(const void*, SIZE_T, const ConstantBufferLayout* const*, UINT);
@@ -0,0 +1,17 @@
+//////////////////////////////////////////////////////////////////////
+// Filename: SoftwareRasterBenchmark.h
+//////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <memory>
+
+#include "System/JobSystemBenchmark.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+// software_raster : SoftwareRenderContext::Flush() of 4 overlapping layers of 160x120 quads
+//                   on an 800x600 target, the tiles split over the threads.
+////////////////////////////////////////////////////////////////////////////////////////////////
+std::unique_ptr<JobSystemWorkload> CreateSoftwareRasterWorkload();
@@ -0,0 +1,175 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: SoftwareRenderContext.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <d3d11.h>
+#include <DirectXMath.h>
+#include <cstdint>
+#include <vector>
+
+#include "Graphics/RenderDevice.h"
+#include "Graphics/SoftwareResources.h"
+#include "System/JobSystem.h"
+
+// Time spent rasterizing one screen tile during the last Flush().
+struct SoftwareTileTiming
+{
+    int m_tileX;
+    int m_tileY;
+    // JobSystem::GetCallingThreadIndex() of the thread that rasterized it.
+    unsigned int m_threadIndex;
+    unsigned int m_triangleCount;
+    double m_milliseconds;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: SoftwareRenderContext
+//
+// Desription
+//  : CPU rasterizer with the same BeginScene/draw/EndScene path as the hardware context.
+//
+//    DrawIndexed (and DrawIndexedInstanced, one instance after the other) runs the
+//    vertex stage right away on the calling thread, culls and
+//    sets up the triangles and bins them into kTileSize x kTileSize screen tiles.
+//    Flush() then rasterizes the tiles in parallel on the JobSystem, one job per tile, with
+//    the calling thread helping out. A tile is only ever touched by one thread and its bin is
+//    in submission order, so draw order is preserved without locks.
+//
+//    The render target is a RGBA8 color buffer and a 24-bit unorm depth buffer owned
+//    by the context, the views passed to Clear*View and OMSetRenderTargets are ignored.
+//    Only triangle lists are supported and there is no near plane clipping, triangles
+//    with a vertex behind the eye are dropped. Stencil operations are not emulated.
+////////////////////////////////////////////////////////////////////////////////
+class SoftwareRenderContext : public RenderContext
+{
+public:
+    static constexpr int kTileSize = 64;
+
+    // Without a JobSystem every tile is rasterized on the thread calling Flush().
+    SoftwareRenderContext(int, int, JobSystem*);
+
+    void ClearRenderTargetView(ID3D11RenderTargetView*, const FLOAT[4]) override;
+    void ClearDepthStencilView(ID3D11DepthStencilView*, UINT, FLOAT, UINT8) override;
+
+    void OMSetRenderTargets(UINT, ID3D11RenderTargetView* const*, ID3D11DepthStencilView*) override;
+    void OMSetDepthStencilState(ID3D11DepthStencilState*, UINT) override;
+    void RSSetState(ID3D11RasterizerState*) override;
+    void RSSetViewports(UINT, const D3D11_VIEWPORT*) override;
+
+    void IASetInputLayout(ID3D11InputLayout*) override;
+    void IASetVertexBuffers(UINT, UINT, ID3D11Buffer* const*, const UINT*, const UINT*) override;
+    void IASetIndexBuffer(ID3D11Buffer*, DXGI_FORMAT, UINT) override;
+    void IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY) override;
+
+    void VSSetShader(ID3D11VertexShader*, ID3D11ClassInstance* const*, UINT) override;
+    void PSSetShader(ID3D11PixelShader*, ID3D11ClassInstance* const*, UINT) override;
+    void VSSetConstantBuffers(UINT, UINT, ID3D11Buffer* const*) override;
+    void VSSetConstantBuffers1(UINT, UINT, ID3D11Buffer* const*, const UINT*, const UINT*) override;
+
+    HRESULT Map(ID3D11Resource*, UINT, D3D11_MAP, UINT, D3D11_MAPPED_SUBRESOURCE*) override;
+    void Unmap(ID3D11Resource*, UINT) override;
+    void UpdateSubresource(ID3D11Resource*, UINT, const D3D11_BOX*, const void*, UINT, UINT) override;
+
+    void DrawIndexed(UINT, UINT, INT) override;
+    void DrawIndexedInstanced(UINT, UINT, UINT, INT, UINT) override;
+
+    void End(ID3D11Asynchronous*) override;
+    HRESULT GetData(ID3D11Asynchronous*, void*, UINT, UINT) override;
+
+    HRESULT FinishCommandList(BOOL, ID3D11CommandList**) override;
+    void ExecuteCommandList(ID3D11CommandList*, BOOL) override;
+
+    void Flush() override;
+
+    int GetWidth() const;
+    int GetHeight() const;
+    // The calling thread and the JobSystem's workers.
+    unsigned int GetThreadCount() const;
+
+    // Row-major RGBA8 pixels of the last flushed frame.
+    const uint32_t* GetColorBuffer() const;
+    const std::vector<SoftwareTileTiming>& GetTileTimings() const;
+
+private:
+    // A triangle after viewport transform, ready for the tile back-end.
+    struct Triangle
+    {
+        float m_x[3];
+        float m_y[3];
+        float m_z[3];
+        float m_invW[3];
+        DirectX::XMFLOAT4 m_colorOverW[3];
+
+        int m_minX;
+        int m_minY;
+        int m_maxX;
+        int m_maxY;
+
+        SoftwarePixelShaderFunc m_pPixelShader;
+        bool m_depthEnable;
+        bool m_depthWrite;
+        D3D11_COMPARISON_FUNC m_depthFunc;
+        bool m_depthClip;
+    };
+
+    struct Tile
+    {
+        int m_x0;
+        int m_y0;
+        int m_x1;
+        int m_y1;
+        std::vector<uint32_t> m_triangles;
+    };
+
+    // The vertex index, then the instance and the first instance of the draw.
+    bool FetchVertex(UINT, UINT, UINT, SoftwareVertex&);
+    void SetupTriangle(const SoftwareVertex&, const SoftwareVertex&, const SoftwareVertex&);
+    void RasterizeTile(Tile&, unsigned int, SoftwareTileTiming&);
+
+private:
+    int m_width;
+    int m_height;
+    int m_tilesX;
+    int m_tilesY;
+
+    std::vector<uint32_t> m_colorBuffer;
+    std::vector<uint32_t> m_depthBuffer;
+
+    // Clears are applied per tile at the start of the next Flush().
+    bool m_clearColorPending;
+    bool m_clearDepthPending;
+    uint32_t m_clearColor;
+    uint32_t m_clearDepth;
+
+    std::vector<Tile> m_tiles;
+    std::vector<Triangle> m_triangles;
+    std::vector<SoftwareTileTiming> m_tileTimings;
+
+    // Bound pipeline state.
+    SoftwareInputLayout* m_pInputLayout;
+    SoftwareBuffer* m_pVertexBuffers[D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT];
+    UINT m_vertexStrides[D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT];
+    UINT m_vertexOffsets[D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT];
+    SoftwareBuffer* m_pIndexBuffer;
+    DXGI_FORMAT m_indexFormat;
+    UINT m_indexOffset;
+    D3D11_PRIMITIVE_TOPOLOGY m_topology;
+    SoftwareVertexShader* m_pVertexShader;
+    SoftwarePixelShader* m_pPixelShader;
+    SoftwareBuffer* m_pConstantBuffers[D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT];
+    UINT m_constantBufferOffsets[D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT]; // In bytes.
+    D3D11_DEPTH_STENCIL_DESC m_depthStencilDesc;
+    D3D11_RASTERIZER_DESC m_rasterDesc;
+    D3D11_VIEWPORT m_viewport;
+
+    // Per draw cache of transformed vertices, indexed by the index buffer value.
+    std::vector<SoftwareVertex> m_vertexCache;
+    std::vector<uint32_t> m_vertexCacheTag;
+    uint32_t m_drawTag;
+
+    JobSystem* m_pJobSystem;
+};
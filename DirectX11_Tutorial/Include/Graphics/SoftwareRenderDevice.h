@@ -0,0 +1,41 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: SoftwareRenderDevice.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <d3d11.h>
+
+#include "Graphics/RenderDevice.h"
+#include "Graphics/SoftwareResources.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: SoftwareRenderDevice
+//
+// Desription
+//  : Creates system memory resources for the CPU backends.
+//    Shaders are looked up by HLSL entry point name, see RenderDevice.h.
+////////////////////////////////////////////////////////////////////////////////
+class SoftwareRenderDevice : public RenderDevice
+{
+public:
+    explicit SoftwareRenderDevice(RenderBackend);
+
+    RenderBackend GetBackend() const override;
+
+    HRESULT CreateBuffer(const D3D11_BUFFER_DESC*, const D3D11_SUBRESOURCE_DATA*, ID3D11Buffer**) override;
+    HRESULT CreateVertexShader(const void*, SIZE_T, ID3D11ClassLinkage*, ID3D11VertexShader**) override;
+    HRESULT CreatePixelShader(const void*, SIZE_T, ID3D11ClassLinkage*, ID3D11PixelShader**) override;
+    HRESULT CreateInputLayout(const D3D11_INPUT_ELEMENT_DESC*, UINT, const void*, SIZE_T, ID3D11InputLayout**) override;
+    HRESULT CreateDepthStencilState(const D3D11_DEPTH_STENCIL_DESC*, ID3D11DepthStencilState**) override;
+    HRESULT CreateRasterizerState(const D3D11_RASTERIZER_DESC*, ID3D11RasterizerState**) override;
+    HRESULT CreateBlendState(const D3D11_BLEND_DESC*, ID3D11BlendState**) override;
+    HRESULT CreateSamplerState(const D3D11_SAMPLER_DESC*, ID3D11SamplerState**) override;
+    HRESULT CreateQuery(const D3D11_QUERY_DESC*, ID3D11Query**) override;
+    HRESULT CreateDeferredContext(UINT, RenderContext**) override;
+
+private:
+    RenderBackend m_backend;
+};
@@ -0,0 +1,344 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: SoftwareResources.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <d3d11.h>
+#include <DirectXMath.h>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+// Software shader stages.
+// A single float4 varying (the color) is passed from the vertex to the pixel stage,
+// which is all ColorVS.hlsl and ColorPS.hlsl need.
+////////////////////////////////////////////////////////////////////////////////
+struct SoftwareVertex
+{
+    DirectX::XMFLOAT4 m_position;
+    DirectX::XMFLOAT4 m_color;
+};
+
+// pAttributes holds one float4 per input layout element, in layout order.
+// ppConstantBuffers holds the data of the bound VS constant buffers (nullptr when unbound).
+using SoftwareVertexShaderFunc = void(*)(const DirectX::XMFLOAT4* pAttributes, const uint8_t* const* ppConstantBuffers, SoftwareVertex& output);
+using SoftwarePixelShaderFunc = DirectX::XMFLOAT4(*)(const DirectX::XMFLOAT4& color);
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: SoftwareDeviceChild
+//
+// Desription
+//  : Implements IUnknown and ID3D11DeviceChild so CPU side objects can be handed
+//    out as regular D3D11 interface pointers and released with Release().
+////////////////////////////////////////////////////////////////////////////////
+template<typename Interface>
+class SoftwareDeviceChild : public Interface
+{
+public:
+    SoftwareDeviceChild()
+        : m_refCount(1)
+    {
+    }
+
+    virtual ~SoftwareDeviceChild() = default;
+
+    HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** ppObject) override
+    {
+        if (!ppObject)
+        {
+            return E_POINTER;
+        }
+
+        if (riid == __uuidof(IUnknown) || riid == __uuidof(ID3D11DeviceChild) || riid == __uuidof(Interface))
+        {
+            *ppObject = static_cast<Interface*>(this);
+            AddRef();
+            return S_OK;
+        }
+
+        *ppObject = nullptr;
+        return E_NOINTERFACE;
+    }
+
+    ULONG STDMETHODCALLTYPE AddRef() override
+    {
+        return ++m_refCount;
+    }
+
+    ULONG STDMETHODCALLTYPE Release() override
+    {
+        ULONG refCount = --m_refCount;
+        if (refCount == 0)
+        {
+            delete this;
+        }
+
+        return refCount;
+    }
+
+    // There is no ID3D11Device behind software objects.
+    void STDMETHODCALLTYPE GetDevice(ID3D11Device** ppDevice) override
+    {
+        *ppDevice = nullptr;
+    }
+
+    HRESULT STDMETHODCALLTYPE GetPrivateData(REFGUID, UINT*, void*) override
+    {
+        return E_NOTIMPL;
+    }
+
+    HRESULT STDMETHODCALLTYPE SetPrivateData(REFGUID, UINT, const void*) override
+    {
+        return E_NOTIMPL;
+    }
+
+    HRESULT STDMETHODCALLTYPE SetPrivateDataInterface(REFGUID, const IUnknown*) override
+    {
+        return E_NOTIMPL;
+    }
+
+private:
+    ULONG m_refCount;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: SoftwareBuffer
+//
+// Desription
+//  : Vertex, index and constant buffers live in system memory.
+//    Map() hands out m_data directly.
+////////////////////////////////////////////////////////////////////////////////
+class SoftwareBuffer : public SoftwareDeviceChild<ID3D11Buffer>
+{
+public:
+    SoftwareBuffer(const D3D11_BUFFER_DESC& kDesc, const void* pInitialData)
+        : m_desc(kDesc)
+        , m_data(kDesc.ByteWidth, 0)
+    {
+        if (pInitialData)
+        {
+            memcpy(m_data.data(), pInitialData, kDesc.ByteWidth);
+        }
+    }
+
+    void STDMETHODCALLTYPE GetType(D3D11_RESOURCE_DIMENSION* pResourceDimension) override
+    {
+        *pResourceDimension = D3D11_RESOURCE_DIMENSION_BUFFER;
+    }
+
+    void STDMETHODCALLTYPE SetEvictionPriority(UINT) override
+    {
+    }
+
+    UINT STDMETHODCALLTYPE GetEvictionPriority() override
+    {
+        return 0;
+    }
+
+    void STDMETHODCALLTYPE GetDesc(D3D11_BUFFER_DESC* pDesc) override
+    {
+        *pDesc = m_desc;
+    }
+
+    uint8_t* GetData()
+    {
+        return m_data.data();
+    }
+
+    UINT GetByteWidth() const
+    {
+        return m_desc.ByteWidth;
+    }
+
+    // UpdateSubresource() of a buffer, a null box is the whole buffer. Returns the bytes written.
+    UINT Update(const D3D11_BOX* pBox, const void* pSourceData)
+    {
+        UINT begin = pBox ? pBox->left : 0;
+        UINT end = pBox ? pBox->right : m_desc.ByteWidth;
+        if (begin >= end || end > m_desc.ByteWidth)
+        {
+            return 0;
+        }
+
+        memcpy(m_data.data() + begin, pSourceData, end - begin);
+        return end - begin;
+    }
+
+private:
+    D3D11_BUFFER_DESC m_desc;
+    std::vector<uint8_t> m_data;
+};
+
+class SoftwareVertexShader : public SoftwareDeviceChild<ID3D11VertexShader>
+{
+public:
+    explicit SoftwareVertexShader(SoftwareVertexShaderFunc pFunction)
+        : m_pFunction(pFunction)
+    {
+    }
+
+    SoftwareVertexShaderFunc GetFunction() const
+    {
+        return m_pFunction;
+    }
+
+private:
+    SoftwareVertexShaderFunc m_pFunction;
+};
+
+class SoftwarePixelShader : public SoftwareDeviceChild<ID3D11PixelShader>
+{
+public:
+    explicit SoftwarePixelShader(SoftwarePixelShaderFunc pFunction)
+        : m_pFunction(pFunction)
+    {
+    }
+
+    SoftwarePixelShaderFunc GetFunction() const
+    {
+        return m_pFunction;
+    }
+
+private:
+    SoftwarePixelShaderFunc m_pFunction;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: SoftwareInputLayout
+//
+// Desription
+//  : Input elements with D3D11_APPEND_ALIGNED_ELEMENT already resolved to byte offsets.
+////////////////////////////////////////////////////////////////////////////////
+class SoftwareInputLayout : public SoftwareDeviceChild<ID3D11InputLayout>
+{
+public:
+    struct Element
+    {
+        UINT m_inputSlot;
+        UINT m_byteOffset;
+        UINT m_componentCount;
+        D3D11_INPUT_CLASSIFICATION m_classification;
+        UINT m_instanceStepRate;
+    };
+
+    explicit SoftwareInputLayout(std::vector<Element> elements)
+        : m_elements(std::move(elements))
+    {
+    }
+
+    const std::vector<Element>& GetElements() const
+    {
+        return m_elements;
+    }
+
+private:
+    std::vector<Element> m_elements;
+};
+
+class SoftwareDepthStencilState : public SoftwareDeviceChild<ID3D11DepthStencilState>
+{
+public:
+    explicit SoftwareDepthStencilState(const D3D11_DEPTH_STENCIL_DESC& kDesc)
+        : m_desc(kDesc)
+    {
+    }
+
+    void STDMETHODCALLTYPE GetDesc(D3D11_DEPTH_STENCIL_DESC* pDesc) override
+    {
+        *pDesc = m_desc;
+    }
+
+    const D3D11_DEPTH_STENCIL_DESC& GetDescRef() const
+    {
+        return m_desc;
+    }
+
+private:
+    D3D11_DEPTH_STENCIL_DESC m_desc;
+};
+
+class SoftwareRasterizerState : public SoftwareDeviceChild<ID3D11RasterizerState>
+{
+public:
+    explicit SoftwareRasterizerState(const D3D11_RASTERIZER_DESC& kDesc)
+        : m_desc(kDesc)
+    {
+    }
+
+    void STDMETHODCALLTYPE GetDesc(D3D11_RASTERIZER_DESC* pDesc) override
+    {
+        *pDesc = m_desc;
+    }
+
+    const D3D11_RASTERIZER_DESC& GetDescRef() const
+    {
+        return m_desc;
+    }
+
+private:
+    D3D11_RASTERIZER_DESC m_desc;
+};
+
+// The rasterizer writes every pixel opaque, blend states are only kept so they can be created and bound.
+class SoftwareBlendState : public SoftwareDeviceChild<ID3D11BlendState>
+{
+public:
+    explicit SoftwareBlendState(const D3D11_BLEND_DESC& kDesc)
+        : m_desc(kDesc)
+    {
+    }
+
+    void STDMETHODCALLTYPE GetDesc(D3D11_BLEND_DESC* pDesc) override
+    {
+        *pDesc = m_desc;
+    }
+
+private:
+    D3D11_BLEND_DESC m_desc;
+};
+
+// Work on the CPU backends is finished by the time GetData() is asked, see SoftwareRenderContext::GetData().
+class SoftwareQuery : public SoftwareDeviceChild<ID3D11Query>
+{
+public:
+    explicit SoftwareQuery(const D3D11_QUERY_DESC& kDesc)
+        : m_desc(kDesc)
+    {
+    }
+
+    UINT STDMETHODCALLTYPE GetDataSize() override
+    {
+        return sizeof(BOOL);
+    }
+
+    void STDMETHODCALLTYPE GetDesc(D3D11_QUERY_DESC* pDesc) override
+    {
+        *pDesc = m_desc;
+    }
+
+private:
+    D3D11_QUERY_DESC m_desc;
+};
+
+// Nothing is textured yet, like the blend state this only holds the description.
+class SoftwareSamplerState : public SoftwareDeviceChild<ID3D11SamplerState>
+{
+public:
+    explicit SoftwareSamplerState(const D3D11_SAMPLER_DESC& kDesc)
+        : m_desc(kDesc)
+    {
+    }
+
+    void STDMETHODCALLTYPE GetDesc(D3D11_SAMPLER_DESC* pDesc) override
+    {
+        *pDesc = m_desc;
+    }
+
+private:
+    D3D11_SAMPLER_DESC m_desc;
+};
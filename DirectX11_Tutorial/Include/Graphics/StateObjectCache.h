@@ -0,0 +1,93 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: StateObjectCache.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <d3d11.h>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "Graphics/RenderDevice.h"
+
+struct StateObjectCacheStats
+{
+    uint64_t m_hits;
+    uint64_t m_misses;
+    unsigned int m_objectCount;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: StateObjectCache
+//
+// Desription
+//  : Hands out rasterizer, depth stencil, blend and sampler states so that two
+//    identical descriptions share one object. The lookup key is a hash of every
+//    field of the description, entries with the same hash are compared in full.
+//
+//    The returned object carries a reference for the caller, who releases it as
+//    usual. The cache keeps a reference of its own until Trim() finds it unused
+//    or Shutdown(). It only needs a RenderDevice, any backend (or a mock) will do.
+//
+//    Fields the pipeline ignores don't split entries, e.g. the render targets
+//    after the first of a blend state without independent blending.
+////////////////////////////////////////////////////////////////////////////////
+class StateObjectCache
+{
+public:
+    explicit StateObjectCache();
+    StateObjectCache(const StateObjectCache&) = delete;
+    ~StateObjectCache();
+
+    void Initialize(RenderDevice*);
+    void Shutdown();
+
+    HRESULT GetRasterizerState(const D3D11_RASTERIZER_DESC&, ID3D11RasterizerState**);
+    HRESULT GetDepthStencilState(const D3D11_DEPTH_STENCIL_DESC&, ID3D11DepthStencilState**);
+    HRESULT GetBlendState(const D3D11_BLEND_DESC&, ID3D11BlendState**);
+    HRESULT GetSamplerState(const D3D11_SAMPLER_DESC&, ID3D11SamplerState**);
+
+    // Releases the objects nobody but the cache holds any more, returns how many.
+    unsigned int Trim();
+
+    StateObjectCacheStats GetStats() const;
+
+private:
+    template<typename Desc, typename State>
+    struct Entry
+    {
+        Desc m_desc;
+        State* m_pState;
+    };
+
+    template<typename Desc, typename State>
+    using Table = std::unordered_map<uint64_t, std::vector<Entry<Desc, State>>>;
+
+    template<typename Desc, typename State, typename CreateFunction>
+    HRESULT GetOrCreate(Table<Desc, State>&, const Desc&, State**, CreateFunction);
+
+    template<typename Desc, typename State>
+    unsigned int TrimTable(Table<Desc, State>&);
+
+    template<typename Desc, typename State>
+    void ReleaseTable(Table<Desc, State>&);
+
+private:
+    // Owned by Direct3D.
+    RenderDevice* m_pDevice;
+
+    mutable std::mutex m_mutex;
+
+    Table<D3D11_RASTERIZER_DESC, ID3D11RasterizerState> m_rasterizerStates;
+    Table<D3D11_DEPTH_STENCIL_DESC, ID3D11DepthStencilState> m_depthStencilStates;
+    Table<D3D11_BLEND_DESC, ID3D11BlendState> m_blendStates;
+    Table<D3D11_SAMPLER_DESC, ID3D11SamplerState> m_samplerStates;
+
+    uint64_t m_hits;
+    uint64_t m_misses;
+    unsigned int m_objectCount;
+};
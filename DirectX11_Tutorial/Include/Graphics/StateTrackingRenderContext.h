@@ -0,0 +1,149 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: StateTrackingRenderContext.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <d3d11.h>
+#include <cstdint>
+
+#include "Graphics/RenderDevice.h"
+
+// Binds forwarded to the wrapped context and binds dropped because they changed nothing,
+// since the last ResetCounters().
+struct StateTrackingCounters
+{
+    uint64_t m_issuedBinds;
+    uint64_t m_elidedBinds;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: StateTrackingRenderContext
+//
+// Desription
+//  : Sits in front of another RenderContext and remembers what is bound. A bind that
+//    sets exactly what is already there is dropped, everything else is forwarded.
+//    Clears, maps, draws and flushes always go through.
+//
+//    Until a piece of state has been set through the tracker it counts as unknown,
+//    so the first bind of each always reaches the wrapped context. Call Invalidate()
+//    when something else changed the wrapped context's state behind its back.
+//
+//    Binds with class instances aren't tracked and always go through.
+////////////////////////////////////////////////////////////////////////////////
+class StateTrackingRenderContext : public RenderContext
+{
+public:
+    explicit StateTrackingRenderContext(RenderContext*);
+
+    void ClearRenderTargetView(ID3D11RenderTargetView*, const FLOAT[4]) override;
+    void ClearDepthStencilView(ID3D11DepthStencilView*, UINT, FLOAT, UINT8) override;
+
+    void OMSetRenderTargets(UINT, ID3D11RenderTargetView* const*, ID3D11DepthStencilView*) override;
+    void OMSetDepthStencilState(ID3D11DepthStencilState*, UINT) override;
+    void RSSetState(ID3D11RasterizerState*) override;
+    void RSSetViewports(UINT, const D3D11_VIEWPORT*) override;
+
+    void IASetInputLayout(ID3D11InputLayout*) override;
+    void IASetVertexBuffers(UINT, UINT, ID3D11Buffer* const*, const UINT*, const UINT*) override;
+    void IASetIndexBuffer(ID3D11Buffer*, DXGI_FORMAT, UINT) override;
+    void IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY) override;
+
+    void VSSetShader(ID3D11VertexShader*, ID3D11ClassInstance* const*, UINT) override;
+    void PSSetShader(ID3D11PixelShader*, ID3D11ClassInstance* const*, UINT) override;
+    void VSSetConstantBuffers(UINT, UINT, ID3D11Buffer* const*) override;
+    void VSSetConstantBuffers1(UINT, UINT, ID3D11Buffer* const*, const UINT*, const UINT*) override;
+
+    HRESULT Map(ID3D11Resource*, UINT, D3D11_MAP, UINT, D3D11_MAPPED_SUBRESOURCE*) override;
+    void Unmap(ID3D11Resource*, UINT) override;
+    void UpdateSubresource(ID3D11Resource*, UINT, const D3D11_BOX*, const void*, UINT, UINT) override;
+
+    void DrawIndexed(UINT, UINT, INT) override;
+    void DrawIndexedInstanced(UINT, UINT, UINT, INT, UINT) override;
+
+    void End(ID3D11Asynchronous*) override;
+    HRESULT GetData(ID3D11Asynchronous*, void*, UINT, UINT) override;
+
+    HRESULT FinishCommandList(BOOL, ID3D11CommandList**) override;
+    void ExecuteCommandList(ID3D11CommandList*, BOOL) override;
+
+    void Flush() override;
+
+    // Forgets everything that is bound, the next bind of each state goes through.
+    void Invalidate();
+
+    const StateTrackingCounters& GetCounters() const;
+    void ResetCounters();
+
+private:
+    // Counts the bind and returns true when it has to be forwarded.
+    bool ShouldIssue(bool);
+
+    // Whether binding the range with these windows changes anything, null windows mean whole buffers.
+    bool ConstantBuffersChanged(UINT, UINT, ID3D11Buffer* const*, const UINT*, const UINT*) const;
+    void StoreConstantBuffers(UINT, UINT, ID3D11Buffer* const*, const UINT*, const UINT*);
+
+private:
+    static constexpr UINT kMaxRenderTargets = D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT;
+    static constexpr UINT kMaxViewports = D3D11_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE;
+    static constexpr UINT kVertexBufferSlots = D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT;
+    static constexpr UINT kConstantBufferSlots = D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT;
+
+    // The constant count of a slot bound without a window.
+    static constexpr UINT kWholeConstantBuffer = ~0u;
+
+    struct VertexBufferBinding
+    {
+        ID3D11Buffer* m_pBuffer;
+        UINT m_stride;
+        UINT m_offset;
+    };
+
+    // Not owned, Direct3D owns the context being wrapped.
+    RenderContext* m_pContext;
+
+    StateTrackingCounters m_counters;
+
+    bool m_renderTargetsKnown;
+    UINT m_renderTargetCount;
+    ID3D11RenderTargetView* m_pRenderTargets[kMaxRenderTargets];
+    ID3D11DepthStencilView* m_pDepthStencilView;
+
+    bool m_depthStencilStateKnown;
+    ID3D11DepthStencilState* m_pDepthStencilState;
+    UINT m_stencilRef;
+
+    bool m_rasterizerStateKnown;
+    ID3D11RasterizerState* m_pRasterizerState;
+
+    bool m_viewportsKnown;
+    UINT m_viewportCount;
+    D3D11_VIEWPORT m_viewports[kMaxViewports];
+
+    bool m_inputLayoutKnown;
+    ID3D11InputLayout* m_pInputLayout;
+
+    bool m_vertexBuffersKnown[kVertexBufferSlots];
+    VertexBufferBinding m_vertexBuffers[kVertexBufferSlots];
+
+    bool m_indexBufferKnown;
+    ID3D11Buffer* m_pIndexBuffer;
+    DXGI_FORMAT m_indexFormat;
+    UINT m_indexOffset;
+
+    bool m_topologyKnown;
+    D3D11_PRIMITIVE_TOPOLOGY m_topology;
+
+    bool m_vertexShaderKnown;
+    ID3D11VertexShader* m_pVertexShader;
+
+    bool m_pixelShaderKnown;
+    ID3D11PixelShader* m_pPixelShader;
+
+    bool m_constantBuffersKnown[kConstantBufferSlots];
+    ID3D11Buffer* m_pConstantBuffers[kConstantBufferSlots];
+    UINT m_constantBufferFirst[kConstantBufferSlots];
+    UINT m_constantBufferCount[kConstantBufferSlots];
+};
@@ -0,0 +1,114 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: TransformHierarchy.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <DirectXMath.h>
+#include <cstdint>
+#include <vector>
+
+#include "System/JobSystem.h"
+
+// What the hierarchy hands out for a node, stays the same until the node is destroyed.
+using TransformHandle = uint32_t;
+constexpr TransformHandle INVALID_TRANSFORM_HANDLE = ~0u;
+
+// What the last TransformHierarchy::Update() did.
+struct TransformUpdateStats
+{
+    uint64_t m_nodes;
+    uint64_t m_updatedNodes; // World matrices recomputed, the changed nodes and everything under them.
+    unsigned int m_levels;
+    bool m_reordered; // The arrays were sorted again for nodes created or destroyed.
+    double m_updateSeconds;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: TransformHierarchy
+//
+// Desription
+//  : The scene's parent and child transforms. Every node has a local position, rotation
+//    (a quaternion) and scale relative to its parent, and Update() turns them into world
+//    matrices: world = scale * rotation * translation * parent's world.
+//
+//    The nodes are stored breadth first, a level of the tree after the one above it and
+//    the children of a node next to each other, in one array per field. A parent is
+//    always updated before its children, and the update walks every array front to back.
+//
+//    Changing a node marks it dirty, and Update() only recomputes the dirty nodes and the
+//    nodes under them. A level is split into chunks over the job system, a chunk skips
+//    8 clean nodes at a time and marks the children of every node it updates.
+//
+//    Creating or destroying nodes sorts the arrays again at the next Update(), a pass
+//    over every node. That's for loading and spawning, not for every frame. Handles stay
+//    valid across it, indices don't, so nothing outside looks at the arrays.
+//
+//    Everything but Update() itself belongs to one thread, and the world matrices are
+//    only up to date after Update().
+////////////////////////////////////////////////////////////////////////////////
+class TransformHierarchy
+{
+public:
+    explicit TransformHierarchy();
+    TransformHierarchy(const TransformHierarchy&) = delete;
+
+    void Reserve(unsigned int);
+    void Clear();
+
+    // The parent (INVALID_TRANSFORM_HANDLE for a root) and the local position, rotation and scale.
+    TransformHandle Create(TransformHandle, const DirectX::XMFLOAT3&, const DirectX::XMFLOAT4&, const DirectX::XMFLOAT3&);
+    // Takes the node's children with it. Their handles go away at the next Update().
+    void Destroy(TransformHandle);
+
+    void SetLocal(TransformHandle, const DirectX::XMFLOAT3&, const DirectX::XMFLOAT4&, const DirectX::XMFLOAT3&);
+    void SetPosition(TransformHandle, const DirectX::XMFLOAT3&);
+    void SetRotation(TransformHandle, const DirectX::XMFLOAT4&);
+    void SetScale(TransformHandle, const DirectX::XMFLOAT3&);
+
+    // pJobSystem may be nullptr.
+    void Update(JobSystem*);
+
+    const DirectX::XMFLOAT4X4& GetWorldMatrix(TransformHandle) const;
+    TransformHandle GetParent(TransformHandle) const;
+    unsigned int GetCount() const;
+    const TransformUpdateStats& GetStats() const;
+
+private:
+    void MarkDirty(uint32_t);
+    void Reorder();
+    void UpdateRange(uint32_t, uint32_t, uint64_t&);
+
+private:
+    static constexpr uint32_t kNoParent = ~0u;
+    // Nodes per job of a parallel Update().
+    static constexpr unsigned int kUpdateChunkSize = 8192;
+
+    // Per node, in breadth first order once sorted.
+    std::vector<DirectX::XMFLOAT3> m_positions;
+    std::vector<DirectX::XMFLOAT4> m_rotations;
+    std::vector<DirectX::XMFLOAT3> m_scales;
+    std::vector<DirectX::XMFLOAT4X4> m_worldMatrices;
+    std::vector<uint32_t> m_parents;
+    std::vector<uint32_t> m_firstChildren;
+    std::vector<uint32_t> m_childCounts;
+    std::vector<uint8_t> m_dirty;
+    std::vector<TransformHandle> m_handles;
+
+    // Where each level starts, with the node count at the end.
+    std::vector<uint32_t> m_levelStarts;
+    // Levels with a node changed since the last Update().
+    std::vector<uint8_t> m_dirtyLevels;
+
+    // Handle to index, freed handles are chained through it.
+    std::vector<uint32_t> m_handleIndices;
+    TransformHandle m_freeHandle;
+
+    // Nodes created or destroyed since the last sort, m_destroyed marks the ones to drop.
+    bool m_needsReorder;
+    std::vector<uint8_t> m_destroyed;
+
+    TransformUpdateStats m_stats;
+};
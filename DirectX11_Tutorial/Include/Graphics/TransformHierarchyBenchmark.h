@@ -0,0 +1,37 @@
+//////////////////////////////////////////////////////////////////////
+// Filename: TransformHierarchyBenchmark.h
+//////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <memory>
+
+#include "System/JobSystemBenchmark.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+// transform_update : TransformHierarchy::Update() of 1048576 nodes with a hundredth of them
+//                    turned.
+////////////////////////////////////////////////////////////////////////////////////////////////
+std::unique_ptr<JobSystemWorkload> CreateTransformUpdateWorkload();
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+// Builds a random tree of 200000 nodes, one hierarchy updated on the calling thread and one on
+// the job system, and puts both through steps that change one node, a few, a hundredth, a tenth
+// or half of them, nothing, or create and destroy nodes. After every Update() it compares them
+// with the nodes worked out from scratch and writes how many didn't match to stdout. True when
+// all did.
+//
+//  world_mismatches         : World matrices that aren't scale * rotation * translation * the
+//                             parent's world, multiplied out again for every node.
+//  structure_mismatches     : Parents, node counts, handles and reorders that don't match the
+//                             nodes created and destroyed, or the two hierarchies disagree on.
+//  updated_count_mismatches : Updates that recomputed other than the changed and created nodes
+//                             and everything under them.
+//
+// Sparse steps leave long clean runs for the 8 flags at a time skip, and a changed parent whose
+// children weren't marked leaves them stale. Creating and destroying nodes, with children of
+// new nodes and changes to destroyed ones in the same step, sorts the nodes again in between.
+////////////////////////////////////////////////////////////////////////////////////////////////
+bool RunTransformHierarchyCheck();
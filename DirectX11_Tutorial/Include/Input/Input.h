@@ -3,8 +3,36 @@
 ////////////////////////////////////////////////////////////////////////////////
 #pragma once
 
+//////////////
+// INCLUDES //
+//////////////
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "Input/InputEvent.h"
+#include "Input/InputRecording.h"
+#include "System/SpscQueue.h"
+
 ////////////////////////////////////////////////////////////////////////////////
 // Class name: Input
+//
+// Desription
+//  : Event based input. The window thread queues timestamped events with PushEvent()
+//    through a lock-free queue, the render thread takes them in one batch per frame
+//    with BeginFrame() and applies them in order.
+//
+//    WasKeyPressed() also catches a key that went down and up again within one batch,
+//    which IsKeyDown() alone would miss.
+//
+//    EndFrame() is called once the frame that used the batch has been submitted and
+//    records the input-to-submit latency of every event in it.
+//
+//    StartRecording() writes each batch to a file keyed by frame index, StopRecording()
+//    ends the file. StartReplay() discards live events and feeds the batches of a
+//    recording back on the same frames instead, which together with a fixed frame time
+//    reproduces a run exactly. IsReplayFinished() turns true on the frame the recorded
+//    run stopped at.
 ////////////////////////////////////////////////////////////////////////////////
 class Input
 {
@@ -12,14 +40,59 @@ public:
     Input();
     Input(const Input&);
     ~Input();
-    
+
     void Initialize();
-    
+    void Shutdown();
+
+    // Call before the first frame.
+    bool StartRecording(const char*);
+    bool StartReplay(const char*);
+    bool IsReplayFinished() const;
+    // False when any part of the recording couldn't be written.
+    bool StopRecording();
+
+    // Window thread only.
+    bool PushEvent(const InputEvent&);
+
+    // Render thread only. BeginFrame() returns false when the batch couldn't be recorded,
+    // the recording stops there.
+    bool BeginFrame();
+    void EndFrame();
+    const std::vector<InputEvent>& GetFrameEvents() const;
+    unsigned long long GetFrameIndex() const;
+
     void KeyDown(unsigned int);
     void KeyUp(unsigned int);
-    
+
     bool IsKeyDown(unsigned int);
+    bool WasKeyPressed(unsigned int);
+
+    bool IsMouseButtonDown(unsigned int);
+    void GetMousePosition(int&, int&);
+
+    InputLatencyStats GetLatencyStats() const;
+
+private:
+    void ApplyEvent(const InputEvent&);
 
 private:
     bool m_keys[256];
+    bool m_keysPressed[256];
+    bool m_mouseButtons[2];
+    int m_mouseX;
+    int m_mouseY;
+
+    SpscQueue<InputEvent, 4096> m_eventQueue;
+    std::atomic<unsigned int> m_droppedEventCount;
+
+    std::vector<InputEvent> m_frameEvents;
+    unsigned long long m_frameIndex;
+
+    std::unique_ptr<InputRecorder> m_pRecorder;
+    bool m_recordingFailed;
+    std::unique_ptr<InputPlayer> m_pPlayer;
+
+    unsigned long long m_latencyEventCount;
+    double m_latencyTotalSeconds;
+    double m_latencyMaxSeconds;
 };
@@ -0,0 +1,53 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: InputEvent.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <chrono>
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: InputEvent
+//
+// Desription
+//  : A keyboard or mouse message handed from the window thread to the render thread.
+//    m_timestamp is when windows posted the message, not when we got to it,
+//    so the latency measured from it includes time spent in the message queue.
+////////////////////////////////////////////////////////////////////////////////
+struct InputEvent
+{
+    enum class Type
+    {
+        KeyDown,
+        KeyUp,
+        MouseMove,
+        MouseButtonDown,
+        MouseButtonUp,
+    };
+
+    // Mouse buttons in m_code.
+    static constexpr unsigned int kLeftButton = 0;
+    static constexpr unsigned int kRightButton = 1;
+
+    Type m_type;
+
+    // Virtual key code for key events, button for mouse button events.
+    unsigned int m_code;
+
+    // Cursor position in client coordinates for mouse events.
+    int m_x;
+    int m_y;
+
+    std::chrono::steady_clock::time_point m_timestamp;
+};
+
+// Input-to-submit latency of the events handled so far.
+struct InputLatencyStats
+{
+    unsigned long long m_eventCount;
+    unsigned int m_droppedEventCount;
+    double m_averageLatencySeconds;
+    double m_maxLatencySeconds;
+};
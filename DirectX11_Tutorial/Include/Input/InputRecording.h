@@ -0,0 +1,93 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: InputRecording.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "Input/InputEvent.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Binary layout of a recording, little endian:
+//
+//  header : "INPR", uint32 version
+//  batch  : uint32 frame index, uint32 event count, then per event
+//           uint8 type, uint16 code, int16 x, int16 y,
+//           uint32 microseconds between the start of the recording and the event
+//
+// Only frames that had events get a batch. A last batch without events marks the end,
+// its frame index is the number of frames recorded. A recording without it (the run
+// didn't shut down) ends with its last batch.
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: InputRecorder
+//
+// Desription
+//  : Writes every frame's input batch to a recording as the frame begins.
+//    Finish() writes the end of the recording and flushes it.
+////////////////////////////////////////////////////////////////////////////////
+class InputRecorder
+{
+public:
+    InputRecorder();
+    InputRecorder(const InputRecorder&) = delete;
+    ~InputRecorder();
+
+    bool Open(const char*);
+    void Close();
+
+    bool Record(unsigned long long, const std::vector<InputEvent>&);
+    // The number of frames recorded.
+    bool Finish(unsigned long long);
+
+private:
+    FILE* m_pFile;
+    std::chrono::steady_clock::time_point m_startTime;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: InputPlayer
+//
+// Desription
+//  : Reads a whole recording up front and hands back the batch of each frame,
+//    so replaying never touches the disk in the middle of a run.
+////////////////////////////////////////////////////////////////////////////////
+class InputPlayer
+{
+public:
+    InputPlayer();
+    InputPlayer(const InputPlayer&) = delete;
+    ~InputPlayer();
+
+    bool Open(const char*);
+
+    // Appends the events recorded for the frame. They keep their recorded time, counted from
+    // Open() instead of the start of the recording, but are never stamped later than the given
+    // time (the frame's start): a replay running ahead of the recording can't hand out events
+    // that haven't happened yet.
+    void GetFrameEvents(unsigned long long, std::chrono::steady_clock::time_point, std::vector<InputEvent>&);
+
+    // True once the frame index reaches the end of the recording.
+    bool IsFinished(unsigned long long) const;
+
+private:
+    struct Batch
+    {
+        unsigned long long m_frameIndex;
+        size_t m_firstEvent;
+        size_t m_eventCount;
+    };
+
+    std::vector<Batch> m_batches;
+    // Timestamps are the time since the start of the recording until GetFrameEvents().
+    std::vector<InputEvent> m_events;
+    size_t m_nextBatch;
+    unsigned long long m_frameCount;
+    std::chrono::steady_clock::time_point m_startTime;
+};
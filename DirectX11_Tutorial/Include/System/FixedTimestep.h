@@ -0,0 +1,75 @@
+//////////////////////////////////////////////////////////////////////
+// Filename: FixedTimestep.h
+//////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <chrono>
+
+// Steps run since FixedTimestep::Initialize().
+struct FixedTimestepStats
+{
+    unsigned long long m_stepCount;
+    double m_stepSeconds;
+    double m_averageStepCostSeconds;
+    double m_maxStepCostSeconds;
+
+    // Real time thrown away because a frame was too slow to catch up.
+    double m_droppedSeconds;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: FixedTimestep
+//
+// Desription
+//  : Simulation clock that always advances in steps of the same length,
+//    no matter how often frames are rendered.
+//
+//    Advance() adds the real time since the last call and returns how many
+//    steps are due. GetAlpha() is how far the clock is into the next step,
+//    the render interpolates between the last two simulated states by it.
+//    A frame runs at most maxStepsPerFrame steps, the rest of the time is dropped
+//    so a slow frame can't make the next one slower still.
+//
+//    SetFrameSeconds() makes Advance() add the same time every frame instead of
+//    the real time, so a replayed run simulates exactly the same steps.
+////////////////////////////////////////////////////////////////////////////////////////////////
+class FixedTimestep
+{
+public:
+    explicit FixedTimestep();
+
+    void Initialize(double, unsigned int);
+    void SetFrameSeconds(double);
+
+    unsigned int Advance();
+    double GetStepSeconds() const;
+    float GetAlpha() const;
+
+    // Wrap the simulation of one step so its cost is measured.
+    void BeginStep();
+    void EndStep();
+
+    FixedTimestepStats GetStats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    double m_stepSeconds;
+    unsigned int m_maxStepsPerFrame;
+
+    // Zero follows the real time.
+    double m_frameSeconds;
+
+    Clock::time_point m_lastTime;
+    Clock::time_point m_stepStartTime;
+    double m_accumulatedSeconds;
+    bool m_started;
+
+    unsigned long long m_stepCount;
+    double m_stepCostTotalSeconds;
+    double m_stepCostMaxSeconds;
+    double m_droppedSeconds;
+};
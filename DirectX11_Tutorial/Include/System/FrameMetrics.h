@@ -0,0 +1,119 @@
+//////////////////////////////////////////////////////////////////////
+// Filename: FrameMetrics.h
+//////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include "System/Histogram.h"
+#include "System/JobSystem.h"
+
+// A frame counts as a stutter when it takes this many times the recent average,
+// and at least the floor so microsecond noise on cheap work isn't counted.
+constexpr double STUTTER_FACTOR = 2.0;
+constexpr double STUTTER_FLOOR_SECONDS = 0.001;
+
+// Percentiles of one series since the start of the run.
+struct FrameTimeSummary
+{
+    uint64_t m_count;
+    double m_p50Seconds;
+    double m_p95Seconds;
+    double m_p99Seconds;
+    double m_p999Seconds;
+    double m_meanSeconds;
+    double m_maxSeconds;
+    uint64_t m_stutterCount;
+};
+
+struct FrameMetricsSnapshot
+{
+    double m_uptimeSeconds;
+    FrameTimeSummary m_frame;
+    FrameTimeSummary m_update;
+    FrameTimeSummary m_submit;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: FrameMetrics
+//
+// Desription
+//  : Frame, scene update and render submission times of every frame, kept in histograms
+//    so a run of any length takes the same memory. Render thread only.
+////////////////////////////////////////////////////////////////////////////////////////////////
+class FrameMetrics
+{
+public:
+    explicit FrameMetrics();
+
+    void Record(double, double, double);
+    FrameMetricsSnapshot GetSnapshot() const;
+
+private:
+    struct Series
+    {
+        Histogram m_histogram;
+        double m_recentAverageSeconds;
+        uint64_t m_stutterCount;
+
+        void Record(double);
+        FrameTimeSummary Summarize() const;
+    };
+
+    Series m_frame;
+    Series m_update;
+    Series m_submit;
+    std::chrono::steady_clock::time_point m_startTime;
+};
+
+enum class MetricsFormat
+{
+    Prometheus, // The file is replaced with the latest values, for a node exporter textfile collector.
+    Csv,        // A row is appended per export.
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: MetricsExporter
+//
+// Desription
+//  : Writes a FrameMetrics snapshot to a file every interval. Update() is called by the
+//    frame loop once per frame and only copies the snapshot, the file is written by a job
+//    so a slow disk never shows up as a stutter. An export still being written when the
+//    next one is due makes that one wait for the following frame.
+////////////////////////////////////////////////////////////////////////////////////////////////
+class MetricsExporter
+{
+public:
+    explicit MetricsExporter();
+    MetricsExporter(const MetricsExporter&) = delete;
+    ~MetricsExporter();
+
+    bool Initialize(const std::string&, MetricsFormat, double, JobSystem*);
+    void Shutdown(const FrameMetrics&);
+
+    void Update(const FrameMetrics&);
+
+private:
+    static void WriteJob(void*);
+    bool Write(const FrameMetricsSnapshot&);
+    bool WritePrometheus(const FrameMetricsSnapshot&);
+    bool WriteCsv(const FrameMetricsSnapshot&);
+
+private:
+    // Owned by System.
+    JobSystem* m_pJobSystem;
+
+    std::string m_fileName;
+    MetricsFormat m_format;
+    std::chrono::steady_clock::duration m_interval;
+    std::chrono::steady_clock::time_point m_nextExportTime;
+
+    FrameMetricsSnapshot m_pendingSnapshot;
+    JobCounter m_writeCounter;
+    bool m_writeRunning;
+};
@@ -0,0 +1,58 @@
+//////////////////////////////////////////////////////////////////////
+// Filename: HeadlessPlatform.h
+//////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <chrono>
+#include <string>
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "System/Platform.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: HeadlessPlatform
+//
+// Desription
+//  : Runs System without a window for a fixed number of frames or seconds,
+//    whichever comes first, at a virtual resolution.
+//    Every FrameCompleted() call closes the timing of one frame, the first frame
+//    is a warm-up and isn't measured but counts towards the frame limit, so a
+//    limit of n renders exactly n frames and measures n - 1 of them.
+//    Shutdown() prints the results and writes them to the results file.
+////////////////////////////////////////////////////////////////////////////////////////////////
+class HeadlessPlatform : public Platform
+{
+public:
+    explicit HeadlessPlatform(int, int, unsigned int, double, const std::string&);
+
+    bool Initialize(int&, int&) override;
+    void Shutdown() override;
+    bool PumpMessages() override;
+    void WaitForMessages(unsigned int) override;
+    bool FrameCompleted() override;
+    HWND GetWindowHandle() const override;
+
+private:
+    void WriteResults() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    int m_screenWidth;
+    int m_screenHeight;
+    unsigned int m_frameLimit;
+    double m_secondsLimit;
+    std::string m_resultsFileName;
+
+    Clock::time_point m_startTime;
+    Clock::time_point m_frameStartTime;
+    unsigned int m_frameCount;
+    double m_totalSeconds;
+    double m_minFrameSeconds;
+    double m_maxFrameSeconds;
+};
@@ -0,0 +1,52 @@
+//////////////////////////////////////////////////////////////////////
+// Filename: Histogram.h
+//////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstdint>
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: Histogram
+//
+// Desription
+//  : Log-linear (HDR style) histogram of durations in microseconds.
+//
+//    Values below 128us get a bucket each. Above that every power of two is split into
+//    64 buckets, so a bucket is never wider than 1/64 of its value and any percentile is
+//    within about 1.6% of the truth. Durations up to 2^36us (19 hours) fit, longer ones
+//    land in the last bucket. The buckets are a fixed array, recording never allocates
+//    and the memory is the same after a minute and after a week.
+////////////////////////////////////////////////////////////////////////////////////////////////
+class Histogram
+{
+public:
+    static constexpr unsigned int kLinearBuckets = 128;
+    static constexpr unsigned int kSubBuckets = 64;
+    static constexpr unsigned int kMaxShift = 29;
+    static constexpr unsigned int kBucketCount = kLinearBuckets + kMaxShift * kSubBuckets;
+
+    explicit Histogram();
+
+    void Record(double);
+    void Reset();
+
+    uint64_t GetCount() const;
+    double GetMeanSeconds() const;
+    double GetMaxSeconds() const;
+
+    // 0 to 100.
+    double GetPercentileSeconds(double) const;
+
+private:
+    static unsigned int GetBucket(uint64_t);
+    static uint64_t GetBucketMidpoint(unsigned int);
+
+private:
+    uint64_t m_buckets[kBucketCount];
+    uint64_t m_count;
+    uint64_t m_totalMicroseconds;
+    uint64_t m_maxMicroseconds;
+};
@@ -0,0 +1,201 @@
+//////////////////////////////////////////////////////////////////////
+// Filename: JobSystem.h
+//////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using JobFunction = void(*)(void*);
+
+struct Job
+{
+    JobFunction m_pFunction;
+    void* m_pData;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: JobCounter
+//
+// Desription
+//  : Counts the unfinished jobs of a batch. JobSystem::Wait() on it to join the batch,
+//    or hand it to JobSystem::Run() as a dependency to start jobs once it reaches zero.
+//    A counter can be reused once it has been waited on.
+////////////////////////////////////////////////////////////////////////////////////////////////
+class JobCounter
+{
+public:
+    JobCounter();
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+
+    bool IsDone() const;
+
+private:
+    friend class JobSystem;
+
+    struct Continuation
+    {
+        Job m_job;
+        JobCounter* m_pCounter;
+    };
+
+    std::atomic<unsigned int> m_pending;
+    std::mutex m_mutex;
+    std::vector<Continuation> m_continuations;
+};
+
+// What one worker did since the last JobSystem::ResetStats().
+struct JobWorkerStats
+{
+    unsigned long long m_jobsExecuted;
+    unsigned long long m_jobsStolen;
+    double m_busySeconds;
+    double m_utilization;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: JobSystem
+//
+// Desription
+//  : Work-stealing job scheduler owned by System and shared with every subsystem.
+//
+//    Every worker thread has its own deque. A worker pushes and pops jobs at the back of its
+//    own deque (newest first, so the data is still in cache) and steals from the front of
+//    the others when it runs dry. Threads that aren't workers (the render thread, the window
+//    thread) spread their jobs over the worker deques and help run jobs while they Wait().
+//
+//    Jobs must not block on anything but JobSystem::Wait().
+////////////////////////////////////////////////////////////////////////////////////////////////
+class JobSystem
+{
+public:
+    explicit JobSystem();
+    explicit JobSystem(const JobSystem&);
+    ~JobSystem();
+
+    // Number of worker threads. With zero workers every job runs on the thread that queues it.
+    bool Initialize(unsigned int);
+    void Shutdown();
+
+    unsigned int GetWorkerCount() const;
+
+    // 0 on any thread that isn't one of the workers, the worker index + 1 on a worker. Threads
+    // numbered like this go from 0 to GetWorkerCount().
+    unsigned int GetCallingThreadIndex() const;
+
+    // One less than the hardware threads, the render thread helps out whenever it waits.
+    static unsigned int GetDefaultWorkerCount();
+
+    // Queues jobs and adds them to pCounter (which may be nullptr).
+    // With a dependency the jobs only start once the dependency counter reaches zero.
+    void Run(const Job*, unsigned int, JobCounter*, JobCounter* = nullptr);
+
+    // Runs other jobs on the calling thread until the counter reaches zero.
+    void Wait(JobCounter&);
+
+    // Calls function(begin, end) over [0, count) split into chunks of at most grainSize,
+    // and returns once every chunk is done.
+    template <typename Function>
+    void ParallelFor(unsigned int, unsigned int, const Function&);
+
+    JobWorkerStats GetWorkerStats(unsigned int) const;
+    void ResetStats();
+
+private:
+    struct Worker
+    {
+        std::mutex m_mutex;
+        std::deque<JobCounter::Continuation> m_jobs;
+
+        std::atomic<unsigned long long> m_jobsExecuted;
+        std::atomic<unsigned long long> m_jobsStolen;
+        std::atomic<long long> m_busyNanoseconds;
+    };
+
+    template <typename Function>
+    struct ParallelForData
+    {
+        const Function* m_pFunction;
+        unsigned int m_begin;
+        unsigned int m_end;
+    };
+
+    template <typename Function>
+    static void ParallelForJob(void*);
+
+    void Push(unsigned int, const JobCounter::Continuation&);
+    bool Pop(unsigned int, JobCounter::Continuation&);
+    bool Steal(unsigned int, JobCounter::Continuation&);
+    bool TryRunJob(unsigned int);
+    void Finish(JobCounter*);
+    void WorkerMain(unsigned int);
+    unsigned int GetCallingWorker() const;
+
+private:
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::vector<std::thread> m_threads;
+
+    // Workers sleep here when every deque is empty.
+    std::mutex m_sleepMutex;
+    std::condition_variable m_sleepCondition;
+    std::atomic<unsigned int> m_queuedJobs;
+    std::atomic<unsigned int> m_nextExternalWorker;
+    bool m_quit;
+
+    std::chrono::steady_clock::time_point m_statsStartTime;
+};
+
+template <typename Function>
+void JobSystem::ParallelForJob(void* pData)
+{
+    const ParallelForData<Function>* pRange = static_cast<const ParallelForData<Function>*>(pData);
+    (*pRange->m_pFunction)(pRange->m_begin, pRange->m_end);
+}
+
+template <typename Function>
+void JobSystem::ParallelFor(unsigned int count, unsigned int grainSize, const Function& kFunction)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    grainSize = std::max(1u, grainSize);
+    unsigned int chunkCount = (count + grainSize - 1) / grainSize;
+
+    // A single chunk (or no workers) isn't worth the queue round trip.
+    if (chunkCount == 1 || m_workers.empty())
+    {
+        kFunction(0u, count);
+        return;
+    }
+
+    std::vector<ParallelForData<Function>> ranges(chunkCount);
+    std::vector<Job> jobs(chunkCount);
+
+    for (unsigned int i = 0; i < chunkCount; ++i)
+    {
+        ranges[i].m_pFunction = &kFunction;
+        ranges[i].m_begin = i * grainSize;
+        ranges[i].m_end = std::min(count, ranges[i].m_begin + grainSize);
+
+        jobs[i].m_pFunction = &JobSystem::ParallelForJob<Function>;
+        jobs[i].m_pData = &ranges[i];
+    }
+
+    // The ranges live on this stack frame, so wait for every chunk before returning.
+    JobCounter counter;
+    Run(jobs.data(), chunkCount, &counter);
+    Wait(counter);
+}
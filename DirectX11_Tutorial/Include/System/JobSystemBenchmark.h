@@ -0,0 +1,51 @@
+//////////////////////////////////////////////////////////////////////
+// Filename: JobSystemBenchmark.h
+//////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <memory>
+#include <string>
+
+#include "System/JobSystem.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: JobSystemWorkload
+//
+// Desription
+//  : One workload RunJobSystemBenchmark() times at every thread count. The subsystems that
+//    run on the job system keep theirs next to their own code and describe them in their
+//    own headers (RenderQueueBenchmark.h, CommandListBenchmark.h, ...).
+//
+//    Initialize() builds the data once, with a fixed seed so every thread count does the
+//    same work. Run() is called a few times for every thread count and returns the seconds
+//    of the part it measures, setting up the next run isn't timed.
+////////////////////////////////////////////////////////////////////////////////////////////////
+class JobSystemWorkload
+{
+public:
+    virtual ~JobSystemWorkload() = default;
+
+    // The name in the results.
+    virtual const char* GetName() const = 0;
+
+    // The most threads Run() will be given.
+    virtual bool Initialize(unsigned int) = 0;
+    virtual void Shutdown() = 0;
+    virtual double Run(JobSystem&) = 0;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+// Runs the workloads on the JobSystem with 1 to maxThreads threads (the calling thread plus
+// maxThreads - 1 workers) and writes time, speedup and worker utilization for each thread
+// count to stdout and the results file. Zero uses every hardware thread.
+//
+// The job system's own workloads:
+//  parallel_for : Math heavy loop split with ParallelFor.
+//  fan_out      : Many small jobs in two stages, the second depending on the first.
+//
+// And the subsystems' after them, see the header each one is created in.
+////////////////////////////////////////////////////////////////////////////////////////////////
+bool RunJobSystemBenchmark(unsigned int, const std::string&);
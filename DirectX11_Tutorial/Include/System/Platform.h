@@ -0,0 +1,41 @@
+//////////////////////////////////////////////////////////////////////
+// Filename: Platform.h
+//////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <windows.h>
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: Platform
+//
+// Desription
+//  : Everything System needs from the operating system to run its frame loop.
+//    Win32Platform opens a window and pumps the windows messages, HeadlessPlatform
+//    has no window at all and ends the run after a fixed number of frames or seconds.
+//
+//    PumpMessages() and WaitForMessages() are called on the window thread,
+//    FrameCompleted() on the render thread.
+////////////////////////////////////////////////////////////////////////////////////////////////
+class Platform
+{
+public:
+    virtual ~Platform() = default;
+
+    // Returns the resolution the graphics should be created with.
+    virtual bool Initialize(int&, int&) = 0;
+    virtual void Shutdown() = 0;
+
+    // Handles every pending message. Returns false when the application should quit.
+    virtual bool PumpMessages() = 0;
+    // Sleeps until a message arrives or the time runs out.
+    virtual void WaitForMessages(unsigned int) = 0;
+
+    // Called after every rendered frame. Returns false when the run is over.
+    virtual bool FrameCompleted() = 0;
+
+    // nullptr when there is no window.
+    virtual HWND GetWindowHandle() const = 0;
+};
@@ -0,0 +1,191 @@
+//////////////////////////////////////////////////////////////////////
+// Filename: Profiler.h
+//////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define PROFILER_USE_TSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define PROFILER_USE_TSC 1
+#else
+#define PROFILER_USE_TSC 0
+#endif
+
+// The instrumentation compiles away unless PROFILER_ENABLED is 1.
+// Debug builds have it on, define PROFILER_ENABLED=1 to profile a release build.
+#if !defined(PROFILER_ENABLED)
+#if defined(NDEBUG)
+#define PROFILER_ENABLED 0
+#else
+#define PROFILER_ENABLED 1
+#endif
+#endif
+
+// One finished scope.
+struct ProfileEvent
+{
+    const char* m_pName;
+    long long m_startTicks;
+    long long m_endTicks;
+    unsigned long long m_frameIndex;
+    unsigned int m_depth;
+};
+
+// Written only by the thread it belongs to, read when the profile is collected.
+struct ProfilerThreadBuffer
+{
+    static constexpr unsigned int kCapacity = 1 << 15;
+
+    ProfileEvent m_events[kCapacity];
+    std::atomic<unsigned long long> m_eventCount;
+
+    unsigned int m_depth;
+    unsigned int m_threadId;
+    char m_name[32];
+};
+
+// Time spent in one scope, keyed by its path from the root of its thread.
+struct ProfileScopeStats
+{
+    std::string m_path;
+    const char* m_pName;
+    unsigned int m_depth;
+    unsigned long long m_callCount;
+    long long m_totalTicks;
+    double m_totalSeconds;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: Profiler
+//
+// Desription
+//  : Hierarchical CPU profiler. PROFILE_SCOPE() times the rest of the enclosing block
+//    and writes it to a ring buffer of the calling thread when the block ends, so
+//    recording never takes a lock. The oldest events are overwritten, the rings hold
+//    the last few hundred frames of a normal run.
+//
+//    Every event carries the frame index that was current when it started, the render
+//    thread moves it on with PROFILE_FRAME(). GetSummary() adds up a range of frames
+//    per scope path and ExportChromeTrace() writes the same range for chrome://tracing.
+//
+//    Collecting while other threads are recording is safe, events overwritten during
+//    the copy are left out.
+//
+//    Scopes are timed with the time stamp counter where there is one, reading it costs
+//    a fraction of a steady_clock::now(). It is converted to time when the profile is
+//    collected, against the steady clock over the whole run.
+////////////////////////////////////////////////////////////////////////////////////////////////
+class Profiler
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static long long ReadTicks()
+    {
+#if PROFILER_USE_TSC
+        return static_cast<long long>(__rdtsc());
+#else
+        return Clock::now().time_since_epoch().count();
+#endif
+    }
+
+    static void BeginFrame();
+
+    static unsigned long long GetFrameIndex()
+    {
+        return s_frameIndex.load(std::memory_order_relaxed);
+    }
+
+    // Names the calling thread in the trace.
+    static void SetThreadName(const char*);
+
+    // Returns how many frames of the range were found.
+    static unsigned long long GetSummary(unsigned long long, unsigned long long, std::vector<ProfileScopeStats>&);
+    static bool ExportChromeTrace(const char*, unsigned long long, unsigned long long);
+
+    // Frees every thread buffer. Only the calling thread may still be running.
+    static void Shutdown();
+
+    static ProfilerThreadBuffer& GetThreadBuffer()
+    {
+        if (!s_pThreadBuffer)
+        {
+            s_pThreadBuffer = RegisterThread();
+        }
+
+        return *s_pThreadBuffer;
+    }
+
+private:
+    static ProfilerThreadBuffer* RegisterThread();
+
+    static thread_local ProfilerThreadBuffer* s_pThreadBuffer;
+    static std::atomic<unsigned long long> s_frameIndex;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: ProfileScope
+//
+// Desription
+//  : Use through PROFILE_SCOPE(). The name must outlive the profile, a string literal.
+////////////////////////////////////////////////////////////////////////////////////////////////
+class ProfileScope
+{
+public:
+    explicit ProfileScope(const char* pName)
+        : m_buffer(Profiler::GetThreadBuffer())
+        , m_pName(pName)
+        , m_frameIndex(Profiler::GetFrameIndex())
+        , m_depth(m_buffer.m_depth++)
+        , m_startTicks(Profiler::ReadTicks())
+    {
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+
+    ~ProfileScope()
+    {
+        long long endTicks = Profiler::ReadTicks();
+
+        unsigned long long index = m_buffer.m_eventCount.load(std::memory_order_relaxed);
+        ProfileEvent& event = m_buffer.m_events[index & (ProfilerThreadBuffer::kCapacity - 1)];
+        event.m_pName = m_pName;
+        event.m_startTicks = m_startTicks;
+        event.m_endTicks = endTicks;
+        event.m_frameIndex = m_frameIndex;
+        event.m_depth = m_depth;
+
+        m_buffer.m_eventCount.store(index + 1, std::memory_order_release);
+        --m_buffer.m_depth;
+    }
+
+private:
+    ProfilerThreadBuffer& m_buffer;
+    const char* m_pName;
+    unsigned long long m_frameIndex;
+    unsigned int m_depth;
+    long long m_startTicks;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#if PROFILER_ENABLED
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_FRAME() Profiler::BeginFrame()
+#define PROFILE_THREAD(name) Profiler::SetThreadName(name)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_FRAME() ((void)0)
+#define PROFILE_THREAD(name) ((void)0)
+#endif
@@ -0,0 +1,55 @@
+//////////////////////////////////////////////////////////////////////
+// Filename: RangeAllocator.h
+//////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstdint>
+#include <map>
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: RangeAllocator
+//
+// Desription
+//  : Hands out ranges of [0, capacity) in units of whatever the caller is placing,
+//    vertices or indices for the GeometryPool. Nothing is stored in the ranges, so it
+//    works for memory it can't touch, like a GPU buffer.
+//
+//    The free ranges are kept twice, by offset to merge a freed range with its neighbours
+//    and by size to find the best fit. Both are ordered, so Allocate() and Free() are
+//    O(log n) in the number of free ranges. The caller remembers the size of what it
+//    allocated and passes it back to Free().
+////////////////////////////////////////////////////////////////////////////////////////////////
+class RangeAllocator
+{
+public:
+    explicit RangeAllocator();
+
+    void Initialize(uint32_t);
+
+    // The smallest free range that fits, false when none does (see GetLargestFreeRange()).
+    bool Allocate(uint32_t, uint32_t&);
+    void Free(uint32_t, uint32_t);
+
+    // Everything below the offset is in use and everything above it is free, after a compaction.
+    void Reset(uint32_t);
+
+    uint32_t GetCapacity() const;
+    uint32_t GetFreeCount() const;
+    uint32_t GetFreeRangeCount() const;
+    uint32_t GetLargestFreeRange() const;
+
+private:
+    void AddFreeRange(uint32_t, uint32_t);
+    void RemoveFreeRange(std::map<uint32_t, uint32_t>::iterator);
+
+private:
+    uint32_t m_capacity;
+    uint32_t m_freeCount;
+
+    // Offset to size, and size to offset.
+    std::map<uint32_t, uint32_t> m_freeByOffset;
+    std::multimap<uint32_t, uint32_t> m_freeBySize;
+};
@@ -0,0 +1,44 @@
+//////////////////////////////////////////////////////////////////////
+// Filename: SeededRandom.h
+//////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstdint>
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: SeededRandom
+//
+// Desription
+//  : The linear congruential generator the benchmarks and checks scatter their scenes with.
+//    The same seed gives the same numbers on every run and every thread count, so timings
+//    can be compared. Not for anything that has to look random.
+////////////////////////////////////////////////////////////////////////////////////////////////
+class SeededRandom
+{
+public:
+    explicit SeededRandom(uint32_t seed) : m_seed(seed) {}
+
+    // The top 24 bits of the next state, the low bits of an LCG repeat too soon.
+    uint32_t NextBits()
+    {
+        m_seed = m_seed * 1664525u + 1013904223u;
+        return m_seed >> 8;
+    }
+
+    // In [0, 1).
+    float Next()
+    {
+        return static_cast<float>(NextBits()) / 16777216.0f;
+    }
+
+    float Next(float minimum, float maximum)
+    {
+        return minimum + Next() * (maximum - minimum);
+    }
+
+private:
+    uint32_t m_seed;
+};
@@ -12,6 +12,7 @@
 // INCLUDES //
 //////////////
 #include <windows.h>
+#include <atomic>
 #include <memory>
 
 ///////////////////////
@@ -19,6 +20,14 @@
 ///////////////////////
 #include "Input/Input.h"
 #include "Graphics/Graphics.h"
+#include "System/Platform.h"
+#include "System/SystemSettings.h"
+#include "System/JobSystem.h"
+#include "System/Profiler.h"
+#include "System/FrameMetrics.h"
+
+// Frames the profile summary printed at shutdown is averaged over.
+constexpr unsigned long long PROFILE_SUMMARY_FRAMES = 120;
 
 ////////////////////////////////////////////////////////////////////////////////////////////////
 // Class name: System
@@ -27,6 +36,12 @@
 //  : Initialize, Shutdown, and Run the WinMain defined here.
 //    It also handles MessageHandler function to handle the windows system messages that will
 //    get sent to the application while it is runing.
+//    The window (or the lack of one in a headless run) is owned by the Platform.
+//
+//    Run() keeps the calling thread for the window messages and renders on its own thread.
+//    Keyboard and mouse messages are queued on Input and applied at the start of the next frame.
+//
+//    The JobSystem is created first and shut down last so every subsystem can use it.
 ////////////////////////////////////////////////////////////////////////////////////////////////
 class System
 {
@@ -35,32 +50,40 @@ public:
     explicit System(const System&);
     ~System();
 
-    bool Initialize();
+    bool Initialize(const SystemSettings&);
     void Shutdown();
-    void Run();
+    // False when the run ended on a failure rather than a quit or the end of a headless run.
+    bool Run();
 
     LRESULT CALLBACK MessageHandler(HWND, UINT, WPARAM, LPARAM);
 
 private:
     bool Frame();
-    void InitializeWindows(int&, int&);
-    void ShutdownWindows();
+    void RenderThreadMain();
+    void InjectSyntheticInput();
+    void ReportStats() const;
+    void ReportProfile() const;
 
 private:
-    LPCWSTR m_applicationName;
-    HINSTANCE m_hInstance;
-    HWND m_hwnd;
-
+    std::unique_ptr<Platform> m_pPlatform;
+    std::unique_ptr<JobSystem> m_pJobSystem;
     std::unique_ptr<Input> m_pInput;
     std::unique_ptr<Graphics> m_pGraphics;
-};
 
-/////////////////////////
-// FUNCTION PROTOTYPES //
-/////////////////////////
-static LRESULT CALLBACK WndProc(HWND, UINT, WPARAM, LPARAM);
+    // Written by the render thread, read once it has stopped.
+    FrameMetrics m_frameMetrics;
+    std::unique_ptr<MetricsExporter> m_pMetricsExporter;
+
+    std::atomic<bool> m_quitRequested;
+    std::atomic<bool> m_renderThreadRunning;
+    std::atomic<bool> m_runFailed;
 
-/////////////
-// GLOBALS //
-/////////////
-static System* s_pApplicationHandle = nullptr;
\ No newline at end of file
+    // Synthetic events queued per window loop iteration, window thread only.
+    unsigned int m_syntheticInputRate;
+    unsigned int m_syntheticInputCount;
+
+    // Chrome trace written at shutdown, the frame range is the last summary when both are zero.
+    std::string m_profileFileName;
+    unsigned long long m_profileFirstFrame;
+    unsigned long long m_profileLastFrame;
+};
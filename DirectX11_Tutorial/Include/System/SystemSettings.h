@@ -0,0 +1,107 @@
+//////////////////////////////////////////////////////////////////////
+// Filename: SystemSettings.h
+//////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <string>
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "Graphics/Graphics.h"
+#include "System/FrameMetrics.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: SystemSettings
+//
+// Desription
+//  : How System should run, filled from the command line by WinMain.
+//
+//    -headless            No window, the run ends after -frames or -seconds (or at the end
+//                         of a -replay), one of them is required.
+//    -frames <n>          Number of frames to run, the unmeasured first one included (headless only).
+//    -seconds <s>         Number of seconds to run (headless only).
+//    -width <w>           Resolution (virtual resolution when headless).
+//    -height <h>
+//    -backend <name>      hardware, software or null.
+//    -jobs <n>            Job system worker threads, 0 uses one less than the hardware threads.
+//                         The software rasterizer runs its tiles on them too.
+//    -jobbenchmark        Run the synthetic job system workloads on 1 to -jobs threads
+//                         (every hardware thread when 0) instead of the application.
+//    -scenebenchmark      Time the scene tree queries against brute force instead of
+//                         running the application.
+//    -occlusioncheck      Check the occlusion culler's scalar and SSE code against each other
+//                         and a reference instead of running the application.
+//    -transformcheck      Check the transform hierarchy's updates against world matrices worked
+//                         out from scratch instead of running the application.
+//    -pipeline <n>        Frames in flight between scene update and render submission.
+//    -simrate <hz>        Fixed simulation steps per second.
+//    -syntheticinput <n>  Queue n synthetic key/mouse events every millisecond or so.
+//    -results <file>      Where the headless timing results are written.
+//    -record <file>       Write every frame's input to a recording.
+//    -replay <file>       Feed a recording back instead of the live input. The run ends
+//                         on the frame the recorded run ended on.
+//    -frametime <ms>      Simulate every frame as if this much time had passed,
+//                         use it on both the recorded and the replayed run.
+//    -pacing <mode>       uncapped, vsync, cap or jit (just in time). Headless runs
+//                         default to uncapped, windowed ones to vsync.
+//    -fpscap <hz>         Frame rate of -pacing cap.
+//    -queuedframes <n>    Frames the display may queue before presenting blocks.
+//    -refresh <hz>        Refresh rate of the simulated display used without a swap chain.
+//    -instances <n>       Also draw a grid of n copies of the model with one instanced draw.
+//    -separatedraws       Draw the -instances grid with a draw per copy instead, each culled
+//                         on its own. The copies then all have the model's colors.
+//    -profile <file>      Write a Chrome trace of the profiled scopes at shutdown
+//                         (needs a build with PROFILER_ENABLED).
+//    -profileframes <first> <last>  Frames the trace covers, the last 120 by default.
+//    -metrics <file>      Write frame, update and submit time percentiles and stutter
+//                         counts to a file every -metricsinterval seconds (10 by default).
+//    -metricsformat <f>   prometheus (the default, the file is replaced) or csv (a row per export).
+//    -metricsinterval <s>
+////////////////////////////////////////////////////////////////////////////////////////////////
+struct SystemSettings
+{
+    bool ParseCommandLine(const char*);
+
+    bool m_headless = false;
+    int m_screenWidth = 800;
+    int m_screenHeight = 600;
+
+    // A headless run needs one of them unless it replays a recording.
+    unsigned int m_frameCount = 0;
+    double m_seconds = 0.0;
+
+    RenderBackend m_backend = RenderBackend::Hardware;
+    unsigned int m_instanceCount = 0;
+    bool m_separateDraws = false;
+
+    unsigned int m_jobWorkers = 0;
+    bool m_jobBenchmark = false;
+    bool m_sceneBenchmark = false;
+    bool m_occlusionCheck = false;
+    bool m_transformCheck = false;
+
+    unsigned int m_pipelineDepth = DEFAULT_PIPELINE_DEPTH;
+    double m_simulationRate = DEFAULT_SIMULATION_RATE;
+
+    unsigned int m_syntheticInputRate = 0;
+
+    std::string m_resultsFileName = "BenchmarkResults.txt";
+
+    std::string m_recordFileName;
+    std::string m_replayFileName;
+    double m_fixedFrameSeconds = 0.0;
+
+    std::string m_profileFileName;
+    unsigned long long m_profileFirstFrame = 0;
+    unsigned long long m_profileLastFrame = 0;
+
+    std::string m_metricsFileName;
+    MetricsFormat m_metricsFormat = MetricsFormat::Prometheus;
+    double m_metricsInterval = 10.0;
+
+    FramePacingSettings m_pacing = { VSYNC_ENABLED ? PacingMode::VSync : PacingMode::Uncapped, 60.0, DEFAULT_QUEUED_FRAMES, DEFAULT_SIMULATED_REFRESH_HZ };
+};
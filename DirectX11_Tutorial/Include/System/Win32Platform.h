@@ -0,0 +1,55 @@
+//////////////////////////////////////////////////////////////////////
+// Filename: Win32Platform.h
+//////////////////////////////////////////////////////////////////////
+#pragma once
+
+///////////////////////////////
+// PRE-PROCESSING DIRECTIVES //
+///////////////////////////////
+#define WIN32_LEAN_AND_MEAN
+
+//////////////
+// INCLUDES //
+//////////////
+#include <windows.h>
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "System/Platform.h"
+
+/////////////////////////
+// FORWARD DECLARATION //
+/////////////////////////
+class System;
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: Win32Platform
+//
+// Desription
+//  : Creates the window we render to and pumps its messages.
+//    Keyboard messages are forwarded to System::MessageHandler.
+////////////////////////////////////////////////////////////////////////////////////////////////
+class Win32Platform : public Platform
+{
+public:
+    explicit Win32Platform(System&, int, int);
+
+    bool Initialize(int&, int&) override;
+    void Shutdown() override;
+    bool PumpMessages() override;
+    void WaitForMessages(unsigned int) override;
+    bool FrameCompleted() override;
+    HWND GetWindowHandle() const override;
+
+    LRESULT CALLBACK MessageHandler(HWND, UINT, WPARAM, LPARAM);
+
+private:
+    System& m_system;
+    int m_windowedWidth;
+    int m_windowedHeight;
+
+    LPCWSTR m_applicationName;
+    HINSTANCE m_hInstance;
+    HWND m_hwnd;
+};
@@ -0,0 +1,502 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: AabbTree.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include <algorithm>
+
+#include "Graphics/AabbTree.h"
+
+using namespace DirectX;
+
+AabbTree::AabbTree()
+    : m_root(kNullNode)
+    , m_freeList(kNullNode)
+    , m_proxyCount(0)
+{
+}
+
+// A tree of count leaves has count - 1 inner nodes.
+void AabbTree::Reserve(unsigned int count)
+{
+    m_nodes.reserve(count * 2);
+    m_links.reserve(count * 2);
+}
+
+void AabbTree::Clear()
+{
+    m_nodes.clear();
+    m_links.clear();
+    m_root = kNullNode;
+    m_freeList = kNullNode;
+    m_proxyCount = 0;
+}
+
+AabbProxy AabbTree::Insert(const Aabb& kAabb, uint32_t userData)
+{
+    uint32_t leaf = AllocateNode();
+
+    Node& node = m_nodes[leaf];
+    node.m_min = XMFLOAT3(kAabb.m_min.x - kFatMargin, kAabb.m_min.y - kFatMargin, kAabb.m_min.z - kFatMargin);
+    node.m_max = XMFLOAT3(kAabb.m_max.x + kFatMargin, kAabb.m_max.y + kFatMargin, kAabb.m_max.z + kFatMargin);
+    m_links[leaf].m_userData = userData;
+
+    InsertLeaf(leaf);
+    ++m_proxyCount;
+
+    return static_cast<AabbProxy>(leaf);
+}
+
+void AabbTree::Remove(AabbProxy proxy)
+{
+    RemoveLeaf(proxy);
+    FreeNode(proxy);
+    --m_proxyCount;
+}
+
+//-----------------------------------------------------------------
+// The leaf is left alone while the fat box still holds the new box.
+// It is also reinserted when its fat box has grown much larger than
+// the object needs, e.g. after a fast move, so it can shrink again.
+//-----------------------------------------------------------------
+bool AabbTree::Move(AabbProxy proxy, const Aabb& kAabb, const XMFLOAT3& kDisplacement)
+{
+    XMFLOAT3 fatMin(kAabb.m_min.x - kFatMargin, kAabb.m_min.y - kFatMargin, kAabb.m_min.z - kFatMargin);
+    XMFLOAT3 fatMax(kAabb.m_max.x + kFatMargin, kAabb.m_max.y + kFatMargin, kAabb.m_max.z + kFatMargin);
+
+    // Stretch the box towards where the object is going.
+    XMFLOAT3 stretch(kDisplacement.x * kDisplacementMultiplier, kDisplacement.y * kDisplacementMultiplier, kDisplacement.z * kDisplacementMultiplier);
+    (stretch.x < 0.0f ? fatMin.x : fatMax.x) += stretch.x;
+    (stretch.y < 0.0f ? fatMin.y : fatMax.y) += stretch.y;
+    (stretch.z < 0.0f ? fatMin.z : fatMax.z) += stretch.z;
+
+    const Node& kNode = m_nodes[proxy];
+    bool contained =
+        kNode.m_min.x <= kAabb.m_min.x && kNode.m_min.y <= kAabb.m_min.y && kNode.m_min.z <= kAabb.m_min.z &&
+        kNode.m_max.x >= kAabb.m_max.x && kNode.m_max.y >= kAabb.m_max.y && kNode.m_max.z >= kAabb.m_max.z;
+
+    if (contained)
+    {
+        constexpr float kHugeMargin = kFatMargin * 4.0f;
+        bool huge =
+            kNode.m_min.x < fatMin.x - kHugeMargin || kNode.m_min.y < fatMin.y - kHugeMargin || kNode.m_min.z < fatMin.z - kHugeMargin ||
+            kNode.m_max.x > fatMax.x + kHugeMargin || kNode.m_max.y > fatMax.y + kHugeMargin || kNode.m_max.z > fatMax.z + kHugeMargin;
+
+        if (!huge)
+        {
+            return false;
+        }
+    }
+
+    RemoveLeaf(proxy);
+
+    m_nodes[proxy].m_min = fatMin;
+    m_nodes[proxy].m_max = fatMax;
+
+    InsertLeaf(proxy);
+
+    return true;
+}
+
+uint32_t AabbTree::GetUserData(AabbProxy proxy) const
+{
+    return m_links[proxy].m_userData;
+}
+
+Aabb AabbTree::GetFatAabb(AabbProxy proxy) const
+{
+    Aabb aabb;
+    aabb.m_min = m_nodes[proxy].m_min;
+    aabb.m_max = m_nodes[proxy].m_max;
+    return aabb;
+}
+
+unsigned int AabbTree::GetProxyCount() const
+{
+    return m_proxyCount;
+}
+
+int AabbTree::GetHeight() const
+{
+    if (m_root == kNullNode)
+    {
+        return 0;
+    }
+
+    return m_links[m_root].m_height + 1;
+}
+
+float AabbTree::GetAreaRatio() const
+{
+    if (m_root == kNullNode)
+    {
+        return 0.0f;
+    }
+
+    float rootArea = SurfaceArea(m_nodes[m_root].m_min, m_nodes[m_root].m_max);
+
+    float totalArea = 0.0f;
+    for (size_t i = 0; i < m_nodes.size(); ++i)
+    {
+        // Skips the free nodes and the leaves.
+        if (m_links[i].m_height > 0)
+        {
+            totalArea += SurfaceArea(m_nodes[i].m_min, m_nodes[i].m_max);
+        }
+    }
+
+    return (rootArea > 0.0f) ? totalArea / rootArea : 0.0f;
+}
+
+bool AabbTree::Validate() const
+{
+    unsigned int freeCount = 0;
+    for (uint32_t index = m_freeList; index != kNullNode; index = m_links[index].m_parent)
+    {
+        if (m_links[index].m_height != -1 || ++freeCount > m_nodes.size())
+        {
+            return false;
+        }
+    }
+
+    if (m_root == kNullNode)
+    {
+        return m_proxyCount == 0 && freeCount == m_nodes.size();
+    }
+
+    if (m_links[m_root].m_parent != kNullNode)
+    {
+        return false;
+    }
+
+    unsigned int nodeCount = 0;
+    unsigned int leafCount = 0;
+
+    std::vector<uint32_t> stack;
+    stack.push_back(m_root);
+
+    while (!stack.empty())
+    {
+        uint32_t index = stack.back();
+        stack.pop_back();
+        ++nodeCount;
+
+        const Node& kNode = m_nodes[index];
+        const NodeLinks& kLinks = m_links[index];
+
+        if (IsLeaf(index))
+        {
+            if (kNode.m_child2 != kNullNode || kLinks.m_height != 0)
+            {
+                return false;
+            }
+
+            ++leafCount;
+            continue;
+        }
+
+        uint32_t child1 = kNode.m_child1;
+        uint32_t child2 = kNode.m_child2;
+        if (child2 == kNullNode || m_links[child1].m_parent != index || m_links[child2].m_parent != index)
+        {
+            return false;
+        }
+
+        if (kLinks.m_height != 1 + std::max(m_links[child1].m_height, m_links[child2].m_height))
+        {
+            return false;
+        }
+
+        const Node& kChild1 = m_nodes[child1];
+        const Node& kChild2 = m_nodes[child2];
+        if (kNode.m_min.x != std::min(kChild1.m_min.x, kChild2.m_min.x) || kNode.m_max.x != std::max(kChild1.m_max.x, kChild2.m_max.x) ||
+            kNode.m_min.y != std::min(kChild1.m_min.y, kChild2.m_min.y) || kNode.m_max.y != std::max(kChild1.m_max.y, kChild2.m_max.y) ||
+            kNode.m_min.z != std::min(kChild1.m_min.z, kChild2.m_min.z) || kNode.m_max.z != std::max(kChild1.m_max.z, kChild2.m_max.z))
+        {
+            return false;
+        }
+
+        stack.push_back(child1);
+        stack.push_back(child2);
+    }
+
+    return leafCount == m_proxyCount && nodeCount + freeCount == m_nodes.size();
+}
+
+// Both arrays grow together. The references of either go stale when a node is allocated.
+uint32_t AabbTree::AllocateNode()
+{
+    uint32_t index = m_freeList;
+    if (index != kNullNode)
+    {
+        m_freeList = m_links[index].m_parent;
+    }
+    else
+    {
+        index = static_cast<uint32_t>(m_nodes.size());
+        m_nodes.emplace_back();
+        m_links.emplace_back();
+    }
+
+    m_nodes[index].m_child1 = kNullNode;
+    m_nodes[index].m_child2 = kNullNode;
+    m_links[index].m_parent = kNullNode;
+    m_links[index].m_height = 0;
+    m_links[index].m_userData = 0;
+
+    return index;
+}
+
+void AabbTree::FreeNode(uint32_t index)
+{
+    m_links[index].m_parent = m_freeList;
+    m_links[index].m_height = -1;
+    m_freeList = index;
+}
+
+//-----------------------------------------------------------------
+// Walks down to the node that is cheapest to pair the leaf with.
+// Pairing with a node costs the area of the new parent, and every
+// node above it grows by however much the leaf makes it grow. The
+// walk stops when going further down can't be cheaper than pairing
+// here.
+//-----------------------------------------------------------------
+void AabbTree::InsertLeaf(uint32_t leaf)
+{
+    if (m_root == kNullNode)
+    {
+        m_root = leaf;
+        m_links[leaf].m_parent = kNullNode;
+        return;
+    }
+
+    XMFLOAT3 leafMin = m_nodes[leaf].m_min;
+    XMFLOAT3 leafMax = m_nodes[leaf].m_max;
+
+    auto combinedArea = [&leafMin, &leafMax](const Node& kNode)
+    {
+        XMFLOAT3 combinedMin(std::min(leafMin.x, kNode.m_min.x), std::min(leafMin.y, kNode.m_min.y), std::min(leafMin.z, kNode.m_min.z));
+        XMFLOAT3 combinedMax(std::max(leafMax.x, kNode.m_max.x), std::max(leafMax.y, kNode.m_max.y), std::max(leafMax.z, kNode.m_max.z));
+        return SurfaceArea(combinedMin, combinedMax);
+    };
+
+    uint32_t index = m_root;
+    while (!IsLeaf(index))
+    {
+        const Node& kNode = m_nodes[index];
+
+        float area = SurfaceArea(kNode.m_min, kNode.m_max);
+        float pairArea = combinedArea(kNode);
+
+        // Pairing here makes a new parent around this node and the leaf.
+        float cost = 2.0f * pairArea;
+        // Going further down still grows this node.
+        float inheritedCost = 2.0f * (pairArea - area);
+
+        auto descendCost = [&](uint32_t child)
+        {
+            const Node& kChild = m_nodes[child];
+            if (IsLeaf(child))
+            {
+                return combinedArea(kChild) + inheritedCost;
+            }
+            return combinedArea(kChild) - SurfaceArea(kChild.m_min, kChild.m_max) + inheritedCost;
+        };
+
+        float cost1 = descendCost(kNode.m_child1);
+        float cost2 = descendCost(kNode.m_child2);
+
+        if (cost < cost1 && cost < cost2)
+        {
+            break;
+        }
+
+        index = (cost1 < cost2) ? kNode.m_child1 : kNode.m_child2;
+    }
+
+    uint32_t sibling = index;
+
+    // A new parent for the leaf and its sibling, in the sibling's place.
+    uint32_t oldParent = m_links[sibling].m_parent;
+    uint32_t newParent = AllocateNode();
+    m_links[newParent].m_parent = oldParent;
+    m_links[newParent].m_height = m_links[sibling].m_height + 1;
+    m_nodes[newParent].m_child1 = sibling;
+    m_nodes[newParent].m_child2 = leaf;
+    SetUnion(newParent, sibling, leaf);
+
+    if (oldParent != kNullNode)
+    {
+        if (m_nodes[oldParent].m_child1 == sibling)
+        {
+            m_nodes[oldParent].m_child1 = newParent;
+        }
+        else
+        {
+            m_nodes[oldParent].m_child2 = newParent;
+        }
+    }
+    else
+    {
+        m_root = newParent;
+    }
+
+    m_links[sibling].m_parent = newParent;
+    m_links[leaf].m_parent = newParent;
+
+    Refit(oldParent);
+}
+
+// The leaf's parent goes away and the sibling takes its place.
+void AabbTree::RemoveLeaf(uint32_t leaf)
+{
+    if (leaf == m_root)
+    {
+        m_root = kNullNode;
+        return;
+    }
+
+    uint32_t parent = m_links[leaf].m_parent;
+    uint32_t grandParent = m_links[parent].m_parent;
+    uint32_t sibling = (m_nodes[parent].m_child1 == leaf) ? m_nodes[parent].m_child2 : m_nodes[parent].m_child1;
+
+    m_links[sibling].m_parent = grandParent;
+    FreeNode(parent);
+
+    if (grandParent != kNullNode)
+    {
+        if (m_nodes[grandParent].m_child1 == parent)
+        {
+            m_nodes[grandParent].m_child1 = sibling;
+        }
+        else
+        {
+            m_nodes[grandParent].m_child2 = sibling;
+        }
+
+        Refit(grandParent);
+    }
+    else
+    {
+        m_root = sibling;
+    }
+}
+
+void AabbTree::Refit(uint32_t index)
+{
+    while (index != kNullNode)
+    {
+        index = Balance(index);
+
+        uint32_t child1 = m_nodes[index].m_child1;
+        uint32_t child2 = m_nodes[index].m_child2;
+
+        m_links[index].m_height = 1 + std::max(m_links[child1].m_height, m_links[child2].m_height);
+        SetUnion(index, child1, child2);
+
+        index = m_links[index].m_parent;
+    }
+}
+
+// Returns the node that is now where the node was.
+uint32_t AabbTree::Balance(uint32_t index)
+{
+    if (IsLeaf(index) || m_links[index].m_height < 2)
+    {
+        return index;
+    }
+
+    uint32_t child1 = m_nodes[index].m_child1;
+    uint32_t child2 = m_nodes[index].m_child2;
+    int32_t balance = m_links[child2].m_height - m_links[child1].m_height;
+
+    if (balance > 1)
+    {
+        return Rotate(index, child2, child1);
+    }
+
+    if (balance < -1)
+    {
+        return Rotate(index, child1, child2);
+    }
+
+    return index;
+}
+
+//-----------------------------------------------------------------
+// Lifts the taller child of the node into the node's place. The node
+// becomes the lifted child's first child and keeps its other child,
+// the taller grandchild stays under the lifted child and the node
+// takes the shorter one in the lifted child's place.
+//-----------------------------------------------------------------
+uint32_t AabbTree::Rotate(uint32_t index, uint32_t up, uint32_t other)
+{
+    uint32_t taller = m_nodes[up].m_child1;
+    uint32_t shorter = m_nodes[up].m_child2;
+    if (m_links[shorter].m_height > m_links[taller].m_height)
+    {
+        std::swap(taller, shorter);
+    }
+
+    uint32_t parent = m_links[index].m_parent;
+
+    m_nodes[up].m_child1 = index;
+    m_nodes[up].m_child2 = taller;
+    m_links[up].m_parent = parent;
+    m_links[index].m_parent = up;
+
+    if (parent != kNullNode)
+    {
+        if (m_nodes[parent].m_child1 == index)
+        {
+            m_nodes[parent].m_child1 = up;
+        }
+        else
+        {
+            m_nodes[parent].m_child2 = up;
+        }
+    }
+    else
+    {
+        m_root = up;
+    }
+
+    if (m_nodes[index].m_child1 == up)
+    {
+        m_nodes[index].m_child1 = shorter;
+    }
+    else
+    {
+        m_nodes[index].m_child2 = shorter;
+    }
+    m_links[shorter].m_parent = index;
+
+    SetUnion(index, other, shorter);
+    m_links[index].m_height = 1 + std::max(m_links[other].m_height, m_links[shorter].m_height);
+
+    SetUnion(up, index, taller);
+    m_links[up].m_height = 1 + std::max(m_links[index].m_height, m_links[taller].m_height);
+
+    return up;
+}
+
+void AabbTree::SetUnion(uint32_t index, uint32_t first, uint32_t second)
+{
+    const Node& kFirst = m_nodes[first];
+    const Node& kSecond = m_nodes[second];
+    Node& node = m_nodes[index];
+
+    node.m_min = XMFLOAT3(std::min(kFirst.m_min.x, kSecond.m_min.x), std::min(kFirst.m_min.y, kSecond.m_min.y), std::min(kFirst.m_min.z, kSecond.m_min.z));
+    node.m_max = XMFLOAT3(std::max(kFirst.m_max.x, kSecond.m_max.x), std::max(kFirst.m_max.y, kSecond.m_max.y), std::max(kFirst.m_max.z, kSecond.m_max.z));
+}
+
+bool AabbTree::IsLeaf(uint32_t index) const
+{
+    return m_nodes[index].m_child1 == kNullNode;
+}
+
+float AabbTree::SurfaceArea(const XMFLOAT3& kMin, const XMFLOAT3& kMax)
+{
+    float width = kMax.x - kMin.x;
+    float height = kMax.y - kMin.y;
+    float depth = kMax.z - kMin.z;
+    return 2.0f * (width * height + height * depth + depth * width);
+}
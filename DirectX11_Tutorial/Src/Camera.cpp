@@ -1,4 +1,5 @@
 #include "Graphics/Camera.h"
+#include "System/Profiler.h"
 using namespace DirectX;
 
 Camera::Camera()
@@ -46,6 +47,8 @@ XMFLOAT3 Camera::GetRotation()
 // Uses the position and rotation of the camera to build and update the view matrix.
 void Camera::Render()
 {
+	PROFILE_SCOPE("Camera::Render");
+
 	// Setup the vector that points upwards
 	XMFLOAT3 up;
 	up.x = 0.0f;
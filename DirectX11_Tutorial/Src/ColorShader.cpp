@@ -1,14 +1,37 @@
 #include <string_view>
 #include <fstream>
 #include <filesystem>
+#include <cstring>
 #include "Graphics/ColorShader.h"
+#include "Graphics/RenderStats.h"
+#include "System/Profiler.h"
 using namespace DirectX;
 
+namespace
+{
+    // Software backends have no blobs, these are null then.
+    void ReleaseShaderBuffers(ID3D10Blob*& pVertexShaderBuffer, ID3D10Blob*& pPixelShaderBuffer)
+    {
+        if (pVertexShaderBuffer)
+        {
+            pVertexShaderBuffer->Release();
+            pVertexShaderBuffer = nullptr;
+        }
+
+        if (pPixelShaderBuffer)
+        {
+            pPixelShaderBuffer->Release();
+            pPixelShaderBuffer = nullptr;
+        }
+    }
+}
+
 ColorShader::ColorShader()
     : m_pVertexShader(0)
     , m_pPixelShader(0)
     , m_pLayout(0)
-    , m_pMatrixBuffer(0)
+    , m_pInstancedVertexShader(0)
+    , m_pInstancedLayout(0)
 {
 }
 
@@ -17,16 +40,23 @@ ColorShader::ColorShader(const ColorShader& kOther)
     m_pVertexShader = kOther.m_pVertexShader;
     m_pPixelShader = kOther.m_pPixelShader;
     m_pLayout = kOther.m_pLayout;
-    m_pMatrixBuffer = kOther.m_pMatrixBuffer;
+    m_pInstancedVertexShader = kOther.m_pInstancedVertexShader;
+    m_pInstancedLayout = kOther.m_pInstancedLayout;
 }
 
 ColorShader::~ColorShader()
 {
 }
 
-bool ColorShader::Initialize(ID3D11Device* pDevice, HWND hwnd)
+bool ColorShader::Initialize(RenderDevice* pDevice, HWND hwnd)
 {
-    return InitializeShader(pDevice, hwnd, L"Src/Shaders/ColorVS.hlsl", L"Src/Shaders/ColorPS.hlsl");
+    if (!InitializeShader(pDevice, hwnd, L"Src/Shaders/ColorVS.hlsl", L"Src/Shaders/ColorPS.hlsl"))
+    {
+        return false;
+    }
+
+    // The instanced variant shares the pixel shader, only the vertex shader and the layout differ.
+    return InitializeInstancedShader(pDevice, hwnd, L"Src/Shaders/ColorInstancedVS.hlsl");
 }
 
 void ColorShader::Shutdown()
@@ -35,16 +65,34 @@ void ColorShader::Shutdown()
     ShutdownShader();
 }
 
-bool ColorShader::Render(ID3D11DeviceContext* pDeviceContext, int indexCount, XMMATRIX worldMatrix, XMMATRIX viewMatrix, XMMATRIX projectionMatrix)
+bool ColorShader::Render(RenderContext* pDeviceContext, const GeometryRange& kGeometry, const ConstantAllocation& kParameters)
 {
+    PROFILE_SCOPE("ColorShader::Render");
+
     // Set the shader parameters that it will use for rendering.
-    if (!SetShaderParameters(pDeviceContext, worldMatrix, viewMatrix, projectionMatrix))
-    {
-        return false;
-    }
+    SetShaderParameters(pDeviceContext, kParameters);
 
     // Now render the prepared buffers with the shader.
-    RenderShader(pDeviceContext, indexCount);
+    RenderShader(pDeviceContext, kGeometry);
+
+    return true;
+}
+
+bool ColorShader::RenderInstanced(RenderContext* pDeviceContext, const GeometryRange& kGeometry, unsigned int instanceCount)
+{
+    PROFILE_SCOPE("ColorShader::RenderInstanced");
+
+    // The world matrices come with the instances, there are no object constants to set.
+    pDeviceContext->IASetInputLayout(m_pInstancedLayout);
+
+    pDeviceContext->VSSetShader(m_pInstancedVertexShader, nullptr, 0);
+    pDeviceContext->PSSetShader(m_pPixelShader, nullptr, 0);
+
+    // One draw call for every copy of the model.
+    pDeviceContext->DrawIndexedInstanced(kGeometry.m_indexCount, instanceCount, kGeometry.m_startIndex, kGeometry.m_baseVertex, 0);
+
+    RenderStats::AddStateBinds(3);
+    RenderStats::AddDrawIndexedInstanced(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST, kGeometry.m_indexCount, instanceCount);
 
     return true;
 }
@@ -52,7 +100,7 @@ bool ColorShader::Render(ID3D11DeviceContext* pDeviceContext, int indexCount, XM
 // Loads the shader files and makes it usable to DirectX and the GPU.
 // You will also see the setup of the layout and how the vertex buffer data is going to look on the graphics pipeline in the GPU. 
 // The layout will need the match the VertexType in the modelclass.h file as well as the one defined in the color.vs file.
-bool ColorShader::InitializeShader(ID3D11Device* pDevice, HWND hwnd, const WCHAR* pVertexShaderFile, const WCHAR* pPixelShaderFile)
+bool ColorShader::InitializeShader(RenderDevice* pDevice, HWND hwnd, const WCHAR* pVertexShaderFile, const WCHAR* pPixelShaderFile)
 {
     HRESULT result;
     ID3D10Blob* pErrorMsg;
@@ -60,64 +108,101 @@ bool ColorShader::InitializeShader(ID3D11Device* pDevice, HWND hwnd, const WCHAR
     ID3D10Blob* pPixelShaderBuffer;
     D3D11_INPUT_ELEMENT_DESC polygonLayout[2];
     uint32_t numElements;
-    D3D11_BUFFER_DESC matrixBufferDesc;
+    const void* pVertexBytecode;
+    SIZE_T vertexBytecodeSize;
+    const void* pPixelBytecode;
+    SIZE_T pixelBytecodeSize;
+
+    constexpr const char* kVertexShaderEntry = "ColorVertexShader";
+    constexpr const char* kPixelShaderEntry = "ColorPixelShader";
 
     // Initialize the pointers this function will use to null.
     pErrorMsg = nullptr;
     pVertexShaderBuffer = nullptr;
     pPixelShaderBuffer = nullptr;
 
-    // Here is where we compile the shader program into buffers.
-    // We give the name of the shader file, the name of the shader, the shader version(5.0 in DirectX 11), and the buffer to compile the shader info.
-    // If it fails compiling the shader it will put an error message inside the pErrorMsg, which we send to another function to write out the error.
-    // If it still fails and there is no error message string, then it means it could not find the shader file in which case we pop up a dialog box saying so.
-
-    // Compile the vertex shader code.
-    result = D3DCompileFromFile(pVertexShaderFile, nullptr, nullptr, "ColorVertexShader", "vs_5_0", D3D10_SHADER_ENABLE_STRICTNESS, 0, &pVertexShaderBuffer, &pErrorMsg);
-    if (FAILED(result))
+    // Software backends run a C++ version of the shader that is looked up by the entry point name
+    // instead of compiled bytecode (see RenderDevice.h), so there is nothing to compile.
+    if (pDevice->GetBackend() == RenderBackend::Hardware)
     {
-        if (pErrorMsg)
+        // Here is where we compile the shader program into buffers.
+        // We give the name of the shader file, the name of the shader, the shader version(5.0 in DirectX 11), and the buffer to compile the shader info.
+        // If it fails compiling the shader it will put an error message inside the pErrorMsg, which we send to another function to write out the error.
+        // If it still fails and there is no error message string, then it means it could not find the shader file in which case we pop up a dialog box saying so.
+
+        // Compile the vertex shader code.
+        result = D3DCompileFromFile(pVertexShaderFile, nullptr, D3D_COMPILE_STANDARD_FILE_INCLUDE, kVertexShaderEntry, "vs_5_0", D3D10_SHADER_ENABLE_STRICTNESS, 0, &pVertexShaderBuffer, &pErrorMsg);
+        if (FAILED(result))
         {
-            OutputShaderErrorMessage(pErrorMsg, hwnd, pVertexShaderFile);
+            if (pErrorMsg)
+            {
+                OutputShaderErrorMessage(pErrorMsg, hwnd, pVertexShaderFile);
+            }
+            else
+            {
+                MessageBox(hwnd, pVertexShaderFile, L"Missing Shader File", MB_OK);
+            }
+
+            return false;
         }
-        else
+
+        // Compile the pixel shader code.
+        result = D3DCompileFromFile(pPixelShaderFile, nullptr, D3D_COMPILE_STANDARD_FILE_INCLUDE, kPixelShaderEntry, "ps_5_0", D3D10_SHADER_ENABLE_STRICTNESS, 0, &pPixelShaderBuffer, &pErrorMsg);
+        if (FAILED(result))
         {
-            MessageBox(hwnd, pVertexShaderFile, L"Missing Shader File", MB_OK);
+            if (pErrorMsg)
+            {
+                OutputShaderErrorMessage(pErrorMsg, hwnd, pPixelShaderFile);
+            }
+            else
+            {
+                MessageBox(hwnd, pPixelShaderFile, L"Missing Shader File", MB_OK);
+            }
+
+            ReleaseShaderBuffers(pVertexShaderBuffer, pPixelShaderBuffer);
+            return false;
         }
 
-        return false;
-    }
+        pVertexBytecode = pVertexShaderBuffer->GetBufferPointer();
+        vertexBytecodeSize = pVertexShaderBuffer->GetBufferSize();
 
-    // Compile the pixel shader code.
-    result = D3DCompileFromFile(pPixelShaderFile, nullptr, nullptr, "ColorPixelShader", "ps_5_0", D3D10_SHADER_ENABLE_STRICTNESS, 0, &pPixelShaderBuffer, &pErrorMsg);
-    if (FAILED(result))
-    {
-        if (pErrorMsg)
-        {
-            OutputShaderErrorMessage(pErrorMsg, hwnd, pPixelShaderFile);
-        }
-        else
+        // The constant buffers are declared in ShaderConstants.hlsli and filled from the structs in ShaderConstants.h.
+        // Make sure the compiler laid them out the way the C++ side expects, ColorVS reads both.
+        const ConstantBufferLayout* kLayouts[] = { &VIEW_CONSTANTS_LAYOUT, &OBJECT_CONSTANTS_LAYOUT };
+        if (!CheckConstantBufferLayouts(pVertexBytecode, vertexBytecodeSize, kLayouts, sizeof(kLayouts) / sizeof(kLayouts[0])))
         {
-            MessageBox(hwnd, pPixelShaderFile, L"Missing Shader File", MB_OK);
+            ReleaseShaderBuffers(pVertexShaderBuffer, pPixelShaderBuffer);
+            MessageBox(hwnd, L"Constant buffer layout doesn't match ShaderConstants.h. Check the debug output.", pVertexShaderFile, MB_OK);
+            return false;
         }
 
-        return false;
+        pPixelBytecode = pPixelShaderBuffer->GetBufferPointer();
+        pixelBytecodeSize = pPixelShaderBuffer->GetBufferSize();
+    }
+    else
+    {
+        pVertexBytecode = kVertexShaderEntry;
+        vertexBytecodeSize = strlen(kVertexShaderEntry);
+        pPixelBytecode = kPixelShaderEntry;
+        pixelBytecodeSize = strlen(kPixelShaderEntry);
     }
 
     // User compiled buffers to create the shader objects themselves.
     // Then use these pointers to interface with the vertex and pixel shader from this point forward.
 
     // Create the vertex shader from the buffer
-    result = pDevice->CreateVertexShader(pVertexShaderBuffer->GetBufferPointer(), pVertexShaderBuffer->GetBufferSize(), nullptr, &m_pVertexShader);
+    result = pDevice->CreateVertexShader(pVertexBytecode, vertexBytecodeSize, nullptr, &m_pVertexShader);
     if (FAILED(result))
     {
+        ReleaseShaderBuffers(pVertexShaderBuffer, pPixelShaderBuffer);
         return false;
     }
 
     // Create the pixel shader from the buffer
-    result = pDevice->CreatePixelShader(pPixelShaderBuffer->GetBufferPointer(), pPixelShaderBuffer->GetBufferSize(), nullptr, &m_pPixelShader);
+    result = pDevice->CreatePixelShader(pPixelBytecode, pixelBytecodeSize, nullptr, &m_pPixelShader);
     if (FAILED(result))
     {
+        ReleaseShaderBuffers(pVertexShaderBuffer, pPixelShaderBuffer);
         return false;
     }
  
@@ -153,46 +238,154 @@ bool ColorShader::InitializeShader(ID3D11Device* pDevice, HWND hwnd, const WCHAR
     numElements = sizeof(polygonLayout) / sizeof(polygonLayout[0]);
 
     // Create the vertex input layout.
-    result = pDevice->CreateInputLayout(polygonLayout, numElements, pVertexShaderBuffer->GetBufferPointer(), pVertexShaderBuffer->GetBufferSize(), &m_pLayout);
+    result = pDevice->CreateInputLayout(polygonLayout, numElements, pVertexBytecode, vertexBytecodeSize, &m_pLayout);
     if (FAILED(result))
     {
+        ReleaseShaderBuffers(pVertexShaderBuffer, pPixelShaderBuffer);
         return false;
     }
 
     // Release the vertex shader buffer and pixel shader buffer since they are no longer needed.
-    pVertexShaderBuffer->Release();
+    ReleaseShaderBuffers(pVertexShaderBuffer, pPixelShaderBuffer);
+
+    // There is no constant buffer of our own, the matrices of every draw go into Direct3D's constant upload ring.
+
+    return true;
+}
+
+//-----------------------------------------------------------------
+// The instanced layout reads the model's vertices from slot 0 and
+// one ModelInstance per instance from slot 1. The four rows of the
+// world matrix are four WORLD elements, an input element can't be
+// bigger than a float4.
+//-----------------------------------------------------------------
+bool ColorShader::InitializeInstancedShader(RenderDevice* pDevice, HWND hwnd, const WCHAR* pVertexShaderFile)
+{
+    HRESULT result;
+    ID3D10Blob* pErrorMsg;
+    ID3D10Blob* pVertexShaderBuffer;
+    D3D11_INPUT_ELEMENT_DESC instancedLayout[7];
+    uint32_t numElements;
+    const void* pVertexBytecode;
+    SIZE_T vertexBytecodeSize;
+
+    constexpr const char* kVertexShaderEntry = "ColorInstancedVertexShader";
+
+    pErrorMsg = nullptr;
     pVertexShaderBuffer = nullptr;
 
-    pPixelShaderBuffer->Release();
-    pPixelShaderBuffer = nullptr;
+    if (pDevice->GetBackend() == RenderBackend::Hardware)
+    {
+        result = D3DCompileFromFile(pVertexShaderFile, nullptr, D3D_COMPILE_STANDARD_FILE_INCLUDE, kVertexShaderEntry, "vs_5_0", D3D10_SHADER_ENABLE_STRICTNESS, 0, &pVertexShaderBuffer, &pErrorMsg);
+        if (FAILED(result))
+        {
+            if (pErrorMsg)
+            {
+                OutputShaderErrorMessage(pErrorMsg, hwnd, pVertexShaderFile);
+            }
+            else
+            {
+                MessageBox(hwnd, pVertexShaderFile, L"Missing Shader File", MB_OK);
+            }
+
+            return false;
+        }
 
-    // Setup the description of the dynamic matrix constant buffer that is in the vertex shader.
-    matrixBufferDesc.Usage = D3D11_USAGE_DYNAMIC;                   // Set to dynamic sine we will be updating it each frame.
-    matrixBufferDesc.ByteWidth = sizeof(MatrixBuffer);
-    matrixBufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;        // Indicates this buffer will be a constant buffer.
-    matrixBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;       // Need to match up with the usage.
-    matrixBufferDesc.MiscFlags = 0;
-    matrixBufferDesc.StructureByteStride = 0;
+        pVertexBytecode = pVertexShaderBuffer->GetBufferPointer();
+        vertexBytecodeSize = pVertexShaderBuffer->GetBufferSize();
 
-    // Create the constant buffer pointer so we can access the vertex shader constant buffer from within this class.
-    result = pDevice->CreateBuffer(&matrixBufferDesc, nullptr, &m_pMatrixBuffer);
+        // The world matrix comes with the instance, only the view constants are read.
+        const ConstantBufferLayout* kLayouts[] = { &VIEW_CONSTANTS_LAYOUT };
+        if (!CheckConstantBufferLayouts(pVertexBytecode, vertexBytecodeSize, kLayouts, sizeof(kLayouts) / sizeof(kLayouts[0])))
+        {
+            pVertexShaderBuffer->Release();
+            MessageBox(hwnd, L"Constant buffer layout doesn't match ShaderConstants.h. Check the debug output.", pVertexShaderFile, MB_OK);
+            return false;
+        }
+    }
+    else
+    {
+        pVertexBytecode = kVertexShaderEntry;
+        vertexBytecodeSize = strlen(kVertexShaderEntry);
+    }
+
+    result = pDevice->CreateVertexShader(pVertexBytecode, vertexBytecodeSize, nullptr, &m_pInstancedVertexShader);
     if (FAILED(result))
     {
+        if (pVertexShaderBuffer)
+        {
+            pVertexShaderBuffer->Release();
+        }
+
         return false;
     }
 
-    return true;
+    // Per vertex, the same as the plain layout.
+    instancedLayout[0].SemanticName = "POSITION";
+    instancedLayout[0].SemanticIndex = 0;
+    instancedLayout[0].Format = DXGI_FORMAT_R32G32B32_FLOAT;
+    instancedLayout[0].InputSlot = 0;
+    instancedLayout[0].AlignedByteOffset = 0;
+    instancedLayout[0].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+    instancedLayout[0].InstanceDataStepRate = 0;
+
+    instancedLayout[1].SemanticName = "COLOR";
+    instancedLayout[1].SemanticIndex = 0;
+    instancedLayout[1].Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
+    instancedLayout[1].InputSlot = 0;
+    instancedLayout[1].AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
+    instancedLayout[1].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+    instancedLayout[1].InstanceDataStepRate = 0;
+
+    // Per instance, this needs to match ModelInstance in Model.h.
+    for (UINT row = 0; row < 4; ++row)
+    {
+        D3D11_INPUT_ELEMENT_DESC& element = instancedLayout[2 + row];
+        element.SemanticName = "WORLD";
+        element.SemanticIndex = row;
+        element.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
+        element.InputSlot = 1;
+        element.AlignedByteOffset = row == 0 ? 0 : D3D11_APPEND_ALIGNED_ELEMENT;
+        element.InputSlotClass = D3D11_INPUT_PER_INSTANCE_DATA;
+        element.InstanceDataStepRate = 1;
+    }
+
+    instancedLayout[6].SemanticName = "TINT";
+    instancedLayout[6].SemanticIndex = 0;
+    instancedLayout[6].Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
+    instancedLayout[6].InputSlot = 1;
+    instancedLayout[6].AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
+    instancedLayout[6].InputSlotClass = D3D11_INPUT_PER_INSTANCE_DATA;
+    instancedLayout[6].InstanceDataStepRate = 1;
+
+    numElements = sizeof(instancedLayout) / sizeof(instancedLayout[0]);
+
+    result = pDevice->CreateInputLayout(instancedLayout, numElements, pVertexBytecode, vertexBytecodeSize, &m_pInstancedLayout);
+
+    if (pVertexShaderBuffer)
+    {
+        pVertexShaderBuffer->Release();
+        pVertexShaderBuffer = nullptr;
+    }
+
+    return SUCCEEDED(result);
 }
 
 void ColorShader::ShutdownShader()
 {
-    // Release all four interfaces that were setup in the InitializeShader function.
-    if (m_pMatrixBuffer)
+    if (m_pInstancedLayout)
+    {
+        m_pInstancedLayout->Release();
+        m_pInstancedLayout = nullptr;
+    }
+
+    if (m_pInstancedVertexShader)
     {
-        m_pMatrixBuffer->Release();
-        m_pMatrixBuffer = nullptr;
+        m_pInstancedVertexShader->Release();
+        m_pInstancedVertexShader = nullptr;
     }
 
+    // Release all three interfaces that were setup in the InitializeShader function.
     if (m_pLayout)
     {
         m_pLayout->Release();
@@ -243,48 +436,56 @@ void ColorShader::OutputShaderErrorMessage(ID3D10Blob* pErrorMsg, HWND hwnd, con
     MessageBox(hwnd, L"Error compiling shader. Check shader-error.txt for message.", pShaderFileName, MB_OK);
 }
 
-// First function caleed in the Render function
-// It is called before RenderShader function to ensure the shader parameters are setup corretly.
-bool ColorShader::SetShaderParameters(ID3D11DeviceContext* pDeviceContext, XMMATRIX worldMatrix, XMMATRIX viewMatrix, XMMATRIX projectionMatrix)
+// Copies the object constants of one draw into the mapped upload ring.
+// The ring is mapped once for all draws of the frame, so this is a plain memory write.
+// The view and projection matrices are per view, they aren't repeated for every draw.
+bool ColorShader::WriteParameters(ConstantUploadRing& uploadRing, XMMATRIX worldMatrix, ConstantAllocation& allocation)
 {
-    // Trnaspose the matrices to prepare them for the shader.
-    worldMatrix = XMMatrixTranspose(worldMatrix);
-    viewMatrix = XMMatrixTranspose(viewMatrix);
-    projectionMatrix = XMMatrixTranspose(projectionMatrix);
-
-    // Lock the constant buffer so it can be written to.
-    D3D11_MAPPED_SUBRESOURCE mappedResource;
-    HRESULT result(pDeviceContext->Map(m_pMatrixBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource));
-    if (FAILED(result))
+    // Get a window of the ring that is big enough for the object constants.
+    if (!uploadRing.Allocate(sizeof(ObjectConstants), allocation))
     {
         return false;
     }
 
     // Get a pointer to the data in the constant buffer.
-    MatrixBuffer* pData(static_cast<MatrixBuffer*>(mappedResource.pData));
+    ObjectConstants* pData(static_cast<ObjectConstants*>(allocation.m_pData));
 
-    // Copy the matrices into the constant buffer.
-    pData->m_world = worldMatrix;
-    pData->m_view = viewMatrix;
-    pData->m_projection = projectionMatrix;
+    // Trnaspose the matrix to prepare it for the shader and copy it into the constant buffer.
+    XMStoreFloat4x4(&pData->m_world, XMMatrixTranspose(worldMatrix));
 
-    // Unlock the constant buffer.
-    pDeviceContext->Unmap(m_pMatrixBuffer, 0);
+    RenderStats::AddConstantBufferUpload(sizeof(ObjectConstants));
+
+    return true;
+}
 
-    /// Now, Set the updated matrix buffer in the HLSL vertex shader.
+// First function caleed in the Render function
+// It is called before RenderShader function to ensure the shader parameters are setup corretly.
+void ColorShader::SetShaderParameters(RenderContext* pDeviceContext, const ConstantAllocation& kParameters)
+{
+    PROFILE_SCOPE("ColorShader::SetShaderParameters");
 
     // Set the position of the constant buffer in the vertex shader.
-    uint32_t bufferNumber(0);
+    uint32_t bufferNumber(OBJECT_CONSTANTS_SLOT);
 
-    // Finally set the constnat buffer in the vertex shader with the updated values.
-    pDeviceContext->VSSetConstantBuffers(bufferNumber, 1, &m_pMatrixBuffer);
-    
-    return true;
+    // Set the window of the upload ring that holds this draw's matrices in the vertex shader,
+    // or the whole buffer when the draw got one of its own.
+    if (kParameters.m_constantCount > 0)
+    {
+        pDeviceContext->VSSetConstantBuffers1(bufferNumber, 1, &kParameters.m_pBuffer, &kParameters.m_firstConstant, &kParameters.m_constantCount);
+    }
+    else
+    {
+        pDeviceContext->VSSetConstantBuffers(bufferNumber, 1, &kParameters.m_pBuffer);
+    }
+
+    RenderStats::AddStateBinds(1);
 }
 
 // Second function called in the Render function.
-void ColorShader::RenderShader(ID3D11DeviceContext* pDeviceContext, int indexCount)
+void ColorShader::RenderShader(RenderContext* pDeviceContext, const GeometryRange& kGeometry)
 {
+    PROFILE_SCOPE("ColorShader::RenderShader");
+
     // Set the vertex input layout in the input assembler.
     // This lets teh GPU know the format of the data in the vertex buffer.
     pDeviceContext->IASetInputLayout(m_pLayout);
@@ -293,6 +494,10 @@ void ColorShader::RenderShader(ID3D11DeviceContext* pDeviceContext, int indexCou
     pDeviceContext->VSSetShader(m_pVertexShader, nullptr, 0);
     pDeviceContext->PSSetShader(m_pPixelShader, nullptr, 0);
 
-    // Render the triangle.
-    pDeviceContext->DrawIndexed(indexCount, 0, 0);
+    // Render the triangle from its range of the geometry pool.
+    pDeviceContext->DrawIndexed(kGeometry.m_indexCount, kGeometry.m_startIndex, kGeometry.m_baseVertex);
+
+    // Input layout and the two shaders. The geometry pool has bound a triangle list.
+    RenderStats::AddStateBinds(3);
+    RenderStats::AddDrawIndexed(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST, kGeometry.m_indexCount);
 }
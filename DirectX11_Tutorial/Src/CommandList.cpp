@@ -0,0 +1,585 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: CommandList.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include <cstring>
+
+#include "Graphics/CommandList.h"
+
+enum class CommandList::Command : uint32_t
+{
+    ClearRenderTargetView,
+    ClearDepthStencilView,
+    OMSetRenderTargets,
+    OMSetDepthStencilState,
+    RSSetState,
+    RSSetViewports,
+    IASetInputLayout,
+    IASetVertexBuffers,
+    IASetIndexBuffer,
+    IASetPrimitiveTopology,
+    VSSetShader,
+    PSSetShader,
+    VSSetConstantBuffers,
+    VSSetConstantBuffers1,
+    UpdateSubresource,
+    DrawIndexed,
+    DrawIndexedInstanced,
+    End,
+    ExecuteCommandList,
+};
+
+namespace
+{
+    // Every command starts on this, so the arrays after a command's fixed part can hold pointers.
+    constexpr size_t kCommandAlignment = 8;
+
+    constexpr size_t AlignCommandSize(size_t size)
+    {
+        return (size + kCommandAlignment - 1) & ~(kCommandAlignment - 1);
+    }
+
+    // m_size covers the header, the fixed part and the arrays after it.
+    struct CommandHeader
+    {
+        uint32_t m_command;
+        uint32_t m_size;
+    };
+
+    static_assert(sizeof(CommandHeader) % kCommandAlignment == 0, "The fixed part of a command has to stay aligned");
+
+    // Where the arrays of a command start.
+    template<typename T>
+    uint8_t* Trailing(T* pCommand)
+    {
+        return reinterpret_cast<uint8_t*>(pCommand) + AlignCommandSize(sizeof(T));
+    }
+
+    template<typename T>
+    const uint8_t* Trailing(const T* pCommand)
+    {
+        return reinterpret_cast<const uint8_t*>(pCommand) + AlignCommandSize(sizeof(T));
+    }
+
+    struct ClearRenderTargetViewCommand
+    {
+        ID3D11RenderTargetView* m_pView;
+        FLOAT m_color[4];
+    };
+
+    struct ClearDepthStencilViewCommand
+    {
+        ID3D11DepthStencilView* m_pView;
+        UINT m_clearFlags;
+        FLOAT m_depth;
+        UINT8 m_stencil;
+    };
+
+    // Followed by m_viewCount render target views.
+    struct OMSetRenderTargetsCommand
+    {
+        ID3D11DepthStencilView* m_pDepthStencilView;
+        UINT m_viewCount;
+    };
+
+    struct OMSetDepthStencilStateCommand
+    {
+        ID3D11DepthStencilState* m_pState;
+        UINT m_stencilRef;
+    };
+
+    struct RSSetStateCommand
+    {
+        ID3D11RasterizerState* m_pState;
+    };
+
+    // Followed by m_viewportCount viewports.
+    struct RSSetViewportsCommand
+    {
+        UINT m_viewportCount;
+    };
+
+    struct IASetInputLayoutCommand
+    {
+        ID3D11InputLayout* m_pLayout;
+    };
+
+    // Followed by m_bufferCount buffers, then as many strides and offsets.
+    struct IASetVertexBuffersCommand
+    {
+        UINT m_startSlot;
+        UINT m_bufferCount;
+    };
+
+    struct IASetIndexBufferCommand
+    {
+        ID3D11Buffer* m_pBuffer;
+        DXGI_FORMAT m_format;
+        UINT m_offset;
+    };
+
+    struct IASetPrimitiveTopologyCommand
+    {
+        D3D11_PRIMITIVE_TOPOLOGY m_topology;
+    };
+
+    // Followed by m_classInstanceCount class instances.
+    template<typename Shader>
+    struct SetShaderCommand
+    {
+        Shader* m_pShader;
+        UINT m_classInstanceCount;
+    };
+
+    // Followed by m_bufferCount buffers, and with m_windowed as many first constants and constant counts.
+    struct SetConstantBuffersCommand
+    {
+        UINT m_startSlot;
+        UINT m_bufferCount;
+        UINT m_windowed;
+    };
+
+    // Followed by the m_byteCount bytes of source data.
+    struct UpdateSubresourceCommand
+    {
+        ID3D11Resource* m_pResource;
+        UINT m_subresource;
+        UINT m_hasBox;
+        D3D11_BOX m_box;
+        UINT m_sourceRowPitch;
+        UINT m_sourceDepthPitch;
+        UINT m_byteCount;
+    };
+
+    struct DrawIndexedCommand
+    {
+        UINT m_indexCount;
+        UINT m_startIndexLocation;
+        INT m_baseVertexLocation;
+    };
+
+    struct DrawIndexedInstancedCommand
+    {
+        UINT m_indexCountPerInstance;
+        UINT m_instanceCount;
+        UINT m_startIndexLocation;
+        INT m_baseVertexLocation;
+        UINT m_startInstanceLocation;
+    };
+
+    struct EndCommand
+    {
+        ID3D11Asynchronous* m_pAsync;
+    };
+
+    struct ExecuteCommandListCommand
+    {
+        ID3D11CommandList* m_pCommandList;
+        BOOL m_restoreContextState;
+    };
+}
+
+CommandList::CommandList()
+    : m_commandCount(0)
+{
+}
+
+template<typename T>
+T* CommandList::Append(Command command, size_t extraBytes)
+{
+    size_t size = sizeof(CommandHeader) + AlignCommandSize(sizeof(T)) + AlignCommandSize(extraBytes);
+    size_t offset = m_data.size();
+    m_data.resize(offset + size);
+
+    CommandHeader* pHeader = reinterpret_cast<CommandHeader*>(m_data.data() + offset);
+    pHeader->m_command = static_cast<uint32_t>(command);
+    pHeader->m_size = static_cast<uint32_t>(size);
+
+    ++m_commandCount;
+
+    return reinterpret_cast<T*>(pHeader + 1);
+}
+
+void CommandList::ClearRenderTargetView(ID3D11RenderTargetView* pView, const FLOAT color[4])
+{
+    ClearRenderTargetViewCommand* pCommand = Append<ClearRenderTargetViewCommand>(Command::ClearRenderTargetView, 0);
+    pCommand->m_pView = pView;
+    memcpy(pCommand->m_color, color, sizeof(pCommand->m_color));
+}
+
+void CommandList::ClearDepthStencilView(ID3D11DepthStencilView* pView, UINT clearFlags, FLOAT depth, UINT8 stencil)
+{
+    ClearDepthStencilViewCommand* pCommand = Append<ClearDepthStencilViewCommand>(Command::ClearDepthStencilView, 0);
+    pCommand->m_pView = pView;
+    pCommand->m_clearFlags = clearFlags;
+    pCommand->m_depth = depth;
+    pCommand->m_stencil = stencil;
+}
+
+void CommandList::OMSetRenderTargets(UINT numViews, ID3D11RenderTargetView* const* ppViews, ID3D11DepthStencilView* pDepthStencilView)
+{
+    OMSetRenderTargetsCommand* pCommand = Append<OMSetRenderTargetsCommand>(Command::OMSetRenderTargets, sizeof(ID3D11RenderTargetView*) * numViews);
+    pCommand->m_pDepthStencilView = pDepthStencilView;
+    pCommand->m_viewCount = numViews;
+
+    ID3D11RenderTargetView** ppRecordedViews = reinterpret_cast<ID3D11RenderTargetView**>(Trailing(pCommand));
+    for (UINT i = 0; i < numViews; ++i)
+    {
+        ppRecordedViews[i] = ppViews ? ppViews[i] : nullptr;
+    }
+}
+
+void CommandList::OMSetDepthStencilState(ID3D11DepthStencilState* pState, UINT stencilRef)
+{
+    OMSetDepthStencilStateCommand* pCommand = Append<OMSetDepthStencilStateCommand>(Command::OMSetDepthStencilState, 0);
+    pCommand->m_pState = pState;
+    pCommand->m_stencilRef = stencilRef;
+}
+
+void CommandList::RSSetState(ID3D11RasterizerState* pState)
+{
+    Append<RSSetStateCommand>(Command::RSSetState, 0)->m_pState = pState;
+}
+
+void CommandList::RSSetViewports(UINT numViewports, const D3D11_VIEWPORT* pViewports)
+{
+    RSSetViewportsCommand* pCommand = Append<RSSetViewportsCommand>(Command::RSSetViewports, sizeof(D3D11_VIEWPORT) * numViewports);
+    pCommand->m_viewportCount = numViewports;
+    memcpy(Trailing(pCommand), pViewports, sizeof(D3D11_VIEWPORT) * numViewports);
+}
+
+void CommandList::IASetInputLayout(ID3D11InputLayout* pLayout)
+{
+    Append<IASetInputLayoutCommand>(Command::IASetInputLayout, 0)->m_pLayout = pLayout;
+}
+
+void CommandList::IASetVertexBuffers(UINT startSlot, UINT numBuffers, ID3D11Buffer* const* ppBuffers, const UINT* pStrides, const UINT* pOffsets)
+{
+    IASetVertexBuffersCommand* pCommand = Append<IASetVertexBuffersCommand>(Command::IASetVertexBuffers, (sizeof(ID3D11Buffer*) + sizeof(UINT) * 2) * numBuffers);
+    pCommand->m_startSlot = startSlot;
+    pCommand->m_bufferCount = numBuffers;
+
+    uint8_t* pArrays = Trailing(pCommand);
+    memcpy(pArrays, ppBuffers, sizeof(ID3D11Buffer*) * numBuffers);
+    memcpy(pArrays + sizeof(ID3D11Buffer*) * numBuffers, pStrides, sizeof(UINT) * numBuffers);
+    memcpy(pArrays + (sizeof(ID3D11Buffer*) + sizeof(UINT)) * numBuffers, pOffsets, sizeof(UINT) * numBuffers);
+}
+
+void CommandList::IASetIndexBuffer(ID3D11Buffer* pBuffer, DXGI_FORMAT format, UINT offset)
+{
+    IASetIndexBufferCommand* pCommand = Append<IASetIndexBufferCommand>(Command::IASetIndexBuffer, 0);
+    pCommand->m_pBuffer = pBuffer;
+    pCommand->m_format = format;
+    pCommand->m_offset = offset;
+}
+
+void CommandList::IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY topology)
+{
+    Append<IASetPrimitiveTopologyCommand>(Command::IASetPrimitiveTopology, 0)->m_topology = topology;
+}
+
+void CommandList::VSSetShader(ID3D11VertexShader* pShader, ID3D11ClassInstance* const* ppClassInstances, UINT numClassInstances)
+{
+    SetShaderCommand<ID3D11VertexShader>* pCommand = Append<SetShaderCommand<ID3D11VertexShader>>(Command::VSSetShader, sizeof(ID3D11ClassInstance*) * numClassInstances);
+    pCommand->m_pShader = pShader;
+    pCommand->m_classInstanceCount = numClassInstances;
+    if (numClassInstances > 0)
+    {
+        memcpy(Trailing(pCommand), ppClassInstances, sizeof(ID3D11ClassInstance*) * numClassInstances);
+    }
+}
+
+void CommandList::PSSetShader(ID3D11PixelShader* pShader, ID3D11ClassInstance* const* ppClassInstances, UINT numClassInstances)
+{
+    SetShaderCommand<ID3D11PixelShader>* pCommand = Append<SetShaderCommand<ID3D11PixelShader>>(Command::PSSetShader, sizeof(ID3D11ClassInstance*) * numClassInstances);
+    pCommand->m_pShader = pShader;
+    pCommand->m_classInstanceCount = numClassInstances;
+    if (numClassInstances > 0)
+    {
+        memcpy(Trailing(pCommand), ppClassInstances, sizeof(ID3D11ClassInstance*) * numClassInstances);
+    }
+}
+
+void CommandList::VSSetConstantBuffers(UINT startSlot, UINT numBuffers, ID3D11Buffer* const* ppConstantBuffers)
+{
+    VSSetConstantBuffers1(startSlot, numBuffers, ppConstantBuffers, nullptr, nullptr);
+}
+
+// Whole buffers are recorded as the plain bind so the replay makes the same call.
+void CommandList::VSSetConstantBuffers1(UINT startSlot, UINT numBuffers, ID3D11Buffer* const* ppConstantBuffers, const UINT* pFirstConstant, const UINT* pNumConstants)
+{
+    bool windowed = pFirstConstant && pNumConstants;
+    size_t extraBytes = (sizeof(ID3D11Buffer*) + (windowed ? sizeof(UINT) * 2 : 0)) * numBuffers;
+
+    SetConstantBuffersCommand* pCommand = Append<SetConstantBuffersCommand>(windowed ? Command::VSSetConstantBuffers1 : Command::VSSetConstantBuffers, extraBytes);
+    pCommand->m_startSlot = startSlot;
+    pCommand->m_bufferCount = numBuffers;
+    pCommand->m_windowed = windowed ? 1 : 0;
+
+    uint8_t* pArrays = Trailing(pCommand);
+    memcpy(pArrays, ppConstantBuffers, sizeof(ID3D11Buffer*) * numBuffers);
+    if (windowed)
+    {
+        memcpy(pArrays + sizeof(ID3D11Buffer*) * numBuffers, pFirstConstant, sizeof(UINT) * numBuffers);
+        memcpy(pArrays + (sizeof(ID3D11Buffer*) + sizeof(UINT)) * numBuffers, pNumConstants, sizeof(UINT) * numBuffers);
+    }
+}
+
+HRESULT CommandList::Map(ID3D11Resource*, UINT, D3D11_MAP, UINT, D3D11_MAPPED_SUBRESOURCE*)
+{
+    return E_NOTIMPL;
+}
+
+void CommandList::Unmap(ID3D11Resource*, UINT)
+{
+}
+
+//-----------------------------------------------------------------
+// The source bytes are copied into the list, the caller's memory can
+// be reused as soon as this returns. Only buffers, like everywhere
+// else, so the box is a byte range and no box is the whole buffer.
+//-----------------------------------------------------------------
+void CommandList::UpdateSubresource(ID3D11Resource* pResource, UINT subresource, const D3D11_BOX* pBox, const void* pSourceData, UINT sourceRowPitch, UINT sourceDepthPitch)
+{
+    if (!pResource || !pSourceData)
+    {
+        return;
+    }
+
+    D3D11_RESOURCE_DIMENSION dimension;
+    pResource->GetType(&dimension);
+    if (dimension != D3D11_RESOURCE_DIMENSION_BUFFER)
+    {
+        return;
+    }
+
+    UINT byteCount = 0;
+    if (pBox)
+    {
+        byteCount = (pBox->right > pBox->left) ? pBox->right - pBox->left : 0;
+    }
+    else
+    {
+        D3D11_BUFFER_DESC desc;
+        static_cast<ID3D11Buffer*>(pResource)->GetDesc(&desc);
+        byteCount = desc.ByteWidth;
+    }
+
+    UpdateSubresourceCommand* pCommand = Append<UpdateSubresourceCommand>(Command::UpdateSubresource, byteCount);
+    pCommand->m_pResource = pResource;
+    pCommand->m_subresource = subresource;
+    pCommand->m_hasBox = pBox ? 1 : 0;
+    pCommand->m_box = pBox ? *pBox : D3D11_BOX();
+    pCommand->m_sourceRowPitch = sourceRowPitch;
+    pCommand->m_sourceDepthPitch = sourceDepthPitch;
+    pCommand->m_byteCount = byteCount;
+    memcpy(Trailing(pCommand), pSourceData, byteCount);
+}
+
+void CommandList::DrawIndexed(UINT indexCount, UINT startIndexLocation, INT baseVertexLocation)
+{
+    DrawIndexedCommand* pCommand = Append<DrawIndexedCommand>(Command::DrawIndexed, 0);
+    pCommand->m_indexCount = indexCount;
+    pCommand->m_startIndexLocation = startIndexLocation;
+    pCommand->m_baseVertexLocation = baseVertexLocation;
+}
+
+void CommandList::DrawIndexedInstanced(UINT indexCountPerInstance, UINT instanceCount, UINT startIndexLocation, INT baseVertexLocation, UINT startInstanceLocation)
+{
+    DrawIndexedInstancedCommand* pCommand = Append<DrawIndexedInstancedCommand>(Command::DrawIndexedInstanced, 0);
+    pCommand->m_indexCountPerInstance = indexCountPerInstance;
+    pCommand->m_instanceCount = instanceCount;
+    pCommand->m_startIndexLocation = startIndexLocation;
+    pCommand->m_baseVertexLocation = baseVertexLocation;
+    pCommand->m_startInstanceLocation = startInstanceLocation;
+}
+
+void CommandList::End(ID3D11Asynchronous* pAsync)
+{
+    Append<EndCommand>(Command::End, 0)->m_pAsync = pAsync;
+}
+
+// A recorded list hasn't run yet, there is nothing to ask about.
+HRESULT CommandList::GetData(ID3D11Asynchronous*, void*, UINT, UINT)
+{
+    return E_NOTIMPL;
+}
+
+HRESULT CommandList::FinishCommandList(BOOL, ID3D11CommandList**)
+{
+    return E_NOTIMPL;
+}
+
+void CommandList::ExecuteCommandList(ID3D11CommandList* pCommandList, BOOL restoreContextState)
+{
+    ExecuteCommandListCommand* pCommand = Append<ExecuteCommandListCommand>(Command::ExecuteCommandList, 0);
+    pCommand->m_pCommandList = pCommandList;
+    pCommand->m_restoreContextState = restoreContextState;
+}
+
+void CommandList::Flush()
+{
+}
+
+void CommandList::Reset()
+{
+    m_data.clear();
+    m_commandCount = 0;
+}
+
+void CommandList::Execute(RenderContext* pContext) const
+{
+    const uint8_t* pPosition = m_data.data();
+    const uint8_t* pEnd = pPosition + m_data.size();
+
+    while (pPosition < pEnd)
+    {
+        const CommandHeader* pHeader = reinterpret_cast<const CommandHeader*>(pPosition);
+        const void* pPayload = pHeader + 1;
+        pPosition += pHeader->m_size;
+
+        switch (static_cast<Command>(pHeader->m_command))
+        {
+        case Command::ClearRenderTargetView:
+        {
+            const ClearRenderTargetViewCommand* pCommand = static_cast<const ClearRenderTargetViewCommand*>(pPayload);
+            pContext->ClearRenderTargetView(pCommand->m_pView, pCommand->m_color);
+            break;
+        }
+
+        case Command::ClearDepthStencilView:
+        {
+            const ClearDepthStencilViewCommand* pCommand = static_cast<const ClearDepthStencilViewCommand*>(pPayload);
+            pContext->ClearDepthStencilView(pCommand->m_pView, pCommand->m_clearFlags, pCommand->m_depth, pCommand->m_stencil);
+            break;
+        }
+
+        case Command::OMSetRenderTargets:
+        {
+            const OMSetRenderTargetsCommand* pCommand = static_cast<const OMSetRenderTargetsCommand*>(pPayload);
+            pContext->OMSetRenderTargets(pCommand->m_viewCount, reinterpret_cast<ID3D11RenderTargetView* const*>(Trailing(pCommand)), pCommand->m_pDepthStencilView);
+            break;
+        }
+
+        case Command::OMSetDepthStencilState:
+        {
+            const OMSetDepthStencilStateCommand* pCommand = static_cast<const OMSetDepthStencilStateCommand*>(pPayload);
+            pContext->OMSetDepthStencilState(pCommand->m_pState, pCommand->m_stencilRef);
+            break;
+        }
+
+        case Command::RSSetState:
+            pContext->RSSetState(static_cast<const RSSetStateCommand*>(pPayload)->m_pState);
+            break;
+
+        case Command::RSSetViewports:
+        {
+            const RSSetViewportsCommand* pCommand = static_cast<const RSSetViewportsCommand*>(pPayload);
+            pContext->RSSetViewports(pCommand->m_viewportCount, reinterpret_cast<const D3D11_VIEWPORT*>(Trailing(pCommand)));
+            break;
+        }
+
+        case Command::IASetInputLayout:
+            pContext->IASetInputLayout(static_cast<const IASetInputLayoutCommand*>(pPayload)->m_pLayout);
+            break;
+
+        case Command::IASetVertexBuffers:
+        {
+            const IASetVertexBuffersCommand* pCommand = static_cast<const IASetVertexBuffersCommand*>(pPayload);
+            const uint8_t* pArrays = Trailing(pCommand);
+            UINT count = pCommand->m_bufferCount;
+            pContext->IASetVertexBuffers(pCommand->m_startSlot, count,
+                reinterpret_cast<ID3D11Buffer* const*>(pArrays),
+                reinterpret_cast<const UINT*>(pArrays + sizeof(ID3D11Buffer*) * count),
+                reinterpret_cast<const UINT*>(pArrays + (sizeof(ID3D11Buffer*) + sizeof(UINT)) * count));
+            break;
+        }
+
+        case Command::IASetIndexBuffer:
+        {
+            const IASetIndexBufferCommand* pCommand = static_cast<const IASetIndexBufferCommand*>(pPayload);
+            pContext->IASetIndexBuffer(pCommand->m_pBuffer, pCommand->m_format, pCommand->m_offset);
+            break;
+        }
+
+        case Command::IASetPrimitiveTopology:
+            pContext->IASetPrimitiveTopology(static_cast<const IASetPrimitiveTopologyCommand*>(pPayload)->m_topology);
+            break;
+
+        case Command::VSSetShader:
+        {
+            const SetShaderCommand<ID3D11VertexShader>* pCommand = static_cast<const SetShaderCommand<ID3D11VertexShader>*>(pPayload);
+            pContext->VSSetShader(pCommand->m_pShader, pCommand->m_classInstanceCount ? reinterpret_cast<ID3D11ClassInstance* const*>(Trailing(pCommand)) : nullptr, pCommand->m_classInstanceCount);
+            break;
+        }
+
+        case Command::PSSetShader:
+        {
+            const SetShaderCommand<ID3D11PixelShader>* pCommand = static_cast<const SetShaderCommand<ID3D11PixelShader>*>(pPayload);
+            pContext->PSSetShader(pCommand->m_pShader, pCommand->m_classInstanceCount ? reinterpret_cast<ID3D11ClassInstance* const*>(Trailing(pCommand)) : nullptr, pCommand->m_classInstanceCount);
+            break;
+        }
+
+        case Command::VSSetConstantBuffers:
+        {
+            const SetConstantBuffersCommand* pCommand = static_cast<const SetConstantBuffersCommand*>(pPayload);
+            pContext->VSSetConstantBuffers(pCommand->m_startSlot, pCommand->m_bufferCount, reinterpret_cast<ID3D11Buffer* const*>(Trailing(pCommand)));
+            break;
+        }
+
+        case Command::VSSetConstantBuffers1:
+        {
+            const SetConstantBuffersCommand* pCommand = static_cast<const SetConstantBuffersCommand*>(pPayload);
+            const uint8_t* pArrays = Trailing(pCommand);
+            UINT count = pCommand->m_bufferCount;
+            pContext->VSSetConstantBuffers1(pCommand->m_startSlot, count,
+                reinterpret_cast<ID3D11Buffer* const*>(pArrays),
+                reinterpret_cast<const UINT*>(pArrays + sizeof(ID3D11Buffer*) * count),
+                reinterpret_cast<const UINT*>(pArrays + (sizeof(ID3D11Buffer*) + sizeof(UINT)) * count));
+            break;
+        }
+
+        case Command::UpdateSubresource:
+        {
+            const UpdateSubresourceCommand* pCommand = static_cast<const UpdateSubresourceCommand*>(pPayload);
+            pContext->UpdateSubresource(pCommand->m_pResource, pCommand->m_subresource, pCommand->m_hasBox ? &pCommand->m_box : nullptr,
+                Trailing(pCommand), pCommand->m_sourceRowPitch, pCommand->m_sourceDepthPitch);
+            break;
+        }
+
+        case Command::DrawIndexed:
+        {
+            const DrawIndexedCommand* pCommand = static_cast<const DrawIndexedCommand*>(pPayload);
+            pContext->DrawIndexed(pCommand->m_indexCount, pCommand->m_startIndexLocation, pCommand->m_baseVertexLocation);
+            break;
+        }
+
+        case Command::DrawIndexedInstanced:
+        {
+            const DrawIndexedInstancedCommand* pCommand = static_cast<const DrawIndexedInstancedCommand*>(pPayload);
+            pContext->DrawIndexedInstanced(pCommand->m_indexCountPerInstance, pCommand->m_instanceCount, pCommand->m_startIndexLocation, pCommand->m_baseVertexLocation, pCommand->m_startInstanceLocation);
+            break;
+        }
+
+        case Command::End:
+            pContext->End(static_cast<const EndCommand*>(pPayload)->m_pAsync);
+            break;
+
+        case Command::ExecuteCommandList:
+        {
+            const ExecuteCommandListCommand* pCommand = static_cast<const ExecuteCommandListCommand*>(pPayload);
+            pContext->ExecuteCommandList(pCommand->m_pCommandList, pCommand->m_restoreContextState);
+            break;
+        }
+        }
+    }
+}
+
+unsigned int CommandList::GetCommandCount() const
+{
+    return m_commandCount;
+}
+
+size_t CommandList::GetByteCount() const
+{
+    return m_data.size();
+}
@@ -0,0 +1,63 @@
+//////////////////////////////////////////////////////////////////////
+// Filename: CommandListBenchmark.cpp
+//////////////////////////////////////////////////////////////////////
+#include "Graphics/CommandListBenchmark.h"
+#include "Graphics/CommandListRecorder.h"
+
+namespace
+{
+    constexpr unsigned int kRecordedDraws = 50000;
+    constexpr unsigned int kMinDrawsPerList = 1024;
+
+    class CommandListRecordWorkload : public JobSystemWorkload
+    {
+    public:
+        const char* GetName() const override
+        {
+            return "command_list_record";
+        }
+
+        // As many lists as the most threads, a run with fewer threads just records several per thread.
+        bool Initialize(unsigned int maxThreads) override
+        {
+            return m_recorder.Initialize(nullptr, maxThreads);
+        }
+
+        void Shutdown() override
+        {
+            m_recorder.Shutdown();
+        }
+
+        // Records what ColorShader::Render() does per draw: its own window of the constant ring,
+        // the layout and shaders (the state trackers drop those after the first) and the draw.
+        // Only the recording is timed, not the replay.
+        double Run(JobSystem& jobSystem) override
+        {
+            m_recorder.Record(&jobSystem, kRecordedDraws, kMinDrawsPerList, [](RenderContext* pContext, unsigned int begin, unsigned int end)
+            {
+                ID3D11Buffer* pConstants = nullptr;
+                UINT constantCount = 16;
+
+                for (unsigned int i = begin; i < end; ++i)
+                {
+                    UINT firstConstant = (i % 4096) * constantCount;
+                    pContext->VSSetConstantBuffers1(2, 1, &pConstants, &firstConstant, &constantCount);
+                    pContext->IASetInputLayout(nullptr);
+                    pContext->VSSetShader(nullptr, nullptr, 0);
+                    pContext->PSSetShader(nullptr, nullptr, 0);
+                    pContext->DrawIndexed(36, (i % 64) * 36, 0);
+                }
+            });
+
+            return m_recorder.GetStats().m_recordSeconds;
+        }
+
+    private:
+        CommandListRecorder m_recorder;
+    };
+}
+
+std::unique_ptr<JobSystemWorkload> CreateCommandListRecordWorkload()
+{
+    return std::make_unique<CommandListRecordWorkload>();
+}
@@ -0,0 +1,195 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: CommandListRecorder.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <atomic>
+
+#include "Graphics/CommandListRecorder.h"
+#include "System/Profiler.h"
+
+CommandListRecorder::CommandListRecorder()
+    : m_recordedLists(0)
+    , m_stats()
+{
+}
+
+CommandListRecorder::~CommandListRecorder()
+{
+    Shutdown();
+}
+
+bool CommandListRecorder::Initialize(RenderDevice* pDevice, unsigned int listCount)
+{
+    Shutdown();
+
+    listCount = std::max(1u, listCount);
+
+    for (unsigned int i = 0; i < listCount; ++i)
+    {
+        m_lists.push_back(std::make_unique<CommandList>());
+        m_trackers.push_back(std::make_unique<StateTrackingRenderContext>(m_lists.back().get()));
+    }
+
+    // Without deferred contexts the lists are replayed, which works everywhere.
+    for (unsigned int i = 0; pDevice && i < listCount; ++i)
+    {
+        RenderContext* pDeferredContext = nullptr;
+        if (FAILED(pDevice->CreateDeferredContext(0, &pDeferredContext)))
+        {
+            m_deferredContexts.clear();
+            break;
+        }
+
+        m_deferredContexts.emplace_back(pDeferredContext);
+    }
+
+    m_finishedLists.assign(listCount, nullptr);
+
+    return true;
+}
+
+void CommandListRecorder::Shutdown()
+{
+    for (ID3D11CommandList*& pFinishedList : m_finishedLists)
+    {
+        if (pFinishedList)
+        {
+            pFinishedList->Release();
+            pFinishedList = nullptr;
+        }
+    }
+
+    m_finishedLists.clear();
+    m_deferredContexts.clear();
+    m_trackers.clear();
+    m_lists.clear();
+    m_recordedLists = 0;
+}
+
+//-----------------------------------------------------------------
+// The items go to as many lists as there are, as long as every
+// list gets at least the minimum. Fewer larger lists are cheaper
+// to submit, more lists record faster.
+//-----------------------------------------------------------------
+unsigned int CommandListRecorder::BeginRecord(unsigned int count, unsigned int minimum)
+{
+    minimum = std::max(1u, minimum);
+
+    unsigned int listCount = std::min(static_cast<unsigned int>(m_lists.size()), (count + minimum - 1) / minimum);
+
+    for (unsigned int i = 0; i < listCount; ++i)
+    {
+        m_lists[i]->Reset();
+        m_trackers[i]->Invalidate();
+        m_trackers[i]->ResetCounters();
+    }
+
+    m_recordedLists = listCount;
+
+    return listCount;
+}
+
+void CommandListRecorder::EndRecord(double recordSeconds)
+{
+    m_stats.m_lists = m_recordedLists;
+    m_stats.m_commands = 0;
+    m_stats.m_bytes = 0;
+    m_stats.m_elidedBinds = 0;
+    m_stats.m_recordSeconds = recordSeconds;
+
+    for (unsigned int i = 0; i < m_recordedLists; ++i)
+    {
+        m_stats.m_commands += m_lists[i]->GetCommandCount();
+        m_stats.m_bytes += m_lists[i]->GetByteCount();
+        m_stats.m_elidedBinds += m_trackers[i]->GetCounters().m_elidedBinds;
+    }
+}
+
+bool CommandListRecorder::Submit(RenderContext* pDeviceContext, JobSystem* pJobSystem)
+{
+    PROFILE_SCOPE("CommandListRecorder::Submit");
+
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+    bool result = true;
+    m_stats.m_deferredContexts = (m_recordedLists > 1 && !m_deferredContexts.empty());
+
+    if (m_stats.m_deferredContexts)
+    {
+        result = SubmitDeferred(pDeviceContext, pJobSystem);
+    }
+    else
+    {
+        for (unsigned int i = 0; i < m_recordedLists; ++i)
+        {
+            m_lists[i]->Execute(pDeviceContext);
+        }
+    }
+
+    m_stats.m_submitSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    return result;
+}
+
+unsigned int CommandListRecorder::GetListCount() const
+{
+    return static_cast<unsigned int>(m_lists.size());
+}
+
+const CommandListRecorderStats& CommandListRecorder::GetStats() const
+{
+    return m_stats;
+}
+
+//-----------------------------------------------------------------
+// Translating a list into D3D11 calls is the expensive part of the
+// submission, so that happens on the job system, one deferred
+// context per list. Only executing the finished lists has to be on
+// the device context, and it goes in list order.
+//
+// The deferred contexts don't restore their state, every list binds
+// its own. Executing doesn't restore the device context's either,
+// the state tracker in front of it forgets what it knew.
+//-----------------------------------------------------------------
+bool CommandListRecorder::SubmitDeferred(RenderContext* pDeviceContext, JobSystem* pJobSystem)
+{
+    std::atomic<bool> finished(true);
+
+    auto translate = [this, &finished](unsigned int begin, unsigned int end)
+    {
+        for (unsigned int i = begin; i < end; ++i)
+        {
+            m_lists[i]->Execute(m_deferredContexts[i].get());
+            if (FAILED(m_deferredContexts[i]->FinishCommandList(FALSE, &m_finishedLists[i])))
+            {
+                m_finishedLists[i] = nullptr;
+                finished = false;
+            }
+        }
+    };
+
+    if (pJobSystem)
+    {
+        pJobSystem->ParallelFor(m_recordedLists, 1, translate);
+    }
+    else
+    {
+        translate(0, m_recordedLists);
+    }
+
+    for (unsigned int i = 0; i < m_recordedLists; ++i)
+    {
+        if (finished)
+        {
+            pDeviceContext->ExecuteCommandList(m_finishedLists[i], FALSE);
+        }
+
+        if (m_finishedLists[i])
+        {
+            m_finishedLists[i]->Release();
+            m_finishedLists[i] = nullptr;
+        }
+    }
+
+    return finished;
+}
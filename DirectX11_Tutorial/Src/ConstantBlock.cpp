@@ -0,0 +1,95 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: ConstantBlock.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include <cstring>
+
+#include "Graphics/ConstantBlock.h"
+#include "Graphics/RenderStats.h"
+
+ConstantBlock::ConstantBlock()
+    : m_pBuffer(nullptr)
+    , m_uploadedValid(false)
+    , m_uploadCount(0)
+{
+}
+
+ConstantBlock::~ConstantBlock()
+{
+    Shutdown();
+}
+
+bool ConstantBlock::Initialize(RenderDevice* pDevice, UINT byteWidth)
+{
+    HRESULT result;
+    D3D11_BUFFER_DESC bufferDesc;
+
+    // Constant buffers are a whole number of 16 byte registers.
+    bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+    bufferDesc.ByteWidth = (byteWidth + 15) / 16 * 16;
+    bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+    bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+    bufferDesc.MiscFlags = 0;
+    bufferDesc.StructureByteStride = 0;
+
+    result = pDevice->CreateBuffer(&bufferDesc, nullptr, &m_pBuffer);
+    if (FAILED(result))
+    {
+        return false;
+    }
+
+    m_uploaded.assign(byteWidth, 0);
+    m_uploadedValid = false;
+    m_uploadCount = 0;
+
+    return true;
+}
+
+void ConstantBlock::Shutdown()
+{
+    if (m_pBuffer)
+    {
+        m_pBuffer->Release();
+        m_pBuffer = nullptr;
+    }
+
+    m_uploaded.clear();
+    m_uploadedValid = false;
+}
+
+bool ConstantBlock::Update(RenderContext* pContext, const void* pData)
+{
+    if (m_uploadedValid && memcmp(m_uploaded.data(), pData, m_uploaded.size()) == 0)
+    {
+        return true;
+    }
+
+    // The old contents are never read again, so the driver may hand out fresh memory.
+    D3D11_MAPPED_SUBRESOURCE mappedResource;
+    HRESULT result = pContext->Map(m_pBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+    if (FAILED(result))
+    {
+        return false;
+    }
+
+    memcpy(mappedResource.pData, pData, m_uploaded.size());
+    pContext->Unmap(m_pBuffer, 0);
+
+    memcpy(m_uploaded.data(), pData, m_uploaded.size());
+    m_uploadedValid = true;
+    ++m_uploadCount;
+
+    RenderStats::AddConstantBufferUpload(static_cast<unsigned int>(m_uploaded.size()));
+    RenderStats::AddConstantBufferMap();
+
+    return true;
+}
+
+ID3D11Buffer* ConstantBlock::GetBuffer() const
+{
+    return m_pBuffer;
+}
+
+uint64_t ConstantBlock::GetUploadCount() const
+{
+    return m_uploadCount;
+}
@@ -0,0 +1,398 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: ConstantUploadRing.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <thread>
+
+#include "Graphics/ConstantUploadRing.h"
+#include "Graphics/RenderStats.h"
+#include "System/Profiler.h"
+
+ConstantUploadRing::ConstantUploadRing()
+    : m_pDevice(nullptr)
+    , m_pUploadContext(nullptr)
+    , m_useRing(false)
+    , m_pBuffer(nullptr)
+    , m_segmentBytes(0)
+    , m_segmentCount(0)
+    , m_segment(0)
+    , m_segmentOffset(0)
+    , m_segmentReady(false)
+    , m_everMapped(false)
+    , m_pMappedData(nullptr)
+    , m_frameBytes(0)
+    , m_requiredSegmentBytes(0)
+    , m_drawBuffersUsed(0)
+    , m_drawBuffersUnmapped(0)
+    , m_stats()
+{
+}
+
+ConstantUploadRing::~ConstantUploadRing()
+{
+    Shutdown();
+}
+
+// segmentBytes is what one frame may upload before the segments grow, segmentCount how many
+// frames can be in flight plus one. Without useRing every draw gets a buffer of its own.
+bool ConstantUploadRing::Initialize(RenderDevice* pDevice, UINT segmentBytes, UINT segmentCount, bool useRing)
+{
+    HRESULT result;
+    D3D11_QUERY_DESC queryDesc;
+
+    if (segmentCount == 0 || segmentBytes < kAlignment)
+    {
+        return false;
+    }
+
+    m_pDevice = pDevice;
+    m_useRing = useRing;
+    m_segmentCount = segmentCount;
+    m_segmentReady = false;
+    m_frameBytes = 0;
+    m_requiredSegmentBytes = 0;
+    m_drawBuffersUsed = 0;
+    m_drawBuffersUnmapped = 0;
+    m_stats = ConstantUploadRingStats();
+
+    if (!m_useRing)
+    {
+        return true;
+    }
+
+    queryDesc.Query = D3D11_QUERY_EVENT;
+    queryDesc.MiscFlags = 0;
+
+    m_fences.assign(m_segmentCount, nullptr);
+    m_fencesIssued.assign(m_segmentCount, false);
+    for (ID3D11Query*& pFence : m_fences)
+    {
+        result = pDevice->CreateQuery(&queryDesc, &pFence);
+        if (FAILED(result))
+        {
+            return false;
+        }
+    }
+
+    return CreateRing(segmentBytes);
+}
+
+void ConstantUploadRing::Shutdown()
+{
+    for (ID3D11Query* pFence : m_fences)
+    {
+        if (pFence)
+        {
+            pFence->Release();
+        }
+    }
+
+    m_fences.clear();
+    m_fencesIssued.clear();
+
+    ReleaseRing();
+
+    for (ID3D11Buffer* pDrawBuffer : m_drawBuffers)
+    {
+        if (pDrawBuffer)
+        {
+            pDrawBuffer->Release();
+        }
+    }
+
+    m_drawBuffers.clear();
+    m_drawBufferBytes.clear();
+    m_drawBuffersUsed = 0;
+    m_drawBuffersUnmapped = 0;
+
+    m_pUploadContext = nullptr;
+    m_pDevice = nullptr;
+}
+
+//-----------------------------------------------------------------
+// The first map of the buffer has to discard, after that the fences
+// guarantee the segment being written isn't read any more, so the
+// driver doesn't need to rename the buffer.
+//-----------------------------------------------------------------
+bool ConstantUploadRing::BeginUpload(RenderContext* pContext)
+{
+    PROFILE_SCOPE("ConstantUploadRing::BeginUpload");
+
+    HRESULT result;
+    D3D11_MAPPED_SUBRESOURCE mappedResource;
+
+    m_pUploadContext = pContext;
+
+    if (!m_useRing)
+    {
+        return true;
+    }
+
+    if (!m_segmentReady)
+    {
+        // A frame overflowed, double the segments until it would have fit. When the bigger
+        // buffer can't be created the frames keep overflowing into buffers of their own.
+        if (m_requiredSegmentBytes > m_segmentBytes)
+        {
+            UINT segmentBytes = m_segmentBytes;
+            while (segmentBytes < m_requiredSegmentBytes)
+            {
+                segmentBytes *= 2;
+            }
+
+            if (CreateRing(segmentBytes))
+            {
+                ++m_stats.m_growths;
+            }
+            m_requiredSegmentBytes = 0;
+        }
+
+        WaitForSegment(pContext);
+        m_segmentReady = true;
+    }
+
+    result = pContext->Map(m_pBuffer, 0, m_everMapped ? D3D11_MAP_WRITE_NO_OVERWRITE : D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+    if (FAILED(result))
+    {
+        return false;
+    }
+
+    m_everMapped = true;
+    m_pMappedData = static_cast<uint8_t*>(mappedResource.pData);
+
+    ++m_stats.m_maps;
+    RenderStats::AddConstantBufferMap();
+
+    return true;
+}
+
+bool ConstantUploadRing::Allocate(UINT byteCount, ConstantAllocation& allocation)
+{
+    UINT alignedBytes = (byteCount + kAlignment - 1) / kAlignment * kAlignment;
+
+    if (!m_pUploadContext || alignedBytes == 0)
+    {
+        ++m_stats.m_failedAllocations;
+        return false;
+    }
+
+    m_frameBytes += alignedBytes;
+
+    // Past the end of the segment the rest of the frame gets a buffer per draw.
+    if (!m_pMappedData || alignedBytes > m_segmentBytes - m_segmentOffset)
+    {
+        if (m_useRing)
+        {
+            ++m_stats.m_overflowAllocations;
+        }
+        return AllocateDrawBuffer(alignedBytes, allocation);
+    }
+
+    UINT byteOffset = m_segment * m_segmentBytes + m_segmentOffset;
+    m_segmentOffset += alignedBytes;
+
+    allocation.m_pBuffer = m_pBuffer;
+    allocation.m_firstConstant = byteOffset / 16;
+    allocation.m_constantCount = alignedBytes / 16;
+    allocation.m_pData = m_pMappedData + byteOffset;
+
+    ++m_stats.m_allocations;
+    m_stats.m_bytesAllocated += alignedBytes;
+
+    return true;
+}
+
+void ConstantUploadRing::EndUpload(RenderContext* pContext)
+{
+    if (m_pMappedData)
+    {
+        pContext->Unmap(m_pBuffer, 0);
+        m_pMappedData = nullptr;
+    }
+
+    for (unsigned int i = m_drawBuffersUnmapped; i < m_drawBuffersUsed; ++i)
+    {
+        pContext->Unmap(m_drawBuffers[i], 0);
+    }
+    m_drawBuffersUnmapped = m_drawBuffersUsed;
+
+    m_pUploadContext = nullptr;
+}
+
+void ConstantUploadRing::EndFrame(RenderContext* pContext)
+{
+    EndUpload(pContext);
+
+    // The draw buffers were mapped with DISCARD, the next frame can map them again right away.
+    m_drawBuffersUsed = 0;
+    m_drawBuffersUnmapped = 0;
+
+    if (m_useRing && m_frameBytes > m_segmentBytes)
+    {
+        m_requiredSegmentBytes = std::max(m_requiredSegmentBytes, m_frameBytes);
+    }
+    m_frameBytes = 0;
+
+    // A frame that never uploaded didn't touch its segment, it can be used by the next one as is.
+    if (!m_segmentReady)
+    {
+        return;
+    }
+
+    pContext->End(m_fences[m_segment]);
+    m_fencesIssued[m_segment] = true;
+
+    m_segment = (m_segment + 1) % m_segmentCount;
+    m_segmentOffset = 0;
+    m_segmentReady = false;
+}
+
+UINT ConstantUploadRing::GetSegmentBytes() const
+{
+    return m_segmentBytes;
+}
+
+const ConstantUploadRingStats& ConstantUploadRing::GetStats() const
+{
+    return m_stats;
+}
+
+//-----------------------------------------------------------------
+// Creates the buffer with segments of segmentBytes and starts over
+// at the first one. Nothing in flight reads the new buffer, so the
+// fences of the old one don't matter any more. The old buffer stays
+// alive until the GPU is done with it, D3D11 takes care of that.
+//-----------------------------------------------------------------
+bool ConstantUploadRing::CreateRing(UINT segmentBytes)
+{
+    HRESULT result;
+    D3D11_BUFFER_DESC bufferDesc;
+    ID3D11Buffer* pBuffer = nullptr;
+
+    segmentBytes = segmentBytes / kAlignment * kAlignment;
+
+    bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+    bufferDesc.ByteWidth = segmentBytes * m_segmentCount;
+    bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+    bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+    bufferDesc.MiscFlags = 0;
+    bufferDesc.StructureByteStride = 0;
+
+    result = m_pDevice->CreateBuffer(&bufferDesc, nullptr, &pBuffer);
+    if (FAILED(result))
+    {
+        return false;
+    }
+
+    ReleaseRing();
+
+    m_pBuffer = pBuffer;
+    m_segmentBytes = segmentBytes;
+    m_segment = 0;
+    m_segmentOffset = 0;
+    m_everMapped = false;
+    m_fencesIssued.assign(m_segmentCount, false);
+
+    return true;
+}
+
+void ConstantUploadRing::ReleaseRing()
+{
+    if (m_pBuffer)
+    {
+        m_pBuffer->Release();
+        m_pBuffer = nullptr;
+    }
+
+    m_pMappedData = nullptr;
+}
+
+//-----------------------------------------------------------------
+// With a segment per queued frame plus one this only waits when the
+// GPU falls further behind than the present queue lets it.
+//-----------------------------------------------------------------
+void ConstantUploadRing::WaitForSegment(RenderContext* pContext)
+{
+    if (!m_fencesIssued[m_segment])
+    {
+        return;
+    }
+
+    if (pContext->GetData(m_fences[m_segment], nullptr, 0, 0) == S_FALSE)
+    {
+        PROFILE_SCOPE("ConstantUploadRing::WaitForSegment");
+
+        ++m_stats.m_fenceWaits;
+        while (pContext->GetData(m_fences[m_segment], nullptr, 0, 0) == S_FALSE)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    m_fencesIssued[m_segment] = false;
+}
+
+//-----------------------------------------------------------------
+// Hands out the next draw buffer of the frame, mapped with DISCARD
+// so the driver renames it if an earlier frame still reads it. The
+// buffers are made as the frames need them and kept.
+//-----------------------------------------------------------------
+bool ConstantUploadRing::AllocateDrawBuffer(UINT byteCount, ConstantAllocation& allocation)
+{
+    HRESULT result;
+    D3D11_BUFFER_DESC bufferDesc;
+    D3D11_MAPPED_SUBRESOURCE mappedResource;
+
+    if (m_drawBuffersUsed == m_drawBuffers.size())
+    {
+        m_drawBuffers.push_back(nullptr);
+        m_drawBufferBytes.push_back(0);
+    }
+
+    ID3D11Buffer*& pDrawBuffer = m_drawBuffers[m_drawBuffersUsed];
+    if (!pDrawBuffer || m_drawBufferBytes[m_drawBuffersUsed] < byteCount)
+    {
+        if (pDrawBuffer)
+        {
+            pDrawBuffer->Release();
+            pDrawBuffer = nullptr;
+        }
+
+        bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+        bufferDesc.ByteWidth = byteCount;
+        bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+        bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+        bufferDesc.MiscFlags = 0;
+        bufferDesc.StructureByteStride = 0;
+
+        result = m_pDevice->CreateBuffer(&bufferDesc, nullptr, &pDrawBuffer);
+        if (FAILED(result))
+        {
+            pDrawBuffer = nullptr;
+            ++m_stats.m_failedAllocations;
+            return false;
+        }
+        m_drawBufferBytes[m_drawBuffersUsed] = byteCount;
+    }
+
+    result = m_pUploadContext->Map(pDrawBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+    if (FAILED(result))
+    {
+        ++m_stats.m_failedAllocations;
+        return false;
+    }
+
+    ++m_drawBuffersUsed;
+
+    allocation.m_pBuffer = pDrawBuffer;
+    allocation.m_firstConstant = 0;
+    allocation.m_constantCount = 0;
+    allocation.m_pData = mappedResource.pData;
+
+    ++m_stats.m_maps;
+    ++m_stats.m_allocations;
+    m_stats.m_bytesAllocated += byteCount;
+    RenderStats::AddConstantBufferMap();
+
+    return true;
+}
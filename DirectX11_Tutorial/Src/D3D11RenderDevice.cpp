@@ -0,0 +1,271 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: D3D11RenderDevice.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include <cstdint>
+#include <new>
+
+#include "Graphics/D3D11RenderDevice.h"
+
+D3D11RenderDevice::D3D11RenderDevice(ID3D11Device* pDevice)
+    : m_pDevice(pDevice)
+{
+}
+
+RenderBackend D3D11RenderDevice::GetBackend() const
+{
+    return RenderBackend::Hardware;
+}
+
+HRESULT D3D11RenderDevice::CreateBuffer(const D3D11_BUFFER_DESC* pDesc, const D3D11_SUBRESOURCE_DATA* pInitialData, ID3D11Buffer** ppBuffer)
+{
+    return m_pDevice->CreateBuffer(pDesc, pInitialData, ppBuffer);
+}
+
+HRESULT D3D11RenderDevice::CreateVertexShader(const void* pBytecode, SIZE_T bytecodeLength, ID3D11ClassLinkage* pClassLinkage, ID3D11VertexShader** ppShader)
+{
+    return m_pDevice->CreateVertexShader(pBytecode, bytecodeLength, pClassLinkage, ppShader);
+}
+
+HRESULT D3D11RenderDevice::CreatePixelShader(const void* pBytecode, SIZE_T bytecodeLength, ID3D11ClassLinkage* pClassLinkage, ID3D11PixelShader** ppShader)
+{
+    return m_pDevice->CreatePixelShader(pBytecode, bytecodeLength, pClassLinkage, ppShader);
+}
+
+HRESULT D3D11RenderDevice::CreateInputLayout(const D3D11_INPUT_ELEMENT_DESC* pElements, UINT numElements, const void* pBytecode, SIZE_T bytecodeLength, ID3D11InputLayout** ppLayout)
+{
+    return m_pDevice->CreateInputLayout(pElements, numElements, pBytecode, bytecodeLength, ppLayout);
+}
+
+HRESULT D3D11RenderDevice::CreateDepthStencilState(const D3D11_DEPTH_STENCIL_DESC* pDesc, ID3D11DepthStencilState** ppState)
+{
+    return m_pDevice->CreateDepthStencilState(pDesc, ppState);
+}
+
+HRESULT D3D11RenderDevice::CreateRasterizerState(const D3D11_RASTERIZER_DESC* pDesc, ID3D11RasterizerState** ppState)
+{
+    return m_pDevice->CreateRasterizerState(pDesc, ppState);
+}
+
+HRESULT D3D11RenderDevice::CreateBlendState(const D3D11_BLEND_DESC* pDesc, ID3D11BlendState** ppState)
+{
+    return m_pDevice->CreateBlendState(pDesc, ppState);
+}
+
+HRESULT D3D11RenderDevice::CreateSamplerState(const D3D11_SAMPLER_DESC* pDesc, ID3D11SamplerState** ppState)
+{
+    return m_pDevice->CreateSamplerState(pDesc, ppState);
+}
+
+HRESULT D3D11RenderDevice::CreateQuery(const D3D11_QUERY_DESC* pDesc, ID3D11Query** ppQuery)
+{
+    return m_pDevice->CreateQuery(pDesc, ppQuery);
+}
+
+//-----------------------------------------------------------------
+// The context needs to know whether the driver records command lists
+// itself or leaves that to the runtime, see UpdateSubresource().
+//-----------------------------------------------------------------
+HRESULT D3D11RenderDevice::CreateDeferredContext(UINT contextFlags, RenderContext** ppContext)
+{
+    ID3D11DeviceContext* pDeferredContext = nullptr;
+    HRESULT result = m_pDevice->CreateDeferredContext(contextFlags, &pDeferredContext);
+    if (FAILED(result))
+    {
+        return result;
+    }
+
+    // Stays null on the 11.0 runtime.
+    ID3D11DeviceContext1* pDeferredContext1 = nullptr;
+    if (FAILED(pDeferredContext->QueryInterface(__uuidof(ID3D11DeviceContext1), reinterpret_cast<void**>(&pDeferredContext1))))
+    {
+        pDeferredContext1 = nullptr;
+    }
+
+    D3D11_FEATURE_DATA_THREADING threading = {};
+    if (FAILED(m_pDevice->CheckFeatureSupport(D3D11_FEATURE_THREADING, &threading, sizeof(threading))))
+    {
+        threading.DriverCommandLists = FALSE;
+    }
+
+    *ppContext = new (std::nothrow) D3D11RenderContext(pDeferredContext, pDeferredContext1, threading.DriverCommandLists != FALSE);
+    if (!*ppContext)
+    {
+        if (pDeferredContext1)
+        {
+            pDeferredContext1->Release();
+        }
+
+        pDeferredContext->Release();
+        return E_OUTOFMEMORY;
+    }
+
+    return S_OK;
+}
+
+D3D11RenderContext::D3D11RenderContext(ID3D11DeviceContext* pDeviceContext, ID3D11DeviceContext1* pDeviceContext1)
+    : m_pDeviceContext(pDeviceContext)
+    , m_pDeviceContext1(pDeviceContext1)
+    , m_ownsDeviceContext(false)
+    , m_offsetUpdateSource(false)
+{
+}
+
+D3D11RenderContext::D3D11RenderContext(ID3D11DeviceContext* pDeviceContext, ID3D11DeviceContext1* pDeviceContext1, bool driverCommandLists)
+    : m_pDeviceContext(pDeviceContext)
+    , m_pDeviceContext1(pDeviceContext1)
+    , m_ownsDeviceContext(true)
+    , m_offsetUpdateSource(!driverCommandLists)
+{
+}
+
+D3D11RenderContext::~D3D11RenderContext()
+{
+    if (m_ownsDeviceContext && m_pDeviceContext1)
+    {
+        m_pDeviceContext1->Release();
+        m_pDeviceContext1 = nullptr;
+    }
+
+    if (m_ownsDeviceContext && m_pDeviceContext)
+    {
+        m_pDeviceContext->Release();
+        m_pDeviceContext = nullptr;
+    }
+}
+
+void D3D11RenderContext::ClearRenderTargetView(ID3D11RenderTargetView* pView, const FLOAT color[4])
+{
+    m_pDeviceContext->ClearRenderTargetView(pView, color);
+}
+
+void D3D11RenderContext::ClearDepthStencilView(ID3D11DepthStencilView* pView, UINT clearFlags, FLOAT depth, UINT8 stencil)
+{
+    m_pDeviceContext->ClearDepthStencilView(pView, clearFlags, depth, stencil);
+}
+
+void D3D11RenderContext::OMSetRenderTargets(UINT numViews, ID3D11RenderTargetView* const* ppViews, ID3D11DepthStencilView* pDepthView)
+{
+    m_pDeviceContext->OMSetRenderTargets(numViews, ppViews, pDepthView);
+}
+
+void D3D11RenderContext::OMSetDepthStencilState(ID3D11DepthStencilState* pState, UINT stencilRef)
+{
+    m_pDeviceContext->OMSetDepthStencilState(pState, stencilRef);
+}
+
+void D3D11RenderContext::RSSetState(ID3D11RasterizerState* pState)
+{
+    m_pDeviceContext->RSSetState(pState);
+}
+
+void D3D11RenderContext::RSSetViewports(UINT numViewports, const D3D11_VIEWPORT* pViewports)
+{
+    m_pDeviceContext->RSSetViewports(numViewports, pViewports);
+}
+
+void D3D11RenderContext::IASetInputLayout(ID3D11InputLayout* pLayout)
+{
+    m_pDeviceContext->IASetInputLayout(pLayout);
+}
+
+void D3D11RenderContext::IASetVertexBuffers(UINT startSlot, UINT numBuffers, ID3D11Buffer* const* ppBuffers, const UINT* pStrides, const UINT* pOffsets)
+{
+    m_pDeviceContext->IASetVertexBuffers(startSlot, numBuffers, ppBuffers, pStrides, pOffsets);
+}
+
+void D3D11RenderContext::IASetIndexBuffer(ID3D11Buffer* pBuffer, DXGI_FORMAT format, UINT offset)
+{
+    m_pDeviceContext->IASetIndexBuffer(pBuffer, format, offset);
+}
+
+void D3D11RenderContext::IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY topology)
+{
+    m_pDeviceContext->IASetPrimitiveTopology(topology);
+}
+
+void D3D11RenderContext::VSSetShader(ID3D11VertexShader* pShader, ID3D11ClassInstance* const* ppClassInstances, UINT numClassInstances)
+{
+    m_pDeviceContext->VSSetShader(pShader, ppClassInstances, numClassInstances);
+}
+
+void D3D11RenderContext::PSSetShader(ID3D11PixelShader* pShader, ID3D11ClassInstance* const* ppClassInstances, UINT numClassInstances)
+{
+    m_pDeviceContext->PSSetShader(pShader, ppClassInstances, numClassInstances);
+}
+
+void D3D11RenderContext::VSSetConstantBuffers(UINT startSlot, UINT numBuffers, ID3D11Buffer* const* ppBuffers)
+{
+    m_pDeviceContext->VSSetConstantBuffers(startSlot, numBuffers, ppBuffers);
+}
+
+// Without the 11.1 context nothing asks for windows (Direct3D turns offsetting off),
+// so the buffers are bound whole.
+void D3D11RenderContext::VSSetConstantBuffers1(UINT startSlot, UINT numBuffers, ID3D11Buffer* const* ppBuffers, const UINT* pFirstConstant, const UINT* pNumConstants)
+{
+    if (m_pDeviceContext1)
+    {
+        m_pDeviceContext1->VSSetConstantBuffers1(startSlot, numBuffers, ppBuffers, pFirstConstant, pNumConstants);
+    }
+    else
+    {
+        m_pDeviceContext->VSSetConstantBuffers(startSlot, numBuffers, ppBuffers);
+    }
+}
+
+HRESULT D3D11RenderContext::Map(ID3D11Resource* pResource, UINT subresource, D3D11_MAP mapType, UINT mapFlags, D3D11_MAPPED_SUBRESOURCE* pMappedResource)
+{
+    return m_pDeviceContext->Map(pResource, subresource, mapType, mapFlags, pMappedResource);
+}
+
+void D3D11RenderContext::Unmap(ID3D11Resource* pResource, UINT subresource)
+{
+    m_pDeviceContext->Unmap(pResource, subresource);
+}
+
+// When the runtime emulates command lists it offsets the source of a deferred
+// update by the box a second time, the documented workaround takes it back out.
+// Only buffers are updated, so the box is in bytes.
+void D3D11RenderContext::UpdateSubresource(ID3D11Resource* pResource, UINT subresource, const D3D11_BOX* pBox, const void* pSourceData, UINT sourceRowPitch, UINT sourceDepthPitch)
+{
+    if (m_offsetUpdateSource && pBox)
+    {
+        pSourceData = static_cast<const uint8_t*>(pSourceData) - pBox->left;
+    }
+
+    m_pDeviceContext->UpdateSubresource(pResource, subresource, pBox, pSourceData, sourceRowPitch, sourceDepthPitch);
+}
+
+void D3D11RenderContext::DrawIndexed(UINT indexCount, UINT startIndexLocation, INT baseVertexLocation)
+{
+    m_pDeviceContext->DrawIndexed(indexCount, startIndexLocation, baseVertexLocation);
+}
+
+void D3D11RenderContext::DrawIndexedInstanced(UINT indexCountPerInstance, UINT instanceCount, UINT startIndexLocation, INT baseVertexLocation, UINT startInstanceLocation)
+{
+    m_pDeviceContext->DrawIndexedInstanced(indexCountPerInstance, instanceCount, startIndexLocation, baseVertexLocation, startInstanceLocation);
+}
+
+void D3D11RenderContext::End(ID3D11Asynchronous* pAsync)
+{
+    m_pDeviceContext->End(pAsync);
+}
+
+HRESULT D3D11RenderContext::GetData(ID3D11Asynchronous* pAsync, void* pData, UINT dataSize, UINT getDataFlags)
+{
+    return m_pDeviceContext->GetData(pAsync, pData, dataSize, getDataFlags);
+}
+
+HRESULT D3D11RenderContext::FinishCommandList(BOOL restoreDeferredContextState, ID3D11CommandList** ppCommandList)
+{
+    return m_pDeviceContext->FinishCommandList(restoreDeferredContextState, ppCommandList);
+}
+
+void D3D11RenderContext::ExecuteCommandList(ID3D11CommandList* pCommandList, BOOL restoreContextState)
+{
+    m_pDeviceContext->ExecuteCommandList(pCommandList, restoreContextState);
+}
+
+void D3D11RenderContext::Flush()
+{
+    // The swap chain presents the hardware frame, nothing is deferred here.
+}
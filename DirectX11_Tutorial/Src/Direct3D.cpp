@@ -8,18 +8,32 @@
 // Filename: Direct3D.cpp
 ////////////////////////////////////////////////////////////////////////////////
 #include "Graphics/Direct3D.h"
+#include "Graphics/D3D11RenderDevice.h"
+#include "Graphics/SoftwareRenderDevice.h"
+#include "Graphics/RenderStats.h"
+#include "System/Profiler.h"
 
 using namespace DirectX;
 
 Direct3D::Direct3D()
-    : m_pSwapChain(nullptr)
+    : m_refreshSeconds(0.0)
+    , m_pSwapChain(nullptr)
     , m_pDevice(nullptr)
     , m_pDeviceContext(nullptr)
+    , m_pDeviceContext1(nullptr)
     , m_pRenderTargetView(nullptr)
     , m_pDepthStencilBuffer(nullptr)
     , m_pDepthStencilState(nullptr)
     , m_pDepthStencilView(nullptr)
     , m_pRasterState(nullptr)
+    , m_constantBufferOffsetting(true)
+    , m_pRenderDevice(nullptr)
+    , m_pRenderContext(nullptr)
+    , m_pSoftwareRenderContext(nullptr)
+    , m_pNullRenderContext(nullptr)
+    , m_pStateTrackingContext(nullptr)
+    , m_pPresentClock(nullptr)
+    , m_viewport()
 {
 }
 
@@ -32,8 +46,198 @@ Direct3D::~Direct3D()
 }
 
 // Setup for Direct3D for DirectX 11.
-// 
-bool Direct3D::Initialize(int screenWidth, int screenHeight, bool vsync, HWND hwnd, bool fullScreen, float screenDepth, float screenNear)
+// The device is either created on the video card or, for the Software backend, on the CPU.
+// Everything after that (states, viewport and matrices) is shared by both.
+bool Direct3D::Initialize(RenderBackend backend, JobSystem* pJobSystem, int screenWidth, int screenHeight, const FramePacingSettings& kPacingSettings, HWND hwnd, bool fullScreen, float screenDepth, float screenNear)
+{
+    HRESULT result;
+
+    D3D11_DEPTH_STENCIL_DESC        depthStencilDesc;
+    D3D11_RASTERIZER_DESC           rasterDesc;
+    D3D11_VIEWPORT                  viewport;
+
+    float fieldOfView;
+    float screenAspect;
+
+    // Store the pacing settings, the swap chain is set up for them.
+    m_pacingSettings = kPacingSettings;
+
+    // Create the device, device context and render targets.
+    if (backend == RenderBackend::Hardware)
+    {
+        if (!InitializeHardwareDevice(screenWidth, screenHeight, hwnd, fullScreen))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        if (!InitializeSoftwareDevice(backend, pJobSystem, screenWidth, screenHeight))
+        {
+            return false;
+        }
+    }
+
+    // Every bind from here on, including the ones below, goes through the state tracker.
+    m_pStateTrackingContext = std::make_unique<StateTrackingRenderContext>(m_pRenderContext.get());
+
+    // Identical state descriptions share one object.
+    m_stateObjectCache.Initialize(m_pRenderDevice.get());
+
+    // One segment of the upload ring per frame the display may queue, and one for the frame being recorded.
+    if (!m_constantUploadRing.Initialize(m_pRenderDevice.get(), CONSTANT_UPLOAD_FRAME_BYTES, m_pacingSettings.m_queuedFrames + 1, m_constantBufferOffsetting))
+    {
+        return false;
+    }
+
+    // Frames are presented through the swap chain or, without one, to a simulated display.
+    if (m_pSwapChain)
+    {
+        std::unique_ptr<SwapChainPresentClock> pSwapChainClock = std::make_unique<SwapChainPresentClock>();
+        if (!pSwapChainClock->Initialize(m_pSwapChain, m_pDevice, m_refreshSeconds, m_pacingSettings.m_queuedFrames))
+        {
+            return false;
+        }
+
+        m_pPresentClock = std::move(pSwapChainClock);
+    }
+    else
+    {
+        double refreshSeconds = (m_pacingSettings.m_simulatedRefreshHz > 0.0) ? (1.0 / m_pacingSettings.m_simulatedRefreshHz) : 0.0;
+        m_pPresentClock = std::make_unique<SimulatedDisplay>(refreshSeconds, m_pacingSettings.m_queuedFrames);
+    }
+
+    m_framePacer.Initialize(m_pPresentClock.get(), m_pacingSettings);
+
+    // Setup the depth stencil description.
+    // This allows us to control what type of depth test Direct3D will do for each pixel.
+    {
+        // Initialize the description of the stencil state.
+        ZeroMemory(&depthStencilDesc, sizeof(depthStencilDesc));
+
+        // Set up the description of the stencil state.
+        depthStencilDesc.DepthEnable = true;
+        depthStencilDesc.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ALL;
+        depthStencilDesc.DepthFunc = D3D11_COMPARISON_LESS;
+
+        depthStencilDesc.StencilEnable = true;
+        depthStencilDesc.StencilReadMask = 0xFF;
+        depthStencilDesc.StencilWriteMask = 0xFF;
+
+        // Stencil operation if pixel is front-facing.
+        depthStencilDesc.FrontFace.StencilFailOp = D3D11_STENCIL_OP_KEEP;
+        depthStencilDesc.FrontFace.StencilDepthFailOp = D3D11_STENCIL_OP_INCR;
+        depthStencilDesc.FrontFace.StencilPassOp = D3D11_STENCIL_OP_KEEP;
+        depthStencilDesc.FrontFace.StencilFunc = D3D11_COMPARISON_ALWAYS;
+
+        // Stencil operations if pixel is back-facing.
+        depthStencilDesc.BackFace.StencilFailOp = D3D11_STENCIL_OP_KEEP;
+        depthStencilDesc.BackFace.StencilDepthFailOp = D3D11_STENCIL_OP_DECR;
+        depthStencilDesc.BackFace.StencilPassOp = D3D11_STENCIL_OP_KEEP;
+        depthStencilDesc.BackFace.StencilFunc = D3D11_COMPARISON_ALWAYS;
+
+        // Create the depth stencil state.
+        result = m_stateObjectCache.GetDepthStencilState(depthStencilDesc, &m_pDepthStencilState);
+        if (FAILED(result))
+        {
+            return false;
+        }
+
+        // Set the depth stencil state.
+        m_pStateTrackingContext->OMSetDepthStencilState(m_pDepthStencilState, 1);
+    }
+
+    // Bind the render target view and depth stencil view.
+    {
+        // [ OMSetRenderTarget ] : Binds the render target view and the depth stencil buffer to the output render pipeline.
+        // This way the graphics that the pipeline renders will get drawn to our back buffer that we previously created. 
+        // With the graphics written to the back buffer we can then swap it to the front and display our graphics on the user's screen.
+        m_pStateTrackingContext->OMSetRenderTargets(1, &m_pRenderTargetView, m_pDepthStencilView);
+    }
+
+    // Create Extras.
+    {
+        // Setup the raster description which will determine how and what polygons will be drawn.
+        {
+            // This allows us to control over how polygons are rendered.
+            // Like making our scenes render in wireframe mode or have DirectX draw both the front and back faces of polygons.
+            // By default, DirectX already has a resterizer state set up and working the exact same as the one below.
+            rasterDesc.AntialiasedLineEnable = false;
+            rasterDesc.CullMode = D3D11_CULL_BACK;
+            rasterDesc.DepthBias = 0;
+            rasterDesc.DepthBiasClamp = 0.0f;
+            rasterDesc.DepthClipEnable = true;
+            rasterDesc.FillMode = D3D11_FILL_SOLID;
+            rasterDesc.FrontCounterClockwise = false;
+            rasterDesc.MultisampleEnable = false;
+            rasterDesc.ScissorEnable = false;
+            rasterDesc.SlopeScaledDepthBias = 0.0f;
+
+            // Create the rasterizer state from the description we just filled out.
+            result = m_stateObjectCache.GetRasterizerState(rasterDesc, &m_pRasterState);
+            if (FAILED(result))
+            {
+                return false;
+            }
+
+            // Now set the rasterizer state.
+            m_pStateTrackingContext->RSSetState(m_pRasterState);
+        }
+
+        // Setup the viewport for rendering.
+        {
+            // This allows Direct3D can map clip space coordinates to the render target space.
+            // Set this to be the entire size of th window.
+            viewport.Width = static_cast<float>(screenWidth);
+            viewport.Height = static_cast<float>(screenHeight);
+            viewport.MinDepth = 0.0f;
+            viewport.MaxDepth = 1.0f;
+            viewport.TopLeftX = 0.0f;
+            viewport.TopLeftY = 0.0f;
+
+            // Create the viewport.
+            m_pStateTrackingContext->RSSetViewports(1, &viewport);
+            m_viewport = viewport;
+        }
+
+        // Setup the projection matrix.
+        {
+            // This is sued to translate the 3D scene into the 2D viewport space.
+            // We will need to keep a copy of this matrix sothat we can pass it to our shaders that will be used to render our scenes.
+            fieldOfView = 3.141592654f / 4.0f;
+            screenAspect = static_cast<float>(screenWidth) / static_cast<float>(screenHeight);
+
+            // Create the projection matrix for 3D rendering.
+            m_projectionMatrix = XMMatrixPerspectiveFovLH(fieldOfView, screenAspect, screenNear, screenDepth);
+        }
+
+        // Setup the world matrix.
+        {
+            // This is used to conver the vertices of our objects into vertices in the 3D scene.
+            // This is also used to rotate, translate, and scale our objects in 3D space.
+            // Copy of this will be needed to be passed to the shaders for rendering also.
+
+            // Initialize the world matrix to the identity matrix.
+            // The view matrix is used to calculate the position of where we are looing at the scene from.
+            // You can think of it as a camera and you only view the scene through this camera.
+            m_worldMatrix = XMMatrixIdentity();
+        }
+
+        // Setup an orthographics projection matrix.
+        {
+            // This matrix is used for rendering 2D elements like user interfaces on the screen allowing us to skip the 3D rendering.
+
+            // Create an orthographics projection matrix for 2D rendering.
+            m_orthoMatrix = XMMatrixOrthographicLH(static_cast<float>(screenWidth), static_cast<float>(screenHeight), screenNear, screenDepth);
+        }
+    }
+
+    return true;
+}
+
+// Creates the hardware device and swap chain along with the back buffer render target
+// and the depth stencil buffer and view.
+bool Direct3D::InitializeHardwareDevice(int screenWidth, int screenHeight, HWND hwnd, bool fullScreen)
 {
     HRESULT result;
 
@@ -49,7 +253,6 @@ bool Direct3D::Initialize(int screenWidth, int screenHeight, bool vsync, HWND hw
 
     std::vector<DXGI_MODE_DESC> displayModeList;
 
-    DXGI_MODE_DESC* pDisplayModeList = nullptr;
     DXGI_ADAPTER_DESC adapterDesc;
 
     int error = 0;
@@ -59,16 +262,7 @@ bool Direct3D::Initialize(int screenWidth, int screenHeight, bool vsync, HWND hw
     ID3D11Texture2D* pBackBuffer;
 
     D3D11_TEXTURE2D_DESC            depthBufferDesc;
-    D3D11_DEPTH_STENCIL_DESC        depthStencilDesc;
     D3D11_DEPTH_STENCIL_VIEW_DESC   depthStencilViewDesc;
-    D3D11_RASTERIZER_DESC           rasterDesc;
-    D3D11_VIEWPORT                  viewport;
-
-    float fieldOfView;
-    float screenAspect;
-
-    // Store the vsync setting.
-    m_vsyncEnabled = vsync;
 
     // Getting the refesh rate from the video card/monitor.
     // If we just set the refresh rate to a default value which may not exist on all computers then
@@ -130,6 +324,9 @@ bool Direct3D::Initialize(int screenWidth, int screenHeight, bool vsync, HWND hw
                 }
             }
         }
+
+        // The frame pacer needs the refresh period, assume 60Hz when no mode matched.
+        m_refreshSeconds = (numerator > 0) ? (static_cast<double>(denominator) / numerator) : (1.0 / 60.0);
     }
 
     // Retriving the name of the video card and the amount of video memory.
@@ -188,7 +385,8 @@ bool Direct3D::Initialize(int screenWidth, int screenHeight, bool vsync, HWND hw
         swapChainDesc.BufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
 
         // Set the refesh rate of the back buffer.
-        if (m_vsyncEnabled)
+        // Only the modes that present on the vertical blank need the real one.
+        if (m_pacingSettings.m_mode == PacingMode::VSync || m_pacingSettings.m_mode == PacingMode::JustInTime)
         {
             swapChainDesc.BufferDesc.RefreshRate.Numerator = numerator;
             swapChainDesc.BufferDesc.RefreshRate.Denominator = denominator;
@@ -302,44 +500,6 @@ bool Direct3D::Initialize(int screenWidth, int screenHeight, bool vsync, HWND hw
         }
     }
 
-    // Setup the depth stencil description.
-    // This allows us to control what type of depth test Direct3D will do for each pixel.
-    {
-        // Initialize the description of the stencil state.
-        ZeroMemory(&depthStencilDesc, sizeof(depthStencilDesc));
-
-        // Set up the description of the stencil state.
-        depthStencilDesc.DepthEnable = true;
-        depthStencilDesc.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ALL;
-        depthStencilDesc.DepthFunc = D3D11_COMPARISON_LESS;
-
-        depthStencilDesc.StencilEnable = true;
-        depthStencilDesc.StencilReadMask = 0xFF;
-        depthStencilDesc.StencilWriteMask = 0xFF;
-
-        // Stencil operation if pixel is front-facing.
-        depthStencilDesc.FrontFace.StencilFailOp = D3D11_STENCIL_OP_KEEP;
-        depthStencilDesc.FrontFace.StencilDepthFailOp = D3D11_STENCIL_OP_INCR;
-        depthStencilDesc.FrontFace.StencilPassOp = D3D11_STENCIL_OP_KEEP;
-        depthStencilDesc.FrontFace.StencilFunc = D3D11_COMPARISON_ALWAYS;
-
-        // Stencil operations if pixel is back-facing.
-        depthStencilDesc.BackFace.StencilFailOp = D3D11_STENCIL_OP_KEEP;
-        depthStencilDesc.BackFace.StencilDepthFailOp = D3D11_STENCIL_OP_DECR;
-        depthStencilDesc.BackFace.StencilPassOp = D3D11_STENCIL_OP_KEEP;
-        depthStencilDesc.BackFace.StencilFunc = D3D11_COMPARISON_ALWAYS;
-
-        // Create the depth stencil state.
-        result = m_pDevice->CreateDepthStencilState(&depthStencilDesc, &m_pDepthStencilState);
-        if (FAILED(result))
-        {
-            return false;
-        }
-
-        // Set the depth stencil state.
-        m_pDeviceContext->OMSetDepthStencilState(m_pDepthStencilState, 1);
-    }
-
     // Create the desription of the view of the depth stencil buffer.
     // This process is required so that Direct3D knows to use the depth buffer as a depth stencil texture.
     {
@@ -357,89 +517,58 @@ bool Direct3D::Initialize(int screenWidth, int screenHeight, bool vsync, HWND hw
         {
             return false;
         }
-
-        // [ OMSetRenderTarget ] : Binds the render target view and the depth stencil buffer to the output render pipeline.
-        // This way the graphics that the pipeline renders will get drawn to our back buffer that we previously created. 
-        // With the graphics written to the back buffer we can then swap it to the front and display our graphics on the user's screen.
-        m_pDeviceContext->OMSetRenderTargets(1, &m_pRenderTargetView, m_pDepthStencilView);
     }
 
-    // Create Extras.
+    // The constant upload ring binds windows of one buffer and writes to it while earlier frames are in flight.
+    // Both need the Direct3D 11.1 runtime and support in the driver, without them every draw maps a buffer of its own.
     {
-        // Setup the raster description which will determine how and what polygons will be drawn.
-        {
-            // This allows us to control over how polygons are rendered.
-            // Like making our scenes render in wireframe mode or have DirectX draw both the front and back faces of polygons.
-            // By default, DirectX already has a resterizer state set up and working the exact same as the one below.
-            rasterDesc.AntialiasedLineEnable = false;
-            rasterDesc.CullMode = D3D11_CULL_BACK;
-            rasterDesc.DepthBias = 0;
-            rasterDesc.DepthBiasClamp = 0.0f;
-            rasterDesc.DepthClipEnable = true;
-            rasterDesc.FillMode = D3D11_FILL_SOLID;
-            rasterDesc.FrontCounterClockwise = false;
-            rasterDesc.MultisampleEnable = false;
-            rasterDesc.ScissorEnable = false;
-            rasterDesc.SlopeScaledDepthBias = 0.0f;
+        D3D11_FEATURE_DATA_D3D11_OPTIONS options;
+        ZeroMemory(&options, sizeof(options));
 
-            // Create the rasterizer state from the description we just filled out.
-            result = m_pDevice->CreateRasterizerState(&rasterDesc, &m_pRasterState);
-            if (FAILED(result))
-            {
-                return false;
-            }
-
-            // Now set the rasterizer state.
-            m_pDeviceContext->RSSetState(m_pRasterState);
-        }
-
-        // Setup the viewport for rendering.
+        // The 11.0 runtime has neither the interface nor the options.
+        result = m_pDeviceContext->QueryInterface(__uuidof(ID3D11DeviceContext1), reinterpret_cast<void**>(&m_pDeviceContext1));
+        if (FAILED(result))
         {
-            // This allows Direct3D can map clip space coordinates to the render target space.
-            // Set this to be the entire size of th window.
-            viewport.Width = static_cast<float>(screenWidth);
-            viewport.Height = static_cast<float>(screenHeight);
-            viewport.MinDepth = 0.0f;
-            viewport.MaxDepth = 1.0f;
-            viewport.TopLeftX = 0.0f;
-            viewport.TopLeftY = 0.0f;
-
-            // Create the viewport.
-            m_pDeviceContext->RSSetViewports(1, &viewport);
+            m_pDeviceContext1 = nullptr;
         }
 
-        // Setup the projection matrix.
-        {
-            // This is sued to translate the 3D scene into the 2D viewport space.
-            // We will need to keep a copy of this matrix sothat we can pass it to our shaders that will be used to render our scenes.
-            fieldOfView = 3.141592654f / 4.0f;
-            screenAspect = static_cast<float>(screenWidth) / static_cast<float>(screenHeight);
+        result = m_pDevice->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options));
+        m_constantBufferOffsetting = m_pDeviceContext1 && SUCCEEDED(result) && options.ConstantBufferOffsetting && options.MapNoOverwriteOnDynamicConstantBuffer;
+    }
 
-            // Create the projection matrix for 3D rendering.
-            m_projectionMatrix = XMMatrixPerspectiveFovLH(fieldOfView, screenAspect, screenNear, screenDepth);
-        }
+    // Wrap the device and device context so the rest of the engine doesn't care which backend it runs on.
+    m_pRenderDevice = std::make_unique<D3D11RenderDevice>(m_pDevice);
+    m_pRenderContext = std::make_unique<D3D11RenderContext>(m_pDeviceContext, m_pDeviceContext1);
 
-        // Setup the world matrix.
-        {
-            // This is used to conver the vertices of our objects into vertices in the 3D scene.
-            // This is also used to rotate, translate, and scale our objects in 3D space.
-            // Copy of this will be needed to be passed to the shaders for rendering also.
+    return true;
+}
 
-            // Initialize the world matrix to the identity matrix.
-            // The view matrix is used to calculate the position of where we are looing at the scene from.
-            // You can think of it as a camera and you only view the scene through this camera.
-            m_worldMatrix = XMMatrixIdentity();
-        }
+// Creates the CPU device and context.
+// There is no swap chain, the software context owns its color and depth buffers
+// and the null context doesn't draw anything at all.
+bool Direct3D::InitializeSoftwareDevice(RenderBackend backend, JobSystem* pJobSystem, int screenWidth, int screenHeight)
+{
+    m_pRenderDevice = std::make_unique<SoftwareRenderDevice>(backend);
 
-        // Setup an orthographics projection matrix.
-        {
-            // This matrix is used for rendering 2D elements like user interfaces on the screen allowing us to skip the 3D rendering.
+    if (backend == RenderBackend::Null)
+    {
+        std::unique_ptr<NullRenderContext> pNullContext = std::make_unique<NullRenderContext>();
+        m_pNullRenderContext = pNullContext.get();
+        m_pRenderContext = std::move(pNullContext);
 
-            // Create an orthographics projection matrix for 2D rendering.
-            m_orthoMatrix = XMMatrixOrthographicLH(static_cast<float>(screenWidth), static_cast<float>(screenHeight), screenNear, screenDepth);
-        }
+        strcpy_s(m_videoCardDescription, 128, "Null Device");
+    }
+    else
+    {
+        std::unique_ptr<SoftwareRenderContext> pSoftwareContext = std::make_unique<SoftwareRenderContext>(screenWidth, screenHeight, pJobSystem);
+        m_pSoftwareRenderContext = pSoftwareContext.get();
+        m_pRenderContext = std::move(pSoftwareContext);
+
+        strcpy_s(m_videoCardDescription, 128, "Software Rasterizer");
     }
 
+    m_videoCardMemory = 0;
+
     return true;
 }
 
@@ -460,6 +589,19 @@ void Direct3D::Shutdown()
         m_pRasterState = 0;
     }
 
+    m_pPresentClock.reset();
+    m_pPresentClock = nullptr;
+
+    // Release the backend wrappers. On hardware they don't own the device and context released below.
+    m_pSoftwareRenderContext = nullptr;
+    m_pNullRenderContext = nullptr;
+    m_constantUploadRing.Shutdown();
+    m_pStateTrackingContext.reset();
+    m_pStateTrackingContext = nullptr;
+    m_stateObjectCache.Shutdown();
+    m_pRenderContext.reset();
+    m_pRenderDevice.reset();
+
     if (m_pDepthStencilView)
     {
         m_pDepthStencilView->Release();
@@ -484,6 +626,12 @@ void Direct3D::Shutdown()
         m_pRenderTargetView = 0;
     }
 
+    if (m_pDeviceContext1)
+    {
+        m_pDeviceContext1->Release();
+        m_pDeviceContext1 = 0;
+    }
+
     if (m_pDeviceContext)
     {
         m_pDeviceContext->Release();
@@ -505,6 +653,8 @@ void Direct3D::Shutdown()
 
 void Direct3D::BeginScene(float red, float green, float blue, float alpha)
 {
+    PROFILE_SCOPE("Direct3D::BeginScene");
+
     float color[4];
 
     // Setup the color to clear the buffer to.
@@ -514,36 +664,93 @@ void Direct3D::BeginScene(float red, float green, float blue, float alpha)
     color[3] = alpha;
 
     // Clear the back buffer.
-    m_pDeviceContext->ClearRenderTargetView(m_pRenderTargetView, color);
+    m_pStateTrackingContext->ClearRenderTargetView(m_pRenderTargetView, color);
 
     // Clear the depth buffer.
-    m_pDeviceContext->ClearDepthStencilView(m_pDepthStencilView, D3D11_CLEAR_DEPTH, 1.0f, 0);
+    m_pStateTrackingContext->ClearDepthStencilView(m_pDepthStencilView, D3D11_CLEAR_DEPTH, 1.0f, 0);
+
+    RenderStats::AddClears(2);
+
+    // Executed command lists can leave the device context in its default state.
+    // When nothing changed the state tracker drops these.
+    BindRenderTargets(m_pStateTrackingContext.get());
+}
+
+// The state every draw of the frame starts from. Command lists start from the default
+// state, not from what the device context has bound, and put this on themselves.
+void Direct3D::BindRenderTargets(RenderContext* pDeviceContext)
+{
+    pDeviceContext->OMSetRenderTargets(1, &m_pRenderTargetView, m_pDepthStencilView);
+    pDeviceContext->OMSetDepthStencilState(m_pDepthStencilState, 1);
+    pDeviceContext->RSSetState(m_pRasterState);
+    pDeviceContext->RSSetViewports(1, &m_viewport);
+
+    // Render targets, depth stencil state, rasterizer state and viewport.
+    RenderStats::AddStateBinds(4);
 }
 
 // Tells the swap chain to display our 3d scene once all the drawing has completed at the end of each frame.
+// The frame pacer decides whether to wait for the vertical blank.
 void Direct3D::EndScene()
 {
-    // Present the back buffer to the screen since rendering is complete.
-    if (m_vsyncEnabled)
+    PROFILE_SCOPE("Direct3D::EndScene");
+
+    // The frame's constants can't be overwritten until the GPU got past this point.
+    m_constantUploadRing.EndFrame(m_pStateTrackingContext.get());
+
+    // Without a swap chain the frame is finished by flushing the CPU context.
+    if (!m_pSwapChain)
     {
-        // Lock to screen refesh rate.
-        m_pSwapChain->Present(1, 0);
+        m_pStateTrackingContext->Flush();
     }
-    else
+
+    // The null backend's counters are kept per frame.
+    if (m_pNullRenderContext)
     {
-        // Presnt as fast as possible.
-        m_pSwapChain->Present(0, 0);
+        m_pNullRenderContext->EndFrame();
     }
+
+    m_framePacer.EndFrame();
+}
+
+void Direct3D::BeginFrame()
+{
+    m_framePacer.BeginFrame();
+}
+
+const FramePacer& Direct3D::GetFramePacer() const
+{
+    return m_framePacer;
+}
+
+StateObjectCache& Direct3D::GetStateObjectCache()
+{
+    return m_stateObjectCache;
+}
+
+ConstantUploadRing& Direct3D::GetConstantUploadRing()
+{
+    return m_constantUploadRing;
+}
+
+RenderDevice* Direct3D::GetDevice()
+{
+    return m_pRenderDevice.get();
+}
+
+RenderContext* Direct3D::GetDeviceContext()
+{
+    return m_pStateTrackingContext.get();
 }
 
-ID3D11Device* Direct3D::GetDevice()
+SoftwareRenderContext* Direct3D::GetSoftwareRenderContext()
 {
-    return m_pDevice;
+    return m_pSoftwareRenderContext;
 }
 
-ID3D11DeviceContext* Direct3D::GetDeviceContext()
+NullRenderContext* Direct3D::GetNullRenderContext()
 {
-    return m_pDeviceContext;
+    return m_pNullRenderContext;
 }
 
 void Direct3D::GetProjectionMatrix(DirectX::XMMATRIX& projectionMatrix)
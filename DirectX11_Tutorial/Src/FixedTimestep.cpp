@@ -0,0 +1,109 @@
+//////////////////////////////////////////////////////////////////////
+// Filename: FixedTimestep.cpp
+//////////////////////////////////////////////////////////////////////
+#include <algorithm>
+
+#include "System/FixedTimestep.h"
+
+FixedTimestep::FixedTimestep()
+    : m_stepSeconds(1.0 / 120.0)
+    , m_maxStepsPerFrame(8)
+    , m_frameSeconds(0.0)
+    , m_accumulatedSeconds(0.0)
+    , m_started(false)
+    , m_stepCount(0)
+    , m_stepCostTotalSeconds(0.0)
+    , m_stepCostMaxSeconds(0.0)
+    , m_droppedSeconds(0.0)
+{
+}
+
+void FixedTimestep::Initialize(double stepSeconds, unsigned int maxStepsPerFrame)
+{
+    m_stepSeconds = stepSeconds;
+    m_maxStepsPerFrame = std::max(1u, maxStepsPerFrame);
+
+    m_accumulatedSeconds = 0.0;
+    m_started = false;
+
+    m_stepCount = 0;
+    m_stepCostTotalSeconds = 0.0;
+    m_stepCostMaxSeconds = 0.0;
+    m_droppedSeconds = 0.0;
+}
+
+void FixedTimestep::SetFrameSeconds(double frameSeconds)
+{
+    m_frameSeconds = std::max(0.0, frameSeconds);
+}
+
+unsigned int FixedTimestep::Advance()
+{
+    Clock::time_point now = Clock::now();
+
+    // The first call only starts the clock.
+    if (!m_started)
+    {
+        m_lastTime = now;
+        m_started = true;
+        return 0;
+    }
+
+    if (m_frameSeconds > 0.0)
+    {
+        m_accumulatedSeconds += m_frameSeconds;
+    }
+    else
+    {
+        m_accumulatedSeconds += std::chrono::duration<double>(now - m_lastTime).count();
+    }
+    m_lastTime = now;
+
+    unsigned int steps = static_cast<unsigned int>(m_accumulatedSeconds / m_stepSeconds);
+    if (steps > m_maxStepsPerFrame)
+    {
+        double dropped = (steps - m_maxStepsPerFrame) * m_stepSeconds;
+        m_droppedSeconds += dropped;
+        m_accumulatedSeconds -= dropped;
+        steps = m_maxStepsPerFrame;
+    }
+
+    m_accumulatedSeconds -= steps * m_stepSeconds;
+
+    return steps;
+}
+
+double FixedTimestep::GetStepSeconds() const
+{
+    return m_stepSeconds;
+}
+
+float FixedTimestep::GetAlpha() const
+{
+    return static_cast<float>(std::min(1.0, m_accumulatedSeconds / m_stepSeconds));
+}
+
+void FixedTimestep::BeginStep()
+{
+    m_stepStartTime = Clock::now();
+}
+
+void FixedTimestep::EndStep()
+{
+    double cost = std::chrono::duration<double>(Clock::now() - m_stepStartTime).count();
+
+    ++m_stepCount;
+    m_stepCostTotalSeconds += cost;
+    m_stepCostMaxSeconds = std::max(m_stepCostMaxSeconds, cost);
+}
+
+FixedTimestepStats FixedTimestep::GetStats() const
+{
+    FixedTimestepStats stats;
+    stats.m_stepCount = m_stepCount;
+    stats.m_stepSeconds = m_stepSeconds;
+    stats.m_averageStepCostSeconds = (m_stepCount > 0) ? (m_stepCostTotalSeconds / m_stepCount) : 0.0;
+    stats.m_maxStepCostSeconds = m_stepCostMaxSeconds;
+    stats.m_droppedSeconds = m_droppedSeconds;
+    return stats;
+}
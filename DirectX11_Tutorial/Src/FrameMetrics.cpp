@@ -0,0 +1,237 @@
+//////////////////////////////////////////////////////////////////////
+// Filename: FrameMetrics.cpp
+//////////////////////////////////////////////////////////////////////
+#include <cstdio>
+
+#include "System/FrameMetrics.h"
+
+namespace
+{
+    // How quickly the recent average a stutter is measured against follows the frames.
+    constexpr double kRecentAverageSmoothing = 0.05;
+
+    void WritePrometheusSeries(FILE* pFile, const char* pName, const char* pHelp, const FrameTimeSummary& kSummary)
+    {
+        fprintf(pFile, "# HELP %s_seconds %s\n", pName, pHelp);
+        fprintf(pFile, "# TYPE %s_seconds summary\n", pName);
+        fprintf(pFile, "%s_seconds{quantile=\"0.5\"} %.6f\n", pName, kSummary.m_p50Seconds);
+        fprintf(pFile, "%s_seconds{quantile=\"0.95\"} %.6f\n", pName, kSummary.m_p95Seconds);
+        fprintf(pFile, "%s_seconds{quantile=\"0.99\"} %.6f\n", pName, kSummary.m_p99Seconds);
+        fprintf(pFile, "%s_seconds{quantile=\"0.999\"} %.6f\n", pName, kSummary.m_p999Seconds);
+        fprintf(pFile, "%s_seconds_sum %.6f\n", pName, kSummary.m_meanSeconds * kSummary.m_count);
+        fprintf(pFile, "%s_seconds_count %llu\n", pName, static_cast<unsigned long long>(kSummary.m_count));
+        fprintf(pFile, "# HELP %s_max_seconds Longest so far.\n", pName);
+        fprintf(pFile, "# TYPE %s_max_seconds gauge\n", pName);
+        fprintf(pFile, "%s_max_seconds %.6f\n", pName, kSummary.m_maxSeconds);
+        fprintf(pFile, "# HELP %s_stutters_total Times over %.1fx the recent average.\n", pName, STUTTER_FACTOR);
+        fprintf(pFile, "# TYPE %s_stutters_total counter\n", pName);
+        fprintf(pFile, "%s_stutters_total %llu\n", pName, static_cast<unsigned long long>(kSummary.m_stutterCount));
+    }
+
+    void WriteCsvSeries(FILE* pFile, const FrameTimeSummary& kSummary)
+    {
+        fprintf(pFile, ",%llu,%.4f,%.4f,%.4f,%.4f,%.4f,%llu", static_cast<unsigned long long>(kSummary.m_count),
+            kSummary.m_p50Seconds * 1000.0, kSummary.m_p95Seconds * 1000.0, kSummary.m_p99Seconds * 1000.0,
+            kSummary.m_p999Seconds * 1000.0, kSummary.m_maxSeconds * 1000.0, static_cast<unsigned long long>(kSummary.m_stutterCount));
+    }
+}
+
+void FrameMetrics::Series::Record(double seconds)
+{
+    if (m_histogram.GetCount() > 0 && seconds > STUTTER_FLOOR_SECONDS && seconds > m_recentAverageSeconds * STUTTER_FACTOR)
+    {
+        ++m_stutterCount;
+    }
+
+    m_recentAverageSeconds = (m_histogram.GetCount() > 0) ? (m_recentAverageSeconds + (seconds - m_recentAverageSeconds) * kRecentAverageSmoothing) : seconds;
+    m_histogram.Record(seconds);
+}
+
+FrameTimeSummary FrameMetrics::Series::Summarize() const
+{
+    FrameTimeSummary summary;
+    summary.m_count = m_histogram.GetCount();
+    summary.m_p50Seconds = m_histogram.GetPercentileSeconds(50.0);
+    summary.m_p95Seconds = m_histogram.GetPercentileSeconds(95.0);
+    summary.m_p99Seconds = m_histogram.GetPercentileSeconds(99.0);
+    summary.m_p999Seconds = m_histogram.GetPercentileSeconds(99.9);
+    summary.m_meanSeconds = m_histogram.GetMeanSeconds();
+    summary.m_maxSeconds = m_histogram.GetMaxSeconds();
+    summary.m_stutterCount = m_stutterCount;
+    return summary;
+}
+
+FrameMetrics::FrameMetrics()
+    : m_startTime(std::chrono::steady_clock::now())
+{
+    m_frame.m_recentAverageSeconds = 0.0;
+    m_frame.m_stutterCount = 0;
+    m_update.m_recentAverageSeconds = 0.0;
+    m_update.m_stutterCount = 0;
+    m_submit.m_recentAverageSeconds = 0.0;
+    m_submit.m_stutterCount = 0;
+}
+
+void FrameMetrics::Record(double frameSeconds, double updateSeconds, double submitSeconds)
+{
+    m_frame.Record(frameSeconds);
+    m_update.Record(updateSeconds);
+    m_submit.Record(submitSeconds);
+}
+
+FrameMetricsSnapshot FrameMetrics::GetSnapshot() const
+{
+    FrameMetricsSnapshot snapshot;
+    snapshot.m_uptimeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_startTime).count();
+    snapshot.m_frame = m_frame.Summarize();
+    snapshot.m_update = m_update.Summarize();
+    snapshot.m_submit = m_submit.Summarize();
+    return snapshot;
+}
+
+MetricsExporter::MetricsExporter()
+    : m_pJobSystem(nullptr)
+    , m_format(MetricsFormat::Prometheus)
+    , m_writeRunning(false)
+{
+}
+
+MetricsExporter::~MetricsExporter()
+{
+}
+
+bool MetricsExporter::Initialize(const std::string& kFileName, MetricsFormat format, double intervalSeconds, JobSystem* pJobSystem)
+{
+    m_pJobSystem = pJobSystem;
+    m_fileName = kFileName;
+    m_format = format;
+    m_interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(intervalSeconds));
+    m_nextExportTime = std::chrono::steady_clock::now() + m_interval;
+
+    // Start the CSV over with its header, a failure here means the file can't be written at all.
+    if (m_format == MetricsFormat::Csv)
+    {
+        FILE* pFile = nullptr;
+        if (fopen_s(&pFile, m_fileName.c_str(), "w") != 0 || !pFile)
+        {
+            return false;
+        }
+
+        fputs("uptime_s", pFile);
+        const char* kSeriesNames[] = { "frame", "update", "submit" };
+        for (const char* pName : kSeriesNames)
+        {
+            fprintf(pFile, ",%s_count,%s_p50_ms,%s_p95_ms,%s_p99_ms,%s_p999_ms,%s_max_ms,%s_stutters", pName, pName, pName, pName, pName, pName, pName);
+        }
+        fputs("\n", pFile);
+        fclose(pFile);
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------
+// Waits for the export in flight and writes the final values.
+//-----------------------------------------------------------------
+void MetricsExporter::Shutdown(const FrameMetrics& kMetrics)
+{
+    if (m_writeRunning)
+    {
+        m_pJobSystem->Wait(m_writeCounter);
+        m_writeRunning = false;
+    }
+
+    Write(kMetrics.GetSnapshot());
+}
+
+void MetricsExporter::Update(const FrameMetrics& kMetrics)
+{
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (now < m_nextExportTime)
+    {
+        return;
+    }
+
+    if (m_writeRunning)
+    {
+        if (!m_writeCounter.IsDone())
+        {
+            return;
+        }
+
+        m_pJobSystem->Wait(m_writeCounter);
+        m_writeRunning = false;
+    }
+
+    m_pendingSnapshot = kMetrics.GetSnapshot();
+    m_nextExportTime = now + m_interval;
+
+    Job job;
+    job.m_pFunction = &MetricsExporter::WriteJob;
+    job.m_pData = this;
+
+    m_writeRunning = true;
+    m_pJobSystem->Run(&job, 1, &m_writeCounter);
+}
+
+void MetricsExporter::WriteJob(void* pData)
+{
+    MetricsExporter* pExporter = static_cast<MetricsExporter*>(pData);
+    pExporter->Write(pExporter->m_pendingSnapshot);
+}
+
+bool MetricsExporter::Write(const FrameMetricsSnapshot& kSnapshot)
+{
+    if (m_format == MetricsFormat::Csv)
+    {
+        return WriteCsv(kSnapshot);
+    }
+
+    return WritePrometheus(kSnapshot);
+}
+
+//-----------------------------------------------------------------
+// Writes a temporary file and moves it over the old one, so a
+// collector never reads a half written file.
+//-----------------------------------------------------------------
+bool MetricsExporter::WritePrometheus(const FrameMetricsSnapshot& kSnapshot)
+{
+    std::string temporaryName = m_fileName + ".tmp";
+
+    FILE* pFile = nullptr;
+    if (fopen_s(&pFile, temporaryName.c_str(), "w") != 0 || !pFile)
+    {
+        return false;
+    }
+
+    fputs("# HELP uptime_seconds Time since the metrics started.\n", pFile);
+    fputs("# TYPE uptime_seconds gauge\n", pFile);
+    fprintf(pFile, "uptime_seconds %.3f\n", kSnapshot.m_uptimeSeconds);
+
+    WritePrometheusSeries(pFile, "frame_time", "Time from the end of one frame to the end of the next.", kSnapshot.m_frame);
+    WritePrometheusSeries(pFile, "update_time", "Scene update of a frame.", kSnapshot.m_update);
+    WritePrometheusSeries(pFile, "submit_time", "Render submission of a frame, without the wait in Present.", kSnapshot.m_submit);
+
+    fclose(pFile);
+
+    remove(m_fileName.c_str());
+    return rename(temporaryName.c_str(), m_fileName.c_str()) == 0;
+}
+
+bool MetricsExporter::WriteCsv(const FrameMetricsSnapshot& kSnapshot)
+{
+    FILE* pFile = nullptr;
+    if (fopen_s(&pFile, m_fileName.c_str(), "a") != 0 || !pFile)
+    {
+        return false;
+    }
+
+    fprintf(pFile, "%.3f", kSnapshot.m_uptimeSeconds);
+    WriteCsvSeries(pFile, kSnapshot.m_frame);
+    WriteCsvSeries(pFile, kSnapshot.m_update);
+    WriteCsvSeries(pFile, kSnapshot.m_submit);
+    fputs("\n", pFile);
+
+    fclose(pFile);
+    return true;
+}
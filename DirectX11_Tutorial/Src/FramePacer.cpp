@@ -0,0 +1,167 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: FramePacer.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include <algorithm>
+
+#include "Graphics/FramePacer.h"
+#include "System/Profiler.h"
+
+namespace
+{
+    // Just in time starts a frame this much earlier than its cost estimate says it has to.
+    constexpr double kJustInTimeCostScale = 1.2;
+    constexpr double kJustInTimeMarginSeconds = 0.001;
+
+    // How fast the cost estimate follows cheaper frames. A more expensive one is taken at once.
+    constexpr double kFrameCostSmoothing = 0.1;
+
+    double Seconds(std::chrono::steady_clock::duration duration)
+    {
+        return std::chrono::duration<double>(duration).count();
+    }
+}
+
+FramePacer::FramePacer()
+    : m_pPresentClock(nullptr)
+    , m_settings{ PacingMode::Uncapped, 0.0, 1, 60.0 }
+    , m_hasPresented(false)
+    , m_frameCostSeconds(0.0)
+    , m_lastFrameTiming{ 0.0, 0.0, 0, 0.0, 0.0 }
+    , m_frameCount(0)
+    , m_frameTimeMean(0.0)
+    , m_frameTimeM2(0.0)
+    , m_latencyFrameCount(0)
+    , m_latencyTotalSeconds(0.0)
+    , m_latencyMaxSeconds(0.0)
+{
+}
+
+FramePacer::FramePacer(const FramePacer&)
+{
+}
+
+FramePacer::~FramePacer()
+{
+}
+
+void FramePacer::Initialize(PresentClock* pPresentClock, const FramePacingSettings& kSettings)
+{
+    m_pPresentClock = pPresentClock;
+    m_settings = kSettings;
+
+    m_frameStartTime = Clock::now();
+    m_hasPresented = false;
+    m_frameCostSeconds = 0.0;
+}
+
+//-----------------------------------------------------------------
+// Waits until the next frame is allowed to start.
+//
+//  - Frame cap: one frame interval after the last frame started.
+//  - Just in time: the estimated frame cost before the first blank
+//    the frame can still make.
+//-----------------------------------------------------------------
+void FramePacer::BeginFrame()
+{
+    PROFILE_SCOPE("FramePacer::BeginFrame");
+
+    Clock::time_point now = Clock::now();
+    Clock::time_point startTime = now;
+
+    if (m_settings.m_mode == PacingMode::FrameCap && m_settings.m_frameCapHz > 0.0)
+    {
+        startTime = m_frameStartTime + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / m_settings.m_frameCapHz));
+    }
+    else if (m_settings.m_mode == PacingMode::JustInTime && m_hasPresented)
+    {
+        double refreshSeconds = m_pPresentClock->GetRefreshSeconds();
+        if (refreshSeconds > 0.0)
+        {
+            double budgetSeconds = m_frameCostSeconds * kJustInTimeCostScale + kJustInTimeMarginSeconds;
+
+            // The blank after the last frame's, or the first one after it still far enough away.
+            double blankOffset = Seconds(m_lastDisplayTime - now) + refreshSeconds;
+            while (blankOffset - budgetSeconds < 0.0)
+            {
+                blankOffset += refreshSeconds;
+            }
+
+            startTime = now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(blankOffset - budgetSeconds));
+        }
+    }
+
+    if (startTime > now)
+    {
+        PresentClock::SleepUntil(startTime);
+    }
+
+    m_frameStartTime = Clock::now();
+    m_lastFrameTiming.m_waitSeconds = Seconds(m_frameStartTime - now);
+}
+
+//-----------------------------------------------------------------
+// Presents the frame and records its timing.
+//-----------------------------------------------------------------
+void FramePacer::EndFrame()
+{
+    PROFILE_SCOPE("FramePacer::EndFrame");
+
+    Clock::time_point submitTime = Clock::now();
+
+    double frameCost = Seconds(submitTime - m_frameStartTime);
+    if (frameCost > m_frameCostSeconds)
+    {
+        m_frameCostSeconds = frameCost;
+    }
+    else
+    {
+        m_frameCostSeconds += (frameCost - m_frameCostSeconds) * kFrameCostSmoothing;
+    }
+
+    unsigned int syncInterval = (m_settings.m_mode == PacingMode::VSync || m_settings.m_mode == PacingMode::JustInTime) ? 1 : 0;
+    Clock::time_point displayTime = m_pPresentClock->Present(syncInterval);
+    Clock::time_point presentTime = Clock::now();
+
+    m_lastFrameTiming.m_presentSeconds = Seconds(presentTime - submitTime);
+
+    m_lastFrameTiming.m_queuedLatencySeconds = std::max(0.0, Seconds(displayTime - submitTime));
+    m_lastFrameTiming.m_queuedFrames = m_pPresentClock->GetQueuedFrameCount();
+    m_lastFrameTiming.m_frameSeconds = m_hasPresented ? Seconds(presentTime - m_lastPresentTime) : 0.0;
+
+    if (m_hasPresented)
+    {
+        ++m_frameCount;
+        double delta = m_lastFrameTiming.m_frameSeconds - m_frameTimeMean;
+        m_frameTimeMean += delta / m_frameCount;
+        m_frameTimeM2 += delta * (m_lastFrameTiming.m_frameSeconds - m_frameTimeMean);
+    }
+
+    ++m_latencyFrameCount;
+    m_latencyTotalSeconds += m_lastFrameTiming.m_queuedLatencySeconds;
+    m_latencyMaxSeconds = std::max(m_latencyMaxSeconds, m_lastFrameTiming.m_queuedLatencySeconds);
+
+    m_lastPresentTime = presentTime;
+    m_lastDisplayTime = displayTime;
+    m_hasPresented = true;
+}
+
+PacingMode FramePacer::GetMode() const
+{
+    return m_settings.m_mode;
+}
+
+const FramePacingTiming& FramePacer::GetLastFrameTiming() const
+{
+    return m_lastFrameTiming;
+}
+
+FramePacingStats FramePacer::GetStats() const
+{
+    FramePacingStats stats;
+    stats.m_frameCount = m_frameCount;
+    stats.m_averageFrameSeconds = m_frameTimeMean;
+    stats.m_frameTimeVariance = (m_frameCount > 1) ? (m_frameTimeM2 / (m_frameCount - 1)) : 0.0;
+    stats.m_averageQueuedLatencySeconds = (m_latencyFrameCount > 0) ? (m_latencyTotalSeconds / m_latencyFrameCount) : 0.0;
+    stats.m_maxQueuedLatencySeconds = m_latencyMaxSeconds;
+    return stats;
+}
@@ -0,0 +1,346 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: FrustumCuller.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#include "Graphics/FrustumCuller.h"
+#include "System/Profiler.h"
+
+// AVX when the build targets it (/arch:AVX or /arch:AVX2), SSE on every other x86 and x64 build.
+#if defined(__AVX__)
+#include <immintrin.h>
+#define FRUSTUM_CULLER_USE_AVX 1
+#define FRUSTUM_CULLER_USE_SSE 0
+#elif defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <xmmintrin.h>
+#define FRUSTUM_CULLER_USE_AVX 0
+#define FRUSTUM_CULLER_USE_SSE 1
+#else
+#define FRUSTUM_CULLER_USE_AVX 0
+#define FRUSTUM_CULLER_USE_SSE 0
+#endif
+
+using namespace DirectX;
+
+namespace
+{
+    // What a plane is tested with: its normal, the normal's absolute value for the box and its distance.
+    struct CullPlane
+    {
+        float m_normalX;
+        float m_normalY;
+        float m_normalZ;
+        float m_absNormalX;
+        float m_absNormalY;
+        float m_absNormalZ;
+        float m_distance;
+    };
+
+    void PrepareCullPlanes(const Frustum& kFrustum, CullPlane* pPlanes)
+    {
+        for (unsigned int i = 0; i < Frustum::PlaneCount; ++i)
+        {
+            const XMFLOAT4& kPlane = kFrustum.m_planes[i];
+            pPlanes[i].m_normalX = kPlane.x;
+            pPlanes[i].m_normalY = kPlane.y;
+            pPlanes[i].m_normalZ = kPlane.z;
+            pPlanes[i].m_absNormalX = fabsf(kPlane.x);
+            pPlanes[i].m_absNormalY = fabsf(kPlane.y);
+            pPlanes[i].m_absNormalZ = fabsf(kPlane.z);
+            pPlanes[i].m_distance = kPlane.w;
+        }
+    }
+}
+
+FrustumCuller::FrustumCuller()
+    : m_count(0)
+    , m_stats()
+{
+}
+
+//-----------------------------------------------------------------
+// A point is inside when its clip space x, y and z satisfy -w <= x <= w,
+// -w <= y <= w and 0 <= z <= w. With row vectors clip = p * M, so every
+// clip coordinate is p dotted with a column of M and each inequality is
+// a plane made of two columns.
+//-----------------------------------------------------------------
+Frustum FrustumCuller::ExtractFrustum(FXMMATRIX viewProjection)
+{
+    XMMATRIX columns = XMMatrixTranspose(viewProjection);
+
+    XMVECTOR planes[Frustum::PlaneCount];
+    planes[Frustum::Left] = XMVectorAdd(columns.r[3], columns.r[0]);
+    planes[Frustum::Right] = XMVectorSubtract(columns.r[3], columns.r[0]);
+    planes[Frustum::Bottom] = XMVectorAdd(columns.r[3], columns.r[1]);
+    planes[Frustum::Top] = XMVectorSubtract(columns.r[3], columns.r[1]);
+    planes[Frustum::Near] = columns.r[2];
+    planes[Frustum::Far] = XMVectorSubtract(columns.r[3], columns.r[2]);
+
+    Frustum frustum;
+    for (unsigned int i = 0; i < Frustum::PlaneCount; ++i)
+    {
+        XMStoreFloat4(&frustum.m_planes[i], XMPlaneNormalize(planes[i]));
+    }
+
+    return frustum;
+}
+
+void FrustumCuller::Reserve(unsigned int count)
+{
+    unsigned int padded = (count + kLaneCount - 1) / kLaneCount * kLaneCount;
+    for (std::vector<float>* pArray : { &m_centerX, &m_centerY, &m_centerZ, &m_extentX, &m_extentY, &m_extentZ, &m_radius })
+    {
+        pArray->reserve(padded);
+    }
+}
+
+void FrustumCuller::Clear()
+{
+    Resize(0);
+}
+
+uint32_t FrustumCuller::Add(const XMFLOAT3& kCenter, const XMFLOAT3& kExtents)
+{
+    uint32_t index = m_count;
+    Resize(m_count + 1);
+    Set(index, kCenter, kExtents);
+    return index;
+}
+
+uint32_t FrustumCuller::AddSphere(const XMFLOAT3& kCenter, float radius)
+{
+    uint32_t index = Add(kCenter, XMFLOAT3(radius, radius, radius));
+    m_radius[index] = radius;
+    return index;
+}
+
+void FrustumCuller::Set(uint32_t index, const XMFLOAT3& kCenter, const XMFLOAT3& kExtents)
+{
+    m_centerX[index] = kCenter.x;
+    m_centerY[index] = kCenter.y;
+    m_centerZ[index] = kCenter.z;
+    m_extentX[index] = kExtents.x;
+    m_extentY[index] = kExtents.y;
+    m_extentZ[index] = kExtents.z;
+    m_radius[index] = sqrtf(kExtents.x * kExtents.x + kExtents.y * kExtents.y + kExtents.z * kExtents.z);
+}
+
+//-----------------------------------------------------------------
+// The volumes are cut into fixed chunks. Each chunk writes what it
+// found visible at its own offset of a scratch array, so the chunks
+// don't share anything while they run, and the results are packed
+// into the output in chunk order afterwards.
+//-----------------------------------------------------------------
+void FrustumCuller::Cull(const Frustum& kFrustum, JobSystem* pJobSystem, std::vector<uint32_t>& visible)
+{
+    PROFILE_SCOPE("FrustumCuller::Cull");
+
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+    unsigned int chunkCount = (m_count + kChunkSize - 1) / kChunkSize;
+    m_chunkVisible.resize(m_centerX.size());
+    m_chunkVisibleCounts.assign(chunkCount, 0);
+
+    auto cullChunks = [this, &kFrustum](unsigned int begin, unsigned int end)
+    {
+        for (unsigned int chunk = begin; chunk < end; ++chunk)
+        {
+            unsigned int first = chunk * kChunkSize;
+            unsigned int last = std::min(m_count, first + kChunkSize);
+            m_chunkVisibleCounts[chunk] = CullRange(kFrustum, first, last, &m_chunkVisible[first]);
+        }
+    };
+
+    if (pJobSystem && chunkCount > 1)
+    {
+        pJobSystem->ParallelFor(chunkCount, 1, cullChunks);
+    }
+    else
+    {
+        cullChunks(0, chunkCount);
+    }
+
+    unsigned int visibleCount = 0;
+    for (unsigned int chunk = 0; chunk < chunkCount; ++chunk)
+    {
+        visibleCount += m_chunkVisibleCounts[chunk];
+    }
+
+    visible.resize(visibleCount);
+
+    unsigned int offset = 0;
+    for (unsigned int chunk = 0; chunk < chunkCount; ++chunk)
+    {
+        if (m_chunkVisibleCounts[chunk] > 0)
+        {
+            memcpy(&visible[offset], &m_chunkVisible[chunk * kChunkSize], sizeof(uint32_t) * m_chunkVisibleCounts[chunk]);
+            offset += m_chunkVisibleCounts[chunk];
+        }
+    }
+
+    m_stats.m_tested = m_count;
+    m_stats.m_visible = visibleCount;
+    m_stats.m_chunks = chunkCount;
+    m_stats.m_cullSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+unsigned int FrustumCuller::GetCount() const
+{
+    return m_count;
+}
+
+const FrustumCullStats& FrustumCuller::GetStats() const
+{
+    return m_stats;
+}
+
+//-----------------------------------------------------------------
+// A volume is outside a plane when its center is further behind it
+// than its radius along the normal. For the box that radius is
+// |n.x| * e.x + |n.y| * e.y + |n.z| * e.z, for the sphere it is the
+// sphere's, and the smaller of the two is used.
+//
+// begin is a multiple of the lane count and the arrays are padded,
+// so the vector loads never leave the arrays. Lanes past end are
+// masked off. Indices are appended without branches: every lane
+// writes its index and the count only moves past the visible ones.
+//-----------------------------------------------------------------
+unsigned int FrustumCuller::CullRange(const Frustum& kFrustum, unsigned int begin, unsigned int end, uint32_t* pVisible) const
+{
+    CullPlane planes[Frustum::PlaneCount];
+    PrepareCullPlanes(kFrustum, planes);
+
+    unsigned int visibleCount = 0;
+
+#if FRUSTUM_CULLER_USE_AVX
+    __m256 planeVectors[Frustum::PlaneCount][7];
+    for (unsigned int p = 0; p < Frustum::PlaneCount; ++p)
+    {
+        const float* pValues = &planes[p].m_normalX;
+        for (unsigned int v = 0; v < 7; ++v)
+        {
+            planeVectors[p][v] = _mm256_set1_ps(pValues[v]);
+        }
+    }
+
+    const __m256 kZero = _mm256_setzero_ps();
+
+    for (unsigned int i = begin; i < end; i += 8)
+    {
+        __m256 centerX = _mm256_loadu_ps(&m_centerX[i]);
+        __m256 centerY = _mm256_loadu_ps(&m_centerY[i]);
+        __m256 centerZ = _mm256_loadu_ps(&m_centerZ[i]);
+        __m256 extentX = _mm256_loadu_ps(&m_extentX[i]);
+        __m256 extentY = _mm256_loadu_ps(&m_extentY[i]);
+        __m256 extentZ = _mm256_loadu_ps(&m_extentZ[i]);
+        __m256 sphereRadius = _mm256_loadu_ps(&m_radius[i]);
+
+        __m256 inside = _mm256_cmp_ps(kZero, kZero, _CMP_EQ_OQ);
+        for (unsigned int p = 0; p < Frustum::PlaneCount; ++p)
+        {
+            const __m256* pPlane = planeVectors[p];
+            __m256 distance = _mm256_add_ps(
+                _mm256_add_ps(_mm256_mul_ps(pPlane[0], centerX), _mm256_mul_ps(pPlane[1], centerY)),
+                _mm256_add_ps(_mm256_mul_ps(pPlane[2], centerZ), pPlane[6]));
+            __m256 boxRadius = _mm256_add_ps(
+                _mm256_add_ps(_mm256_mul_ps(pPlane[3], extentX), _mm256_mul_ps(pPlane[4], extentY)),
+                _mm256_mul_ps(pPlane[5], extentZ));
+            __m256 radius = _mm256_min_ps(boxRadius, sphereRadius);
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(distance, radius), kZero, _CMP_GE_OQ));
+        }
+
+        unsigned int mask = static_cast<unsigned int>(_mm256_movemask_ps(inside));
+        if (end - i < 8)
+        {
+            mask &= (1u << (end - i)) - 1;
+        }
+
+        for (unsigned int lane = 0; lane < 8; ++lane)
+        {
+            pVisible[visibleCount] = i + lane;
+            visibleCount += (mask >> lane) & 1;
+        }
+    }
+#elif FRUSTUM_CULLER_USE_SSE
+    __m128 planeVectors[Frustum::PlaneCount][7];
+    for (unsigned int p = 0; p < Frustum::PlaneCount; ++p)
+    {
+        const float* pValues = &planes[p].m_normalX;
+        for (unsigned int v = 0; v < 7; ++v)
+        {
+            planeVectors[p][v] = _mm_set1_ps(pValues[v]);
+        }
+    }
+
+    const __m128 kZero = _mm_setzero_ps();
+
+    for (unsigned int i = begin; i < end; i += 4)
+    {
+        __m128 centerX = _mm_loadu_ps(&m_centerX[i]);
+        __m128 centerY = _mm_loadu_ps(&m_centerY[i]);
+        __m128 centerZ = _mm_loadu_ps(&m_centerZ[i]);
+        __m128 extentX = _mm_loadu_ps(&m_extentX[i]);
+        __m128 extentY = _mm_loadu_ps(&m_extentY[i]);
+        __m128 extentZ = _mm_loadu_ps(&m_extentZ[i]);
+        __m128 sphereRadius = _mm_loadu_ps(&m_radius[i]);
+
+        __m128 inside = _mm_cmpeq_ps(kZero, kZero);
+        for (unsigned int p = 0; p < Frustum::PlaneCount; ++p)
+        {
+            const __m128* pPlane = planeVectors[p];
+            __m128 distance = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(pPlane[0], centerX), _mm_mul_ps(pPlane[1], centerY)),
+                _mm_add_ps(_mm_mul_ps(pPlane[2], centerZ), pPlane[6]));
+            __m128 boxRadius = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(pPlane[3], extentX), _mm_mul_ps(pPlane[4], extentY)),
+                _mm_mul_ps(pPlane[5], extentZ));
+            __m128 radius = _mm_min_ps(boxRadius, sphereRadius);
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, radius), kZero));
+        }
+
+        unsigned int mask = static_cast<unsigned int>(_mm_movemask_ps(inside));
+        if (end - i < 4)
+        {
+            mask &= (1u << (end - i)) - 1;
+        }
+
+        for (unsigned int lane = 0; lane < 4; ++lane)
+        {
+            pVisible[visibleCount] = i + lane;
+            visibleCount += (mask >> lane) & 1;
+        }
+    }
+#else
+    for (unsigned int i = begin; i < end; ++i)
+    {
+        bool inside = true;
+        for (unsigned int p = 0; p < Frustum::PlaneCount && inside; ++p)
+        {
+            const CullPlane& kPlane = planes[p];
+            float distance = kPlane.m_normalX * m_centerX[i] + kPlane.m_normalY * m_centerY[i] + kPlane.m_normalZ * m_centerZ[i] + kPlane.m_distance;
+            float boxRadius = kPlane.m_absNormalX * m_extentX[i] + kPlane.m_absNormalY * m_extentY[i] + kPlane.m_absNormalZ * m_extentZ[i];
+            inside = (distance + std::min(boxRadius, m_radius[i]) >= 0.0f);
+        }
+
+        pVisible[visibleCount] = i;
+        visibleCount += inside ? 1 : 0;
+    }
+#endif
+
+    return visibleCount;
+}
+
+// Keeps the arrays padded with empty volumes up to the next multiple of the lane count.
+void FrustumCuller::Resize(unsigned int count)
+{
+    unsigned int padded = (count + kLaneCount - 1) / kLaneCount * kLaneCount;
+    for (std::vector<float>* pArray : { &m_centerX, &m_centerY, &m_centerZ, &m_extentX, &m_extentY, &m_extentZ, &m_radius })
+    {
+        pArray->resize(padded, 0.0f);
+    }
+
+    m_count = count;
+}
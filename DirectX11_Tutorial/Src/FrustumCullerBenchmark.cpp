@@ -0,0 +1,80 @@
+//////////////////////////////////////////////////////////////////////
+// Filename: FrustumCullerBenchmark.cpp
+//////////////////////////////////////////////////////////////////////
+#include <vector>
+
+#include "Graphics/FrustumCuller.h"
+#include "Graphics/FrustumCullerBenchmark.h"
+#include "System/SeededRandom.h"
+
+using namespace DirectX;
+
+namespace
+{
+    constexpr unsigned int kCulledVolumes = 1 << 20;
+
+    class FrustumCullWorkload : public JobSystemWorkload
+    {
+    public:
+        const char* GetName() const override
+        {
+            return "frustum_cull";
+        }
+
+        // Boxes and spheres scattered through a cube around a camera at its center, about
+        // a tenth of them in view.
+        bool Initialize(unsigned int) override
+        {
+            SeededRandom random(54321);
+
+            m_culler.Clear();
+            m_culler.Reserve(kCulledVolumes);
+            for (unsigned int i = 0; i < kCulledVolumes; ++i)
+            {
+                float x = random.Next() * 2000.0f - 1000.0f;
+                float y = random.Next() * 2000.0f - 1000.0f;
+                float z = random.Next() * 2000.0f - 1000.0f;
+                XMFLOAT3 center(x, y, z);
+
+                if (i % 4 == 0)
+                {
+                    m_culler.AddSphere(center, 0.5f + random.Next() * 4.0f);
+                }
+                else
+                {
+                    float extentX = 0.5f + random.Next() * 4.0f;
+                    float extentY = 0.5f + random.Next() * 4.0f;
+                    float extentZ = 0.5f + random.Next() * 4.0f;
+                    m_culler.Add(center, XMFLOAT3(extentX, extentY, extentZ));
+                }
+            }
+
+            XMMATRIX view = XMMatrixRotationRollPitchYaw(0.3f, 0.7f, 0.0f);
+            XMMATRIX projection = XMMatrixPerspectiveFovLH(XM_PIDIV4, 16.0f / 9.0f, 0.1f, 1000.0f);
+            m_frustum = FrustumCuller::ExtractFrustum(XMMatrixMultiply(view, projection));
+            return true;
+        }
+
+        void Shutdown() override
+        {
+            m_culler.Clear();
+            m_visible.clear();
+        }
+
+        double Run(JobSystem& jobSystem) override
+        {
+            m_culler.Cull(m_frustum, &jobSystem, m_visible);
+            return m_culler.GetStats().m_cullSeconds;
+        }
+
+    private:
+        FrustumCuller m_culler;
+        Frustum m_frustum;
+        std::vector<uint32_t> m_visible;
+    };
+}
+
+std::unique_ptr<JobSystemWorkload> CreateFrustumCullWorkload()
+{
+    return std::make_unique<FrustumCullWorkload>();
+}
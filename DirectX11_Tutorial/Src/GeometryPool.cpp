@@ -0,0 +1,361 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: GeometryPool.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <cstring>
+
+#include "Graphics/GeometryPool.h"
+#include "Graphics/RenderStats.h"
+#include "System/Profiler.h"
+
+namespace
+{
+    const GeometryRange kEmptyRange = { 0, 0, 0, 0 };
+}
+
+GeometryPool::GeometryPool()
+    : m_pVertexBuffer(nullptr)
+    , m_pIndexBuffer(nullptr)
+    , m_vertexStride(0)
+    , m_dirtyVertexBegin(0)
+    , m_dirtyVertexEnd(0)
+    , m_dirtyIndexBegin(0)
+    , m_dirtyIndexEnd(0)
+    , m_defragmentations(0)
+    , m_bytesUploaded(0)
+{
+}
+
+GeometryPool::~GeometryPool()
+{
+    Shutdown();
+}
+
+bool GeometryPool::Initialize(RenderDevice* pDevice, UINT vertexStride, UINT maxVertices, UINT maxIndices)
+{
+    HRESULT result;
+    D3D11_BUFFER_DESC bufferDesc;
+
+    if (vertexStride == 0 || maxVertices == 0 || maxIndices == 0)
+    {
+        return false;
+    }
+
+    m_vertexStride = vertexStride;
+    m_vertexData.assign(static_cast<size_t>(vertexStride) * maxVertices, 0);
+    m_indexData.assign(maxIndices, 0);
+
+    // Default usage, the buffers are only ever written with UpdateSubresource().
+    bufferDesc.Usage = D3D11_USAGE_DEFAULT;
+    bufferDesc.ByteWidth = vertexStride * maxVertices;
+    bufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+    bufferDesc.CPUAccessFlags = 0;
+    bufferDesc.MiscFlags = 0;
+    bufferDesc.StructureByteStride = 0;
+
+    result = pDevice->CreateBuffer(&bufferDesc, nullptr, &m_pVertexBuffer);
+    if (FAILED(result))
+    {
+        return false;
+    }
+
+    bufferDesc.ByteWidth = sizeof(uint32_t) * maxIndices;
+    bufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+
+    result = pDevice->CreateBuffer(&bufferDesc, nullptr, &m_pIndexBuffer);
+    if (FAILED(result))
+    {
+        return false;
+    }
+
+    m_vertexRanges.Initialize(maxVertices);
+    m_indexRanges.Initialize(maxIndices);
+
+    m_meshes.clear();
+    m_meshInUse.clear();
+    m_freeHandles.clear();
+
+    m_dirtyVertexBegin = m_dirtyVertexEnd = 0;
+    m_dirtyIndexBegin = m_dirtyIndexEnd = 0;
+    m_defragmentations = 0;
+    m_bytesUploaded = 0;
+
+    return true;
+}
+
+void GeometryPool::Shutdown()
+{
+    if (m_pIndexBuffer)
+    {
+        m_pIndexBuffer->Release();
+        m_pIndexBuffer = nullptr;
+    }
+
+    if (m_pVertexBuffer)
+    {
+        m_pVertexBuffer->Release();
+        m_pVertexBuffer = nullptr;
+    }
+
+    m_vertexData.clear();
+    m_indexData.clear();
+    m_meshes.clear();
+    m_meshInUse.clear();
+    m_freeHandles.clear();
+}
+
+bool GeometryPool::AddMesh(const void* pVertices, UINT vertexCount, const uint32_t* pIndices, UINT indexCount, GeometryHandle& handle)
+{
+    PROFILE_SCOPE("GeometryPool::AddMesh");
+
+    UINT baseVertex;
+    UINT startIndex;
+
+    if (!m_pVertexBuffer || vertexCount == 0 || indexCount == 0)
+    {
+        return false;
+    }
+
+    if (vertexCount > m_vertexRanges.GetFreeCount() || indexCount > m_indexRanges.GetFreeCount())
+    {
+        return false;
+    }
+
+    // Enough space in total but no single range big enough, close the gaps first.
+    if (vertexCount > m_vertexRanges.GetLargestFreeRange() || indexCount > m_indexRanges.GetLargestFreeRange())
+    {
+        Defragment();
+    }
+
+    if (!m_vertexRanges.Allocate(vertexCount, baseVertex))
+    {
+        return false;
+    }
+
+    if (!m_indexRanges.Allocate(indexCount, startIndex))
+    {
+        m_vertexRanges.Free(baseVertex, vertexCount);
+        return false;
+    }
+
+    memcpy(&m_vertexData[static_cast<size_t>(baseVertex) * m_vertexStride], pVertices, static_cast<size_t>(vertexCount) * m_vertexStride);
+    memcpy(&m_indexData[startIndex], pIndices, sizeof(uint32_t) * indexCount);
+
+    MarkVerticesDirty(baseVertex, baseVertex + vertexCount);
+    MarkIndicesDirty(startIndex, startIndex + indexCount);
+
+    if (!m_freeHandles.empty())
+    {
+        handle = m_freeHandles.back();
+        m_freeHandles.pop_back();
+    }
+    else
+    {
+        handle = static_cast<GeometryHandle>(m_meshes.size());
+        m_meshes.push_back(kEmptyRange);
+        m_meshInUse.push_back(false);
+    }
+
+    m_meshes[handle] = { baseVertex, vertexCount, startIndex, indexCount };
+    m_meshInUse[handle] = true;
+
+    return true;
+}
+
+// The data stays in the buffers until something else is placed there, nothing has to be uploaded.
+void GeometryPool::RemoveMesh(GeometryHandle handle)
+{
+    if (handle >= m_meshes.size() || !m_meshInUse[handle])
+    {
+        return;
+    }
+
+    const GeometryRange& kRange = m_meshes[handle];
+    m_vertexRanges.Free(kRange.m_baseVertex, kRange.m_vertexCount);
+    m_indexRanges.Free(kRange.m_startIndex, kRange.m_indexCount);
+
+    m_meshes[handle] = kEmptyRange;
+    m_meshInUse[handle] = false;
+    m_freeHandles.push_back(handle);
+}
+
+const GeometryRange& GeometryPool::GetRange(GeometryHandle handle) const
+{
+    if (handle >= m_meshes.size() || !m_meshInUse[handle])
+    {
+        return kEmptyRange;
+    }
+
+    return m_meshes[handle];
+}
+
+void GeometryPool::Bind(RenderContext* pDeviceContext)
+{
+    PROFILE_SCOPE("GeometryPool::Bind");
+
+    Upload(pDeviceContext);
+    BindBuffers(pDeviceContext);
+}
+
+// Reads nothing Upload() writes, so the recording threads can all call it at once.
+void GeometryPool::BindBuffers(RenderContext* pDeviceContext) const
+{
+    uint32_t stride = m_vertexStride;
+    uint32_t offset = 0;
+
+    pDeviceContext->IASetVertexBuffers(0, 1, &m_pVertexBuffer, &stride, &offset);
+    pDeviceContext->IASetIndexBuffer(m_pIndexBuffer, DXGI_FORMAT_R32_UINT, 0);
+    pDeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+    // Vertex buffer, index buffer and topology.
+    RenderStats::AddStateBinds(3);
+}
+
+//-----------------------------------------------------------------
+// Vertices and indices are packed separately, each in the order
+// they already are in, so a mesh only ever moves down and the copy
+// can be done in place. Everything from the first mesh that moved
+// up to the new end has to be uploaded again.
+//-----------------------------------------------------------------
+UINT GeometryPool::Defragment()
+{
+    PROFILE_SCOPE("GeometryPool::Defragment");
+
+    std::vector<GeometryHandle> handles;
+    handles.reserve(m_meshes.size());
+    for (GeometryHandle handle = 0; handle < m_meshes.size(); ++handle)
+    {
+        if (m_meshInUse[handle])
+        {
+            handles.push_back(handle);
+        }
+    }
+
+    std::vector<bool> moved(m_meshes.size(), false);
+
+    // Vertices.
+    std::sort(handles.begin(), handles.end(), [this](GeometryHandle a, GeometryHandle b)
+    {
+        return m_meshes[a].m_baseVertex < m_meshes[b].m_baseVertex;
+    });
+
+    UINT vertexEnd = 0;
+    for (GeometryHandle handle : handles)
+    {
+        GeometryRange& range = m_meshes[handle];
+        if (range.m_baseVertex != vertexEnd)
+        {
+            memmove(&m_vertexData[static_cast<size_t>(vertexEnd) * m_vertexStride], &m_vertexData[static_cast<size_t>(range.m_baseVertex) * m_vertexStride], static_cast<size_t>(range.m_vertexCount) * m_vertexStride);
+            MarkVerticesDirty(vertexEnd, vertexEnd + range.m_vertexCount);
+            range.m_baseVertex = vertexEnd;
+            moved[handle] = true;
+        }
+
+        vertexEnd += range.m_vertexCount;
+    }
+
+    // Indices.
+    std::sort(handles.begin(), handles.end(), [this](GeometryHandle a, GeometryHandle b)
+    {
+        return m_meshes[a].m_startIndex < m_meshes[b].m_startIndex;
+    });
+
+    UINT indexEnd = 0;
+    for (GeometryHandle handle : handles)
+    {
+        GeometryRange& range = m_meshes[handle];
+        if (range.m_startIndex != indexEnd)
+        {
+            memmove(&m_indexData[indexEnd], &m_indexData[range.m_startIndex], sizeof(uint32_t) * range.m_indexCount);
+            MarkIndicesDirty(indexEnd, indexEnd + range.m_indexCount);
+            range.m_startIndex = indexEnd;
+            moved[handle] = true;
+        }
+
+        indexEnd += range.m_indexCount;
+    }
+
+    m_vertexRanges.Reset(vertexEnd);
+    m_indexRanges.Reset(indexEnd);
+
+    ++m_defragmentations;
+
+    return static_cast<UINT>(std::count(moved.begin(), moved.end(), true));
+}
+
+GeometryPoolStats GeometryPool::GetStats() const
+{
+    GeometryPoolStats stats;
+    stats.m_meshCount = static_cast<UINT>(m_meshes.size() - m_freeHandles.size());
+    stats.m_vertexCapacity = m_vertexRanges.GetCapacity();
+    stats.m_verticesUsed = m_vertexRanges.GetCapacity() - m_vertexRanges.GetFreeCount();
+    stats.m_vertexFreeRanges = m_vertexRanges.GetFreeRangeCount();
+    stats.m_largestVertexFreeRange = m_vertexRanges.GetLargestFreeRange();
+    stats.m_indexCapacity = m_indexRanges.GetCapacity();
+    stats.m_indicesUsed = m_indexRanges.GetCapacity() - m_indexRanges.GetFreeCount();
+    stats.m_indexFreeRanges = m_indexRanges.GetFreeRangeCount();
+    stats.m_largestIndexFreeRange = m_indexRanges.GetLargestFreeRange();
+    stats.m_defragmentations = m_defragmentations;
+    stats.m_bytesUploaded = m_bytesUploaded;
+    return stats;
+}
+
+void GeometryPool::MarkVerticesDirty(UINT begin, UINT end)
+{
+    if (m_dirtyVertexBegin >= m_dirtyVertexEnd)
+    {
+        m_dirtyVertexBegin = begin;
+        m_dirtyVertexEnd = end;
+    }
+    else
+    {
+        m_dirtyVertexBegin = std::min(m_dirtyVertexBegin, begin);
+        m_dirtyVertexEnd = std::max(m_dirtyVertexEnd, end);
+    }
+}
+
+void GeometryPool::MarkIndicesDirty(UINT begin, UINT end)
+{
+    if (m_dirtyIndexBegin >= m_dirtyIndexEnd)
+    {
+        m_dirtyIndexBegin = begin;
+        m_dirtyIndexEnd = end;
+    }
+    else
+    {
+        m_dirtyIndexBegin = std::min(m_dirtyIndexBegin, begin);
+        m_dirtyIndexEnd = std::max(m_dirtyIndexEnd, end);
+    }
+}
+
+// One UpdateSubresource() per buffer covering everything that changed, meshes are added in bulk at load time.
+void GeometryPool::Upload(RenderContext* pDeviceContext)
+{
+    D3D11_BOX box;
+    box.top = 0;
+    box.bottom = 1;
+    box.front = 0;
+    box.back = 1;
+
+    if (m_dirtyVertexBegin < m_dirtyVertexEnd)
+    {
+        box.left = m_dirtyVertexBegin * m_vertexStride;
+        box.right = m_dirtyVertexEnd * m_vertexStride;
+        pDeviceContext->UpdateSubresource(m_pVertexBuffer, 0, &box, &m_vertexData[box.left], 0, 0);
+
+        m_bytesUploaded += box.right - box.left;
+        RenderStats::AddGeometryUpload(box.right - box.left);
+        m_dirtyVertexBegin = m_dirtyVertexEnd = 0;
+    }
+
+    if (m_dirtyIndexBegin < m_dirtyIndexEnd)
+    {
+        box.left = m_dirtyIndexBegin * sizeof(uint32_t);
+        box.right = m_dirtyIndexEnd * sizeof(uint32_t);
+        pDeviceContext->UpdateSubresource(m_pIndexBuffer, 0, &box, &m_indexData[m_dirtyIndexBegin], 0, 0);
+
+        m_bytesUploaded += box.right - box.left;
+        RenderStats::AddGeometryUpload(box.right - box.left);
+        m_dirtyIndexBegin = m_dirtyIndexEnd = 0;
+    }
+}
@@ -1,11 +1,120 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <vector>
+
 #include "Graphics/Graphics.h"
+#include "Graphics/RenderStats.h"
+#include "System/Profiler.h"
 
 using namespace DirectX;
 
+namespace
+{
+    // Shader ids of the render queue keys.
+    constexpr uint32_t kColorShaderKey = 0;
+    constexpr uint32_t kColorInstancedShaderKey = 1;
+    // Every draw uses the pipeline state Direct3D sets up.
+    constexpr uint32_t kDefaultStateKey = 0;
+    // What the scene tree's proxies stand for.
+    constexpr uint32_t kModelVolume = 0;
+    constexpr uint32_t kInstanceGridVolume = 1;
+    // The copies of a grid drawn one by one, kFirstObjectVolume + the copy.
+    constexpr uint32_t kFirstObjectVolume = 2;
+    // What a model draw packet's m_object is when it draws the spinning model.
+    constexpr uint32_t kSpinningModel = ~0u;
+
+    void ShowError(HWND hwnd, LPCWSTR pMessage, LPCWSTR pCaption, UINT type)
+    {
+        if (hwnd)
+        {
+            MessageBox(hwnd, pMessage, pCaption, type);
+        }
+        else
+        {
+            OutputDebugString(pMessage);
+            OutputDebugString(L"\n");
+        }
+    }
+
+    // Distance of the point in front of the camera as a fraction of the far plane, for the sort keys.
+    float ViewDepth(const XMFLOAT3& kPoint, FXMMATRIX viewMatrix)
+    {
+        return XMVectorGetZ(XMVector3TransformCoord(XMLoadFloat3(&kPoint), viewMatrix)) / SCREEN_DEPTH;
+    }
+
+    // The box around a box moved by the matrix, as a center and half extents.
+    void TransformBounds(const XMFLOAT3& kCenter, const XMFLOAT3& kExtents, FXMMATRIX matrix, XMFLOAT3& center, XMFLOAT3& extents)
+    {
+        XMVECTOR newCenter = XMVector3TransformCoord(XMLoadFloat3(&kCenter), matrix);
+        XMVECTOR extentsVector = XMLoadFloat3(&kExtents);
+        XMVECTOR newExtents = XMVectorAdd(XMVectorAdd(
+            XMVectorMultiply(XMVectorSplatX(extentsVector), XMVectorAbs(matrix.r[0])),
+            XMVectorMultiply(XMVectorSplatY(extentsVector), XMVectorAbs(matrix.r[1]))),
+            XMVectorMultiply(XMVectorSplatZ(extentsVector), XMVectorAbs(matrix.r[2])));
+
+        XMStoreFloat3(&center, newCenter);
+        XMStoreFloat3(&extents, newExtents);
+    }
+
+    Aabb MakeAabb(const XMFLOAT3& kCenter, const XMFLOAT3& kExtents)
+    {
+        Aabb aabb;
+        aabb.m_min = XMFLOAT3(kCenter.x - kExtents.x, kCenter.y - kExtents.y, kCenter.z - kExtents.z);
+        aabb.m_max = XMFLOAT3(kCenter.x + kExtents.x, kCenter.y + kExtents.y, kCenter.z + kExtents.z);
+        return aabb;
+    }
+
+    XMFLOAT3 Lerp(const XMFLOAT3& kFrom, const XMFLOAT3& kTo, float alpha)
+    {
+        XMFLOAT3 result;
+        XMStoreFloat3(&result, XMVectorLerp(XMLoadFloat3(&kFrom), XMLoadFloat3(&kTo), alpha));
+        return result;
+    }
+
+    // A square grid of copies facing the camera, far enough back that all of it is in view.
+    // The tint goes from red to blue across the grid and from dark to bright down it.
+    std::vector<ModelInstance> CreateInstanceGrid(unsigned int instanceCount, XMFLOAT3& center)
+    {
+        std::vector<ModelInstance> instances(instanceCount);
+
+        unsigned int side = static_cast<unsigned int>(ceil(sqrt(static_cast<double>(instanceCount))));
+        float extent = (side - 1) * INSTANCE_GRID_SPACING;
+
+        for (unsigned int i = 0; i < instanceCount; ++i)
+        {
+            unsigned int column = i % side;
+            unsigned int row = i / side;
+            float u = side > 1 ? static_cast<float>(column) / (side - 1) : 0.5f;
+            float v = side > 1 ? static_cast<float>(row) / (side - 1) : 0.5f;
+
+            XMMATRIX world = XMMatrixTranslation(column * INSTANCE_GRID_SPACING - extent * 0.5f, row * INSTANCE_GRID_SPACING - extent * 0.5f, extent * 1.5f);
+            XMStoreFloat4x4(&instances[i].m_world, world);
+            instances[i].m_tint = XMFLOAT4(1.0f - u, 0.5f + 0.5f * v, u, 1.0f);
+        }
+
+        center = XMFLOAT3(0.f, 0.f, extent * 1.5f);
+
+        return instances;
+    }
+}
+
 Graphics::Graphics()
-    : m_pDirect3D(nullptr)
+    : m_pJobSystem(nullptr)
+    , m_pDirect3D(nullptr)
     , m_pCamera(nullptr)
     , m_pColorShader(nullptr)
+    , m_modelProxy(INVALID_AABB_PROXY)
+    , m_instanceGridCenter(0.f, 0.f, 0.f)
+    , m_rootTransform(INVALID_TRANSFORM_HANDLE)
+    , m_modelTransform(INVALID_TRANSFORM_HANDLE)
+    , m_nextUpdateFrame(0)
+    , m_nextRenderFrame(0)
+    , m_updateRunning(false)
+    , m_lastFrameTimes{ 0.0, 0.0 }
+    , m_latencyFrameCount(0)
+    , m_latencyTotalSeconds(0.0)
+    , m_latencyMaxSeconds(0.0)
 {
 }
 
@@ -18,10 +127,23 @@ Graphics::~Graphics()
 }
 
 // Create the Direct3D object and then call the Direct3D initialization function.
-// The width, height and handle will be sent to this function.
-bool Graphics::Initialize(int screenWidth, int screenHeight, HWND hwnd)
+// The window handle and the settings will be sent to this function.
+// hwnd is nullptr on a headless run, errors then go to the debugger output instead of a message box.
+bool Graphics::Initialize(HWND hwnd, JobSystem* pJobSystem, const GraphicsSettings& kSettings)
 {
     bool result = false;
+    const int screenWidth = kSettings.m_screenWidth;
+    const int screenHeight = kSettings.m_screenHeight;
+    const unsigned int instanceCount = kSettings.m_instanceCount;
+    const bool separateDraws = kSettings.m_separateDraws;
+
+    m_pJobSystem = pJobSystem;
+
+    // Setup the frame pipeline slots.
+    m_frameStates.resize(kSettings.m_pipelineDepth > 0 ? kSettings.m_pipelineDepth : 1);
+    m_nextUpdateFrame = 0;
+    m_nextRenderFrame = 0;
+    m_updateRunning = false;
 
     // Create the Direct3D object>
     m_pDirect3D = std::make_unique<Direct3D>();
@@ -31,10 +153,10 @@ bool Graphics::Initialize(int screenWidth, int screenHeight, HWND hwnd)
     }
 
     // Initialize the Direct3D object.
-    result = m_pDirect3D->Initialize(screenWidth, screenHeight, VSYNC_ENABLED, hwnd, FULL_SCREEN, SCREEN_DEPTH, SCREEN_NEAR);
+    result = m_pDirect3D->Initialize(kSettings.m_backend, m_pJobSystem, screenWidth, screenHeight, kSettings.m_pacing, hwnd, FULL_SCREEN, SCREEN_DEPTH, SCREEN_NEAR);
     if (!result)
     {
-        MessageBox(hwnd, L"Could not initialize Direct3D", L"Error", MB_OK);
+        ShowError(hwnd, L"Could not initialize Direct3D", L"Error", MB_OK);
         return false;
     }
 
@@ -45,8 +167,45 @@ bool Graphics::Initialize(int screenWidth, int screenHeight, HWND hwnd)
         return false;
     }
 
-    // Set the initial position of the camera.
-    m_pCamera->SetPosition(0.f, 0.f, -10.f);
+    // Set the initial position of the camera. The update moves the camera object
+    // to a blend of the last two simulated states every frame.
+    m_currentScene.m_cameraPosition = XMFLOAT3(0.f, 0.f, -10.f);
+    m_currentScene.m_cameraRotation = XMFLOAT3(0.f, 0.f, 0.f);
+    m_currentScene.m_modelRotation = 0.f;
+    m_currentScene.m_sceneSeconds = 0.f;
+    m_previousScene = m_currentScene;
+
+    m_timestep.Initialize(1.0 / kSettings.m_simulationRate, MAX_SIMULATION_STEPS_PER_FRAME);
+
+    // The model hangs under a root that carries Direct3D's world matrix, the update turns it.
+    XMMATRIX rootMatrix;
+    m_pDirect3D->GetWorldMatrix(rootMatrix);
+
+    XMVECTOR rootScale;
+    XMVECTOR rootRotation;
+    XMVECTOR rootPosition;
+    XMMatrixDecompose(&rootScale, &rootRotation, &rootPosition, rootMatrix);
+
+    XMFLOAT3 scale;
+    XMFLOAT4 rotation;
+    XMFLOAT3 position;
+    XMStoreFloat3(&scale, rootScale);
+    XMStoreFloat4(&rotation, rootRotation);
+    XMStoreFloat3(&position, rootPosition);
+
+    XMFLOAT4 identityRotation;
+    XMStoreFloat4(&identityRotation, XMQuaternionIdentity());
+
+    m_transforms.Clear();
+    m_rootTransform = m_transforms.Create(INVALID_TRANSFORM_HANDLE, position, rotation, scale);
+    m_modelTransform = m_transforms.Create(m_rootTransform, XMFLOAT3(0.f, 0.f, 0.f), identityRotation, XMFLOAT3(1.f, 1.f, 1.f));
+
+    // Create the shared vertex and index buffers the models are placed in.
+    if (!m_geometryPool.Initialize(m_pDirect3D->GetDevice(), sizeof(Model::Vertex), GEOMETRY_POOL_VERTICES, GEOMETRY_POOL_INDICES))
+    {
+        ShowError(hwnd, L"Could not create the geometry pool.", L"Error", MB_OK);
+        return false;
+    }
 
     // Create the model object.
     m_pModel = std::make_unique<Model>();
@@ -55,10 +214,10 @@ bool Graphics::Initialize(int screenWidth, int screenHeight, HWND hwnd)
         return false;
     }
 
-    result = m_pModel->Initialize(m_pDirect3D->GetDevice());
+    result = m_pModel->Initialize(&m_geometryPool);
     if (!result)
     {
-        MessageBox(hwnd, L"Could not initialize the model object.", L"Error", MB_OK);
+        ShowError(hwnd, L"Could not initialize the model object.", L"Error", MB_OK);
         return false;
     }
 
@@ -71,10 +230,102 @@ bool Graphics::Initialize(int screenWidth, int screenHeight, HWND hwnd)
     result = m_pColorShader->Initialize(m_pDirect3D->GetDevice(), hwnd);
     if(!result)
     {
-        MessageBox(hwnd, L"Could not initialize the color shader object.", L"Error", MB_OK);
+        ShowError(hwnd, L"Could not initialize the color shader object.", L"Error", MB_OK);
+        return false;
+    }
+
+    // Create the constant buffer for the per view constants.
+    if (!m_viewConstants.Initialize(m_pDirect3D->GetDevice(), sizeof(ViewConstants)))
+    {
+        ShowError(hwnd, L"Could not create the shader constant buffers.", L"Error", MB_OK);
         return false;
     }
 
+    // One command list for every thread that can record, the render thread included.
+    if (!m_commandRecorder.Initialize(m_pDirect3D->GetDevice(), m_pJobSystem->GetWorkerCount() + 1))
+    {
+        ShowError(hwnd, L"Could not create the command lists.", L"Error", MB_OK);
+        return false;
+    }
+
+    // A quarter of the screen's size is plenty to hide things with.
+    if (!m_occlusionCuller.Initialize(std::max(1, screenWidth / static_cast<int>(OCCLUSION_BUFFER_DIVISOR)), std::max(1, screenHeight / static_cast<int>(OCCLUSION_BUFFER_DIVISOR))))
+    {
+        ShowError(hwnd, L"Could not create the occlusion buffer.", L"Error", MB_OK);
+        return false;
+    }
+
+    // The model moves every frame, Render() moves its box in the scene tree.
+    XMFLOAT3 modelCenter;
+    XMFLOAT3 modelExtents;
+    m_pModel->GetBounds(modelCenter, modelExtents);
+
+    m_sceneTree.Clear();
+    m_modelProxy = m_sceneTree.Insert(MakeAabb(modelCenter, modelExtents), kModelVolume);
+
+    // The grid's slot stays empty when there is no grid or its copies are drawn one by one.
+    unsigned int volumeCount = kFirstObjectVolume + ((instanceCount > 0 && separateDraws) ? instanceCount : 0);
+    m_volumeCenters.assign(volumeCount, XMFLOAT3(0.f, 0.f, 0.f));
+    m_volumeExtents.assign(volumeCount, XMFLOAT3(0.f, 0.f, 0.f));
+    m_volumeCenters[kModelVolume] = modelCenter;
+    m_volumeExtents[kModelVolume] = modelExtents;
+    m_candidateCuller.Reserve(volumeCount);
+
+    // Every copy of the grid as a model of its own, with its own box in the scene tree and its own draw.
+    // The copies don't move, their world matrices are kept for the draws' constants.
+    if (instanceCount > 0 && separateDraws)
+    {
+        std::vector<ModelInstance> instances = CreateInstanceGrid(instanceCount, m_instanceGridCenter);
+
+        m_objectWorlds.resize(instanceCount);
+        for (unsigned int i = 0; i < instanceCount; ++i)
+        {
+            m_objectWorlds[i] = instances[i].m_world;
+
+            XMFLOAT3 center;
+            XMFLOAT3 extents;
+            TransformBounds(modelCenter, modelExtents, XMLoadFloat4x4(&instances[i].m_world), center, extents);
+            m_sceneTree.Insert(MakeAabb(center, extents), kFirstObjectVolume + i);
+            m_volumeCenters[kFirstObjectVolume + i] = center;
+            m_volumeExtents[kFirstObjectVolume + i] = extents;
+        }
+    }
+    // The instance grid doesn't move, it is uploaded once here.
+    else if (instanceCount > 0)
+    {
+        std::vector<ModelInstance> instances = CreateInstanceGrid(instanceCount, m_instanceGridCenter);
+        if (!m_pModel->InitializeInstances(m_pDirect3D->GetDevice(), instanceCount) ||
+            !m_pModel->SetInstances(m_pDirect3D->GetDeviceContext(), instances.data(), instanceCount))
+        {
+            ShowError(hwnd, L"Could not create the model instances.", L"Error", MB_OK);
+            return false;
+        }
+
+        // It is drawn all at once, so it is culled as one box around every copy.
+        XMVECTOR minimum = XMVectorZero();
+        XMVECTOR maximum = XMVectorZero();
+        for (unsigned int i = 0; i < instanceCount; ++i)
+        {
+            XMFLOAT3 center;
+            XMFLOAT3 extents;
+            TransformBounds(modelCenter, modelExtents, XMLoadFloat4x4(&instances[i].m_world), center, extents);
+
+            XMVECTOR centerVector = XMLoadFloat3(&center);
+            XMVECTOR extentsVector = XMLoadFloat3(&extents);
+            XMVECTOR instanceMinimum = XMVectorSubtract(centerVector, extentsVector);
+            XMVECTOR instanceMaximum = XMVectorAdd(centerVector, extentsVector);
+            minimum = (i == 0) ? instanceMinimum : XMVectorMin(minimum, instanceMinimum);
+            maximum = (i == 0) ? instanceMaximum : XMVectorMax(maximum, instanceMaximum);
+        }
+
+        Aabb gridAabb;
+        XMStoreFloat3(&gridAabb.m_min, minimum);
+        XMStoreFloat3(&gridAabb.m_max, maximum);
+        m_sceneTree.Insert(gridAabb, kInstanceGridVolume);
+        XMStoreFloat3(&m_volumeCenters[kInstanceGridVolume], XMVectorScale(XMVectorAdd(minimum, maximum), 0.5f));
+        XMStoreFloat3(&m_volumeExtents[kInstanceGridVolume], XMVectorScale(XMVectorSubtract(maximum, minimum), 0.5f));
+    }
+
     return true;
 }
 
@@ -83,6 +334,23 @@ bool Graphics::Initialize(int screenWidth, int screenHeight, HWND hwnd)
 // If it wasn't we can assume it was never set up and not try to shut it down.
 void Graphics::Shutdown()
 {
+    // Let a running update finish before the objects it uses go away.
+    FinishUpdate();
+
+    m_transforms.Clear();
+    m_rootTransform = INVALID_TRANSFORM_HANDLE;
+    m_modelTransform = INVALID_TRANSFORM_HANDLE;
+
+    m_commandRecorder.Shutdown();
+    m_occlusionCuller.Shutdown();
+    m_sceneTree.Clear();
+    m_modelProxy = INVALID_AABB_PROXY;
+    m_volumeCenters.clear();
+    m_volumeExtents.clear();
+    m_candidateCuller.Clear();
+    m_objectWorlds.clear();
+    m_viewConstants.Shutdown();
+
     if (m_pColorShader)
     {
         m_pColorShader->Shutdown();
@@ -97,6 +365,8 @@ void Graphics::Shutdown()
         m_pModel = nullptr;
     }
 
+    m_geometryPool.Shutdown();
+
     if (m_pCamera)
     {
         m_pCamera.reset();
@@ -112,39 +382,376 @@ void Graphics::Shutdown()
     }
 }
 
+void Graphics::BeginFrame()
+{
+    m_pDirect3D->BeginFrame();
+}
+
+//-----------------------------------------------------------------
+// Hands the next updated frame to the render and keeps the scene
+// update running ahead of it on the job system.
+//
+//  - Make sure the frame about to be rendered has been updated.
+//  - Start the update of a later frame if there is a free slot.
+//  - Submit the frame while that update runs.
+//-----------------------------------------------------------------
 bool Graphics::Frame()
 {
+    PROFILE_SCOPE("Graphics::Frame");
+
+    unsigned int pipelineDepth = static_cast<unsigned int>(m_frameStates.size());
+
+    // The frame to render has to be updated first.
+    while (m_nextUpdateFrame <= m_nextRenderFrame)
+    {
+        if (m_updateRunning)
+        {
+            FinishUpdate();
+        }
+        else
+        {
+            StartUpdate();
+            FinishUpdate();
+        }
+    }
+
+    // Overlap the update of a later frame with this frame's submission.
+    // Its slot is never the one being rendered since it is at most depth - 1 frames ahead.
+    if (!m_updateRunning && m_nextUpdateFrame < m_nextRenderFrame + pipelineDepth)
+    {
+        StartUpdate();
+    }
+
     // Render the graphics scene.
-    if (!Render())
+    const FrameState& kFrameState = m_frameStates[m_nextRenderFrame % pipelineDepth];
+    std::chrono::steady_clock::time_point renderStartTime = std::chrono::steady_clock::now();
+    if (!Render(kFrameState))
     {
         return false;
     }
+
+    double renderSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - renderStartTime).count();
+    m_lastFrameTimes.m_updateSeconds = kFrameState.m_updateSeconds;
+    m_lastFrameTimes.m_submitSeconds = std::max(0.0, renderSeconds - m_pDirect3D->GetFramePacer().GetLastFrameTiming().m_presentSeconds);
+
+    double latency = std::chrono::duration<double>(std::chrono::steady_clock::now() - kFrameState.m_updateStartTime).count();
+    ++m_latencyFrameCount;
+    m_latencyTotalSeconds += latency;
+    m_latencyMaxSeconds = std::max(m_latencyMaxSeconds, latency);
+
+    ++m_nextRenderFrame;
+
     return true;
 }
 
-bool Graphics::Render()
+void Graphics::SetFixedFrameTime(double frameSeconds)
 {
-    // Clear the buffers to begin the scene.
-    m_pDirect3D->BeginScene(0.f, 0.f, 0.f, 1.0f);
+    m_timestep.SetFrameSeconds(frameSeconds);
+}
+
+FramePipelineStats Graphics::GetPipelineStats() const
+{
+    FramePipelineStats stats;
+    stats.m_pipelineDepth = static_cast<unsigned int>(m_frameStates.size());
+    stats.m_frameCount = m_latencyFrameCount;
+    stats.m_averageLatencySeconds = (m_latencyFrameCount > 0) ? (m_latencyTotalSeconds / m_latencyFrameCount) : 0.0;
+    stats.m_maxLatencySeconds = m_latencyMaxSeconds;
+    return stats;
+}
+
+FixedTimestepStats Graphics::GetSimulationStats() const
+{
+    return m_timestep.GetStats();
+}
+
+FramePacingStats Graphics::GetPacingStats() const
+{
+    return m_pDirect3D->GetFramePacer().GetStats();
+}
+
+const FrameTimes& Graphics::GetLastFrameTimes() const
+{
+    return m_lastFrameTimes;
+}
+
+const NullRenderContext* Graphics::GetNullRenderContext() const
+{
+    return m_pDirect3D ? m_pDirect3D->GetNullRenderContext() : nullptr;
+}
+
+const SoftwareRenderContext* Graphics::GetSoftwareRenderContext() const
+{
+    return m_pDirect3D ? m_pDirect3D->GetSoftwareRenderContext() : nullptr;
+}
+
+//-----------------------------------------------------------------
+// Advances the scene by one fixed step.
+//-----------------------------------------------------------------
+void Graphics::Simulate(SceneState& scene, float stepSeconds)
+{
+    scene.m_modelRotation = fmodf(scene.m_modelRotation + MODEL_SPIN_SPEED * stepSeconds, XM_2PI);
+    scene.m_sceneSeconds += stepSeconds;
+}
+
+//-----------------------------------------------------------------
+// Scene update for one frame. Only touches the scene objects and
+// the frame state it writes, never the render objects.
+//
+// Runs the simulation steps that are due, then blends the last two
+// states by how far the clock is into the next step.
+//-----------------------------------------------------------------
+void Graphics::Update(FrameState& frameState)
+{
+    PROFILE_SCOPE("Graphics::Update");
+
+    unsigned int steps = m_timestep.Advance();
+    for (unsigned int i = 0; i < steps; ++i)
+    {
+        m_previousScene = m_currentScene;
+
+        m_timestep.BeginStep();
+        Simulate(m_currentScene, static_cast<float>(m_timestep.GetStepSeconds()));
+        m_timestep.EndStep();
+    }
+
+    float alpha = m_timestep.GetAlpha();
+
+    // Move the camera to the blended state.
+    XMFLOAT3 cameraPosition = Lerp(m_previousScene.m_cameraPosition, m_currentScene.m_cameraPosition, alpha);
+    XMFLOAT3 cameraRotation = Lerp(m_previousScene.m_cameraRotation, m_currentScene.m_cameraRotation, alpha);
+    m_pCamera->SetPosition(cameraPosition.x, cameraPosition.y, cameraPosition.z);
+    m_pCamera->SetRotation(cameraRotation.x, cameraRotation.y, cameraRotation.z);
 
     // Generate the view matrix based on the camera's position
     m_pCamera->Render();
 
-    // Get the world, view, and projection matrices from the camera and d3d objects.
-    XMMATRIX worldMatrix;
-    m_pDirect3D->GetWorldMatrix(worldMatrix);
-    
+    // The rotation wraps at 2 pi, blend across the wrap the short way round.
+    float previousRotation = m_previousScene.m_modelRotation;
+    float currentRotation = m_currentScene.m_modelRotation;
+    if (currentRotation < previousRotation - XM_PI)
+    {
+        currentRotation += XM_2PI;
+    }
+    float modelRotation = previousRotation + (currentRotation - previousRotation) * alpha;
+
+    // Turn the model about z and get the world matrices of the scene, then the view matrix from the camera.
+    XMFLOAT4 modelQuaternion;
+    XMStoreFloat4(&modelQuaternion, XMQuaternionRotationRollPitchYaw(0.f, 0.f, modelRotation));
+    m_transforms.SetRotation(m_modelTransform, modelQuaternion);
+    m_transforms.Update(m_pJobSystem);
+
     XMMATRIX viewMatrix;
     m_pCamera->GetViewMatrix(viewMatrix);
-    
+
+    frameState.m_worldMatrix = m_transforms.GetWorldMatrix(m_modelTransform);
+    XMStoreFloat4x4(&frameState.m_viewMatrix, viewMatrix);
+    frameState.m_sceneSeconds = m_previousScene.m_sceneSeconds + (m_currentScene.m_sceneSeconds - m_previousScene.m_sceneSeconds) * alpha;
+}
+
+void Graphics::StartUpdate()
+{
+    FrameState& frameState = m_frameStates[m_nextUpdateFrame % m_frameStates.size()];
+    frameState.m_frameIndex = m_nextUpdateFrame;
+    frameState.m_updateStartTime = std::chrono::steady_clock::now();
+
+    Job job;
+    job.m_pFunction = &Graphics::UpdateJob;
+    job.m_pData = this;
+
+    m_updateRunning = true;
+    m_pJobSystem->Run(&job, 1, &m_updateCounter);
+}
+
+void Graphics::FinishUpdate()
+{
+    PROFILE_SCOPE("Graphics::FinishUpdate");
+
+    if (!m_updateRunning)
+    {
+        return;
+    }
+
+    m_pJobSystem->Wait(m_updateCounter);
+    m_updateRunning = false;
+    ++m_nextUpdateFrame;
+}
+
+void Graphics::UpdateJob(void* pData)
+{
+    Graphics* pGraphics = static_cast<Graphics*>(pData);
+    FrameState& frameState = pGraphics->m_frameStates[pGraphics->m_nextUpdateFrame % pGraphics->m_frameStates.size()];
+
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    pGraphics->Update(frameState);
+    frameState.m_updateSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+bool Graphics::Render(const FrameState& kFrameState)
+{
+    PROFILE_SCOPE("Graphics::Render");
+
+    // Clear the buffers to begin the scene.
+    m_pDirect3D->BeginScene(0.f, 0.f, 0.f, 1.0f);
+
+    // Get the world and view matrices the update handed over and the projection matrix from the d3d object.
+    XMMATRIX worldMatrix = XMLoadFloat4x4(&kFrameState.m_worldMatrix);
+    XMMATRIX viewMatrix = XMLoadFloat4x4(&kFrameState.m_viewMatrix);
+
     XMMATRIX projectionMatrix;
     m_pDirect3D->GetProjectionMatrix(projectionMatrix);
 
-    // Put the model vertex and index buffers on the graphics pipeline to perpare them for drawing.
-    m_pModel->Render(m_pDirect3D->GetDeviceContext());
+    // Update the per view constants. They only reach the GPU when they changed.
+    ViewConstants viewConstants;
+    XMStoreFloat4x4(&viewConstants.m_view, XMMatrixTranspose(viewMatrix));
+    XMStoreFloat4x4(&viewConstants.m_projection, XMMatrixTranspose(projectionMatrix));
+    XMStoreFloat4x4(&viewConstants.m_viewProjection, XMMatrixTranspose(XMMatrixMultiply(viewMatrix, projectionMatrix)));
 
-    // Render the model using the color shader.
-    if (!m_pColorShader->Render(m_pDirect3D->GetDeviceContext(), m_pModel->GetIndexCount(), worldMatrix, viewMatrix, projectionMatrix))
+    if (!m_viewConstants.Update(m_pDirect3D->GetDeviceContext(), &viewConstants))
+    {
+        return false;
+    }
+
+    // They stay bound for the whole frame, every command list binds them once.
+    ID3D11Buffer* pViewConstants = m_viewConstants.GetBuffer();
+
+    // Move the model's box to where it is this frame, it spins in place. Then ask the scene tree what the view sees.
+    XMFLOAT3 modelCenter;
+    XMFLOAT3 modelExtents;
+    m_pModel->GetBounds(modelCenter, modelExtents);
+    TransformBounds(modelCenter, modelExtents, worldMatrix, modelCenter, modelExtents);
+    m_sceneTree.Move(m_modelProxy, MakeAabb(modelCenter, modelExtents), XMFLOAT3(0.f, 0.f, 0.f));
+    m_volumeCenters[kModelVolume] = modelCenter;
+    m_volumeExtents[kModelVolume] = modelExtents;
+
+    XMMATRIX viewProjection = XMMatrixMultiply(viewMatrix, projectionMatrix);
+    Frustum frustum = FrustumCuller::ExtractFrustum(viewProjection);
+
+    m_frustumCandidates.clear();
+    m_sceneTree.QueryFrustum(frustum, [this](AabbProxy proxy)
+    {
+        m_frustumCandidates.push_back(m_sceneTree.GetUserData(proxy));
+        return true;
+    });
+
+    // The fat boxes reach past the objects, so the tree lets through some that are out of view.
+    // Cull the candidates' own boxes as one batch, on the job system when there are enough of them.
+    m_candidateCuller.Clear();
+    for (uint32_t volume : m_frustumCandidates)
+    {
+        m_candidateCuller.Add(m_volumeCenters[volume], m_volumeExtents[volume]);
+    }
+    m_candidateCuller.Cull(frustum, m_pJobSystem, m_frustumVisible);
+
+    const FrustumCullStats& kFrustumStats = m_candidateCuller.GetStats();
+    RenderStats::AddFrustumTests(static_cast<unsigned int>(kFrustumStats.m_tested), static_cast<unsigned int>(kFrustumStats.m_tested - kFrustumStats.m_visible));
+
+    m_occludeeAabbs.clear();
+    for (uint32_t index : m_frustumVisible)
+    {
+        uint32_t volume = m_frustumCandidates[index];
+        m_occludeeAabbs.push_back(MakeAabb(m_volumeCenters[volume], m_volumeExtents[volume]));
+    }
+
+    // Of those, drop what the model hides. It is its own occluder, but its box always reaches past its triangles.
+    m_occlusionCuller.BeginFrame(viewProjection);
+    m_occlusionCuller.AddOccluder(m_pModel->GetPositions().data(), static_cast<unsigned int>(m_pModel->GetPositions().size()), m_pModel->GetIndices().data(), static_cast<unsigned int>(m_pModel->GetIndices().size()), worldMatrix);
+    m_occlusionCuller.Rasterize(m_pJobSystem);
+    m_occlusionCuller.Cull(m_occludeeAabbs.data(), static_cast<unsigned int>(m_occludeeAabbs.size()), m_pJobSystem, m_unoccluded);
+
+    const OcclusionCullStats& kOcclusionStats = m_occlusionCuller.GetStats();
+    RenderStats::AddOcclusionTests(static_cast<unsigned int>(kOcclusionStats.m_tested), static_cast<unsigned int>(kOcclusionStats.m_culled));
+
+    m_visibleVolumes.clear();
+    for (uint32_t index : m_unoccluded)
+    {
+        m_visibleVolumes.push_back(m_frustumCandidates[m_frustumVisible[index]]);
+    }
+
+    // Collect the frame's draws. Each visible volume gets a packet and a key, the queue sorts them into submission order.
+    m_renderQueue.Clear();
+    m_drawPackets.clear();
+
+    for (uint32_t volume : m_visibleVolumes)
+    {
+        DrawPacket packet = {};
+        packet.m_pModel = m_pModel.get();
+
+        if (volume == kModelVolume)
+        {
+            packet.m_kind = DrawPacket::Kind::Model;
+            packet.m_object = kSpinningModel;
+            m_renderQueue.Push(RenderQueue::MakeOpaqueKey(kColorShaderKey, kDefaultStateKey, m_pModel->GetGeometryHandle(), ViewDepth(XMFLOAT3(0.f, 0.f, 0.f), XMMatrixMultiply(worldMatrix, viewMatrix))), static_cast<uint32_t>(m_drawPackets.size()));
+        }
+        else if (volume == kInstanceGridVolume)
+        {
+            // Every copy of the instance grid in one draw.
+            packet.m_kind = DrawPacket::Kind::ModelInstances;
+            m_renderQueue.Push(RenderQueue::MakeOpaqueKey(kColorInstancedShaderKey, kDefaultStateKey, m_pModel->GetGeometryHandle(), ViewDepth(m_instanceGridCenter, viewMatrix)), static_cast<uint32_t>(m_drawPackets.size()));
+        }
+        else
+        {
+            // One copy of a grid that is drawn one by one.
+            packet.m_kind = DrawPacket::Kind::Model;
+            packet.m_object = volume - kFirstObjectVolume;
+
+            const XMFLOAT4X4& kWorld = m_objectWorlds[packet.m_object];
+            m_renderQueue.Push(RenderQueue::MakeOpaqueKey(kColorShaderKey, kDefaultStateKey, m_pModel->GetGeometryHandle(), ViewDepth(XMFLOAT3(kWorld.m[3][0], kWorld.m[3][1], kWorld.m[3][2]), viewMatrix)), static_cast<uint32_t>(m_drawPackets.size()));
+        }
+
+        m_drawPackets.push_back(packet);
+    }
+
+    m_renderQueue.Sort(m_pJobSystem);
+
+    // Write the constants of every draw with one map of the upload ring, before anything is drawn.
+    ConstantUploadRing& uploadRing = m_pDirect3D->GetConstantUploadRing();
+
+    if (!uploadRing.BeginUpload(m_pDirect3D->GetDeviceContext()))
+    {
+        return false;
+    }
+
+    bool written = true;
+    for (DrawPacket& packet : m_drawPackets)
+    {
+        if (packet.m_kind == DrawPacket::Kind::Model)
+        {
+            XMMATRIX packetWorld = (packet.m_object == kSpinningModel) ? worldMatrix : XMLoadFloat4x4(&m_objectWorlds[packet.m_object]);
+            written = written && m_pColorShader->WriteParameters(uploadRing, packetWorld, packet.m_parameters);
+        }
+    }
+
+    uploadRing.EndUpload(m_pDirect3D->GetDeviceContext());
+
+    if (!written)
+    {
+        return false;
+    }
+
+    // Upload the geometry that changed before anything records, every model draws from the shared buffers.
+    m_geometryPool.Bind(m_pDirect3D->GetDeviceContext());
+
+    // Record the draws in key order, split over the job system when there are enough of them.
+    // A list starts from the default state, so each one binds what the frame draws with first.
+    std::atomic<bool> drawn(true);
+    m_commandRecorder.Record(m_pJobSystem, m_renderQueue.GetCount(), MIN_DRAWS_PER_COMMAND_LIST, [&](RenderContext* pContext, unsigned int begin, unsigned int end)
+    {
+        m_pDirect3D->BindRenderTargets(pContext);
+        pContext->VSSetConstantBuffers(VIEW_CONSTANTS_SLOT, 1, &pViewConstants);
+        RenderStats::AddStateBinds(1);
+        m_geometryPool.BindBuffers(pContext);
+
+        const RenderQueueEntry* pEntries = m_renderQueue.GetEntries();
+        for (unsigned int i = begin; i < end; ++i)
+        {
+            if (!Draw(pContext, m_drawPackets[pEntries[i].m_packet]))
+            {
+                drawn = false;
+            }
+        }
+    });
+
+    if (!drawn || !m_commandRecorder.Submit(m_pDirect3D->GetDeviceContext(), m_pJobSystem))
     {
         return false;
     }
@@ -154,3 +761,19 @@ bool Graphics::Render()
 
     return true;
 }
+
+// Safe on any thread that owns the context, it only reads the models and the shader.
+bool Graphics::Draw(RenderContext* pDeviceContext, const DrawPacket& kPacket)
+{
+    switch (kPacket.m_kind)
+    {
+    case DrawPacket::Kind::Model:
+        return m_pColorShader->Render(pDeviceContext, kPacket.m_pModel->GetGeometry(), kPacket.m_parameters);
+
+    case DrawPacket::Kind::ModelInstances:
+        kPacket.m_pModel->RenderInstanced(pDeviceContext);
+        return m_pColorShader->RenderInstanced(pDeviceContext, kPacket.m_pModel->GetGeometry(), kPacket.m_pModel->GetInstanceCount());
+    }
+
+    return false;
+}
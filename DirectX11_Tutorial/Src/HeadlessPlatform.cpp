@@ -0,0 +1,126 @@
+//////////////////////////////////////////////////////////////////////
+// Filename: HeadlessPlatform.cpp
+//////////////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+
+#include "System/HeadlessPlatform.h"
+
+HeadlessPlatform::HeadlessPlatform(int screenWidth, int screenHeight, unsigned int frameLimit, double secondsLimit, const std::string& resultsFileName)
+    : m_screenWidth(screenWidth)
+    , m_screenHeight(screenHeight)
+    , m_frameLimit(frameLimit)
+    , m_secondsLimit(secondsLimit)
+    , m_resultsFileName(resultsFileName)
+    , m_frameCount(0)
+    , m_totalSeconds(0.0)
+    , m_minFrameSeconds(0.0)
+    , m_maxFrameSeconds(0.0)
+{
+}
+
+bool HeadlessPlatform::Initialize(int& screenWidth, int& screenHeight)
+{
+    screenWidth = m_screenWidth;
+    screenHeight = m_screenHeight;
+
+    m_frameCount = 0;
+    m_totalSeconds = 0.0;
+    m_minFrameSeconds = 0.0;
+    m_maxFrameSeconds = 0.0;
+
+    // Timing starts at the end of the first frame so the graphics setup isn't measured.
+    m_startTime = Clock::time_point();
+
+    return true;
+}
+
+void HeadlessPlatform::Shutdown()
+{
+    WriteResults();
+}
+
+bool HeadlessPlatform::PumpMessages()
+{
+    // There are no messages, the render thread ends the run.
+    return true;
+}
+
+void HeadlessPlatform::WaitForMessages(unsigned int milliseconds)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+}
+
+//-----------------------------------------------------------------
+// Closes the timing of the frame that just ran and decides
+// whether another one should run.
+//-----------------------------------------------------------------
+bool HeadlessPlatform::FrameCompleted()
+{
+    Clock::time_point now = Clock::now();
+
+    if (m_startTime == Clock::time_point())
+    {
+        m_startTime = now;
+        m_frameStartTime = now;
+        return m_frameLimit != 1;
+    }
+
+    double frameSeconds = std::chrono::duration<double>(now - m_frameStartTime).count();
+    m_frameStartTime = now;
+
+    m_minFrameSeconds = (m_frameCount == 0) ? frameSeconds : std::min(m_minFrameSeconds, frameSeconds);
+    m_maxFrameSeconds = std::max(m_maxFrameSeconds, frameSeconds);
+    ++m_frameCount;
+
+    m_totalSeconds = std::chrono::duration<double>(now - m_startTime).count();
+
+    // The warm-up frame is one of the limit's.
+    if (m_frameLimit > 0 && m_frameCount + 1 >= m_frameLimit)
+    {
+        return false;
+    }
+
+    if (m_secondsLimit > 0.0 && m_totalSeconds >= m_secondsLimit)
+    {
+        return false;
+    }
+
+    return true;
+}
+
+HWND HeadlessPlatform::GetWindowHandle() const
+{
+    return nullptr;
+}
+
+void HeadlessPlatform::WriteResults() const
+{
+    double averageMilliseconds = (m_frameCount > 0) ? (m_totalSeconds * 1000.0 / m_frameCount) : 0.0;
+    double framesPerSecond = (m_totalSeconds > 0.0) ? (m_frameCount / m_totalSeconds) : 0.0;
+
+    char results[512];
+    sprintf_s(results, sizeof(results),
+        "resolution: %dx%d\n"
+        "frames: %u\n"
+        "measured_frames: %u\n"
+        "seconds: %.6f\n"
+        "average_ms: %.4f\n"
+        "min_ms: %.4f\n"
+        "max_ms: %.4f\n"
+        "fps: %.2f\n",
+        m_screenWidth, m_screenHeight, (m_startTime == Clock::time_point()) ? 0 : m_frameCount + 1, m_frameCount, m_totalSeconds,
+        averageMilliseconds, m_minFrameSeconds * 1000.0, m_maxFrameSeconds * 1000.0, framesPerSecond);
+
+    // A /SUBSYSTEM:WINDOWS build has no console attached, so the file is the main output.
+    fputs(results, stdout);
+    OutputDebugStringA(results);
+
+    FILE* pFile = nullptr;
+    if (fopen_s(&pFile, m_resultsFileName.c_str(), "w") == 0 && pFile)
+    {
+        fputs(results, pFile);
+        fclose(pFile);
+    }
+}
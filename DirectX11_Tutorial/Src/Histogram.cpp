@@ -0,0 +1,113 @@
+//////////////////////////////////////////////////////////////////////
+// Filename: Histogram.cpp
+//////////////////////////////////////////////////////////////////////
+#include <algorithm>
+
+#include "System/Histogram.h"
+
+namespace
+{
+    constexpr uint64_t kMaxMicroseconds = (1ull << 36) - 1;
+}
+
+Histogram::Histogram()
+{
+    Reset();
+}
+
+void Histogram::Record(double seconds)
+{
+    uint64_t microseconds = (seconds > 0.0) ? static_cast<uint64_t>(seconds * 1000000.0 + 0.5) : 0;
+    microseconds = std::min(microseconds, kMaxMicroseconds);
+
+    ++m_buckets[GetBucket(microseconds)];
+    ++m_count;
+    m_totalMicroseconds += microseconds;
+    m_maxMicroseconds = std::max(m_maxMicroseconds, microseconds);
+}
+
+void Histogram::Reset()
+{
+    std::fill(m_buckets, m_buckets + kBucketCount, 0ull);
+    m_count = 0;
+    m_totalMicroseconds = 0;
+    m_maxMicroseconds = 0;
+}
+
+uint64_t Histogram::GetCount() const
+{
+    return m_count;
+}
+
+double Histogram::GetMeanSeconds() const
+{
+    return (m_count > 0) ? (static_cast<double>(m_totalMicroseconds) / m_count / 1000000.0) : 0.0;
+}
+
+double Histogram::GetMaxSeconds() const
+{
+    return m_maxMicroseconds / 1000000.0;
+}
+
+//-----------------------------------------------------------------
+// The value below which the given percentage of the recorded
+// values fall, as the middle of the bucket it lands in.
+//-----------------------------------------------------------------
+double Histogram::GetPercentileSeconds(double percentile) const
+{
+    if (m_count == 0)
+    {
+        return 0.0;
+    }
+
+    percentile = std::min(100.0, std::max(0.0, percentile));
+
+    uint64_t rank = static_cast<uint64_t>(percentile / 100.0 * m_count + 0.5);
+    rank = std::min(m_count, std::max<uint64_t>(1, rank));
+
+    uint64_t seen = 0;
+    for (unsigned int i = 0; i < kBucketCount; ++i)
+    {
+        seen += m_buckets[i];
+        if (seen >= rank)
+        {
+            // Never report more than was actually recorded.
+            return std::min(GetBucketMidpoint(i), m_maxMicroseconds) / 1000000.0;
+        }
+    }
+
+    return GetMaxSeconds();
+}
+
+unsigned int Histogram::GetBucket(uint64_t microseconds)
+{
+    if (microseconds < kLinearBuckets)
+    {
+        return static_cast<unsigned int>(microseconds);
+    }
+
+    // Keep the top 7 bits, the highest of them picks the power of two and the other 6 the sub-bucket.
+    unsigned int highestBit = 0;
+    while ((microseconds >> (highestBit + 1)) != 0)
+    {
+        ++highestBit;
+    }
+
+    unsigned int shift = highestBit - 6;
+    unsigned int subBucket = static_cast<unsigned int>(microseconds >> shift) - kSubBuckets;
+
+    return kLinearBuckets + (shift - 1) * kSubBuckets + subBucket;
+}
+
+uint64_t Histogram::GetBucketMidpoint(unsigned int bucket)
+{
+    if (bucket < kLinearBuckets)
+    {
+        return bucket;
+    }
+
+    unsigned int shift = (bucket - kLinearBuckets) / kSubBuckets + 1;
+    uint64_t mantissa = (bucket - kLinearBuckets) % kSubBuckets + kSubBuckets;
+
+    return (mantissa << shift) + ((1ull << shift) >> 1);
+}
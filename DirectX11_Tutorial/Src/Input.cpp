@@ -1,9 +1,21 @@
 ////////////////////////////////////////////////////////////////////////////////
 // Filename: inputclass.cpp
 ////////////////////////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <cstddef>
+
 #include "Input/Input.h"
+#include "System/Profiler.h"
 
 Input::Input()
+    : m_mouseX(0)
+    , m_mouseY(0)
+    , m_droppedEventCount(0)
+    , m_frameIndex(0)
+    , m_recordingFailed(false)
+    , m_latencyEventCount(0)
+    , m_latencyTotalSeconds(0.0)
+    , m_latencyMaxSeconds(0.0)
 {
 }
 
@@ -21,13 +33,176 @@ void Input::Initialize()
     for (size_t i = 0; i < 256; ++i)
     {
         m_keys[i] = false;
+        m_keysPressed[i] = false;
+    }
+
+    m_mouseButtons[InputEvent::kLeftButton] = false;
+    m_mouseButtons[InputEvent::kRightButton] = false;
+
+    // A frame rarely sees more than a few hundred events, the batch grows if it does.
+    m_frameEvents.reserve(1024);
+}
+
+void Input::Shutdown()
+{
+    if (m_pRecorder)
+    {
+        m_pRecorder->Close();
+        m_pRecorder.reset();
+        m_pRecorder = nullptr;
+    }
+
+    m_pPlayer.reset();
+    m_pPlayer = nullptr;
+}
+
+bool Input::StartRecording(const char* pFileName)
+{
+    m_pRecorder = std::make_unique<InputRecorder>();
+    if (!m_pRecorder->Open(pFileName))
+    {
+        m_pRecorder.reset();
+        m_pRecorder = nullptr;
+        return false;
+    }
+
+    return true;
+}
+
+bool Input::StartReplay(const char* pFileName)
+{
+    m_pPlayer = std::make_unique<InputPlayer>();
+    if (!m_pPlayer->Open(pFileName))
+    {
+        m_pPlayer.reset();
+        m_pPlayer = nullptr;
+        return false;
     }
+
+    return true;
+}
+
+bool Input::IsReplayFinished() const
+{
+    return m_pPlayer && m_pPlayer->IsFinished(m_frameIndex);
+}
+
+//-----------------------------------------------------------------
+// Ends the recording with the number of frames it covers, so a
+// replay stops on the same frame.
+//-----------------------------------------------------------------
+bool Input::StopRecording()
+{
+    if (m_pRecorder)
+    {
+        if (!m_pRecorder->Finish(m_frameIndex))
+        {
+            m_recordingFailed = true;
+        }
+
+        m_pRecorder.reset();
+        m_pRecorder = nullptr;
+    }
+
+    return !m_recordingFailed;
+}
+
+//-----------------------------------------------------------------
+// Queues an event for the next frame. Returns false (and counts it
+// as dropped) when the render thread has fallen that far behind.
+//-----------------------------------------------------------------
+bool Input::PushEvent(const InputEvent& kEvent)
+{
+    if (!m_eventQueue.TryPush(kEvent))
+    {
+        m_droppedEventCount.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------
+// Takes every event queued since the last frame as this frame's
+// batch and applies them in the order they happened. When
+// replaying, live events are thrown away and the recorded batch
+// of this frame is used instead.
+//-----------------------------------------------------------------
+bool Input::BeginFrame()
+{
+    PROFILE_SCOPE("Input::BeginFrame");
+
+    for (size_t i = 0; i < 256; ++i)
+    {
+        m_keysPressed[i] = false;
+    }
+
+    m_frameEvents.clear();
+
+    InputEvent event;
+    while (m_eventQueue.TryPop(event))
+    {
+        if (!m_pPlayer)
+        {
+            m_frameEvents.push_back(event);
+        }
+    }
+
+    if (m_pPlayer)
+    {
+        m_pPlayer->GetFrameEvents(m_frameIndex, std::chrono::steady_clock::now(), m_frameEvents);
+    }
+
+    for (const InputEvent& kEvent : m_frameEvents)
+    {
+        ApplyEvent(kEvent);
+    }
+
+    // A recording with a frame missing can't reproduce the run, so it ends here.
+    bool recorded = true;
+    if (m_pRecorder && !m_pRecorder->Record(m_frameIndex, m_frameEvents))
+    {
+        m_pRecorder->Close();
+        m_pRecorder.reset();
+        m_pRecorder = nullptr;
+        m_recordingFailed = true;
+        recorded = false;
+    }
+
+    ++m_frameIndex;
+
+    return recorded;
+}
+
+void Input::EndFrame()
+{
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+    for (const InputEvent& kEvent : m_frameEvents)
+    {
+        double latency = std::chrono::duration<double>(now - kEvent.m_timestamp).count();
+
+        ++m_latencyEventCount;
+        m_latencyTotalSeconds += latency;
+        m_latencyMaxSeconds = std::max(m_latencyMaxSeconds, latency);
+    }
+}
+
+const std::vector<InputEvent>& Input::GetFrameEvents() const
+{
+    return m_frameEvents;
+}
+
+unsigned long long Input::GetFrameIndex() const
+{
+    return m_frameIndex;
 }
 
 void Input::KeyDown(unsigned int input)
 {
     // If a key is pressed then save that state in the key array.
     m_keys[input] = true;
+    m_keysPressed[input] = true;
     return;
 }
 
@@ -44,4 +219,60 @@ bool Input::IsKeyDown(unsigned int key)
 {
     // Return what state the key is in (pressed/not pressed).
     return m_keys[key];
-}
\ No newline at end of file
+}
+
+bool Input::WasKeyPressed(unsigned int key)
+{
+    // Return whether the key went down during this frame's batch.
+    return m_keysPressed[key];
+}
+
+bool Input::IsMouseButtonDown(unsigned int button)
+{
+    return m_mouseButtons[button];
+}
+
+void Input::GetMousePosition(int& x, int& y)
+{
+    x = m_mouseX;
+    y = m_mouseY;
+}
+
+InputLatencyStats Input::GetLatencyStats() const
+{
+    InputLatencyStats stats;
+    stats.m_eventCount = m_latencyEventCount;
+    stats.m_droppedEventCount = m_droppedEventCount.load(std::memory_order_relaxed);
+    stats.m_averageLatencySeconds = (m_latencyEventCount > 0) ? (m_latencyTotalSeconds / m_latencyEventCount) : 0.0;
+    stats.m_maxLatencySeconds = m_latencyMaxSeconds;
+    return stats;
+}
+
+void Input::ApplyEvent(const InputEvent& kEvent)
+{
+    switch (kEvent.m_type)
+    {
+    case InputEvent::Type::KeyDown:
+        KeyDown(kEvent.m_code & 0xff);
+        break;
+
+    case InputEvent::Type::KeyUp:
+        KeyUp(kEvent.m_code & 0xff);
+        break;
+
+    case InputEvent::Type::MouseMove:
+        m_mouseX = kEvent.m_x;
+        m_mouseY = kEvent.m_y;
+        break;
+
+    case InputEvent::Type::MouseButtonDown:
+    case InputEvent::Type::MouseButtonUp:
+        m_mouseX = kEvent.m_x;
+        m_mouseY = kEvent.m_y;
+        if (kEvent.m_code <= InputEvent::kRightButton)
+        {
+            m_mouseButtons[kEvent.m_code] = (kEvent.m_type == InputEvent::Type::MouseButtonDown);
+        }
+        break;
+    }
+}
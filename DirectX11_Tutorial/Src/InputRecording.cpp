@@ -0,0 +1,249 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: InputRecording.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <cstring>
+
+#include "Input/InputRecording.h"
+
+namespace
+{
+    constexpr char kMagic[4] = { 'I', 'N', 'P', 'R' };
+    constexpr uint32_t kVersion = 1;
+    constexpr size_t kEventSize = 11;
+
+    void WriteU16(uint8_t* pOut, uint16_t value)
+    {
+        pOut[0] = static_cast<uint8_t>(value);
+        pOut[1] = static_cast<uint8_t>(value >> 8);
+    }
+
+    void WriteU32(uint8_t* pOut, uint32_t value)
+    {
+        pOut[0] = static_cast<uint8_t>(value);
+        pOut[1] = static_cast<uint8_t>(value >> 8);
+        pOut[2] = static_cast<uint8_t>(value >> 16);
+        pOut[3] = static_cast<uint8_t>(value >> 24);
+    }
+
+    uint16_t ReadU16(const uint8_t* pIn)
+    {
+        return static_cast<uint16_t>(pIn[0] | (pIn[1] << 8));
+    }
+
+    uint32_t ReadU32(const uint8_t* pIn)
+    {
+        return static_cast<uint32_t>(pIn[0]) | (static_cast<uint32_t>(pIn[1]) << 8) | (static_cast<uint32_t>(pIn[2]) << 16) | (static_cast<uint32_t>(pIn[3]) << 24);
+    }
+}
+
+InputRecorder::InputRecorder()
+    : m_pFile(nullptr)
+{
+}
+
+InputRecorder::~InputRecorder()
+{
+    Close();
+}
+
+bool InputRecorder::Open(const char* pFileName)
+{
+    Close();
+
+    if (fopen_s(&m_pFile, pFileName, "wb") != 0 || !m_pFile)
+    {
+        m_pFile = nullptr;
+        return false;
+    }
+
+    uint8_t header[8];
+    memcpy(header, kMagic, sizeof(kMagic));
+    WriteU32(header + 4, kVersion);
+
+    if (fwrite(header, sizeof(header), 1, m_pFile) != 1)
+    {
+        Close();
+        return false;
+    }
+
+    m_startTime = std::chrono::steady_clock::now();
+    return true;
+}
+
+void InputRecorder::Close()
+{
+    if (m_pFile)
+    {
+        fclose(m_pFile);
+        m_pFile = nullptr;
+    }
+}
+
+bool InputRecorder::Record(unsigned long long frameIndex, const std::vector<InputEvent>& kEvents)
+{
+    if (!m_pFile || kEvents.empty())
+    {
+        return true;
+    }
+
+    // Build the whole batch first so it goes out in one write.
+    std::vector<uint8_t> batch(8 + kEvents.size() * kEventSize);
+    WriteU32(batch.data(), static_cast<uint32_t>(frameIndex));
+    WriteU32(batch.data() + 4, static_cast<uint32_t>(kEvents.size()));
+
+    uint8_t* pOut = batch.data() + 8;
+    for (const InputEvent& kEvent : kEvents)
+    {
+        long long microseconds = std::chrono::duration_cast<std::chrono::microseconds>(kEvent.m_timestamp - m_startTime).count();
+
+        pOut[0] = static_cast<uint8_t>(kEvent.m_type);
+        WriteU16(pOut + 1, static_cast<uint16_t>(kEvent.m_code));
+        WriteU16(pOut + 3, static_cast<uint16_t>(static_cast<int16_t>(kEvent.m_x)));
+        WriteU16(pOut + 5, static_cast<uint16_t>(static_cast<int16_t>(kEvent.m_y)));
+        WriteU32(pOut + 7, static_cast<uint32_t>(microseconds > 0 ? microseconds : 0));
+        pOut += kEventSize;
+    }
+
+    return fwrite(batch.data(), batch.size(), 1, m_pFile) == 1;
+}
+
+bool InputRecorder::Finish(unsigned long long frameCount)
+{
+    if (!m_pFile)
+    {
+        return false;
+    }
+
+    uint8_t end[8];
+    WriteU32(end, static_cast<uint32_t>(frameCount));
+    WriteU32(end + 4, 0);
+
+    bool written = fwrite(end, sizeof(end), 1, m_pFile) == 1;
+    written = (fflush(m_pFile) == 0) && written;
+
+    // A failed close can still lose buffered data.
+    written = (fclose(m_pFile) == 0) && written;
+    m_pFile = nullptr;
+
+    return written;
+}
+
+InputPlayer::InputPlayer()
+    : m_nextBatch(0)
+    , m_frameCount(0)
+{
+}
+
+InputPlayer::~InputPlayer()
+{
+}
+
+bool InputPlayer::Open(const char* pFileName)
+{
+    FILE* pFile = nullptr;
+    if (fopen_s(&pFile, pFileName, "rb") != 0 || !pFile)
+    {
+        return false;
+    }
+
+    std::vector<uint8_t> data;
+    uint8_t buffer[4096];
+    size_t readCount = 0;
+    while ((readCount = fread(buffer, 1, sizeof(buffer), pFile)) > 0)
+    {
+        data.insert(data.end(), buffer, buffer + readCount);
+    }
+    fclose(pFile);
+
+    if (data.size() < 8 || memcmp(data.data(), kMagic, sizeof(kMagic)) != 0 || ReadU32(data.data() + 4) != kVersion)
+    {
+        return false;
+    }
+
+    m_batches.clear();
+    m_events.clear();
+    m_nextBatch = 0;
+    m_frameCount = 0;
+
+    bool ended = false;
+
+    size_t offset = 8;
+    while (offset + 8 <= data.size())
+    {
+        Batch batch;
+        batch.m_frameIndex = ReadU32(data.data() + offset);
+        batch.m_eventCount = ReadU32(data.data() + offset + 4);
+        batch.m_firstEvent = m_events.size();
+        offset += 8;
+
+        if (batch.m_eventCount == 0)
+        {
+            m_frameCount = batch.m_frameIndex;
+            ended = true;
+            break;
+        }
+
+        if (offset + batch.m_eventCount * kEventSize > data.size())
+        {
+            // Truncated file, keep what was complete.
+            break;
+        }
+
+        for (size_t i = 0; i < batch.m_eventCount; ++i)
+        {
+            const uint8_t* pIn = data.data() + offset;
+            if (pIn[0] > static_cast<uint8_t>(InputEvent::Type::MouseButtonUp))
+            {
+                return false;
+            }
+
+            InputEvent event;
+            event.m_type = static_cast<InputEvent::Type>(pIn[0]);
+            event.m_code = ReadU16(pIn + 1);
+            event.m_x = static_cast<int16_t>(ReadU16(pIn + 3));
+            event.m_y = static_cast<int16_t>(ReadU16(pIn + 5));
+            event.m_timestamp = std::chrono::steady_clock::time_point(std::chrono::microseconds(ReadU32(pIn + 7)));
+            m_events.push_back(event);
+
+            offset += kEventSize;
+        }
+
+        m_batches.push_back(batch);
+    }
+
+    if (!ended)
+    {
+        m_frameCount = m_batches.empty() ? 0 : m_batches.back().m_frameIndex + 1;
+    }
+
+    m_startTime = std::chrono::steady_clock::now();
+    return true;
+}
+
+void InputPlayer::GetFrameEvents(unsigned long long frameIndex, std::chrono::steady_clock::time_point timestamp, std::vector<InputEvent>& events)
+{
+    // Skip batches of frames that already went by.
+    while (m_nextBatch < m_batches.size() && m_batches[m_nextBatch].m_frameIndex < frameIndex)
+    {
+        ++m_nextBatch;
+    }
+
+    if (m_nextBatch >= m_batches.size() || m_batches[m_nextBatch].m_frameIndex != frameIndex)
+    {
+        return;
+    }
+
+    const Batch& kBatch = m_batches[m_nextBatch++];
+    for (size_t i = 0; i < kBatch.m_eventCount; ++i)
+    {
+        InputEvent event = m_events[kBatch.m_firstEvent + i];
+        event.m_timestamp = std::min(m_startTime + event.m_timestamp.time_since_epoch(), timestamp);
+        events.push_back(event);
+    }
+}
+
+bool InputPlayer::IsFinished(unsigned long long frameIndex) const
+{
+    return frameIndex >= m_frameCount;
+}
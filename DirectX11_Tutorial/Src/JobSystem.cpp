@@ -0,0 +1,406 @@
+//////////////////////////////////////////////////////////////////////
+// Filename: JobSystem.cpp
+//////////////////////////////////////////////////////////////////////
+#include <climits>
+#include <cstdio>
+
+#include "System/JobSystem.h"
+#include "System/Profiler.h"
+
+namespace
+{
+    constexpr unsigned int kNotAWorker = UINT_MAX;
+
+    // How often an idle worker looks for work before it goes to sleep.
+    constexpr unsigned int kSpinCount = 64;
+
+    // Which worker of which job system the current thread is.
+    thread_local const JobSystem* t_pJobSystem = nullptr;
+    thread_local unsigned int t_workerIndex = kNotAWorker;
+}
+
+JobCounter::JobCounter()
+    : m_pending(0)
+{
+}
+
+bool JobCounter::IsDone() const
+{
+    return m_pending.load(std::memory_order_acquire) == 0;
+}
+
+JobSystem::JobSystem()
+    : m_queuedJobs(0)
+    , m_nextExternalWorker(0)
+    , m_quit(false)
+{
+}
+
+JobSystem::JobSystem(const JobSystem& other)
+{
+}
+
+JobSystem::~JobSystem()
+{
+}
+
+bool JobSystem::Initialize(unsigned int workerCount)
+{
+    m_quit = false;
+    m_queuedJobs = 0;
+
+    for (unsigned int i = 0; i < workerCount; ++i)
+    {
+        std::unique_ptr<Worker> pWorker = std::make_unique<Worker>();
+        pWorker->m_jobsExecuted = 0;
+        pWorker->m_jobsStolen = 0;
+        pWorker->m_busyNanoseconds = 0;
+        m_workers.push_back(std::move(pWorker));
+    }
+
+    // Start the threads only once every deque exists, they steal from each other right away.
+    for (unsigned int i = 0; i < workerCount; ++i)
+    {
+        m_threads.emplace_back(&JobSystem::WorkerMain, this, i);
+    }
+
+    ResetStats();
+
+    return true;
+}
+
+void JobSystem::Shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_quit = true;
+    }
+    m_sleepCondition.notify_all();
+
+    for (std::thread& thread : m_threads)
+    {
+        thread.join();
+    }
+
+    m_threads.clear();
+    m_workers.clear();
+}
+
+unsigned int JobSystem::GetWorkerCount() const
+{
+    return static_cast<unsigned int>(m_workers.size());
+}
+
+unsigned int JobSystem::GetCallingThreadIndex() const
+{
+    unsigned int workerIndex = GetCallingWorker();
+    return (workerIndex != kNotAWorker) ? workerIndex + 1 : 0;
+}
+
+unsigned int JobSystem::GetDefaultWorkerCount()
+{
+    unsigned int hardwareThreads = std::thread::hardware_concurrency();
+    return (hardwareThreads > 1) ? hardwareThreads - 1 : 1;
+}
+
+void JobSystem::Run(const Job* pJobs, unsigned int count, JobCounter* pCounter, JobCounter* pDependency)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    if (pCounter)
+    {
+        pCounter->m_pending.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    // Park the jobs on the dependency if it is still running, Finish() queues them.
+    if (pDependency)
+    {
+        std::lock_guard<std::mutex> lock(pDependency->m_mutex);
+        if (pDependency->m_pending.load(std::memory_order_acquire) != 0)
+        {
+            for (unsigned int i = 0; i < count; ++i)
+            {
+                pDependency->m_continuations.push_back({ pJobs[i], pCounter });
+            }
+            return;
+        }
+    }
+
+    if (m_workers.empty())
+    {
+        // Nothing to hand the jobs to, run them here.
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            pJobs[i].m_pFunction(pJobs[i].m_pData);
+            Finish(pCounter);
+        }
+        return;
+    }
+
+    unsigned int workerIndex = GetCallingWorker();
+
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        // Workers keep their own jobs, everyone else deals them out round robin.
+        unsigned int target = (workerIndex != kNotAWorker) ? workerIndex : m_nextExternalWorker.fetch_add(1, std::memory_order_relaxed) % GetWorkerCount();
+        Push(target, { pJobs[i], pCounter });
+    }
+
+    // Taking the sleep mutex makes sure a worker that just found nothing to do is
+    // either already waiting (and gets the notify) or will see the new jobs.
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+    }
+
+    if (count == 1)
+    {
+        m_sleepCondition.notify_one();
+    }
+    else
+    {
+        m_sleepCondition.notify_all();
+    }
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+    unsigned int workerIndex = GetCallingWorker();
+
+    while (!counter.IsDone())
+    {
+        if (!TryRunJob(workerIndex))
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    // The last Finish() still holds the counter's mutex for a moment after the count
+    // hits zero. Wait for it so the caller can destroy the counter right away.
+    std::lock_guard<std::mutex> lock(counter.m_mutex);
+}
+
+JobWorkerStats JobSystem::GetWorkerStats(unsigned int workerIndex) const
+{
+    const Worker& kWorker = *m_workers[workerIndex];
+
+    JobWorkerStats stats;
+    stats.m_jobsExecuted = kWorker.m_jobsExecuted.load(std::memory_order_relaxed);
+    stats.m_jobsStolen = kWorker.m_jobsStolen.load(std::memory_order_relaxed);
+    stats.m_busySeconds = kWorker.m_busyNanoseconds.load(std::memory_order_relaxed) * 1e-9;
+
+    double elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_statsStartTime).count();
+    stats.m_utilization = (elapsedSeconds > 0.0) ? std::min(1.0, stats.m_busySeconds / elapsedSeconds) : 0.0;
+
+    return stats;
+}
+
+void JobSystem::ResetStats()
+{
+    for (std::unique_ptr<Worker>& pWorker : m_workers)
+    {
+        pWorker->m_jobsExecuted = 0;
+        pWorker->m_jobsStolen = 0;
+        pWorker->m_busyNanoseconds = 0;
+    }
+
+    m_statsStartTime = std::chrono::steady_clock::now();
+}
+
+void JobSystem::Push(unsigned int workerIndex, const JobCounter::Continuation& kJob)
+{
+    Worker& worker = *m_workers[workerIndex];
+    std::lock_guard<std::mutex> lock(worker.m_mutex);
+
+    // Count the job before it can be popped so m_queuedJobs never wraps below zero.
+    m_queuedJobs.fetch_add(1, std::memory_order_release);
+    worker.m_jobs.push_back(kJob);
+}
+
+//-----------------------------------------------------------------
+// The owner takes its newest job.
+//-----------------------------------------------------------------
+bool JobSystem::Pop(unsigned int workerIndex, JobCounter::Continuation& job)
+{
+    Worker& worker = *m_workers[workerIndex];
+    std::lock_guard<std::mutex> lock(worker.m_mutex);
+
+    if (worker.m_jobs.empty())
+    {
+        return false;
+    }
+
+    job = worker.m_jobs.back();
+    worker.m_jobs.pop_back();
+    m_queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+//-----------------------------------------------------------------
+// Takes the oldest job of another worker, starting with the next
+// one along so the thieves don't all hit the same deque.
+//-----------------------------------------------------------------
+bool JobSystem::Steal(unsigned int workerIndex, JobCounter::Continuation& job)
+{
+    unsigned int workerCount = GetWorkerCount();
+    unsigned int start = (workerIndex != kNotAWorker) ? workerIndex + 1 : 0;
+
+    for (unsigned int i = 0; i < workerCount; ++i)
+    {
+        unsigned int victimIndex = (start + i) % workerCount;
+        if (victimIndex == workerIndex)
+        {
+            continue;
+        }
+
+        Worker& victim = *m_workers[victimIndex];
+        std::lock_guard<std::mutex> lock(victim.m_mutex);
+
+        if (!victim.m_jobs.empty())
+        {
+            job = victim.m_jobs.front();
+            victim.m_jobs.pop_front();
+            m_queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool JobSystem::TryRunJob(unsigned int workerIndex)
+{
+    if (m_queuedJobs.load(std::memory_order_acquire) == 0)
+    {
+        return false;
+    }
+
+    JobCounter::Continuation job;
+    bool stolen = false;
+
+    if (workerIndex == kNotAWorker || !Pop(workerIndex, job))
+    {
+        if (!Steal(workerIndex, job))
+        {
+            return false;
+        }
+        stolen = true;
+    }
+
+    if (workerIndex == kNotAWorker)
+    {
+        job.m_job.m_pFunction(job.m_job.m_pData);
+        Finish(job.m_pCounter);
+        return true;
+    }
+
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    {
+        PROFILE_SCOPE("Job");
+        job.m_job.m_pFunction(job.m_job.m_pData);
+    }
+    std::chrono::steady_clock::time_point endTime = std::chrono::steady_clock::now();
+
+    Worker& worker = *m_workers[workerIndex];
+    worker.m_jobsExecuted.fetch_add(1, std::memory_order_relaxed);
+    worker.m_busyNanoseconds.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count(), std::memory_order_relaxed);
+    if (stolen)
+    {
+        worker.m_jobsStolen.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Finish(job.m_pCounter);
+    return true;
+}
+
+//-----------------------------------------------------------------
+// Counts a job as done and queues whatever was waiting on its
+// counter once the counter reaches zero.
+//-----------------------------------------------------------------
+void JobSystem::Finish(JobCounter* pCounter)
+{
+    if (!pCounter)
+    {
+        return;
+    }
+
+    std::vector<JobCounter::Continuation> continuations;
+    {
+        std::lock_guard<std::mutex> lock(pCounter->m_mutex);
+        if (pCounter->m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            continuations.swap(pCounter->m_continuations);
+        }
+    }
+
+    // The continuations were already added to their own counters by Run().
+    for (const JobCounter::Continuation& kContinuation : continuations)
+    {
+        if (m_workers.empty())
+        {
+            kContinuation.m_job.m_pFunction(kContinuation.m_job.m_pData);
+            Finish(kContinuation.m_pCounter);
+            continue;
+        }
+
+        unsigned int workerIndex = GetCallingWorker();
+        Push((workerIndex != kNotAWorker) ? workerIndex : 0, kContinuation);
+    }
+
+    if (!continuations.empty())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+        }
+        m_sleepCondition.notify_all();
+    }
+}
+
+void JobSystem::WorkerMain(unsigned int workerIndex)
+{
+    t_pJobSystem = this;
+    t_workerIndex = workerIndex;
+
+#if PROFILER_ENABLED
+    char threadName[32];
+    sprintf_s(threadName, sizeof(threadName), "Job Worker %u", workerIndex);
+    PROFILE_THREAD(threadName);
+#endif
+
+    unsigned int idleCount = 0;
+
+    while (true)
+    {
+        if (TryRunJob(workerIndex))
+        {
+            idleCount = 0;
+            continue;
+        }
+
+        if (++idleCount < kSpinCount)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_sleepCondition.wait(lock, [this]() { return m_quit || m_queuedJobs.load(std::memory_order_acquire) > 0; });
+
+        if (m_quit && m_queuedJobs.load(std::memory_order_acquire) == 0)
+        {
+            break;
+        }
+
+        idleCount = 0;
+    }
+
+    t_pJobSystem = nullptr;
+    t_workerIndex = kNotAWorker;
+}
+
+unsigned int JobSystem::GetCallingWorker() const
+{
+    return (t_pJobSystem == this) ? t_workerIndex : kNotAWorker;
+}
@@ -0,0 +1,247 @@
+//////////////////////////////////////////////////////////////////////
+// Filename: JobSystemBenchmark.cpp
+//////////////////////////////////////////////////////////////////////
+#include <windows.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "Graphics/CommandListBenchmark.h"
+#include "Graphics/FrustumCullerBenchmark.h"
+#include "Graphics/OcclusionCullerBenchmark.h"
+#include "Graphics/RenderQueueBenchmark.h"
+#include "Graphics/SoftwareRasterBenchmark.h"
+#include "Graphics/TransformHierarchyBenchmark.h"
+#include "System/JobSystemBenchmark.h"
+
+namespace
+{
+    constexpr unsigned int kParallelForCount = 1 << 20;
+    constexpr unsigned int kParallelForGrain = 4096;
+    constexpr unsigned int kFanOutJobs = 4096;
+    constexpr unsigned int kFanOutWork = 256;
+    constexpr int kRepeats = 5;
+
+    // Enough math per element that the loop is compute bound, not memory bound.
+    float SyntheticWork(float value, unsigned int iterations)
+    {
+        for (unsigned int i = 0; i < iterations; ++i)
+        {
+            value = std::sqrt(value * value + 1.0f) * 0.999f + std::sin(value) * 0.001f;
+        }
+        return value;
+    }
+
+    class ParallelForWorkload : public JobSystemWorkload
+    {
+    public:
+        const char* GetName() const override
+        {
+            return "parallel_for";
+        }
+
+        bool Initialize(unsigned int) override
+        {
+            m_values.assign(kParallelForCount, 1.0f);
+            return true;
+        }
+
+        void Shutdown() override
+        {
+            m_values.clear();
+        }
+
+        double Run(JobSystem& jobSystem) override
+        {
+            std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+            jobSystem.ParallelFor(kParallelForCount, kParallelForGrain, [this](unsigned int begin, unsigned int end)
+            {
+                for (unsigned int i = begin; i < end; ++i)
+                {
+                    m_values[i] = SyntheticWork(m_values[i], 16);
+                }
+            });
+
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        }
+
+    private:
+        std::vector<float> m_values;
+    };
+
+    struct FanOutData
+    {
+        std::vector<float>* m_pValues;
+        unsigned int m_index;
+    };
+
+    void FanOutJob(void* pData)
+    {
+        FanOutData* pFanOut = static_cast<FanOutData*>(pData);
+        float& value = (*pFanOut->m_pValues)[pFanOut->m_index];
+        value = SyntheticWork(value, kFanOutWork);
+    }
+
+    class FanOutWorkload : public JobSystemWorkload
+    {
+    public:
+        const char* GetName() const override
+        {
+            return "fan_out";
+        }
+
+        // Both stages work on the same values, so the second really depends on the first.
+        bool Initialize(unsigned int) override
+        {
+            m_values.assign(kFanOutJobs, 1.0f);
+            m_data.resize(kFanOutJobs * 2);
+            m_jobs.resize(kFanOutJobs * 2);
+            for (unsigned int i = 0; i < kFanOutJobs * 2; ++i)
+            {
+                m_data[i].m_pValues = &m_values;
+                m_data[i].m_index = i % kFanOutJobs;
+                m_jobs[i].m_pFunction = FanOutJob;
+                m_jobs[i].m_pData = &m_data[i];
+            }
+
+            return true;
+        }
+
+        void Shutdown() override
+        {
+            m_jobs.clear();
+            m_data.clear();
+            m_values.clear();
+        }
+
+        // Two stages of small jobs, the second only starts once the first is done.
+        double Run(JobSystem& jobSystem) override
+        {
+            std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+            JobCounter firstStage;
+            JobCounter secondStage;
+            jobSystem.Run(m_jobs.data(), kFanOutJobs, &firstStage);
+            jobSystem.Run(m_jobs.data() + kFanOutJobs, kFanOutJobs, &secondStage, &firstStage);
+            jobSystem.Wait(secondStage);
+            jobSystem.Wait(firstStage);
+
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        }
+
+    private:
+        std::vector<float> m_values;
+        std::vector<FanOutData> m_data;
+        std::vector<Job> m_jobs;
+    };
+}
+
+bool RunJobSystemBenchmark(unsigned int maxThreads, const std::string& resultsFileName)
+{
+    if (maxThreads == 0)
+    {
+        maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    std::vector<std::unique_ptr<JobSystemWorkload>> workloads;
+    workloads.push_back(std::make_unique<ParallelForWorkload>());
+    workloads.push_back(std::make_unique<FanOutWorkload>());
+    workloads.push_back(CreateRenderQueueSortWorkload());
+    workloads.push_back(CreateCommandListRecordWorkload());
+    workloads.push_back(CreateFrustumCullWorkload());
+    workloads.push_back(CreateOcclusionCullWorkload());
+    workloads.push_back(CreateTransformUpdateWorkload());
+    workloads.push_back(CreateSoftwareRasterWorkload());
+
+    auto shutdownWorkloads = [&workloads]()
+    {
+        for (std::unique_ptr<JobSystemWorkload>& pWorkload : workloads)
+        {
+            pWorkload->Shutdown();
+        }
+    };
+
+    for (std::unique_ptr<JobSystemWorkload>& pWorkload : workloads)
+    {
+        if (!pWorkload->Initialize(maxThreads))
+        {
+            shutdownWorkloads();
+            return false;
+        }
+    }
+
+    std::string results = "workload,threads,seconds,speedup,average_utilization,jobs_stolen\n";
+
+    std::vector<double> singleThreadSeconds(workloads.size(), 0.0);
+
+    for (unsigned int threads = 1; threads <= maxThreads; ++threads)
+    {
+        // The calling thread counts as one of the threads.
+        JobSystem jobSystem;
+        if (!jobSystem.Initialize(threads - 1))
+        {
+            shutdownWorkloads();
+            return false;
+        }
+
+        for (size_t workload = 0; workload < workloads.size(); ++workload)
+        {
+            // Best of a few runs, the first one also warms up the caches and wakes the workers.
+            double bestSeconds = 0.0;
+            jobSystem.ResetStats();
+
+            for (int repeat = 0; repeat < kRepeats; ++repeat)
+            {
+                double seconds = workloads[workload]->Run(jobSystem);
+                bestSeconds = (repeat == 0) ? seconds : std::min(bestSeconds, seconds);
+            }
+
+            double utilization = 0.0;
+            unsigned long long jobsStolen = 0;
+            for (unsigned int i = 0; i < jobSystem.GetWorkerCount(); ++i)
+            {
+                JobWorkerStats stats = jobSystem.GetWorkerStats(i);
+                utilization += stats.m_utilization;
+                jobsStolen += stats.m_jobsStolen;
+            }
+            if (jobSystem.GetWorkerCount() > 0)
+            {
+                utilization /= jobSystem.GetWorkerCount();
+            }
+
+            if (threads == 1)
+            {
+                singleThreadSeconds[workload] = bestSeconds;
+            }
+
+            char line[256];
+            sprintf_s(line, sizeof(line), "%s,%u,%.6f,%.3f,%.3f,%llu\n",
+                workloads[workload]->GetName(), threads, bestSeconds,
+                (bestSeconds > 0.0) ? singleThreadSeconds[workload] / bestSeconds : 0.0,
+                utilization, jobsStolen);
+            results += line;
+        }
+
+        jobSystem.Shutdown();
+    }
+
+    shutdownWorkloads();
+
+    fputs(results.c_str(), stdout);
+    OutputDebugStringA(results.c_str());
+
+    FILE* pFile = nullptr;
+    if (fopen_s(&pFile, resultsFileName.c_str(), "w") != 0 || !pFile)
+    {
+        return false;
+    }
+
+    fputs(results.c_str(), pFile);
+    fclose(pFile);
+
+    return true;
+}
@@ -1,4 +1,8 @@
 ﻿#include "System/System.h"
+#include "System/JobSystemBenchmark.h"
+#include "Graphics/SceneQueryBenchmark.h"
+#include "Graphics/OcclusionCullerBenchmark.h"
+#include "Graphics/TransformHierarchyBenchmark.h"
 
 int WINAPI WinMain(
     HINSTANCE hInstance, 
@@ -6,21 +10,50 @@ int WINAPI WinMain(
     PSTR pScmdline, 
     int iCmdshow)
 {
-    bool result;
+    int exitCode = 1;
+    SystemSettings settings;
 
+    // Read the run settings, e.g. "-headless -frames 1000 -backend software".
+    if (!settings.ParseCommandLine(pScmdline))
+    {
+        return 1;
+    }
+
+    // The job system benchmark doesn't need the rest of the application.
+    if (settings.m_jobBenchmark)
+    {
+        return RunJobSystemBenchmark(settings.m_jobWorkers, settings.m_resultsFileName) ? 0 : 1;
+    }
+
+    // Neither does the scene query benchmark.
+    if (settings.m_sceneBenchmark)
+    {
+        return RunSceneQueryBenchmark(settings.m_resultsFileName) ? 0 : 1;
+    }
+
+    // Nor the occlusion culler check.
+    if (settings.m_occlusionCheck)
+    {
+        return RunOcclusionCullerCheck() ? 0 : 1;
+    }
+
+    // Nor the transform hierarchy check.
+    if (settings.m_transformCheck)
+    {
+        return RunTransformHierarchyCheck() ? 0 : 1;
+    }
 
     // Create the system object.
     std::unique_ptr<System> pSystem = std::make_unique<System>();
     if (!pSystem)
     {
-        return 0;
+        return 1;
     }
 
-    // Initialize and run the system object.
-    result = pSystem->Initialize();
-    if (result)
+    // Initialize and run the system object. A failure of either is the exit code, for scripted runs.
+    if (pSystem->Initialize(settings) && pSystem->Run())
     {
-        pSystem->Run();
+        exitCode = 0;
     }
 
     // Shutdown and release the system object.
@@ -28,7 +61,7 @@ int WINAPI WinMain(
     pSystem.reset();
     pSystem = nullptr;
 
-    return 0;
+    return exitCode;
 }
 
 /*
@@ -1,14 +1,22 @@
 #include <vector>
 #include <memory>
+#include <cstring>
 #include "Graphics/Model.h"
+#include "Graphics/RenderStats.h"
+#include "System/Profiler.h"
 
 using namespace DirectX;
 
 Model::Model()
-	: m_pVertexBuffer(nullptr)
-	, m_pIndexBuffer(nullptr)
+	: m_pGeometryPool(nullptr)
+	, m_geometry(INVALID_GEOMETRY_HANDLE)
+	, m_pInstanceBuffer(nullptr)
 	, m_vertexCount(0)
 	, m_indexCount(0)
+	, m_maxInstanceCount(0)
+	, m_instanceCount(0)
+	, m_boundsCenter(0.0f, 0.0f, 0.0f)
+	, m_boundsExtents(0.0f, 0.0f, 0.0f)
 {
 }
 
@@ -16,18 +24,25 @@ Model::Model(const Model& kOther)
 {
 	m_indexCount = kOther.m_indexCount;
 	m_vertexCount = kOther.m_vertexCount;
-	m_pVertexBuffer = kOther.m_pVertexBuffer;
-	m_pIndexBuffer = kOther.m_pIndexBuffer;
+	m_pGeometryPool = kOther.m_pGeometryPool;
+	m_geometry = kOther.m_geometry;
+	m_pInstanceBuffer = kOther.m_pInstanceBuffer;
+	m_maxInstanceCount = kOther.m_maxInstanceCount;
+	m_instanceCount = kOther.m_instanceCount;
+	m_boundsCenter = kOther.m_boundsCenter;
+	m_boundsExtents = kOther.m_boundsExtents;
+	m_positions = kOther.m_positions;
+	m_indices = kOther.m_indices;
 }
 
 Model::~Model()
 {
 }
 
-bool Model::Initialize(ID3D11Device* pDevice)
+bool Model::Initialize(GeometryPool* pGeometryPool)
 {
-	// Initialize the vertex and index buffers.
-	return InitializeBuffers(pDevice);
+	// Place the vertices and indices in the geometry pool.
+	return InitializeBuffers(pGeometryPool);
 }
 
 void Model::Shutdown()
@@ -35,20 +50,101 @@ void Model::Shutdown()
 	ShutdownBuffers();
 }
 
-// This will be called from Graphics::Render function.
-void Model::Render(ID3D11DeviceContext* pDeviceContext)
+// Instanced draws take the model from the geometry pool in the first vertex buffer slot and the instances from the second one.
+void Model::RenderInstanced(RenderContext* pDeviceContext)
 {
-	// Put the vertex and index buffers on the graphics pipeline to prepare them for drawing.
-	RenderBuffers(pDeviceContext);
+	PROFILE_SCOPE("Model::RenderInstanced");
+
+	// Set the instance buffer to active in the second input slot.
+	uint32_t stride = sizeof(ModelInstance);
+	uint32_t offset = 0;
+	pDeviceContext->IASetVertexBuffers(1, 1, &m_pInstanceBuffer, &stride, &offset);
+
+	RenderStats::AddStateBinds(1);
+}
+
+// Looked up on every draw, defragmenting the pool moves the model.
+const GeometryRange& Model::GetGeometry() const
+{
+	return m_pGeometryPool->GetRange(m_geometry);
+}
+
+// Stays the same for the life of the model, unlike the range.
+GeometryHandle Model::GetGeometryHandle() const
+{
+	return m_geometry;
+}
+
+unsigned int Model::GetInstanceCount() const
+{
+	return m_instanceCount;
+}
+
+void Model::GetBounds(XMFLOAT3& center, XMFLOAT3& extents) const
+{
+	center = m_boundsCenter;
+	extents = m_boundsExtents;
+}
+
+const std::vector<XMFLOAT3>& Model::GetPositions() const
+{
+	return m_positions;
+}
+
+const std::vector<uint32_t>& Model::GetIndices() const
+{
+	return m_indices;
+}
+
+// The instance buffer is dynamic, a new batch is written over the old one with WRITE_DISCARD.
+bool Model::InitializeInstances(RenderDevice* pDevice, unsigned int maxInstances)
+{
+	D3D11_BUFFER_DESC instanceBufferDesc;
+	instanceBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	instanceBufferDesc.ByteWidth = sizeof(ModelInstance) * maxInstances;
+	instanceBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+	instanceBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	instanceBufferDesc.MiscFlags = 0;
+	instanceBufferDesc.StructureByteStride = 0;
+
+	HRESULT result = pDevice->CreateBuffer(&instanceBufferDesc, nullptr, &m_pInstanceBuffer);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	m_maxInstanceCount = maxInstances;
+	m_instanceCount = 0;
+
+	return true;
 }
 
-int Model::GetIndexCount()
+bool Model::SetInstances(RenderContext* pDeviceContext, const ModelInstance* pInstances, unsigned int instanceCount)
 {
-	return m_indexCount;
+	PROFILE_SCOPE("Model::SetInstances");
+
+	if (!m_pInstanceBuffer || instanceCount > m_maxInstanceCount)
+	{
+		return false;
+	}
+
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+	HRESULT result = pDeviceContext->Map(m_pInstanceBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	memcpy(mappedResource.pData, pInstances, sizeof(ModelInstance) * instanceCount);
+	pDeviceContext->Unmap(m_pInstanceBuffer, 0);
+
+	m_instanceCount = instanceCount;
+
+	return true;
 }
 
-// Where we handle dreating the vertex and index buffers.
-bool Model::InitializeBuffers(ID3D11Device* pDevice)
+// Where we handle dreating the vertex and index arrays and placing them in the geometry pool.
+bool Model::InitializeBuffers(GeometryPool* pGeometryPool)
 {
 	// Set the number of vertices in the vertex array.
 	m_vertexCount = 3;
@@ -63,7 +159,7 @@ bool Model::InitializeBuffers(ID3D11Device* pDevice)
 	}
 
 	// Create the index array.
-	unsigned long* pIndices = new unsigned long[m_indexCount];
+	uint32_t* pIndices = new uint32_t[m_indexCount];
 	if (!pIndices)
 	{
 		return false;
@@ -89,96 +185,56 @@ bool Model::InitializeBuffers(ID3D11Device* pDevice)
 	pIndices[1] = 1; // Top middle.
 	pIndices[2] = 2; // Bottom right.
 
-	// Steps to creating the vertex buffer and index buffer.
-	// 1. Fill out a description of the buffer.
-	// 2. Fill out a subresource pointer which will point to either your vertex or index array.
-	// 3. Call CreateBuffer using the D3DD device and it will return a pointer to your new buffer.
-
-	// Set up the description of the static vertex buffer.
-	D3D11_BUFFER_DESC vertexBufferDesc;
-	vertexBufferDesc.Usage = D3D11_USAGE_DEFAULT;
-	vertexBufferDesc.ByteWidth = sizeof(Vertex) * m_vertexCount;
-	vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-	vertexBufferDesc.CPUAccessFlags = 0;
-	vertexBufferDesc.MiscFlags = 0;
-	vertexBufferDesc.StructureByteStride = 0;
-		
-	// Give the subresource structure a pointer to the vertex data.
-	D3D11_SUBRESOURCE_DATA vertexData;
-	vertexData.pSysMem = pVertices;
-	vertexData.SysMemPitch = 0;
-	vertexData.SysMemSlicePitch = 0;
-
-	// Now create the vertex buffer.
-	HRESULT result = pDevice->CreateBuffer(&vertexBufferDesc, &vertexData, &m_pVertexBuffer);
-	if (FAILED(result))
+	// Keep the box around the vertices for culling.
+	XMVECTOR minimum = XMLoadFloat3(&pVertices[0].m_position);
+	XMVECTOR maximum = minimum;
+	for (int i = 1; i < m_vertexCount; ++i)
 	{
-		return false;
+		XMVECTOR position = XMLoadFloat3(&pVertices[i].m_position);
+		minimum = XMVectorMin(minimum, position);
+		maximum = XMVectorMax(maximum, position);
 	}
 
-	// Setup the description of the static index buffer.
-	D3D11_BUFFER_DESC indexBufferDesc;
-	indexBufferDesc.Usage = D3D11_USAGE_DEFAULT;
-	indexBufferDesc.ByteWidth = sizeof(unsigned long) * m_indexCount;
-	indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-	indexBufferDesc.CPUAccessFlags = 0;
-	indexBufferDesc.MiscFlags = 0;
-	indexBufferDesc.StructureByteStride = 0;
-
-	// Give the subresource structure a pointer to the index data.
-	D3D11_SUBRESOURCE_DATA indexData;
-	indexData.pSysMem = pIndices;
-	indexData.SysMemPitch = 0;
-	indexData.SysMemSlicePitch = 0;
-
-	// Create the index buffer.
-	result = pDevice->CreateBuffer(&indexBufferDesc, &indexData, &m_pIndexBuffer);
-	if (FAILED(result))
+	XMStoreFloat3(&m_boundsCenter, XMVectorScale(XMVectorAdd(minimum, maximum), 0.5f));
+	XMStoreFloat3(&m_boundsExtents, XMVectorScale(XMVectorSubtract(maximum, minimum), 0.5f));
+
+	// And the triangles themselves, for the occlusion culling.
+	m_positions.resize(m_vertexCount);
+	for (int i = 0; i < m_vertexCount; ++i)
 	{
-		return false;
+		m_positions[i] = pVertices[i].m_position;
 	}
+	m_indices.assign(pIndices, pIndices + m_indexCount);
+
+	// The pool copies both arrays into its shared vertex and index buffers.
+	// The indices stay relative to the model's first vertex, the draw adds the base vertex.
+	m_pGeometryPool = pGeometryPool;
+	bool result = m_pGeometryPool->AddMesh(pVertices, m_vertexCount, pIndices, m_indexCount, m_geometry);
 
-	// Release the arrays now that the vertex and index buffers have been created and loaded.
+	// Release the arrays now that the pool has its own copy.
 	delete[] pVertices;
 	pVertices = nullptr;
 
 	delete[] pIndices;
 	pIndices = nullptr;
 
-	return true;
+	return result;
 }
 
 void Model::ShutdownBuffers()
 {
-	// Release the index buffer.
-	if (m_pIndexBuffer)
+	// Release the instance buffer.
+	if (m_pInstanceBuffer)
 	{
-		m_pIndexBuffer->Release();
-		m_pIndexBuffer = nullptr;
+		m_pInstanceBuffer->Release();
+		m_pInstanceBuffer = nullptr;
 	}
 
-	// Release the vertex buffer.
-	if (m_pVertexBuffer)
+	// Give the model's space in the geometry pool back.
+	if (m_pGeometryPool)
 	{
-		m_pVertexBuffer->Release();
-		m_pVertexBuffer = nullptr;
+		m_pGeometryPool->RemoveMesh(m_geometry);
+		m_pGeometryPool = nullptr;
+		m_geometry = INVALID_GEOMETRY_HANDLE;
 	}
 }
-
-// Called from the Render function.
-// Purpose : Set the vertex buffer and index buffer as active on the input assemlber on the GPU.
-void Model::RenderBuffers(ID3D11DeviceContext* pDeviceContext)
-{
-	// Set vertex buffer stride and offset.
-	uint32_t stride = sizeof(Vertex);
-	uint32_t offset = 0;
-
-	// Set the vertex buffer to active in the input assembler so it can be rendered.
-	pDeviceContext->IASetVertexBuffers(0, 1, &m_pVertexBuffer, &stride, &offset);
-
-	// Set the index bufffer to active in the input assembler.
-	pDeviceContext->IASetIndexBuffer(m_pIndexBuffer, DXGI_FORMAT_R32_UINT, 0);
-
-	// Set the type of primitive that should be rendered from this vertex buffer.
-	pDeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-}
@@ -0,0 +1,221 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: NullRenderContext.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "Graphics/NullRenderContext.h"
+#include "Graphics/SoftwareResources.h"
+
+NullRenderContext::NullRenderContext()
+    : m_totals()
+    , m_frameCount(0)
+{
+    ResetCounters();
+}
+
+void NullRenderContext::ClearRenderTargetView(ID3D11RenderTargetView*, const FLOAT[4])
+{
+    ++m_counters.m_clears;
+}
+
+void NullRenderContext::ClearDepthStencilView(ID3D11DepthStencilView*, UINT, FLOAT, UINT8)
+{
+    ++m_counters.m_clears;
+}
+
+void NullRenderContext::OMSetRenderTargets(UINT, ID3D11RenderTargetView* const*, ID3D11DepthStencilView*)
+{
+    ++m_counters.m_outputMergerBinds;
+}
+
+void NullRenderContext::OMSetDepthStencilState(ID3D11DepthStencilState*, UINT)
+{
+    ++m_counters.m_outputMergerBinds;
+}
+
+void NullRenderContext::RSSetState(ID3D11RasterizerState*)
+{
+    ++m_counters.m_rasterizerBinds;
+}
+
+void NullRenderContext::RSSetViewports(UINT, const D3D11_VIEWPORT*)
+{
+    ++m_counters.m_rasterizerBinds;
+}
+
+void NullRenderContext::IASetInputLayout(ID3D11InputLayout*)
+{
+    ++m_counters.m_inputLayoutBinds;
+}
+
+void NullRenderContext::IASetVertexBuffers(UINT, UINT numBuffers, ID3D11Buffer* const*, const UINT*, const UINT*)
+{
+    m_counters.m_vertexBufferBinds += numBuffers;
+}
+
+void NullRenderContext::IASetIndexBuffer(ID3D11Buffer*, DXGI_FORMAT, UINT)
+{
+    ++m_counters.m_indexBufferBinds;
+}
+
+void NullRenderContext::IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY)
+{
+    ++m_counters.m_topologyBinds;
+}
+
+void NullRenderContext::VSSetShader(ID3D11VertexShader*, ID3D11ClassInstance* const*, UINT)
+{
+    ++m_counters.m_shaderBinds;
+}
+
+void NullRenderContext::PSSetShader(ID3D11PixelShader*, ID3D11ClassInstance* const*, UINT)
+{
+    ++m_counters.m_shaderBinds;
+}
+
+void NullRenderContext::VSSetConstantBuffers(UINT, UINT numBuffers, ID3D11Buffer* const*)
+{
+    m_counters.m_constantBufferBinds += numBuffers;
+}
+
+void NullRenderContext::VSSetConstantBuffers1(UINT, UINT numBuffers, ID3D11Buffer* const*, const UINT*, const UINT*)
+{
+    m_counters.m_constantBufferBinds += numBuffers;
+}
+
+HRESULT NullRenderContext::Map(ID3D11Resource* pResource, UINT, D3D11_MAP, UINT, D3D11_MAPPED_SUBRESOURCE* pMappedResource)
+{
+    if (!pResource || !pMappedResource)
+    {
+        return E_INVALIDARG;
+    }
+
+    D3D11_RESOURCE_DIMENSION dimension;
+    pResource->GetType(&dimension);
+    if (dimension != D3D11_RESOURCE_DIMENSION_BUFFER)
+    {
+        return E_INVALIDARG;
+    }
+
+    SoftwareBuffer* pBuffer = static_cast<SoftwareBuffer*>(pResource);
+    pMappedResource->pData = pBuffer->GetData();
+    pMappedResource->RowPitch = pBuffer->GetByteWidth();
+    pMappedResource->DepthPitch = pBuffer->GetByteWidth();
+
+    ++m_counters.m_maps;
+    m_counters.m_bytesMapped += pBuffer->GetByteWidth();
+
+    return S_OK;
+}
+
+void NullRenderContext::Unmap(ID3D11Resource*, UINT)
+{
+    ++m_counters.m_unmaps;
+}
+
+void NullRenderContext::UpdateSubresource(ID3D11Resource* pResource, UINT, const D3D11_BOX* pBox, const void* pSourceData, UINT, UINT)
+{
+    if (!pResource || !pSourceData)
+    {
+        return;
+    }
+
+    D3D11_RESOURCE_DIMENSION dimension;
+    pResource->GetType(&dimension);
+    if (dimension != D3D11_RESOURCE_DIMENSION_BUFFER)
+    {
+        return;
+    }
+
+    ++m_counters.m_updates;
+    m_counters.m_bytesUpdated += static_cast<SoftwareBuffer*>(pResource)->Update(pBox, pSourceData);
+}
+
+void NullRenderContext::DrawIndexed(UINT indexCount, UINT, INT)
+{
+    ++m_counters.m_drawCalls;
+    m_counters.m_indicesSubmitted += indexCount;
+    ++m_counters.m_instancesSubmitted;
+}
+
+void NullRenderContext::DrawIndexedInstanced(UINT indexCountPerInstance, UINT instanceCount, UINT, INT, UINT)
+{
+    ++m_counters.m_drawCalls;
+    m_counters.m_indicesSubmitted += static_cast<uint64_t>(indexCountPerInstance) * instanceCount;
+    m_counters.m_instancesSubmitted += instanceCount;
+}
+
+void NullRenderContext::End(ID3D11Asynchronous*)
+{
+    ++m_counters.m_queries;
+}
+
+// Nothing is ever queued, every query is done.
+HRESULT NullRenderContext::GetData(ID3D11Asynchronous*, void* pData, UINT dataSize, UINT)
+{
+    if (pData && dataSize >= sizeof(BOOL))
+    {
+        *static_cast<BOOL*>(pData) = TRUE;
+    }
+
+    return S_OK;
+}
+
+// There are no deferred contexts on this backend, so never a command list.
+HRESULT NullRenderContext::FinishCommandList(BOOL, ID3D11CommandList**)
+{
+    return E_NOTIMPL;
+}
+
+void NullRenderContext::ExecuteCommandList(ID3D11CommandList*, BOOL)
+{
+}
+
+void NullRenderContext::Flush()
+{
+    ++m_counters.m_flushes;
+}
+
+const NullRenderCounters& NullRenderContext::GetCounters() const
+{
+    return m_counters;
+}
+
+void NullRenderContext::ResetCounters()
+{
+    m_counters = NullRenderCounters();
+}
+
+void NullRenderContext::EndFrame()
+{
+    m_totals.m_clears += m_counters.m_clears;
+    m_totals.m_outputMergerBinds += m_counters.m_outputMergerBinds;
+    m_totals.m_rasterizerBinds += m_counters.m_rasterizerBinds;
+    m_totals.m_inputLayoutBinds += m_counters.m_inputLayoutBinds;
+    m_totals.m_vertexBufferBinds += m_counters.m_vertexBufferBinds;
+    m_totals.m_indexBufferBinds += m_counters.m_indexBufferBinds;
+    m_totals.m_topologyBinds += m_counters.m_topologyBinds;
+    m_totals.m_shaderBinds += m_counters.m_shaderBinds;
+    m_totals.m_constantBufferBinds += m_counters.m_constantBufferBinds;
+    m_totals.m_maps += m_counters.m_maps;
+    m_totals.m_unmaps += m_counters.m_unmaps;
+    m_totals.m_bytesMapped += m_counters.m_bytesMapped;
+    m_totals.m_updates += m_counters.m_updates;
+    m_totals.m_bytesUpdated += m_counters.m_bytesUpdated;
+    m_totals.m_drawCalls += m_counters.m_drawCalls;
+    m_totals.m_indicesSubmitted += m_counters.m_indicesSubmitted;
+    m_totals.m_instancesSubmitted += m_counters.m_instancesSubmitted;
+    m_totals.m_flushes += m_counters.m_flushes;
+    m_totals.m_queries += m_counters.m_queries;
+
+    ++m_frameCount;
+    ResetCounters();
+}
+
+const NullRenderCounters& NullRenderContext::GetTotals() const
+{
+    return m_totals;
+}
+
+unsigned long long NullRenderContext::GetFrameCount() const
+{
+    return m_frameCount;
+}
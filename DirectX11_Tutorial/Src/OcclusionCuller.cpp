@@ -0,0 +1,689 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: OcclusionCuller.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+#include "Graphics/OcclusionCuller.h"
+#include "System/Profiler.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <xmmintrin.h>
+#define OCCLUSION_CULLER_USE_SSE 1
+#else
+#define OCCLUSION_CULLER_USE_SSE 0
+#endif
+
+using namespace DirectX;
+
+namespace
+{
+    // What the buffer is cleared to, nothing is farther.
+    constexpr float kFarDepth = 1.0f;
+
+#if OCCLUSION_CULLER_USE_SSE
+    float HorizontalMin(__m128 value)
+    {
+        value = _mm_min_ps(value, _mm_shuffle_ps(value, value, _MM_SHUFFLE(2, 3, 0, 1)));
+        value = _mm_min_ps(value, _mm_shuffle_ps(value, value, _MM_SHUFFLE(1, 0, 3, 2)));
+        return _mm_cvtss_f32(value);
+    }
+
+    float HorizontalMax(__m128 value)
+    {
+        value = _mm_max_ps(value, _mm_shuffle_ps(value, value, _MM_SHUFFLE(2, 3, 0, 1)));
+        value = _mm_max_ps(value, _mm_shuffle_ps(value, value, _MM_SHUFFLE(1, 0, 3, 2)));
+        return _mm_cvtss_f32(value);
+    }
+#endif
+}
+
+OcclusionCuller::OcclusionCuller()
+    : m_width(0)
+    , m_height(0)
+    , m_stride(0)
+    , m_tileColumns(0)
+    , m_tileRows(0)
+    , m_viewProjection()
+    , m_simd(OCCLUSION_CULLER_USE_SSE != 0)
+    , m_stats()
+{
+}
+
+bool OcclusionCuller::Initialize(unsigned int width, unsigned int height)
+{
+    if (width == 0 || height == 0)
+    {
+        return false;
+    }
+
+    m_width = width;
+    m_height = height;
+    m_tileColumns = (width + kTileSize - 1) / kTileSize;
+    m_tileRows = (height + kTileSize - 1) / kTileSize;
+    m_stride = m_tileColumns * kTileSize;
+
+    m_depth.assign(m_stride * m_tileRows * kTileSize, kFarDepth);
+    m_tileMaxDepth.assign(m_tileColumns * m_tileRows, kFarDepth);
+
+    XMStoreFloat4x4(&m_viewProjection, XMMatrixIdentity());
+    m_occluders.clear();
+    m_triangles.clear();
+
+    return true;
+}
+
+void OcclusionCuller::Shutdown()
+{
+    m_depth.clear();
+    m_depth.shrink_to_fit();
+    m_tileMaxDepth.clear();
+    m_tileMaxDepth.shrink_to_fit();
+    m_occluders.clear();
+    m_projectedPositions.clear();
+    m_triangles.clear();
+    m_visibleFlags.clear();
+
+    m_width = 0;
+    m_height = 0;
+}
+
+void OcclusionCuller::BeginFrame(FXMMATRIX viewProjection)
+{
+    XMStoreFloat4x4(&m_viewProjection, viewProjection);
+    m_occluders.clear();
+}
+
+void OcclusionCuller::AddOccluder(const XMFLOAT3* pPositions, unsigned int positionCount, const uint32_t* pIndices, unsigned int indexCount, FXMMATRIX worldMatrix)
+{
+    Occluder occluder;
+    occluder.m_pPositions = pPositions;
+    occluder.m_positionCount = positionCount;
+    occluder.m_pIndices = pIndices;
+    occluder.m_indexCount = indexCount;
+    XMStoreFloat4x4(&occluder.m_worldViewProjection, XMMatrixMultiply(worldMatrix, XMLoadFloat4x4(&m_viewProjection)));
+    m_occluders.push_back(occluder);
+}
+
+//-----------------------------------------------------------------
+// Sets up every triangle on the calling thread, then clears and
+// fills each band on the job system. A band only writes its own
+// rows and tiles, so the bands never wait for each other.
+//-----------------------------------------------------------------
+void OcclusionCuller::Rasterize(JobSystem* pJobSystem)
+{
+    PROFILE_SCOPE("OcclusionCuller::Rasterize");
+
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+    m_triangles.clear();
+
+    uint64_t occluderTriangles = 0;
+    for (const Occluder& kOccluder : m_occluders)
+    {
+        occluderTriangles += kOccluder.m_indexCount / 3;
+        SetupTriangles(kOccluder);
+    }
+
+    unsigned int bandCount = (m_tileRows + kBandTileRows - 1) / kBandTileRows;
+    auto rasterizeBands = [this](unsigned int begin, unsigned int end)
+    {
+        for (unsigned int band = begin; band < end; ++band)
+        {
+            RasterizeBand(band);
+        }
+    };
+
+    if (pJobSystem && bandCount > 1)
+    {
+        pJobSystem->ParallelFor(bandCount, 1, rasterizeBands);
+    }
+    else
+    {
+        rasterizeBands(0, bandCount);
+    }
+
+    m_stats.m_occluderTriangles = occluderTriangles;
+    m_stats.m_rasterizedTriangles = m_triangles.size();
+    m_stats.m_rasterizeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+//-----------------------------------------------------------------
+// Projects the box's corners. The box is hidden when every pixel
+// under their screen rectangle is nearer than the nearest corner.
+// The tiles answer that for most of the rectangle, the pixels of a
+// tile are only read when its farthest depth is behind the box.
+//-----------------------------------------------------------------
+bool OcclusionCuller::IsVisible(const Aabb& kAabb) const
+{
+    float minX;
+    float maxX;
+    float minY;
+    float maxY;
+    float minDepth;
+
+    // Part of the box is behind the near plane.
+    if (!ProjectAabb(kAabb, minX, maxX, minY, maxY, minDepth))
+    {
+        return true;
+    }
+
+    // Off screen, that's for the frustum culling to decide.
+    float width = static_cast<float>(m_width);
+    float height = static_cast<float>(m_height);
+    if (maxX < 0.0f || maxY < 0.0f || minX >= width || minY >= height)
+    {
+        return true;
+    }
+
+    // Every pixel the rectangle touches.
+    int pixelMinX = static_cast<int>(std::max(0.0f, minX));
+    int pixelMaxX = static_cast<int>(std::min(width - 1.0f, maxX));
+    int pixelMinY = static_cast<int>(std::max(0.0f, minY));
+    int pixelMaxY = static_cast<int>(std::min(height - 1.0f, maxY));
+
+    int tileMinX = pixelMinX / kTileSize;
+    int tileMaxX = pixelMaxX / kTileSize;
+    int tileMinY = pixelMinY / kTileSize;
+    int tileMaxY = pixelMaxY / kTileSize;
+
+    for (int tileY = tileMinY; tileY <= tileMaxY; ++tileY)
+    {
+        for (int tileX = tileMinX; tileX <= tileMaxX; ++tileX)
+        {
+            if (m_tileMaxDepth[tileY * m_tileColumns + tileX] < minDepth)
+            {
+                continue;
+            }
+
+            int x0 = std::max(pixelMinX, tileX * static_cast<int>(kTileSize));
+            int x1 = std::min(pixelMaxX, tileX * static_cast<int>(kTileSize) + static_cast<int>(kTileSize) - 1);
+            int y0 = std::max(pixelMinY, tileY * static_cast<int>(kTileSize));
+            int y1 = std::min(pixelMaxY, tileY * static_cast<int>(kTileSize) + static_cast<int>(kTileSize) - 1);
+
+            for (int y = y0; y <= y1; ++y)
+            {
+                const float* pRow = &m_depth[y * m_stride];
+                for (int x = x0; x <= x1; ++x)
+                {
+                    if (pRow[x] >= minDepth)
+                    {
+                        return true;
+                    }
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+void OcclusionCuller::Cull(const Aabb* pAabbs, unsigned int count, JobSystem* pJobSystem, std::vector<uint32_t>& visible)
+{
+    PROFILE_SCOPE("OcclusionCuller::Cull");
+
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+    m_visibleFlags.resize(count);
+
+    unsigned int chunkCount = (count + kCullChunkSize - 1) / kCullChunkSize;
+    auto testChunks = [this, pAabbs, count](unsigned int begin, unsigned int end)
+    {
+        for (unsigned int i = begin * kCullChunkSize; i < std::min(count, end * kCullChunkSize); ++i)
+        {
+            m_visibleFlags[i] = IsVisible(pAabbs[i]) ? 1 : 0;
+        }
+    };
+
+    if (pJobSystem && chunkCount > 1)
+    {
+        pJobSystem->ParallelFor(chunkCount, 1, testChunks);
+    }
+    else
+    {
+        testChunks(0, chunkCount);
+    }
+
+    visible.clear();
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        if (m_visibleFlags[i])
+        {
+            visible.push_back(i);
+        }
+    }
+
+    m_stats.m_tested = count;
+    m_stats.m_culled = count - visible.size();
+    m_stats.m_testSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+void OcclusionCuller::SetSimd(bool simd)
+{
+    m_simd = simd && OCCLUSION_CULLER_USE_SSE != 0;
+}
+
+float OcclusionCuller::GetDepth(unsigned int x, unsigned int y) const
+{
+    return m_depth[y * m_stride + x];
+}
+
+unsigned int OcclusionCuller::GetWidth() const
+{
+    return m_width;
+}
+
+unsigned int OcclusionCuller::GetHeight() const
+{
+    return m_height;
+}
+
+const OcclusionCullStats& OcclusionCuller::GetStats() const
+{
+    return m_stats;
+}
+
+//-----------------------------------------------------------------
+// The screen rectangle of the box's corners in buffer pixels and
+// the nearest depth among them. False when a corner is behind the
+// near plane, the rectangle means nothing then. The SSE version
+// projects 4 corners at a time, the bottom and then the top ones.
+//-----------------------------------------------------------------
+bool OcclusionCuller::ProjectAabb(const Aabb& kAabb, float& minX, float& maxX, float& minY, float& maxY, float& minDepth) const
+{
+    const XMFLOAT4X4& kMatrix = m_viewProjection;
+
+#if OCCLUSION_CULLER_USE_SSE
+    if (m_simd)
+    {
+        __m128 cornerX = _mm_setr_ps(kAabb.m_min.x, kAabb.m_max.x, kAabb.m_min.x, kAabb.m_max.x);
+        __m128 cornerY = _mm_setr_ps(kAabb.m_min.y, kAabb.m_min.y, kAabb.m_max.y, kAabb.m_max.y);
+
+        // Row vectors, clip = x * row 0 + y * row 1 + z * row 2 + row 3. The x and y parts are shared by both faces.
+        __m128 clip[2][4];
+        for (unsigned int component = 0; component < 4; ++component)
+        {
+            __m128 shared = _mm_add_ps(_mm_add_ps(
+                _mm_mul_ps(cornerX, _mm_set1_ps(kMatrix.m[0][component])),
+                _mm_mul_ps(cornerY, _mm_set1_ps(kMatrix.m[1][component]))),
+                _mm_set1_ps(kMatrix.m[3][component]));
+            clip[0][component] = _mm_add_ps(shared, _mm_set1_ps(kAabb.m_min.z * kMatrix.m[2][component]));
+            clip[1][component] = _mm_add_ps(shared, _mm_set1_ps(kAabb.m_max.z * kMatrix.m[2][component]));
+        }
+
+        const __m128 kZero = _mm_setzero_ps();
+        if (_mm_movemask_ps(_mm_or_ps(_mm_cmplt_ps(clip[0][2], kZero), _mm_cmplt_ps(clip[1][2], kZero))) != 0)
+        {
+            return false;
+        }
+
+        const __m128 kHalfWidth = _mm_set1_ps(0.5f * m_width);
+        const __m128 kHalfHeight = _mm_set1_ps(0.5f * m_height);
+
+        __m128 x[2];
+        __m128 y[2];
+        __m128 depth[2];
+        for (unsigned int face = 0; face < 2; ++face)
+        {
+            __m128 inverseW = _mm_div_ps(_mm_set1_ps(1.0f), clip[face][3]);
+            x[face] = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(clip[face][0], inverseW), _mm_set1_ps(1.0f)), kHalfWidth);
+            y[face] = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(clip[face][1], inverseW)), kHalfHeight);
+            depth[face] = _mm_mul_ps(clip[face][2], inverseW);
+        }
+
+        minX = HorizontalMin(_mm_min_ps(x[0], x[1]));
+        maxX = HorizontalMax(_mm_max_ps(x[0], x[1]));
+        minY = HorizontalMin(_mm_min_ps(y[0], y[1]));
+        maxY = HorizontalMax(_mm_max_ps(y[0], y[1]));
+        minDepth = HorizontalMin(_mm_min_ps(depth[0], depth[1]));
+        return true;
+    }
+#endif
+
+    float halfWidth = 0.5f * m_width;
+    float halfHeight = 0.5f * m_height;
+
+    minX = std::numeric_limits<float>::max();
+    maxX = -std::numeric_limits<float>::max();
+    minY = std::numeric_limits<float>::max();
+    maxY = -std::numeric_limits<float>::max();
+    minDepth = std::numeric_limits<float>::max();
+
+    for (unsigned int corner = 0; corner < 8; ++corner)
+    {
+        float cornerX = (corner & 1) ? kAabb.m_max.x : kAabb.m_min.x;
+        float cornerY = (corner & 2) ? kAabb.m_max.y : kAabb.m_min.y;
+        float cornerZ = (corner & 4) ? kAabb.m_max.z : kAabb.m_min.z;
+
+        // Added up in the order the SSE version does it.
+        float clip[4];
+        for (unsigned int component = 0; component < 4; ++component)
+        {
+            float shared = (cornerX * kMatrix.m[0][component] + cornerY * kMatrix.m[1][component]) + kMatrix.m[3][component];
+            clip[component] = shared + cornerZ * kMatrix.m[2][component];
+        }
+
+        if (clip[2] < 0.0f)
+        {
+            return false;
+        }
+
+        float inverseW = 1.0f / clip[3];
+        float x = (clip[0] * inverseW + 1.0f) * halfWidth;
+        float y = (1.0f - clip[1] * inverseW) * halfHeight;
+
+        minX = std::min(minX, x);
+        maxX = std::max(maxX, x);
+        minY = std::min(minY, y);
+        maxY = std::max(maxY, y);
+        minDepth = std::min(minDepth, clip[2] * inverseW);
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------
+// Projects the triangles to buffer pixels and keeps the ones that
+// can hide something: entirely in front of the near plane, facing
+// the camera and touching at least one pixel.
+//-----------------------------------------------------------------
+void OcclusionCuller::SetupTriangles(const Occluder& kOccluder)
+{
+    XMMATRIX worldViewProjection = XMLoadFloat4x4(&kOccluder.m_worldViewProjection);
+
+    // Every position once, the triangles share them. w keeps the clip space z for the near plane test.
+    m_projectedPositions.resize(kOccluder.m_positionCount);
+    for (unsigned int i = 0; i < kOccluder.m_positionCount; ++i)
+    {
+        XMFLOAT4 clip;
+        XMStoreFloat4(&clip, XMVector3Transform(XMLoadFloat3(&kOccluder.m_pPositions[i]), worldViewProjection));
+
+        float inverseW = 1.0f / clip.w;
+        m_projectedPositions[i] = XMFLOAT4(
+            (clip.x * inverseW * 0.5f + 0.5f) * m_width,
+            (0.5f - clip.y * inverseW * 0.5f) * m_height,
+            clip.z * inverseW,
+            clip.z);
+    }
+
+    for (unsigned int i = 0; i + 2 < kOccluder.m_indexCount; i += 3)
+    {
+        ScreenTriangle triangle;
+        float depth[3];
+        bool inFront = true;
+
+        for (unsigned int vertex = 0; vertex < 3; ++vertex)
+        {
+            const XMFLOAT4& kProjected = m_projectedPositions[kOccluder.m_pIndices[i + vertex]];
+            inFront = inFront && kProjected.w >= 0.0f;
+
+            triangle.m_x[vertex] = kProjected.x;
+            triangle.m_y[vertex] = kProjected.y;
+            depth[vertex] = kProjected.z;
+        }
+
+        if (!inFront)
+        {
+            continue;
+        }
+
+        // Positive for a clockwise triangle on screen, with y going down.
+        float x1 = triangle.m_x[1] - triangle.m_x[0];
+        float y1 = triangle.m_y[1] - triangle.m_y[0];
+        float x2 = triangle.m_x[2] - triangle.m_x[0];
+        float y2 = triangle.m_y[2] - triangle.m_y[0];
+        float area = x1 * y2 - x2 * y1;
+        if (!(area > 0.0f))
+        {
+            continue;
+        }
+
+        float minX = std::min(std::min(triangle.m_x[0], triangle.m_x[1]), triangle.m_x[2]);
+        float maxX = std::max(std::max(triangle.m_x[0], triangle.m_x[1]), triangle.m_x[2]);
+        float minY = std::min(std::min(triangle.m_y[0], triangle.m_y[1]), triangle.m_y[2]);
+        float maxY = std::max(std::max(triangle.m_y[0], triangle.m_y[1]), triangle.m_y[2]);
+
+        // Clamped before the conversion, a vertex close to the camera can be far off screen.
+        triangle.m_minX = static_cast<int>(std::max(0.0f, floorf(minX)));
+        triangle.m_maxX = static_cast<int>(std::min(static_cast<float>(m_width - 1), floorf(maxX)));
+        triangle.m_minY = static_cast<int>(std::max(0.0f, floorf(minY)));
+        triangle.m_maxY = static_cast<int>(std::min(static_cast<float>(m_height - 1), floorf(maxY)));
+
+        if (triangle.m_minX > triangle.m_maxX || triangle.m_minY > triangle.m_maxY)
+        {
+            continue;
+        }
+
+        // depth = depthOrigin + depthX * x + depthY * y over the buffer.
+        float depth1 = depth[1] - depth[0];
+        float depth2 = depth[2] - depth[0];
+        triangle.m_depthX = (depth1 * y2 - depth2 * y1) / area;
+        triangle.m_depthY = (x1 * depth2 - x2 * depth1) / area;
+        triangle.m_depthOrigin = depth[0] - triangle.m_depthX * triangle.m_x[0] - triangle.m_depthY * triangle.m_y[0];
+
+        m_triangles.push_back(triangle);
+    }
+}
+
+void OcclusionCuller::RasterizeBand(unsigned int band)
+{
+    unsigned int firstTileRow = band * kBandTileRows;
+    unsigned int endTileRow = std::min(m_tileRows, firstTileRow + kBandTileRows);
+    int bandMinY = static_cast<int>(firstTileRow * kTileSize);
+    int bandEndY = static_cast<int>(endTileRow * kTileSize);
+
+    std::fill(m_depth.begin() + bandMinY * m_stride, m_depth.begin() + bandEndY * m_stride, kFarDepth);
+
+    for (const ScreenTriangle& kTriangle : m_triangles)
+    {
+        if (kTriangle.m_maxY >= bandMinY && kTriangle.m_minY < bandEndY)
+        {
+            RasterizeTriangle(kTriangle, bandMinY, bandEndY);
+        }
+    }
+
+    UpdateTiles(firstTileRow, endTileRow);
+}
+
+//-----------------------------------------------------------------
+// Walks the triangle row by row, 4 pixels at a time. Each edge is a
+// linear function that is positive inside, a pixel is covered when
+// all three are positive at its center and then keeps the nearer of
+// its depth and the triangle's. A center right on a top or left edge
+// is inside too, like D3D does it, so two triangles sharing an edge
+// leave no row of holes between them.
+//-----------------------------------------------------------------
+void OcclusionCuller::RasterizeTriangle(const ScreenTriangle& kTriangle, int minY, int endY)
+{
+    // edge(x, y) = edgeX * x + edgeY * y + edgeOrigin, for the edges 0-1, 1-2 and 2-0.
+    float edgeX[3];
+    float edgeY[3];
+    float edgeOrigin[3];
+    // A center is inside when the edge is above this. With clockwise triangles and y going down,
+    // a left edge goes up and a top edge goes right, and 0 is inside too for them: nothing is
+    // between 0 and the negative float nearest to it.
+    float edgeThreshold[3];
+    // Where each edge crosses a row, crossing = crossingY * y + crossingOrigin. Only to keep
+    // the walk off the empty corners of the bounding rectangle, the edge tests decide.
+    float crossingY[3];
+    float crossingOrigin[3];
+    bool crossingIsLeft[3];
+    unsigned int crossingCount = 0;
+
+    for (unsigned int edge = 0; edge < 3; ++edge)
+    {
+        unsigned int from = edge;
+        unsigned int to = (edge + 1) % 3;
+
+        // Always from the same end of the edge, then flipped. The triangle on the other side
+        // of a shared edge then gets exactly the negated values, and rounding can't open a gap.
+        bool flip = kTriangle.m_y[to] < kTriangle.m_y[from] || (kTriangle.m_y[to] == kTriangle.m_y[from] && kTriangle.m_x[to] < kTriangle.m_x[from]);
+        if (flip)
+        {
+            std::swap(from, to);
+        }
+
+        edgeX[edge] = kTriangle.m_y[from] - kTriangle.m_y[to];
+        edgeY[edge] = kTriangle.m_x[to] - kTriangle.m_x[from];
+        edgeOrigin[edge] = -(edgeX[edge] * kTriangle.m_x[from] + edgeY[edge] * kTriangle.m_y[from]);
+
+        if (flip)
+        {
+            edgeX[edge] = -edgeX[edge];
+            edgeY[edge] = -edgeY[edge];
+            edgeOrigin[edge] = -edgeOrigin[edge];
+        }
+
+        bool topLeft = edgeX[edge] > 0.0f || (edgeX[edge] == 0.0f && edgeY[edge] > 0.0f);
+        edgeThreshold[edge] = topLeft ? -std::numeric_limits<float>::denorm_min() : 0.0f;
+
+        if (edgeX[edge] != 0.0f)
+        {
+            crossingY[crossingCount] = -edgeY[edge] / edgeX[edge];
+            crossingOrigin[crossingCount] = -edgeOrigin[edge] / edgeX[edge];
+            crossingIsLeft[crossingCount] = edgeX[edge] > 0.0f;
+            ++crossingCount;
+        }
+    }
+
+    int y0 = std::max(kTriangle.m_minY, minY);
+    int y1 = std::min(kTriangle.m_maxY, endY - 1);
+    float minX = static_cast<float>(kTriangle.m_minX);
+    float endX = static_cast<float>(kTriangle.m_maxX + 1);
+
+#if OCCLUSION_CULLER_USE_SSE
+    const __m128 kLaneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+
+    __m128 edgeXVector[3];
+    __m128 edgeThresholdVector[3];
+    for (unsigned int edge = 0; edge < 3; ++edge)
+    {
+        edgeXVector[edge] = _mm_set1_ps(edgeX[edge]);
+        edgeThresholdVector[edge] = _mm_set1_ps(edgeThreshold[edge]);
+    }
+    __m128 depthX = _mm_set1_ps(kTriangle.m_depthX);
+#endif
+
+    for (int y = y0; y <= y1; ++y)
+    {
+        float centerY = y + 0.5f;
+        float* pRow = &m_depth[y * m_stride];
+
+        float spanMin = minX;
+        float spanEnd = endX;
+        for (unsigned int crossing = 0; crossing < crossingCount; ++crossing)
+        {
+            float crossingX = crossingY[crossing] * centerY + crossingOrigin[crossing];
+            if (crossingIsLeft[crossing])
+            {
+                spanMin = std::max(spanMin, crossingX);
+            }
+            else
+            {
+                spanEnd = std::min(spanEnd, crossingX);
+            }
+        }
+
+        // A pixel wider on both sides for the rounding. Clamped to the rectangle before the
+        // conversion, a nearly flat edge can cross the row anywhere.
+        int x0 = static_cast<int>(std::min(endX, std::max(minX, spanMin - 1.5f)));
+        int x1 = static_cast<int>(std::max(minX - 1.0f, std::min(endX - 1.0f, spanEnd + 0.5f)));
+
+        // The parts of the edges and the depth that are the same along the row.
+        float edgeRow[3];
+        for (unsigned int edge = 0; edge < 3; ++edge)
+        {
+            edgeRow[edge] = edgeY[edge] * centerY + edgeOrigin[edge];
+        }
+        float depthRow = kTriangle.m_depthY * centerY + kTriangle.m_depthOrigin;
+
+#if OCCLUSION_CULLER_USE_SSE
+        if (m_simd)
+        {
+            __m128 edgeRowVector[3];
+            for (unsigned int edge = 0; edge < 3; ++edge)
+            {
+                edgeRowVector[edge] = _mm_set1_ps(edgeRow[edge]);
+            }
+            __m128 depthRowVector = _mm_set1_ps(depthRow);
+
+            // Rows are padded to the tile size, so the last group of 4 stays in the row.
+            for (int x = x0 & ~3; x <= x1; x += 4)
+            {
+                __m128 centerX = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), kLaneOffsets);
+
+                __m128 inside = _mm_cmpgt_ps(_mm_add_ps(_mm_mul_ps(edgeXVector[0], centerX), edgeRowVector[0]), edgeThresholdVector[0]);
+                inside = _mm_and_ps(inside, _mm_cmpgt_ps(_mm_add_ps(_mm_mul_ps(edgeXVector[1], centerX), edgeRowVector[1]), edgeThresholdVector[1]));
+                inside = _mm_and_ps(inside, _mm_cmpgt_ps(_mm_add_ps(_mm_mul_ps(edgeXVector[2], centerX), edgeRowVector[2]), edgeThresholdVector[2]));
+
+                __m128 depth = _mm_add_ps(_mm_mul_ps(depthX, centerX), depthRowVector);
+                __m128 previous = _mm_loadu_ps(pRow + x);
+                __m128 nearest = _mm_min_ps(previous, depth);
+                _mm_storeu_ps(pRow + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, previous)));
+            }
+            continue;
+        }
+#endif
+
+        for (int x = x0; x <= x1; ++x)
+        {
+            float centerX = x + 0.5f;
+            bool inside =
+                edgeX[0] * centerX + edgeRow[0] > edgeThreshold[0] &&
+                edgeX[1] * centerX + edgeRow[1] > edgeThreshold[1] &&
+                edgeX[2] * centerX + edgeRow[2] > edgeThreshold[2];
+
+            if (inside)
+            {
+                float depth = kTriangle.m_depthX * centerX + depthRow;
+                pRow[x] = std::min(pRow[x], depth);
+            }
+        }
+    }
+}
+
+// Only the pixels inside the buffer count, the padding is never tested.
+void OcclusionCuller::UpdateTiles(unsigned int firstTileRow, unsigned int endTileRow)
+{
+    for (unsigned int tileY = firstTileRow; tileY < endTileRow; ++tileY)
+    {
+        unsigned int y0 = tileY * kTileSize;
+        unsigned int y1 = std::min(m_height, y0 + kTileSize);
+
+        for (unsigned int tileX = 0; tileX < m_tileColumns; ++tileX)
+        {
+            unsigned int x0 = tileX * kTileSize;
+            unsigned int x1 = std::min(m_width, x0 + kTileSize);
+
+            float maxDepth = 0.0f;
+#if OCCLUSION_CULLER_USE_SSE
+            static_assert(kTileSize == 8, "A row of a tile is two groups of 4");
+            if (m_simd && x1 - x0 == kTileSize && y1 - y0 == kTileSize)
+            {
+                __m128 maxVector = _mm_setzero_ps();
+                for (unsigned int y = y0; y < y1; ++y)
+                {
+                    const float* pRow = &m_depth[y * m_stride + x0];
+                    maxVector = _mm_max_ps(maxVector, _mm_max_ps(_mm_loadu_ps(pRow), _mm_loadu_ps(pRow + 4)));
+                }
+                maxDepth = HorizontalMax(maxVector);
+            }
+            else
+#endif
+            {
+                for (unsigned int y = y0; y < y1; ++y)
+                {
+                    const float* pRow = &m_depth[y * m_stride];
+                    for (unsigned int x = x0; x < x1; ++x)
+                    {
+                        maxDepth = std::max(maxDepth, pRow[x]);
+                    }
+                }
+            }
+
+            m_tileMaxDepth[tileY * m_tileColumns + tileX] = maxDepth;
+        }
+    }
+}
@@ -0,0 +1,666 @@
+//////////////////////////////////////////////////////////////////////
+// Filename: OcclusionCullerBenchmark.cpp
+//////////////////////////////////////////////////////////////////////
+#include <windows.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "Graphics/OcclusionCuller.h"
+#include "Graphics/OcclusionCullerBenchmark.h"
+#include "System/SeededRandom.h"
+
+using namespace DirectX;
+
+namespace
+{
+    // A 1920x1080 screen at the quarter size Graphics gives the occlusion buffer.
+    constexpr unsigned int kOcclusionWidth = 480;
+    constexpr unsigned int kOcclusionHeight = 270;
+    constexpr unsigned int kOccluderBoxes = 500;
+    constexpr unsigned int kOccludeeBoxes = 10000;
+    constexpr uint32_t kWorkloadSeed = 98765;
+
+    constexpr unsigned int kCheckStreets = 4;
+    // Boxes around the camera in every checked street, some of them across the near plane.
+    constexpr unsigned int kNearOccluderBoxes = 8;
+    constexpr unsigned int kNearOccludeeBoxes = 200;
+    // Powers of two, so a vertex on a pixel center or a quarter pixel projects exactly.
+    constexpr unsigned int kMeshWidth = 256;
+    constexpr unsigned int kMeshHeight = 128;
+    constexpr unsigned int kMeshColumns = 12;
+    constexpr unsigned int kMeshRows = 6;
+    constexpr float kMeshCellSize = 16.0f;
+    // The culler works in floats and the reference in doubles. A center closer to an edge than
+    // this, in pixels, can be on either side of it, and so can a depth this close to another.
+    constexpr double kPixelTolerance = 1.0e-3;
+    constexpr double kDepthTolerance = 1.0e-5;
+
+    // Clockwise from the outside, with the same winding the tutorial uses.
+    const XMFLOAT3 kCubePositions[8] =
+    {
+        XMFLOAT3(-1.0f, -1.0f, -1.0f), XMFLOAT3(-1.0f, 1.0f, -1.0f), XMFLOAT3(1.0f, 1.0f, -1.0f), XMFLOAT3(1.0f, -1.0f, -1.0f),
+        XMFLOAT3(-1.0f, -1.0f, 1.0f), XMFLOAT3(-1.0f, 1.0f, 1.0f), XMFLOAT3(1.0f, 1.0f, 1.0f), XMFLOAT3(1.0f, -1.0f, 1.0f)
+    };
+    const uint32_t kCubeIndices[36] =
+    {
+        0, 1, 2, 0, 2, 3,  4, 6, 5, 4, 7, 6,  4, 5, 1, 4, 1, 0,
+        3, 2, 6, 3, 6, 7,  1, 5, 6, 1, 6, 2,  4, 0, 3, 4, 3, 7
+    };
+
+    // A street of boxes in front of the camera: the occluders are the world matrices of a unit
+    // cube standing on the ground, the occludees smaller boxes scattered behind and between them.
+    void CreateStreet(SeededRandom& random, std::vector<XMFLOAT4X4>& occluderWorlds, std::vector<Aabb>& occludees)
+    {
+        occluderWorlds.resize(kOccluderBoxes);
+        for (XMFLOAT4X4& world : occluderWorlds)
+        {
+            float width = 0.5f + random.Next() * 3.0f;
+            float height = 1.0f + random.Next() * 6.0f;
+            float depth = 0.5f + random.Next() * 3.0f;
+            float x = random.Next() * 120.0f - 60.0f;
+            float z = 20.0f + random.Next() * 100.0f;
+            XMStoreFloat4x4(&world, XMMatrixMultiply(XMMatrixScaling(width, height, depth), XMMatrixTranslation(x, height - 2.0f, z)));
+        }
+
+        occludees.resize(kOccludeeBoxes);
+        for (Aabb& aabb : occludees)
+        {
+            float x = random.Next() * 120.0f - 60.0f;
+            float y = random.Next() * 6.0f - 2.0f;
+            float z = 20.0f + random.Next() * 180.0f;
+            float extent = 0.2f + random.Next() * 1.5f;
+            aabb.m_min = XMFLOAT3(x - extent, y - extent, z - extent);
+            aabb.m_max = XMFLOAT3(x + extent, y + extent, z + extent);
+        }
+    }
+
+    XMMATRIX StreetViewProjection()
+    {
+        return XMMatrixMultiply(XMMatrixTranslation(0.0f, -1.0f, 0.0f), XMMatrixPerspectiveFovLH(XM_PIDIV4, 16.0f / 9.0f, 0.1f, 1000.0f));
+    }
+
+    class OcclusionCullWorkload : public JobSystemWorkload
+    {
+    public:
+        const char* GetName() const override
+        {
+            return "occlusion_cull";
+        }
+
+        bool Initialize(unsigned int) override
+        {
+            SeededRandom random(kWorkloadSeed);
+            CreateStreet(random, m_occluderWorlds, m_occludees);
+            XMStoreFloat4x4(&m_viewProjection, StreetViewProjection());
+
+            return m_occlusionCuller.Initialize(kOcclusionWidth, kOcclusionHeight);
+        }
+
+        void Shutdown() override
+        {
+            m_occlusionCuller.Shutdown();
+            m_occluderWorlds.clear();
+            m_occludees.clear();
+            m_visible.clear();
+        }
+
+        double Run(JobSystem& jobSystem) override
+        {
+            m_occlusionCuller.BeginFrame(XMLoadFloat4x4(&m_viewProjection));
+            for (const XMFLOAT4X4& kWorld : m_occluderWorlds)
+            {
+                m_occlusionCuller.AddOccluder(kCubePositions, 8, kCubeIndices, 36, XMLoadFloat4x4(&kWorld));
+            }
+            m_occlusionCuller.Rasterize(&jobSystem);
+            m_occlusionCuller.Cull(m_occludees.data(), static_cast<unsigned int>(m_occludees.size()), &jobSystem, m_visible);
+
+            return m_occlusionCuller.GetStats().m_rasterizeSeconds + m_occlusionCuller.GetStats().m_testSeconds;
+        }
+
+    private:
+        OcclusionCuller m_occlusionCuller;
+        XMFLOAT4X4 m_viewProjection;
+        std::vector<XMFLOAT4X4> m_occluderWorlds;
+        std::vector<Aabb> m_occludees;
+        std::vector<uint32_t> m_visible;
+    };
+
+    struct CheckMesh
+    {
+        std::vector<XMFLOAT3> m_positions;
+        std::vector<uint32_t> m_indices;
+        XMFLOAT4X4 m_world;
+    };
+
+    struct CheckScene
+    {
+        unsigned int m_width;
+        unsigned int m_height;
+        XMFLOAT4X4 m_viewProjection;
+        std::vector<CheckMesh> m_meshes;
+        std::vector<Aabb> m_occludees;
+    };
+
+    struct CheckErrors
+    {
+        uint64_t m_simdMismatches = 0;
+        uint64_t m_coveredOutside = 0;
+        uint64_t m_uncoveredInside = 0;
+        uint64_t m_nearerThanOccluder = 0;
+        uint64_t m_sharedEdgeErrors = 0;
+        uint64_t m_backFaceErrors = 0;
+        uint64_t m_hiddenErrors = 0;
+    };
+
+    // A triangle as the reference sees it, in buffer pixels and depth.
+    struct ReferenceTriangle
+    {
+        double m_x[3];
+        double m_y[3];
+        double m_depth[3];
+        double m_area;
+    };
+
+    // A street with other seeds, and boxes around the camera that cross the near plane or are
+    // just in front of it.
+    void CreateCheckStreet(uint32_t seed, CheckScene& scene)
+    {
+        SeededRandom random(seed);
+
+        std::vector<XMFLOAT4X4> occluderWorlds;
+        CreateStreet(random, occluderWorlds, scene.m_occludees);
+
+        for (unsigned int i = 0; i < kNearOccluderBoxes; ++i)
+        {
+            float x = random.Next(-3.0f, 3.0f);
+            float y = random.Next(-1.0f, 3.0f);
+            float z = random.Next(-1.0f, 4.0f);
+            float extent = random.Next(0.2f, 1.5f);
+            XMFLOAT4X4 world;
+            XMStoreFloat4x4(&world, XMMatrixMultiply(XMMatrixScaling(extent, extent, extent), XMMatrixTranslation(x, y, z)));
+            occluderWorlds.push_back(world);
+        }
+
+        for (unsigned int i = 0; i < kNearOccludeeBoxes; ++i)
+        {
+            float x = random.Next(-3.0f, 3.0f);
+            float y = random.Next(-1.0f, 3.0f);
+            float z = random.Next(-1.0f, 20.0f);
+            float extent = random.Next(0.05f, 1.0f);
+            Aabb aabb;
+            aabb.m_min = XMFLOAT3(x - extent, y - extent, z - extent);
+            aabb.m_max = XMFLOAT3(x + extent, y + extent, z + extent);
+            scene.m_occludees.push_back(aabb);
+        }
+
+        scene.m_width = kOcclusionWidth;
+        scene.m_height = kOcclusionHeight;
+        XMStoreFloat4x4(&scene.m_viewProjection, StreetViewProjection());
+
+        scene.m_meshes.resize(occluderWorlds.size());
+        for (size_t i = 0; i < occluderWorlds.size(); ++i)
+        {
+            scene.m_meshes[i].m_positions.assign(kCubePositions, kCubePositions + 8);
+            scene.m_meshes[i].m_indices.assign(kCubeIndices, kCubeIndices + 36);
+            scene.m_meshes[i].m_world = occluderWorlds[i];
+        }
+    }
+
+    // A grid of kMeshColumns x kMeshRows cells cut into two triangles each, clockwise on screen.
+    // The outline is on pixel centers. The inner vertices are moved by up to jitter pixels in
+    // quarter pixel steps, and every vertex gets a depth of its own.
+    void CreateCheckMesh(SeededRandom& random, float jitter, CheckScene& scene)
+    {
+        const float kLeft = 40.5f;
+        const float kTop = 16.5f;
+
+        scene.m_width = kMeshWidth;
+        scene.m_height = kMeshHeight;
+        // Buffer pixels straight through, depth is z.
+        XMStoreFloat4x4(&scene.m_viewProjection, XMMatrixOrthographicOffCenterLH(0.0f, static_cast<float>(kMeshWidth), static_cast<float>(kMeshHeight), 0.0f, 0.0f, 1.0f));
+
+        CheckMesh mesh;
+        XMStoreFloat4x4(&mesh.m_world, XMMatrixIdentity());
+
+        for (unsigned int row = 0; row <= kMeshRows; ++row)
+        {
+            for (unsigned int column = 0; column <= kMeshColumns; ++column)
+            {
+                float x = kLeft + column * kMeshCellSize;
+                float y = kTop + row * kMeshCellSize;
+                if (column > 0 && column < kMeshColumns && row > 0 && row < kMeshRows)
+                {
+                    x += std::floor(random.Next(-jitter, jitter) * 4.0f) * 0.25f;
+                    y += std::floor(random.Next(-jitter, jitter) * 4.0f) * 0.25f;
+                }
+                mesh.m_positions.push_back(XMFLOAT3(x, y, random.Next(0.1f, 0.9f)));
+            }
+        }
+
+        // Every other cell is cut along the other diagonal, so the diagonals go both ways.
+        for (unsigned int row = 0; row < kMeshRows; ++row)
+        {
+            for (unsigned int column = 0; column < kMeshColumns; ++column)
+            {
+                uint32_t topLeft = row * (kMeshColumns + 1) + column;
+                uint32_t topRight = topLeft + 1;
+                uint32_t bottomLeft = topLeft + kMeshColumns + 1;
+                uint32_t bottomRight = bottomLeft + 1;
+
+                const uint32_t kAlongFirst[6] = { topLeft, topRight, bottomRight, topLeft, bottomRight, bottomLeft };
+                const uint32_t kAlongSecond[6] = { topLeft, topRight, bottomLeft, topRight, bottomRight, bottomLeft };
+                const uint32_t* pCell = ((row + column) % 2 == 0) ? kAlongFirst : kAlongSecond;
+                mesh.m_indices.insert(mesh.m_indices.end(), pCell, pCell + 6);
+            }
+        }
+
+        scene.m_meshes.push_back(mesh);
+
+        // Boxes over the mesh, some in front of it and some behind.
+        for (unsigned int i = 0; i < 500; ++i)
+        {
+            float x = random.Next(0.0f, static_cast<float>(kMeshWidth));
+            float y = random.Next(0.0f, static_cast<float>(kMeshHeight));
+            float z = random.Next(0.05f, 0.95f);
+            float extent = random.Next(0.5f, 12.0f);
+            Aabb aabb;
+            aabb.m_min = XMFLOAT3(x - extent, y - extent, z - 0.04f);
+            aabb.m_max = XMFLOAT3(x + extent, y + extent, z + 0.04f);
+            scene.m_occludees.push_back(aabb);
+        }
+    }
+
+    void Rasterize(OcclusionCuller& culler, const CheckScene& kScene, JobSystem* pJobSystem)
+    {
+        culler.BeginFrame(XMLoadFloat4x4(&kScene.m_viewProjection));
+        for (const CheckMesh& kMesh : kScene.m_meshes)
+        {
+            culler.AddOccluder(kMesh.m_positions.data(), static_cast<unsigned int>(kMesh.m_positions.size()),
+                kMesh.m_indices.data(), static_cast<unsigned int>(kMesh.m_indices.size()), XMLoadFloat4x4(&kMesh.m_world));
+        }
+        culler.Rasterize(pJobSystem);
+    }
+
+    // Clip space of a point, by a matrix made the way OcclusionCuller makes it but added up in doubles.
+    void TransformToClip(const XMFLOAT3& kPosition, const XMFLOAT4X4& kMatrix, double clip[4])
+    {
+        for (unsigned int component = 0; component < 4; ++component)
+        {
+            clip[component] = static_cast<double>(kPosition.x) * kMatrix.m[0][component] + static_cast<double>(kPosition.y) * kMatrix.m[1][component] +
+                static_cast<double>(kPosition.z) * kMatrix.m[2][component] + kMatrix.m[3][component];
+        }
+    }
+
+    // The triangles the culler should rasterize: in front of the near plane and clockwise on screen.
+    void ProjectReference(const CheckScene& kScene, std::vector<ReferenceTriangle>& triangles)
+    {
+        triangles.clear();
+
+        for (const CheckMesh& kMesh : kScene.m_meshes)
+        {
+            XMFLOAT4X4 worldViewProjection;
+            XMStoreFloat4x4(&worldViewProjection, XMMatrixMultiply(XMLoadFloat4x4(&kMesh.m_world), XMLoadFloat4x4(&kScene.m_viewProjection)));
+
+            for (size_t i = 0; i + 2 < kMesh.m_indices.size(); i += 3)
+            {
+                ReferenceTriangle triangle;
+                bool inFront = true;
+
+                for (unsigned int vertex = 0; vertex < 3; ++vertex)
+                {
+                    double clip[4];
+                    TransformToClip(kMesh.m_positions[kMesh.m_indices[i + vertex]], worldViewProjection, clip);
+                    inFront = inFront && clip[2] >= 0.0;
+
+                    triangle.m_x[vertex] = (clip[0] / clip[3] * 0.5 + 0.5) * kScene.m_width;
+                    triangle.m_y[vertex] = (0.5 - clip[1] / clip[3] * 0.5) * kScene.m_height;
+                    triangle.m_depth[vertex] = clip[2] / clip[3];
+                }
+
+                triangle.m_area = (triangle.m_x[1] - triangle.m_x[0]) * (triangle.m_y[2] - triangle.m_y[0]) -
+                    (triangle.m_x[2] - triangle.m_x[0]) * (triangle.m_y[1] - triangle.m_y[0]);
+
+                if (inFront && triangle.m_area > 0.0)
+                {
+                    triangles.push_back(triangle);
+                }
+            }
+        }
+    }
+
+    // Of the edge from vertex a to vertex b at a point, positive on the inside. Divided by the
+    // edge's length it is how far inside in pixels, and the three of them add up to the area.
+    double EdgeFunction(const ReferenceTriangle& kTriangle, unsigned int a, unsigned int b, double x, double y)
+    {
+        return (kTriangle.m_x[b] - kTriangle.m_x[a]) * (y - kTriangle.m_y[a]) - (kTriangle.m_y[b] - kTriangle.m_y[a]) * (x - kTriangle.m_x[a]);
+    }
+
+    double EdgeLength(const ReferenceTriangle& kTriangle, unsigned int a, unsigned int b)
+    {
+        double edgeX = kTriangle.m_x[b] - kTriangle.m_x[a];
+        double edgeY = kTriangle.m_y[b] - kTriangle.m_y[a];
+        return std::sqrt(edgeX * edgeX + edgeY * edgeY);
+    }
+
+    // Every pixel of both buffers against the triangles over its center, and the buffers
+    // against each other.
+    void CheckPixels(const CheckScene& kScene, const OcclusionCuller& kSimd, const OcclusionCuller& kScalar, CheckErrors& errors)
+    {
+        std::vector<ReferenceTriangle> triangles;
+        ProjectReference(kScene, triangles);
+
+        // The nearest depth of the triangles that may cover a center, and of those that must.
+        const double kNothing = 2.0;
+        std::vector<double> mayCoverDepth(kScene.m_width * kScene.m_height, kNothing);
+        std::vector<double> mustCoverDepth(kScene.m_width * kScene.m_height, kNothing);
+
+        for (const ReferenceTriangle& kTriangle : triangles)
+        {
+            double minX = std::min(std::min(kTriangle.m_x[0], kTriangle.m_x[1]), kTriangle.m_x[2]);
+            double maxX = std::max(std::max(kTriangle.m_x[0], kTriangle.m_x[1]), kTriangle.m_x[2]);
+            double minY = std::min(std::min(kTriangle.m_y[0], kTriangle.m_y[1]), kTriangle.m_y[2]);
+            double maxY = std::max(std::max(kTriangle.m_y[0], kTriangle.m_y[1]), kTriangle.m_y[2]);
+
+            int x0 = static_cast<int>(std::max(0.0, std::floor(minX - 1.0)));
+            int x1 = static_cast<int>(std::min(kScene.m_width - 1.0, std::floor(maxX + 1.0)));
+            int y0 = static_cast<int>(std::max(0.0, std::floor(minY - 1.0)));
+            int y1 = static_cast<int>(std::min(kScene.m_height - 1.0, std::floor(maxY + 1.0)));
+
+            double length12 = EdgeLength(kTriangle, 1, 2);
+            double length20 = EdgeLength(kTriangle, 2, 0);
+            double length01 = EdgeLength(kTriangle, 0, 1);
+
+            for (int y = y0; y <= y1; ++y)
+            {
+                double centerY = y + 0.5;
+                for (int x = x0; x <= x1; ++x)
+                {
+                    double centerX = x + 0.5;
+                    double edge12 = EdgeFunction(kTriangle, 1, 2, centerX, centerY);
+                    double edge20 = EdgeFunction(kTriangle, 2, 0, centerX, centerY);
+                    double edge01 = EdgeFunction(kTriangle, 0, 1, centerX, centerY);
+                    double inside = std::min(std::min(edge12 / length12, edge20 / length20), edge01 / length01);
+                    if (inside <= -kPixelTolerance)
+                    {
+                        continue;
+                    }
+
+                    // Each vertex weighs as much as the edge across from it.
+                    double depth = (edge12 * kTriangle.m_depth[0] + edge20 * kTriangle.m_depth[1] + edge01 * kTriangle.m_depth[2]) / kTriangle.m_area;
+
+                    unsigned int pixel = y * kScene.m_width + x;
+                    mayCoverDepth[pixel] = std::min(mayCoverDepth[pixel], depth);
+                    if (inside >= kPixelTolerance)
+                    {
+                        mustCoverDepth[pixel] = std::min(mustCoverDepth[pixel], depth);
+                    }
+                }
+            }
+        }
+
+        for (unsigned int y = 0; y < kScene.m_height; ++y)
+        {
+            for (unsigned int x = 0; x < kScene.m_width; ++x)
+            {
+                errors.m_simdMismatches += (kSimd.GetDepth(x, y) != kScalar.GetDepth(x, y)) ? 1 : 0;
+
+                unsigned int pixel = y * kScene.m_width + x;
+                for (const OcclusionCuller* pCuller : { &kSimd, &kScalar })
+                {
+                    float depth = pCuller->GetDepth(x, y);
+                    bool covered = depth < 1.0f;
+                    if (covered && mayCoverDepth[pixel] == kNothing)
+                    {
+                        ++errors.m_coveredOutside;
+                    }
+                    if (!covered && mustCoverDepth[pixel] < 1.0 - kDepthTolerance)
+                    {
+                        ++errors.m_uncoveredInside;
+                    }
+                    if (covered && depth < mayCoverDepth[pixel] - kDepthTolerance)
+                    {
+                        ++errors.m_nearerThanOccluder;
+                    }
+                }
+            }
+        }
+    }
+
+    // A box Cull() dropped has to be in front of the near plane, on screen, and in front of no
+    // pixel it touches. The buffer itself was checked against the triangles already.
+    bool IsWronglyHidden(const CheckScene& kScene, const OcclusionCuller& kCuller, const Aabb& kAabb)
+    {
+        double minX = 1.0e30;
+        double maxX = -1.0e30;
+        double minY = 1.0e30;
+        double maxY = -1.0e30;
+        double minDepth = 1.0e30;
+
+        for (unsigned int corner = 0; corner < 8; ++corner)
+        {
+            XMFLOAT3 position((corner & 1) ? kAabb.m_max.x : kAabb.m_min.x, (corner & 2) ? kAabb.m_max.y : kAabb.m_min.y, (corner & 4) ? kAabb.m_max.z : kAabb.m_min.z);
+            double clip[4];
+            TransformToClip(position, kScene.m_viewProjection, clip);
+            if (clip[2] < 0.0)
+            {
+                return true;
+            }
+
+            double x = (clip[0] / clip[3] * 0.5 + 0.5) * kScene.m_width;
+            double y = (0.5 - clip[1] / clip[3] * 0.5) * kScene.m_height;
+            minX = std::min(minX, x);
+            maxX = std::max(maxX, x);
+            minY = std::min(minY, y);
+            maxY = std::max(maxY, y);
+            minDepth = std::min(minDepth, clip[2] / clip[3]);
+        }
+
+        if (maxX < 0.0 || maxY < 0.0 || minX >= kScene.m_width || minY >= kScene.m_height)
+        {
+            return true;
+        }
+
+        // The pixels the rectangle surely touches.
+        int x0 = static_cast<int>(std::max(0.0, std::floor(minX + kPixelTolerance)));
+        int x1 = static_cast<int>(std::min(kScene.m_width - 1.0, std::floor(maxX - kPixelTolerance)));
+        int y0 = static_cast<int>(std::max(0.0, std::floor(minY + kPixelTolerance)));
+        int y1 = static_cast<int>(std::min(kScene.m_height - 1.0, std::floor(maxY - kPixelTolerance)));
+
+        for (int y = y0; y <= y1; ++y)
+        {
+            for (int x = x0; x <= x1; ++x)
+            {
+                if (kCuller.GetDepth(x, y) >= minDepth + kDepthTolerance)
+                {
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    void CheckBoxes(const CheckScene& kScene, OcclusionCuller& simd, OcclusionCuller& scalar, JobSystem& jobSystem, CheckErrors& errors)
+    {
+        unsigned int count = static_cast<unsigned int>(kScene.m_occludees.size());
+
+        std::vector<uint32_t> simdVisible;
+        std::vector<uint32_t> scalarVisible;
+        simd.Cull(kScene.m_occludees.data(), count, &jobSystem, simdVisible);
+        scalar.Cull(kScene.m_occludees.data(), count, nullptr, scalarVisible);
+
+        std::vector<uint8_t> visibleFlags(count, 0);
+        for (uint32_t index : simdVisible)
+        {
+            visibleFlags[index] |= 1;
+        }
+        for (uint32_t index : scalarVisible)
+        {
+            visibleFlags[index] |= 2;
+        }
+
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            errors.m_simdMismatches += (visibleFlags[i] == 1 || visibleFlags[i] == 2) ? 1 : 0;
+            if ((visibleFlags[i] & 1) == 0 && IsWronglyHidden(kScene, simd, kScene.m_occludees[i]))
+            {
+                ++errors.m_hiddenErrors;
+            }
+            if ((visibleFlags[i] & 2) == 0 && IsWronglyHidden(kScene, scalar, kScene.m_occludees[i]))
+            {
+                ++errors.m_hiddenErrors;
+            }
+        }
+    }
+
+    void CheckScenePixelsAndBoxes(const CheckScene& kScene, JobSystem& jobSystem, CheckErrors& errors)
+    {
+        OcclusionCuller simd;
+        OcclusionCuller scalar;
+        simd.Initialize(kScene.m_width, kScene.m_height);
+        scalar.Initialize(kScene.m_width, kScene.m_height);
+        scalar.SetSimd(false);
+
+        Rasterize(simd, kScene, &jobSystem);
+        Rasterize(scalar, kScene, nullptr);
+
+        CheckPixels(kScene, simd, scalar, errors);
+        CheckBoxes(kScene, simd, scalar, jobSystem, errors);
+
+        simd.Shutdown();
+        scalar.Shutdown();
+    }
+
+    // Rasterizes the mesh one triangle at a time and counts the triangles covering each center.
+    // Strictly inside the outline that is one, on it and outside at most one, and nothing at
+    // all facing away.
+    void CheckSharedEdges(const CheckScene& kScene, bool simd, CheckErrors& errors)
+    {
+        const CheckMesh& kMesh = kScene.m_meshes[0];
+
+        OcclusionCuller culler;
+        culler.Initialize(kScene.m_width, kScene.m_height);
+        culler.SetSimd(simd);
+
+        std::vector<unsigned int> coverCounts(kScene.m_width * kScene.m_height, 0);
+        for (size_t i = 0; i + 2 < kMesh.m_indices.size(); i += 3)
+        {
+            culler.BeginFrame(XMLoadFloat4x4(&kScene.m_viewProjection));
+            culler.AddOccluder(kMesh.m_positions.data(), static_cast<unsigned int>(kMesh.m_positions.size()), &kMesh.m_indices[i], 3, XMLoadFloat4x4(&kMesh.m_world));
+            culler.Rasterize(nullptr);
+
+            for (unsigned int y = 0; y < kScene.m_height; ++y)
+            {
+                for (unsigned int x = 0; x < kScene.m_width; ++x)
+                {
+                    coverCounts[y * kScene.m_width + x] += (culler.GetDepth(x, y) < 1.0f) ? 1 : 0;
+                }
+            }
+        }
+
+        const XMFLOAT3& kFirst = kMesh.m_positions.front();
+        const XMFLOAT3& kLast = kMesh.m_positions.back();
+        for (unsigned int y = 0; y < kScene.m_height; ++y)
+        {
+            for (unsigned int x = 0; x < kScene.m_width; ++x)
+            {
+                float centerX = x + 0.5f;
+                float centerY = y + 0.5f;
+                bool inside = centerX > kFirst.x && centerX < kLast.x && centerY > kFirst.y && centerY < kLast.y;
+                unsigned int count = coverCounts[y * kScene.m_width + x];
+                errors.m_sharedEdgeErrors += (count > 1 || (inside && count == 0)) ? 1 : 0;
+            }
+        }
+
+        // The same triangles the other way around.
+        std::vector<uint32_t> reversed(kMesh.m_indices);
+        for (size_t i = 0; i + 2 < reversed.size(); i += 3)
+        {
+            std::swap(reversed[i + 1], reversed[i + 2]);
+        }
+
+        culler.BeginFrame(XMLoadFloat4x4(&kScene.m_viewProjection));
+        culler.AddOccluder(kMesh.m_positions.data(), static_cast<unsigned int>(kMesh.m_positions.size()), reversed.data(), static_cast<unsigned int>(reversed.size()), XMLoadFloat4x4(&kMesh.m_world));
+        culler.Rasterize(nullptr);
+
+        for (unsigned int y = 0; y < kScene.m_height; ++y)
+        {
+            for (unsigned int x = 0; x < kScene.m_width; ++x)
+            {
+                errors.m_backFaceErrors += (culler.GetDepth(x, y) < 1.0f) ? 1 : 0;
+            }
+        }
+
+        culler.Shutdown();
+    }
+}
+
+std::unique_ptr<JobSystemWorkload> CreateOcclusionCullWorkload()
+{
+    return std::make_unique<OcclusionCullWorkload>();
+}
+
+bool RunOcclusionCullerCheck()
+{
+    JobSystem jobSystem;
+    if (!jobSystem.Initialize(JobSystem::GetDefaultWorkerCount()))
+    {
+        return false;
+    }
+
+    CheckErrors errors;
+    unsigned int scenes = 0;
+
+    for (unsigned int street = 0; street < kCheckStreets; ++street)
+    {
+        CheckScene scene;
+        CreateCheckStreet(kWorkloadSeed + 1 + street, scene);
+        CheckScenePixelsAndBoxes(scene, jobSystem, errors);
+        ++scenes;
+    }
+
+    // On the grid, then moved off it by up to a few pixels. Less than a cell's quarter, so no
+    // triangle turns over.
+    const float kJitters[] = { 0.0f, 0.75f, 2.0f, 3.5f };
+    SeededRandom random(kWorkloadSeed);
+    for (unsigned int i = 0; i < sizeof(kJitters) / sizeof(kJitters[0]); ++i)
+    {
+        CheckScene scene;
+        CreateCheckMesh(random, kJitters[i], scene);
+        CheckScenePixelsAndBoxes(scene, jobSystem, errors);
+        CheckSharedEdges(scene, true, errors);
+        CheckSharedEdges(scene, false, errors);
+        ++scenes;
+    }
+
+    jobSystem.Shutdown();
+
+    char results[1024];
+    sprintf_s(results, sizeof(results),
+        "occlusion_check_scenes: %u\n"
+        "simd_mismatches: %llu\n"
+        "covered_outside: %llu\n"
+        "uncovered_inside: %llu\n"
+        "nearer_than_occluder: %llu\n"
+        "shared_edge_errors: %llu\n"
+        "back_face_errors: %llu\n"
+        "hidden_errors: %llu\n",
+        scenes,
+        static_cast<unsigned long long>(errors.m_simdMismatches),
+        static_cast<unsigned long long>(errors.m_coveredOutside),
+        static_cast<unsigned long long>(errors.m_uncoveredInside),
+        static_cast<unsigned long long>(errors.m_nearerThanOccluder),
+        static_cast<unsigned long long>(errors.m_sharedEdgeErrors),
+        static_cast<unsigned long long>(errors.m_backFaceErrors),
+        static_cast<unsigned long long>(errors.m_hiddenErrors));
+
+    fputs(results, stdout);
+    OutputDebugStringA(results);
+
+    return errors.m_simdMismatches == 0 && errors.m_coveredOutside == 0 && errors.m_uncoveredInside == 0 &&
+        errors.m_nearerThanOccluder == 0 && errors.m_sharedEdgeErrors == 0 && errors.m_backFaceErrors == 0 &&
+        errors.m_hiddenErrors == 0;
+}
@@ -0,0 +1,170 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: PresentClock.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#include "Graphics/PresentClock.h"
+
+void PresentClock::SleepUntil(Clock::time_point time)
+{
+    const Clock::duration kSpinTime = std::chrono::microseconds(1500);
+
+    Clock::time_point now = Clock::now();
+    if (time - now > kSpinTime)
+    {
+        std::this_thread::sleep_for(time - now - kSpinTime);
+    }
+
+    while (Clock::now() < time)
+    {
+        std::this_thread::yield();
+    }
+}
+
+SwapChainPresentClock::SwapChainPresentClock()
+    : m_pSwapChain(nullptr)
+    , m_refreshSeconds(0.0)
+    , m_queuedFrameCount(0)
+{
+    m_performanceFrequency.QuadPart = 0;
+}
+
+SwapChainPresentClock::~SwapChainPresentClock()
+{
+}
+
+bool SwapChainPresentClock::Initialize(IDXGISwapChain* pSwapChain, ID3D11Device* pDevice, double refreshSeconds, unsigned int maxQueuedFrames)
+{
+    HRESULT result;
+    IDXGIDevice1* pDxgiDevice = nullptr;
+
+    m_pSwapChain = pSwapChain;
+    m_refreshSeconds = refreshSeconds;
+
+    // Limit how many frames the driver lets the CPU get ahead of the display.
+    result = pDevice->QueryInterface(__uuidof(IDXGIDevice1), reinterpret_cast<void**>(&pDxgiDevice));
+    if (FAILED(result))
+    {
+        return false;
+    }
+
+    result = pDxgiDevice->SetMaximumFrameLatency(std::max(1u, maxQueuedFrames));
+    pDxgiDevice->Release();
+    pDxgiDevice = nullptr;
+
+    if (FAILED(result))
+    {
+        return false;
+    }
+
+    QueryPerformanceFrequency(&m_performanceFrequency);
+
+    return true;
+}
+
+double SwapChainPresentClock::GetRefreshSeconds() const
+{
+    return m_refreshSeconds;
+}
+
+PresentClock::Clock::time_point SwapChainPresentClock::Present(unsigned int syncInterval)
+{
+    m_pSwapChain->Present(syncInterval, 0);
+
+    Clock::time_point now = Clock::now();
+
+    DXGI_FRAME_STATISTICS frameStatistics;
+    UINT lastPresentCount = 0;
+    if (FAILED(m_pSwapChain->GetFrameStatistics(&frameStatistics)) || FAILED(m_pSwapChain->GetLastPresentCount(&lastPresentCount)))
+    {
+        m_queuedFrameCount = 0;
+        return now;
+    }
+
+    // Frames presented after the one that flipped last are still queued,
+    // each of them takes (at least) one more refresh to reach the screen.
+    m_queuedFrameCount = lastPresentCount - frameStatistics.PresentCount;
+
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+
+    double lastFlipOffset = static_cast<double>(frameStatistics.SyncQPCTime.QuadPart - counter.QuadPart) / m_performanceFrequency.QuadPart;
+    double displayOffset = lastFlipOffset + m_queuedFrameCount * m_refreshSeconds;
+
+    return now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(std::max(0.0, displayOffset)));
+}
+
+unsigned int SwapChainPresentClock::GetQueuedFrameCount() const
+{
+    return m_queuedFrameCount;
+}
+
+SimulatedDisplay::SimulatedDisplay(double refreshSeconds, unsigned int maxQueuedFrames)
+    : m_refreshSeconds(refreshSeconds)
+    , m_maxQueuedFrames(std::max(1u, maxQueuedFrames))
+    , m_startTime(Clock::now())
+    , m_lastFlipTime(m_startTime)
+{
+}
+
+SimulatedDisplay::~SimulatedDisplay()
+{
+}
+
+double SimulatedDisplay::GetRefreshSeconds() const
+{
+    return m_refreshSeconds;
+}
+
+PresentClock::Clock::time_point SimulatedDisplay::Present(unsigned int syncInterval)
+{
+    Clock::time_point now = Clock::now();
+
+    // A frame never flips before the one presented ahead of it.
+    Clock::time_point flipTime = std::max(now, m_lastFlipTime);
+    if (syncInterval > 0 && m_refreshSeconds > 0.0)
+    {
+        flipTime = NextVBlank(flipTime);
+    }
+
+    m_lastFlipTime = flipTime;
+    m_pendingFlips.push_back(flipTime);
+
+    // Retire what has flipped by now and wait for room in the queue.
+    while (!m_pendingFlips.empty() && m_pendingFlips.front() <= now)
+    {
+        m_pendingFlips.pop_front();
+    }
+
+    while (m_pendingFlips.size() > m_maxQueuedFrames)
+    {
+        SleepUntil(m_pendingFlips.front());
+        m_pendingFlips.pop_front();
+    }
+
+    return flipTime;
+}
+
+unsigned int SimulatedDisplay::GetQueuedFrameCount() const
+{
+    Clock::time_point now = Clock::now();
+    while (!m_pendingFlips.empty() && m_pendingFlips.front() <= now)
+    {
+        m_pendingFlips.pop_front();
+    }
+
+    return static_cast<unsigned int>(m_pendingFlips.size());
+}
+
+// The first vertical blank strictly after the given time.
+PresentClock::Clock::time_point SimulatedDisplay::NextVBlank(Clock::time_point time) const
+{
+    // Blank times are rounded to the clock tick, nudge them so a time that
+    // is exactly on a blank counts as on it and not just before.
+    double elapsed = std::chrono::duration<double>(time - m_startTime).count();
+    double blankCount = std::floor(elapsed / m_refreshSeconds + 1e-6) + 1.0;
+
+    return m_startTime + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(blankCount * m_refreshSeconds));
+}
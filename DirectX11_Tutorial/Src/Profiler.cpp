@@ -0,0 +1,292 @@
+//////////////////////////////////////////////////////////////////////
+// Filename: Profiler.cpp
+//////////////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include "System/Profiler.h"
+
+thread_local ProfilerThreadBuffer* Profiler::s_pThreadBuffer = nullptr;
+std::atomic<unsigned long long> Profiler::s_frameIndex(0);
+
+namespace
+{
+    // When each of the last kFrameHistory frames began, for the frame markers of the trace.
+    constexpr unsigned int kFrameHistory = 1024;
+    std::atomic<long long> s_frameStartTicks[kFrameHistory];
+
+    // Where the ticks were measured against the steady clock first.
+    struct Calibration
+    {
+        long long m_ticks;
+        Profiler::Clock::time_point m_time;
+    };
+    const Calibration s_calibration = { Profiler::ReadTicks(), Profiler::Clock::now() };
+
+    std::mutex s_threadMutex;
+    std::vector<std::unique_ptr<ProfilerThreadBuffer>> s_threadBuffers;
+
+    struct CollectedEvent
+    {
+        ProfileEvent m_event;
+        unsigned int m_threadId;
+    };
+
+    double GetTicksPerSecond()
+    {
+#if PROFILER_USE_TSC
+        // Measure the rate over at least a few milliseconds, longer runs only get more precise.
+        Profiler::Clock::time_point now = Profiler::Clock::now();
+        if (now - s_calibration.m_time < std::chrono::milliseconds(10))
+        {
+            now = s_calibration.m_time + std::chrono::milliseconds(10);
+            while (Profiler::Clock::now() < now)
+            {
+            }
+            now = Profiler::Clock::now();
+        }
+
+        double elapsedSeconds = std::chrono::duration<double>(now - s_calibration.m_time).count();
+        return (Profiler::ReadTicks() - s_calibration.m_ticks) / elapsedSeconds;
+#else
+        return static_cast<double>(Profiler::Clock::period::den) / Profiler::Clock::period::num;
+#endif
+    }
+
+    // Copies the events of the frame range out of every ring, sorted by thread and start time.
+    void CollectEvents(unsigned long long firstFrame, unsigned long long lastFrame, std::vector<CollectedEvent>& events, std::vector<const ProfilerThreadBuffer*>& threads)
+    {
+        std::lock_guard<std::mutex> lock(s_threadMutex);
+
+        for (const std::unique_ptr<ProfilerThreadBuffer>& kpBuffer : s_threadBuffers)
+        {
+            threads.push_back(kpBuffer.get());
+
+            unsigned long long end = kpBuffer->m_eventCount.load(std::memory_order_acquire);
+            unsigned long long begin = (end > ProfilerThreadBuffer::kCapacity) ? (end - ProfilerThreadBuffer::kCapacity) : 0;
+
+            size_t firstCopied = events.size();
+            for (unsigned long long i = begin; i < end; ++i)
+            {
+                const ProfileEvent& kEvent = kpBuffer->m_events[i & (ProfilerThreadBuffer::kCapacity - 1)];
+                CollectedEvent collected;
+                collected.m_event = kEvent;
+                collected.m_threadId = kpBuffer->m_threadId;
+                events.push_back(collected);
+            }
+
+            // The owner may have written over the oldest ones while they were copied.
+            unsigned long long endAfter = kpBuffer->m_eventCount.load(std::memory_order_acquire);
+            unsigned long long overwritten = (endAfter >= ProfilerThreadBuffer::kCapacity) ? (endAfter - ProfilerThreadBuffer::kCapacity + 1) : 0;
+            if (overwritten > begin)
+            {
+                size_t dropCount = static_cast<size_t>(std::min(overwritten - begin, end - begin));
+                events.erase(events.begin() + firstCopied, events.begin() + firstCopied + dropCount);
+            }
+        }
+
+        events.erase(std::remove_if(events.begin(), events.end(), [firstFrame, lastFrame](const CollectedEvent& kEvent)
+        {
+            return kEvent.m_event.m_frameIndex < firstFrame || kEvent.m_event.m_frameIndex > lastFrame;
+        }), events.end());
+
+        // Parents start no later than their children and sit less deep.
+        std::sort(events.begin(), events.end(), [](const CollectedEvent& kA, const CollectedEvent& kB)
+        {
+            if (kA.m_threadId != kB.m_threadId)
+            {
+                return kA.m_threadId < kB.m_threadId;
+            }
+            if (kA.m_event.m_startTicks != kB.m_event.m_startTicks)
+            {
+                return kA.m_event.m_startTicks < kB.m_event.m_startTicks;
+            }
+            return kA.m_event.m_depth < kB.m_event.m_depth;
+        });
+    }
+
+    void WriteJsonString(FILE* pFile, const char* pText)
+    {
+        fputc('"', pFile);
+        for (; *pText; ++pText)
+        {
+            if (*pText == '"' || *pText == '\\')
+            {
+                fputc('\\', pFile);
+            }
+            fputc(*pText, pFile);
+        }
+        fputc('"', pFile);
+    }
+}
+
+void Profiler::BeginFrame()
+{
+    unsigned long long frameIndex = s_frameIndex.load(std::memory_order_relaxed) + 1;
+    s_frameStartTicks[frameIndex % kFrameHistory].store(ReadTicks(), std::memory_order_relaxed);
+    s_frameIndex.store(frameIndex, std::memory_order_relaxed);
+}
+
+void Profiler::SetThreadName(const char* pName)
+{
+    ProfilerThreadBuffer& buffer = GetThreadBuffer();
+    strncpy_s(buffer.m_name, sizeof(buffer.m_name), pName, _TRUNCATE);
+}
+
+//-----------------------------------------------------------------
+// Adds up the time of every scope path over the frame range.
+// Paths are "Parent/Child" built from the nesting on each thread,
+// the result is sorted by path so children follow their parent.
+//-----------------------------------------------------------------
+unsigned long long Profiler::GetSummary(unsigned long long firstFrame, unsigned long long lastFrame, std::vector<ProfileScopeStats>& stats)
+{
+    std::vector<CollectedEvent> events;
+    std::vector<const ProfilerThreadBuffer*> threads;
+    CollectEvents(firstFrame, lastFrame, events, threads);
+
+    std::map<std::string, ProfileScopeStats> scopes;
+    std::vector<std::string> pathStack;
+    unsigned int currentThread = ~0u;
+    unsigned long long minFrame = ~0ull;
+    unsigned long long maxFrame = 0;
+
+    for (const CollectedEvent& kEvent : events)
+    {
+        if (kEvent.m_threadId != currentThread)
+        {
+            currentThread = kEvent.m_threadId;
+            pathStack.clear();
+        }
+
+        // A parent that fell out of the ring leaves its children at the top.
+        pathStack.resize(std::min<size_t>(pathStack.size(), kEvent.m_event.m_depth));
+
+        std::string path = pathStack.empty() ? std::string(kEvent.m_event.m_pName) : (pathStack.back() + "/" + kEvent.m_event.m_pName);
+
+        ProfileScopeStats& scope = scopes[path];
+        if (scope.m_callCount == 0)
+        {
+            scope.m_path = path;
+            scope.m_pName = kEvent.m_event.m_pName;
+            scope.m_depth = static_cast<unsigned int>(pathStack.size());
+            scope.m_totalTicks = 0;
+        }
+        ++scope.m_callCount;
+        scope.m_totalTicks += kEvent.m_event.m_endTicks - kEvent.m_event.m_startTicks;
+
+        pathStack.push_back(path);
+
+        minFrame = std::min(minFrame, kEvent.m_event.m_frameIndex);
+        maxFrame = std::max(maxFrame, kEvent.m_event.m_frameIndex);
+    }
+
+    double ticksPerSecond = GetTicksPerSecond();
+
+    stats.clear();
+    for (std::pair<const std::string, ProfileScopeStats>& scope : scopes)
+    {
+        scope.second.m_totalSeconds = scope.second.m_totalTicks / ticksPerSecond;
+        stats.push_back(scope.second);
+    }
+
+    return events.empty() ? 0 : (maxFrame - minFrame + 1);
+}
+
+//-----------------------------------------------------------------
+// Writes the frame range in the Trace Event Format, load it in
+// chrome://tracing or ui.perfetto.dev.
+//-----------------------------------------------------------------
+bool Profiler::ExportChromeTrace(const char* pFileName, unsigned long long firstFrame, unsigned long long lastFrame)
+{
+    std::vector<CollectedEvent> events;
+    std::vector<const ProfilerThreadBuffer*> threads;
+    CollectEvents(firstFrame, lastFrame, events, threads);
+
+    FILE* pFile = nullptr;
+    if (fopen_s(&pFile, pFileName, "w") != 0 || !pFile)
+    {
+        return false;
+    }
+
+    double microsecondsPerTick = 1000000.0 / GetTicksPerSecond();
+
+    // Timestamps are relative to the first event so they stay readable.
+    long long baseTicks = events.empty() ? 0 : events.front().m_event.m_startTicks;
+    for (const CollectedEvent& kEvent : events)
+    {
+        baseTicks = std::min(baseTicks, kEvent.m_event.m_startTicks);
+    }
+
+    fputs("{\"traceEvents\":[\n", pFile);
+    bool first = true;
+
+    for (const ProfilerThreadBuffer* pThread : threads)
+    {
+        fprintf(pFile, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", first ? "" : ",\n", pThread->m_threadId);
+        WriteJsonString(pFile, pThread->m_name[0] ? pThread->m_name : "Thread");
+        fputs("}}", pFile);
+        first = false;
+    }
+
+    for (const CollectedEvent& kEvent : events)
+    {
+        fprintf(pFile, "%s{\"name\":", first ? "" : ",\n");
+        WriteJsonString(pFile, kEvent.m_event.m_pName);
+        fprintf(pFile, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%llu}}",
+            kEvent.m_threadId, (kEvent.m_event.m_startTicks - baseTicks) * microsecondsPerTick,
+            (kEvent.m_event.m_endTicks - kEvent.m_event.m_startTicks) * microsecondsPerTick, kEvent.m_event.m_frameIndex);
+        first = false;
+    }
+
+    // Mark where each frame began, as far back as the history goes.
+    unsigned long long currentFrame = GetFrameIndex();
+    for (unsigned long long frame = firstFrame; frame <= lastFrame && frame <= currentFrame; ++frame)
+    {
+        if (frame + kFrameHistory <= currentFrame || events.empty())
+        {
+            continue;
+        }
+
+        long long startTicks = s_frameStartTicks[frame % kFrameHistory].load(std::memory_order_relaxed);
+        if (startTicks < baseTicks)
+        {
+            continue;
+        }
+
+        fprintf(pFile, "%s{\"name\":\"Frame %llu\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,\"ts\":%.3f}",
+            first ? "" : ",\n", frame, (startTicks - baseTicks) * microsecondsPerTick);
+        first = false;
+    }
+
+    fputs("\n]}\n", pFile);
+    fclose(pFile);
+
+    return true;
+}
+
+void Profiler::Shutdown()
+{
+    std::lock_guard<std::mutex> lock(s_threadMutex);
+
+    s_threadBuffers.clear();
+    s_pThreadBuffer = nullptr;
+}
+
+ProfilerThreadBuffer* Profiler::RegisterThread()
+{
+    std::unique_ptr<ProfilerThreadBuffer> pBuffer = std::make_unique<ProfilerThreadBuffer>();
+    pBuffer->m_eventCount.store(0, std::memory_order_relaxed);
+    pBuffer->m_depth = 0;
+    pBuffer->m_name[0] = '\0';
+
+    std::lock_guard<std::mutex> lock(s_threadMutex);
+
+    pBuffer->m_threadId = static_cast<unsigned int>(s_threadBuffers.size()) + 1;
+    s_threadBuffers.push_back(std::move(pBuffer));
+
+    return s_threadBuffers.back().get();
+}
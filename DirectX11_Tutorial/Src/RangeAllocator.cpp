@@ -0,0 +1,136 @@
+//////////////////////////////////////////////////////////////////////
+// Filename: RangeAllocator.cpp
+//////////////////////////////////////////////////////////////////////
+#include <iterator>
+
+#include "System/RangeAllocator.h"
+
+RangeAllocator::RangeAllocator()
+    : m_capacity(0)
+    , m_freeCount(0)
+{
+}
+
+void RangeAllocator::Initialize(uint32_t capacity)
+{
+    m_capacity = capacity;
+    Reset(0);
+}
+
+//-----------------------------------------------------------------
+// Best fit keeps the large ranges whole for the large meshes, the
+// rest of the chosen range goes back on the free list.
+//-----------------------------------------------------------------
+bool RangeAllocator::Allocate(uint32_t count, uint32_t& offset)
+{
+    if (count == 0)
+    {
+        return false;
+    }
+
+    std::multimap<uint32_t, uint32_t>::iterator bySize = m_freeBySize.lower_bound(count);
+    if (bySize == m_freeBySize.end())
+    {
+        return false;
+    }
+
+    uint32_t rangeOffset = bySize->second;
+    uint32_t rangeSize = bySize->first;
+    RemoveFreeRange(m_freeByOffset.find(rangeOffset));
+
+    if (rangeSize > count)
+    {
+        AddFreeRange(rangeOffset + count, rangeSize - count);
+    }
+
+    m_freeCount -= count;
+    offset = rangeOffset;
+
+    return true;
+}
+
+void RangeAllocator::Free(uint32_t offset, uint32_t count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    m_freeCount += count;
+
+    // Merge with the free range that ends where this one starts.
+    std::map<uint32_t, uint32_t>::iterator next = m_freeByOffset.lower_bound(offset);
+    if (next != m_freeByOffset.begin())
+    {
+        std::map<uint32_t, uint32_t>::iterator previous = std::prev(next);
+        if (previous->first + previous->second == offset)
+        {
+            offset = previous->first;
+            count += previous->second;
+            RemoveFreeRange(previous);
+        }
+    }
+
+    // And with the one that starts where it ends.
+    if (next != m_freeByOffset.end() && offset + count == next->first)
+    {
+        count += next->second;
+        RemoveFreeRange(next);
+    }
+
+    AddFreeRange(offset, count);
+}
+
+void RangeAllocator::Reset(uint32_t usedCount)
+{
+    m_freeByOffset.clear();
+    m_freeBySize.clear();
+
+    m_freeCount = (usedCount < m_capacity) ? m_capacity - usedCount : 0;
+    if (m_freeCount > 0)
+    {
+        AddFreeRange(usedCount, m_freeCount);
+    }
+}
+
+uint32_t RangeAllocator::GetCapacity() const
+{
+    return m_capacity;
+}
+
+uint32_t RangeAllocator::GetFreeCount() const
+{
+    return m_freeCount;
+}
+
+uint32_t RangeAllocator::GetFreeRangeCount() const
+{
+    return static_cast<uint32_t>(m_freeByOffset.size());
+}
+
+uint32_t RangeAllocator::GetLargestFreeRange() const
+{
+    return m_freeBySize.empty() ? 0 : m_freeBySize.rbegin()->first;
+}
+
+void RangeAllocator::AddFreeRange(uint32_t offset, uint32_t count)
+{
+    m_freeByOffset.emplace(offset, count);
+    m_freeBySize.emplace(count, offset);
+}
+
+void RangeAllocator::RemoveFreeRange(std::map<uint32_t, uint32_t>::iterator byOffset)
+{
+    // Ranges of the same size are told apart by their offset.
+    std::pair<std::multimap<uint32_t, uint32_t>::iterator, std::multimap<uint32_t, uint32_t>::iterator> sameSize = m_freeBySize.equal_range(byOffset->second);
+    for (std::multimap<uint32_t, uint32_t>::iterator it = sameSize.first; it != sameSize.second; ++it)
+    {
+        if (it->second == byOffset->first)
+        {
+            m_freeBySize.erase(it);
+            break;
+        }
+    }
+
+    m_freeByOffset.erase(byOffset);
+}
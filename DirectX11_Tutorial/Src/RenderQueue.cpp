@@ -0,0 +1,244 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: RenderQueue.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "Graphics/RenderQueue.h"
+#include "System/Profiler.h"
+
+namespace
+{
+    // Fewer entries than this per chunk and the chunks cost more than they save.
+    constexpr unsigned int kMinEntriesPerChunk = 8192;
+
+    constexpr uint64_t FieldMask(unsigned int bits)
+    {
+        return (uint64_t(1) << bits) - 1;
+    }
+}
+
+RenderQueue::RenderQueue()
+    : m_stats()
+{
+}
+
+uint64_t RenderQueue::MakeOpaqueKey(uint32_t shader, uint32_t state, uint32_t mesh, float depth)
+{
+    uint64_t key = static_cast<uint64_t>(RenderPass::Opaque);
+    key = (key << kShaderBits) | (shader & FieldMask(kShaderBits));
+    key = (key << kStateBits) | (state & FieldMask(kStateBits));
+    key = (key << kMeshBits) | (mesh & FieldMask(kMeshBits));
+    key = (key << kDepthBits) | QuantizeDepth(depth);
+    return key;
+}
+
+// Blending needs back to front, so depth comes before everything but the pass and counts down.
+uint64_t RenderQueue::MakeTransparentKey(uint32_t shader, uint32_t state, uint32_t mesh, float depth)
+{
+    uint64_t key = static_cast<uint64_t>(RenderPass::Transparent);
+    key = (key << kDepthBits) | (FieldMask(kDepthBits) - QuantizeDepth(depth));
+    key = (key << kShaderBits) | (shader & FieldMask(kShaderBits));
+    key = (key << kStateBits) | (state & FieldMask(kStateBits));
+    key = (key << kMeshBits) | (mesh & FieldMask(kMeshBits));
+    return key;
+}
+
+void RenderQueue::Reserve(unsigned int count)
+{
+    m_entries.reserve(count);
+    m_scratch.reserve(count);
+}
+
+void RenderQueue::Clear()
+{
+    m_entries.clear();
+}
+
+void RenderQueue::Push(uint64_t key, uint32_t packet)
+{
+    m_entries.push_back({ key, packet, 0 });
+}
+
+void RenderQueue::Sort(JobSystem* pJobSystem)
+{
+    PROFILE_SCOPE("RenderQueue::Sort");
+
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+    unsigned int count = GetCount();
+    unsigned int chunkCount = 1;
+    if (pJobSystem && count >= kParallelSortMinimum)
+    {
+        chunkCount = std::min(pJobSystem->GetWorkerCount() + 1, count / kMinEntriesPerChunk);
+        chunkCount = std::max(1u, chunkCount);
+    }
+
+    m_stats.m_entries = count;
+    m_stats.m_radixPasses = 0;
+    m_stats.m_chunks = chunkCount;
+
+    if (count > 1)
+    {
+        RadixSort(pJobSystem, chunkCount);
+    }
+
+    m_stats.m_sortSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+const RenderQueueEntry* RenderQueue::GetEntries() const
+{
+    return m_entries.data();
+}
+
+unsigned int RenderQueue::GetCount() const
+{
+    return static_cast<unsigned int>(m_entries.size());
+}
+
+const RenderQueueStats& RenderQueue::GetStats() const
+{
+    return m_stats;
+}
+
+uint32_t RenderQueue::QuantizeDepth(float depth)
+{
+    float clamped = std::min(std::max(depth, 0.0f), 1.0f);
+    return static_cast<uint32_t>(clamped * static_cast<float>(FieldMask(kDepthBits)));
+}
+
+//-----------------------------------------------------------------
+// One read counts all eight digits of every chunk. A digit whose
+// keys all land in one bucket wouldn't move anything and is skipped.
+// The other digits each take a scatter from one buffer into the
+// other, in chunk order so the sort stays stable.
+//
+// With one chunk the counts don't depend on the order of the keys,
+// so the first read is all the counting there is. With several the
+// chunks' counts change after every scatter and are redone before
+// the next one.
+//-----------------------------------------------------------------
+void RenderQueue::RadixSort(JobSystem* pJobSystem, unsigned int chunkCount)
+{
+    unsigned int count = GetCount();
+    m_scratch.resize(count);
+    m_histograms.assign(static_cast<size_t>(chunkCount) * kDigitCount * kBucketCount, 0);
+
+    auto chunkBegin = [count, chunkCount](unsigned int chunk)
+    {
+        return static_cast<unsigned int>(static_cast<uint64_t>(count) * chunk / chunkCount);
+    };
+
+    auto histogram = [this](unsigned int chunk, unsigned int digit)
+    {
+        return &m_histograms[(static_cast<size_t>(chunk) * kDigitCount + digit) * kBucketCount];
+    };
+
+    // Calls function(chunk) for every chunk, spread over the job system when there is more than one.
+    auto forEachChunk = [pJobSystem, chunkCount](const auto& kFunction)
+    {
+        if (chunkCount == 1)
+        {
+            kFunction(0u);
+            return;
+        }
+
+        pJobSystem->ParallelFor(chunkCount, 1, [&kFunction](unsigned int begin, unsigned int end)
+        {
+            for (unsigned int chunk = begin; chunk < end; ++chunk)
+            {
+                kFunction(chunk);
+            }
+        });
+    };
+
+    forEachChunk([&](unsigned int chunk)
+    {
+        const RenderQueueEntry* pEntries = m_entries.data();
+        uint32_t* pCounts = histogram(chunk, 0);
+        for (unsigned int i = chunkBegin(chunk), end = chunkBegin(chunk + 1); i < end; ++i)
+        {
+            uint64_t key = pEntries[i].m_key;
+            for (unsigned int digit = 0; digit < kDigitCount; ++digit)
+            {
+                ++pCounts[digit * kBucketCount + ((key >> (digit * kDigitBits)) & (kBucketCount - 1))];
+            }
+        }
+    });
+
+    bool countsCurrent = true;
+
+    for (unsigned int digit = 0; digit < kDigitCount; ++digit)
+    {
+        // Skip the digit when one bucket holds every key.
+        bool trivial = false;
+        for (unsigned int bucket = 0; bucket < kBucketCount; ++bucket)
+        {
+            unsigned int total = 0;
+            for (unsigned int chunk = 0; chunk < chunkCount; ++chunk)
+            {
+                total += histogram(chunk, digit)[bucket];
+            }
+
+            if (total != 0)
+            {
+                trivial = (total == count);
+                break;
+            }
+        }
+
+        if (trivial)
+        {
+            continue;
+        }
+
+        unsigned int shift = digit * kDigitBits;
+
+        if (!countsCurrent)
+        {
+            forEachChunk([&](unsigned int chunk)
+            {
+                const RenderQueueEntry* pEntries = m_entries.data();
+                uint32_t* pCounts = histogram(chunk, digit);
+                memset(pCounts, 0, sizeof(uint32_t) * kBucketCount);
+                for (unsigned int i = chunkBegin(chunk), end = chunkBegin(chunk + 1); i < end; ++i)
+                {
+                    ++pCounts[(pEntries[i].m_key >> shift) & (kBucketCount - 1)];
+                }
+            });
+        }
+
+        // Turn the counts into write offsets: bucket by bucket, and chunk by chunk within a bucket.
+        uint32_t offset = 0;
+        for (unsigned int bucket = 0; bucket < kBucketCount; ++bucket)
+        {
+            for (unsigned int chunk = 0; chunk < chunkCount; ++chunk)
+            {
+                uint32_t& bucketCount = histogram(chunk, digit)[bucket];
+                uint32_t bucketOffset = offset;
+                offset += bucketCount;
+                bucketCount = bucketOffset;
+            }
+        }
+
+        forEachChunk([&](unsigned int chunk)
+        {
+            const RenderQueueEntry* pSource = m_entries.data();
+            RenderQueueEntry* pDestination = m_scratch.data();
+
+            // A local copy, the writes to the entries could otherwise alias the offsets.
+            uint32_t offsets[kBucketCount];
+            memcpy(offsets, histogram(chunk, digit), sizeof(offsets));
+
+            for (unsigned int i = chunkBegin(chunk), end = chunkBegin(chunk + 1); i < end; ++i)
+            {
+                pDestination[offsets[(pSource[i].m_key >> shift) & (kBucketCount - 1)]++] = pSource[i];
+            }
+        });
+
+        m_entries.swap(m_scratch);
+        ++m_stats.m_radixPasses;
+        countsCurrent = (chunkCount == 1);
+    }
+}
@@ -0,0 +1,71 @@
+//////////////////////////////////////////////////////////////////////
+// Filename: RenderQueueBenchmark.cpp
+//////////////////////////////////////////////////////////////////////
+#include <chrono>
+#include <vector>
+
+#include "Graphics/RenderQueue.h"
+#include "Graphics/RenderQueueBenchmark.h"
+#include "System/SeededRandom.h"
+
+namespace
+{
+    constexpr unsigned int kSortPackets = 100000;
+
+    class RenderQueueSortWorkload : public JobSystemWorkload
+    {
+    public:
+        const char* GetName() const override
+        {
+            return "render_queue_sort";
+        }
+
+        // A busy frame's draws: a few dozen shaders and states, a thousand meshes, any depth.
+        bool Initialize(unsigned int) override
+        {
+            SeededRandom random(12345);
+
+            m_keys.resize(kSortPackets);
+            for (uint64_t& key : m_keys)
+            {
+                uint32_t shader = random.NextBits() % 48;
+                uint32_t state = random.NextBits() % 16;
+                uint32_t mesh = random.NextBits() % 1024;
+                float depth = static_cast<float>(random.NextBits() & 0xffff) / 65535.0f;
+                key = RenderQueue::MakeOpaqueKey(shader, state, mesh, depth);
+            }
+
+            m_renderQueue.Reserve(kSortPackets);
+            return true;
+        }
+
+        void Shutdown() override
+        {
+            m_keys.clear();
+            m_renderQueue.Clear();
+        }
+
+        // Only the sort is timed, refilling the queue is not.
+        double Run(JobSystem& jobSystem) override
+        {
+            m_renderQueue.Clear();
+            for (unsigned int i = 0; i < kSortPackets; ++i)
+            {
+                m_renderQueue.Push(m_keys[i], i);
+            }
+
+            std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+            m_renderQueue.Sort(&jobSystem);
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        }
+
+    private:
+        std::vector<uint64_t> m_keys;
+        RenderQueue m_renderQueue;
+    };
+}
+
+std::unique_ptr<JobSystemWorkload> CreateRenderQueueSortWorkload()
+{
+    return std::make_unique<RenderQueueSortWorkload>();
+}
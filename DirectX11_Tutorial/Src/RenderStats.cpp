@@ -0,0 +1,112 @@
+//////////////////////////////////////////////////////////////////////
+// Filename: RenderStats.cpp
+//////////////////////////////////////////////////////////////////////
+#include "Graphics/RenderStats.h"
+
+std::atomic<uint64_t> RenderStats::s_drawCalls(0);
+std::atomic<uint64_t> RenderStats::s_instances(0);
+std::atomic<uint64_t> RenderStats::s_indices(0);
+std::atomic<uint64_t> RenderStats::s_triangles(0);
+std::atomic<uint64_t> RenderStats::s_stateBinds(0);
+std::atomic<uint64_t> RenderStats::s_issuedStateBinds(0);
+std::atomic<uint64_t> RenderStats::s_constantBufferBytes(0);
+std::atomic<uint64_t> RenderStats::s_constantBufferMaps(0);
+std::atomic<uint64_t> RenderStats::s_geometryBytes(0);
+std::atomic<uint64_t> RenderStats::s_clears(0);
+std::atomic<uint64_t> RenderStats::s_frustumTested(0);
+std::atomic<uint64_t> RenderStats::s_frustumCulled(0);
+std::atomic<uint64_t> RenderStats::s_occlusionTested(0);
+std::atomic<uint64_t> RenderStats::s_occlusionCulled(0);
+
+namespace
+{
+    unsigned long long s_frameIndex = 0;
+    RenderFrameStats s_history[RenderStats::kFrameHistory];
+}
+
+//-----------------------------------------------------------------
+// Moves the counts of the frame that just ended into the history
+// and starts counting the next one from zero.
+//-----------------------------------------------------------------
+void RenderStats::BeginFrame()
+{
+    RenderFrameStats& frame = s_history[s_frameIndex % kFrameHistory];
+    frame.m_frameIndex = s_frameIndex;
+    frame.m_drawCalls = s_drawCalls.exchange(0, std::memory_order_relaxed);
+    frame.m_instances = s_instances.exchange(0, std::memory_order_relaxed);
+    frame.m_indices = s_indices.exchange(0, std::memory_order_relaxed);
+    frame.m_triangles = s_triangles.exchange(0, std::memory_order_relaxed);
+    frame.m_stateBinds = s_stateBinds.exchange(0, std::memory_order_relaxed);
+    frame.m_issuedStateBinds = s_issuedStateBinds.exchange(0, std::memory_order_relaxed);
+    frame.m_constantBufferBytes = s_constantBufferBytes.exchange(0, std::memory_order_relaxed);
+    frame.m_constantBufferMaps = s_constantBufferMaps.exchange(0, std::memory_order_relaxed);
+    frame.m_geometryBytes = s_geometryBytes.exchange(0, std::memory_order_relaxed);
+    frame.m_clears = s_clears.exchange(0, std::memory_order_relaxed);
+    frame.m_frustumTested = s_frustumTested.exchange(0, std::memory_order_relaxed);
+    frame.m_frustumCulled = s_frustumCulled.exchange(0, std::memory_order_relaxed);
+    frame.m_occlusionTested = s_occlusionTested.exchange(0, std::memory_order_relaxed);
+    frame.m_occlusionCulled = s_occlusionCulled.exchange(0, std::memory_order_relaxed);
+
+    ++s_frameIndex;
+}
+
+unsigned long long RenderStats::GetFrameIndex()
+{
+    return s_frameIndex;
+}
+
+bool RenderStats::GetFrameStats(unsigned long long frameIndex, RenderFrameStats& stats)
+{
+    if (frameIndex >= s_frameIndex || frameIndex + kFrameHistory < s_frameIndex)
+    {
+        return false;
+    }
+
+    stats = s_history[frameIndex % kFrameHistory];
+    return true;
+}
+
+bool RenderStats::GetLastFrameStats(RenderFrameStats& stats)
+{
+    return (s_frameIndex > 0) && GetFrameStats(s_frameIndex - 1, stats);
+}
+
+unsigned long long RenderStats::GetSummary(unsigned long long firstFrame, unsigned long long lastFrame, RenderFrameStats& total)
+{
+    total = RenderFrameStats();
+    total.m_frameIndex = firstFrame;
+
+    // Only look at the frames the history still has.
+    if (s_frameIndex > kFrameHistory && firstFrame < s_frameIndex - kFrameHistory)
+    {
+        firstFrame = s_frameIndex - kFrameHistory;
+    }
+
+    unsigned long long frameCount = 0;
+    for (unsigned long long frame = firstFrame; frame <= lastFrame && frame < s_frameIndex; ++frame)
+    {
+        RenderFrameStats stats;
+        if (!GetFrameStats(frame, stats))
+        {
+            continue;
+        }
+
+        total.m_drawCalls += stats.m_drawCalls;
+        total.m_instances += stats.m_instances;
+        total.m_indices += stats.m_indices;
+        total.m_triangles += stats.m_triangles;
+        total.m_stateBinds += stats.m_stateBinds;
+        total.m_issuedStateBinds += stats.m_issuedStateBinds;
+        total.m_constantBufferBytes += stats.m_constantBufferBytes;
+        total.m_constantBufferMaps += stats.m_constantBufferMaps;
+        total.m_geometryBytes += stats.m_geometryBytes;
+        total.m_clears += stats.m_clears;
+        total.m_frustumTested += stats.m_frustumTested;
+        total.m_frustumCulled += stats.m_frustumCulled;
+        total.m_occlusionTested += stats.m_occlusionTested;
+        total.m_occlusionCulled += stats.m_occlusionCulled;
+        ++frameCount;
+    }
+
+    return frameCount;
+}
@@ -0,0 +1,252 @@
+//////////////////////////////////////////////////////////////////////
+// Filename: SceneQueryBenchmark.cpp
+//////////////////////////////////////////////////////////////////////
+#include <windows.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "Graphics/AabbTree.h"
+#include "Graphics/FrustumCuller.h"
+#include "Graphics/SceneQueryBenchmark.h"
+#include "System/SeededRandom.h"
+
+using namespace DirectX;
+
+namespace
+{
+    constexpr unsigned int kSceneSizes[] = { 10000, 100000, 1000000 };
+    // Side of the cube the boxes are scattered in for 1000 of them, it grows with the cube root of the count.
+    constexpr float kSideFor1000 = 200.0f;
+    constexpr unsigned int kRegionQueries = 100;
+    constexpr float kRegionHalfSize = 20.0f;
+    constexpr unsigned int kRayQueries = 100;
+    constexpr float kRayLength = 500.0f;
+    constexpr int kRepeats = 3;
+
+    bool Overlaps(const Aabb& kFirst, const Aabb& kSecond)
+    {
+        return kFirst.m_max.x >= kSecond.m_min.x && kFirst.m_min.x <= kSecond.m_max.x &&
+            kFirst.m_max.y >= kSecond.m_min.y && kFirst.m_min.y <= kSecond.m_max.y &&
+            kFirst.m_max.z >= kSecond.m_min.z && kFirst.m_min.z <= kSecond.m_max.z;
+    }
+
+    // Where the ray enters the box within maxDistance, negative when it doesn't.
+    float RayEntry(const XMFLOAT3& kOrigin, const XMFLOAT3& kInverseDirection, float maxDistance, const Aabb& kAabb)
+    {
+        float x1 = (kAabb.m_min.x - kOrigin.x) * kInverseDirection.x;
+        float x2 = (kAabb.m_max.x - kOrigin.x) * kInverseDirection.x;
+        float y1 = (kAabb.m_min.y - kOrigin.y) * kInverseDirection.y;
+        float y2 = (kAabb.m_max.y - kOrigin.y) * kInverseDirection.y;
+        float z1 = (kAabb.m_min.z - kOrigin.z) * kInverseDirection.z;
+        float z2 = (kAabb.m_max.z - kOrigin.z) * kInverseDirection.z;
+
+        float enter = fmaxf(fmaxf(fminf(x1, x2), fminf(y1, y2)), fmaxf(fminf(z1, z2), 0.0f));
+        float exit = fminf(fminf(fmaxf(x1, x2), fmaxf(y1, y2)), fminf(fmaxf(z1, z2), maxDistance));
+
+        return (enter <= exit) ? enter : -1.0f;
+    }
+
+    template <typename Function>
+    double BestSeconds(const Function& kFunction)
+    {
+        double bestSeconds = 0.0;
+        for (int repeat = 0; repeat < kRepeats; ++repeat)
+        {
+            std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+            kFunction();
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+            bestSeconds = (repeat == 0) ? seconds : std::min(bestSeconds, seconds);
+        }
+        return bestSeconds;
+    }
+
+    void AddResult(std::string& results, const char* pQuery, unsigned int objects, double treeSeconds, double bruteForceSeconds, uint64_t treeHits, uint64_t bruteForceHits)
+    {
+        char line[256];
+        sprintf_s(line, sizeof(line), "%s,%u,%.6f,%.6f,%.2f,%llu,%llu\n",
+            pQuery, objects, treeSeconds, bruteForceSeconds,
+            (treeSeconds > 0.0) ? bruteForceSeconds / treeSeconds : 0.0,
+            static_cast<unsigned long long>(treeHits), static_cast<unsigned long long>(bruteForceHits));
+        results += line;
+    }
+}
+
+bool RunSceneQueryBenchmark(const std::string& resultsFileName)
+{
+    std::string results = "query,objects,tree_seconds,brute_force_seconds,speedup,tree_hits,brute_force_hits\n";
+    // How each tree came out, only printed.
+    std::string treeSummary;
+
+    for (unsigned int objectCount : kSceneSizes)
+    {
+        // The same density whatever the count, so a query sees about as many objects in every scene.
+        float halfSide = 0.5f * kSideFor1000 * std::cbrt(objectCount / 1000.0f);
+        SeededRandom random(objectCount);
+
+        AabbTree tree;
+        tree.Reserve(objectCount);
+        std::vector<AabbProxy> proxies(objectCount);
+
+        std::chrono::steady_clock::time_point buildStartTime = std::chrono::steady_clock::now();
+        for (unsigned int i = 0; i < objectCount; ++i)
+        {
+            XMFLOAT3 center(random.Next(-halfSide, halfSide), random.Next(-halfSide, halfSide), random.Next(-halfSide, halfSide));
+            XMFLOAT3 extents(random.Next(0.5f, 4.0f), random.Next(0.5f, 4.0f), random.Next(0.5f, 4.0f));
+
+            Aabb aabb;
+            aabb.m_min = XMFLOAT3(center.x - extents.x, center.y - extents.y, center.z - extents.z);
+            aabb.m_max = XMFLOAT3(center.x + extents.x, center.y + extents.y, center.z + extents.z);
+            proxies[i] = tree.Insert(aabb, i);
+        }
+        double buildSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - buildStartTime).count();
+
+        // The brute force tests exactly what the tree's leaves hold.
+        std::vector<Aabb> fatAabbs(objectCount);
+        FrustumCuller culler;
+        culler.Reserve(objectCount);
+
+        for (unsigned int i = 0; i < objectCount; ++i)
+        {
+            const Aabb& kFat = fatAabbs[i] = tree.GetFatAabb(proxies[i]);
+            XMFLOAT3 center((kFat.m_min.x + kFat.m_max.x) * 0.5f, (kFat.m_min.y + kFat.m_max.y) * 0.5f, (kFat.m_min.z + kFat.m_max.z) * 0.5f);
+            XMFLOAT3 extents((kFat.m_max.x - kFat.m_min.x) * 0.5f, (kFat.m_max.y - kFat.m_min.y) * 0.5f, (kFat.m_max.z - kFat.m_min.z) * 0.5f);
+            culler.Add(center, extents);
+        }
+
+        // Frustum, from the center of the scene looking across it.
+        XMMATRIX view = XMMatrixRotationRollPitchYaw(0.3f, 0.7f, 0.0f);
+        XMMATRIX projection = XMMatrixPerspectiveFovLH(XM_PIDIV4, 16.0f / 9.0f, 0.1f, 300.0f);
+        Frustum frustum = FrustumCuller::ExtractFrustum(XMMatrixMultiply(view, projection));
+
+        uint64_t treeHits = 0;
+        std::vector<uint32_t> visible;
+        visible.reserve(objectCount);
+        double treeSeconds = BestSeconds([&]()
+        {
+            visible.clear();
+            tree.QueryFrustum(frustum, [&visible](AabbProxy proxy)
+            {
+                visible.push_back(proxy);
+                return true;
+            });
+        });
+        treeHits = visible.size();
+
+        double bruteForceSeconds = BestSeconds([&]()
+        {
+            culler.Cull(frustum, nullptr, visible);
+        });
+        AddResult(results, "frustum", objectCount, treeSeconds, bruteForceSeconds, treeHits, visible.size());
+
+        // Regions and rays, spread over the scene.
+        std::vector<Aabb> regions(kRegionQueries);
+        for (Aabb& region : regions)
+        {
+            XMFLOAT3 center(random.Next(-halfSide, halfSide), random.Next(-halfSide, halfSide), random.Next(-halfSide, halfSide));
+            region.m_min = XMFLOAT3(center.x - kRegionHalfSize, center.y - kRegionHalfSize, center.z - kRegionHalfSize);
+            region.m_max = XMFLOAT3(center.x + kRegionHalfSize, center.y + kRegionHalfSize, center.z + kRegionHalfSize);
+        }
+
+        treeHits = 0;
+        treeSeconds = BestSeconds([&]()
+        {
+            treeHits = 0;
+            for (const Aabb& kRegion : regions)
+            {
+                tree.QueryRegion(kRegion, [&treeHits](AabbProxy)
+                {
+                    ++treeHits;
+                    return true;
+                });
+            }
+        });
+
+        uint64_t bruteForceHits = 0;
+        bruteForceSeconds = BestSeconds([&]()
+        {
+            bruteForceHits = 0;
+            for (const Aabb& kRegion : regions)
+            {
+                for (const Aabb& kFat : fatAabbs)
+                {
+                    bruteForceHits += Overlaps(kRegion, kFat) ? 1 : 0;
+                }
+            }
+        });
+        AddResult(results, "region", objectCount, treeSeconds, bruteForceSeconds, treeHits, bruteForceHits);
+
+        std::vector<XMFLOAT3> rayOrigins(kRayQueries);
+        std::vector<XMFLOAT3> rayDirections(kRayQueries);
+        for (unsigned int i = 0; i < kRayQueries; ++i)
+        {
+            rayOrigins[i] = XMFLOAT3(random.Next(-halfSide, halfSide), random.Next(-halfSide, halfSide), random.Next(-halfSide, halfSide));
+            XMVECTOR direction = XMVector3Normalize(XMVectorSet(random.Next(-1.0f, 1.0f), random.Next(-1.0f, 1.0f), random.Next(-1.0f, 1.0f), 0.0f));
+            XMStoreFloat3(&rayDirections[i], direction);
+        }
+
+        // Hits are the rays that found something.
+        treeSeconds = BestSeconds([&]()
+        {
+            treeHits = 0;
+            for (unsigned int i = 0; i < kRayQueries; ++i)
+            {
+                float nearest = kRayLength;
+                bool hit = false;
+                tree.QueryRay(rayOrigins[i], rayDirections[i], kRayLength, [&nearest, &hit](AabbProxy, float distance)
+                {
+                    hit = true;
+                    nearest = std::min(nearest, distance);
+                    return nearest;
+                });
+                treeHits += hit ? 1 : 0;
+            }
+        });
+
+        bruteForceSeconds = BestSeconds([&]()
+        {
+            bruteForceHits = 0;
+            for (unsigned int i = 0; i < kRayQueries; ++i)
+            {
+                XMFLOAT3 inverseDirection(1.0f / rayDirections[i].x, 1.0f / rayDirections[i].y, 1.0f / rayDirections[i].z);
+                float nearest = kRayLength;
+                bool hit = false;
+                for (const Aabb& kFat : fatAabbs)
+                {
+                    float distance = RayEntry(rayOrigins[i], inverseDirection, nearest, kFat);
+                    if (distance >= 0.0f)
+                    {
+                        hit = true;
+                        nearest = distance;
+                    }
+                }
+                bruteForceHits += hit ? 1 : 0;
+            }
+        });
+        AddResult(results, "ray", objectCount, treeSeconds, bruteForceSeconds, treeHits, bruteForceHits);
+
+        char line[256];
+        sprintf_s(line, sizeof(line), "%u objects: built in %.6f s, height %d, area ratio %.1f\n",
+            objectCount, buildSeconds, tree.GetHeight(), tree.GetAreaRatio());
+        treeSummary += line;
+    }
+
+    fputs(results.c_str(), stdout);
+    fputs(treeSummary.c_str(), stdout);
+    OutputDebugStringA(results.c_str());
+    OutputDebugStringA(treeSummary.c_str());
+
+    FILE* pFile = nullptr;
+    if (fopen_s(&pFile, resultsFileName.c_str(), "w") != 0 || !pFile)
+    {
+        return false;
+    }
+
+    fputs(results.c_str(), pFile);
+    fclose(pFile);
+
+    return true;
+}
@@ -0,0 +1,145 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: ShaderConstants.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include <d3dcompiler.h>
+#include <d3d11shader.h>
+#include <cstdio>
+#include <cstring>
+
+#include "Graphics/ShaderConstants.h"
+
+namespace
+{
+    void ReportMismatch(const char* pBufferName, const char* pWhat)
+    {
+        char line[256];
+        sprintf_s(line, sizeof(line), "shader constants: cbuffer %s doesn't match ShaderConstants.h: %s\n", pBufferName, pWhat);
+        OutputDebugStringA(line);
+    }
+
+    //-----------------------------------------------------------------
+    // The reflection lists every variable of a cbuffer the shader uses,
+    // even the ones it doesn't read, so a variable added on only one
+    // side is caught too.
+    //-----------------------------------------------------------------
+    bool CheckLayout(ID3D11ShaderReflection* pReflection, const ConstantBufferLayout& kLayout)
+    {
+        D3D11_SHADER_BUFFER_DESC bufferDesc;
+        D3D11_SHADER_INPUT_BIND_DESC bindDesc;
+
+        // An unknown name gets a stand-in whose GetDesc() fails.
+        ID3D11ShaderReflectionConstantBuffer* pBuffer = pReflection->GetConstantBufferByName(kLayout.m_pName);
+        if (FAILED(pBuffer->GetDesc(&bufferDesc)))
+        {
+            ReportMismatch(kLayout.m_pName, "the shader doesn't use it");
+            return false;
+        }
+
+        bool matches = true;
+
+        if (FAILED(pReflection->GetResourceBindingDescByName(kLayout.m_pName, &bindDesc)) || bindDesc.BindPoint != kLayout.m_slot)
+        {
+            ReportMismatch(kLayout.m_pName, "register");
+            matches = false;
+        }
+
+        if (bufferDesc.Size != kLayout.m_size)
+        {
+            ReportMismatch(kLayout.m_pName, "size");
+            matches = false;
+        }
+
+        if (bufferDesc.Variables != kLayout.m_fieldCount)
+        {
+            ReportMismatch(kLayout.m_pName, "variable count");
+            matches = false;
+        }
+
+        for (UINT i = 0; i < bufferDesc.Variables; ++i)
+        {
+            D3D11_SHADER_VARIABLE_DESC variableDesc;
+            if (FAILED(pBuffer->GetVariableByIndex(i)->GetDesc(&variableDesc)))
+            {
+                matches = false;
+                continue;
+            }
+
+            const ConstantField* pField = nullptr;
+            for (UINT field = 0; field < kLayout.m_fieldCount; ++field)
+            {
+                if (strcmp(kLayout.m_pFields[field].m_pName, variableDesc.Name) == 0)
+                {
+                    pField = &kLayout.m_pFields[field];
+                    break;
+                }
+            }
+
+            if (!pField || pField->m_offset != variableDesc.StartOffset || pField->m_size != variableDesc.Size)
+            {
+                ReportMismatch(kLayout.m_pName, variableDesc.Name);
+                matches = false;
+            }
+        }
+
+        return matches;
+    }
+}
+
+//-----------------------------------------------------------------
+// Every listed layout is checked, then every cbuffer of the shader
+// has to be one of them: nothing would bind any other.
+//-----------------------------------------------------------------
+bool CheckConstantBufferLayouts(const void* pBytecode, SIZE_T bytecodeLength, const ConstantBufferLayout* const* ppLayouts, UINT layoutCount)
+{
+    HRESULT result;
+    ID3D11ShaderReflection* pReflection = nullptr;
+    D3D11_SHADER_DESC shaderDesc;
+
+    result = D3DReflect(pBytecode, bytecodeLength, __uuidof(ID3D11ShaderReflection), reinterpret_cast<void**>(&pReflection));
+    if (FAILED(result))
+    {
+        OutputDebugStringA("shader constants: the shader can't be reflected\n");
+        return false;
+    }
+
+    bool matches = true;
+
+    for (UINT i = 0; i < layoutCount; ++i)
+    {
+        if (!CheckLayout(pReflection, *ppLayouts[i]))
+        {
+            matches = false;
+        }
+    }
+
+    if (FAILED(pReflection->GetDesc(&shaderDesc)))
+    {
+        shaderDesc.ConstantBuffers = 0;
+        matches = false;
+    }
+
+    for (UINT i = 0; i < shaderDesc.ConstantBuffers; ++i)
+    {
+        D3D11_SHADER_BUFFER_DESC bufferDesc;
+        if (FAILED(pReflection->GetConstantBufferByIndex(i)->GetDesc(&bufferDesc)) || bufferDesc.Type != D3D_CT_CBUFFER)
+        {
+            continue;
+        }
+
+        bool listed = false;
+        for (UINT layout = 0; layout < layoutCount && !listed; ++layout)
+        {
+            listed = strcmp(ppLayouts[layout]->m_pName, bufferDesc.Name) == 0;
+        }
+
+        if (!listed)
+        {
+            ReportMismatch(bufferDesc.Name, "the shader uses it, but it isn't bound for this shader");
+            matches = false;
+        }
+    }
+
+    pReflection->Release();
+
+    return matches;
+}
@@ -0,0 +1,41 @@
+#include "ShaderConstants.hlsli"
+
+struct VertexInput
+{
+	float4 position : POSITION;
+	float4 color : COLOR;
+
+	// Per instance data, see ModelInstance. The world matrix comes in as its four rows
+	// and the tint is multiplied with the vertex color.
+	float4 world0 : WORLD0;
+	float4 world1 : WORLD1;
+	float4 world2 : WORLD2;
+	float4 world3 : WORLD3;
+	float4 tint : TINT;
+};
+
+struct PixelInput
+{
+	float4 position : SV_POSITION;
+	float4 color : COLOR;
+};
+
+PixelInput ColorInstancedVertexShader(VertexInput input)
+{
+	PixelInput output;
+
+	// Change the position vector to be 4 units for proper matrix calculations.
+	input.position.w = 1.0f;
+
+	// Build the world matrix of this instance from its rows, it doesn't come from a constant buffer.
+	float4x4 instanceWorldMatrix = float4x4(input.world0, input.world1, input.world2, input.world3);
+
+	// Calculate the position of the vertex against the instance's world matrix and the combined view and projection matrices.
+	output.position = mul(input.position, instanceWorldMatrix);
+	output.position = mul(output.position, viewProjectionMatrix);
+
+	// Tint the input color for the pixel shader to use.
+	output.color = input.color * input.tint;
+
+	return output;
+}
@@ -1,9 +1,4 @@
-cbuffer MatrixBuffer
-{
-	matrix worldMatrix;
-	matrix viewMatrix;
-	matrix projectionMatrix;
-};
+#include "ShaderConstants.hlsli"
 
 struct VertexInput
 {
@@ -24,10 +19,9 @@ PixelInput ColorVertexShader(VertexInput input)
 	// Change the position vector to be 4 units for proper matrix calculations.
 	input.position.w = 1.0f;
 
-	// Calculate the position of the vertex against the world, view, and projection matrices.
+	// Calculate the position of the vertex against the world matrix and the combined view and projection matrices.
 	output.position = mul(input.position, worldMatrix);
-	output.position = mul(output.position, viewMatrix);
-	output.position = mul(output.position, projectionMatrix);
+	output.position = mul(output.position, viewProjectionMatrix);
 
 	// Store the input color for the pixel shader to use.
 	output.color = input.color;
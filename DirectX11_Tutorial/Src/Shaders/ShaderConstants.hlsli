@@ -0,0 +1,16 @@
+// The constant buffers every shader shares, split by how often they change.
+// The C++ side is Include/Graphics/ShaderConstants.h, ColorShader checks the
+// compiled layouts against it. Matrices are uploaded transposed.
+// b0 is kept for per frame constants, no shader needs any yet.
+
+cbuffer ViewConstants : register(b1)
+{
+	matrix viewMatrix;
+	matrix projectionMatrix;
+	matrix viewProjectionMatrix;
+};
+
+cbuffer ObjectConstants : register(b2)
+{
+	matrix worldMatrix;
+};
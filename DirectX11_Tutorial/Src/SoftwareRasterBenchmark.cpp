@@ -0,0 +1,245 @@
+//////////////////////////////////////////////////////////////////////
+// Filename: SoftwareRasterBenchmark.cpp
+//////////////////////////////////////////////////////////////////////
+#include <windows.h>
+#include <chrono>
+#include <vector>
+
+#include "Graphics/ShaderConstants.h"
+#include "Graphics/SoftwareRasterBenchmark.h"
+#include "Graphics/SoftwareRenderContext.h"
+#include "Graphics/SoftwareRenderDevice.h"
+#include "System/SeededRandom.h"
+
+using namespace DirectX;
+
+namespace
+{
+    // The resolution the software rasterizer is expected to scale on.
+    constexpr int kRasterWidth = 800;
+    constexpr int kRasterHeight = 600;
+    constexpr unsigned int kRasterColumns = 160;
+    constexpr unsigned int kRasterRows = 120;
+    constexpr unsigned int kRasterLayers = 4;
+
+    struct RasterVertex
+    {
+        XMFLOAT3 m_position;
+        XMFLOAT4 m_color;
+    };
+
+    // What the software_raster workload draws with, created through a SoftwareRenderDevice.
+    struct RasterScene
+    {
+        ID3D11Buffer* m_pVertexBuffer = nullptr;
+        ID3D11Buffer* m_pIndexBuffer = nullptr;
+        ID3D11Buffer* m_pViewConstants = nullptr;
+        ID3D11Buffer* m_pObjectConstants = nullptr;
+        ID3D11InputLayout* m_pInputLayout = nullptr;
+        ID3D11VertexShader* m_pVertexShader = nullptr;
+        ID3D11PixelShader* m_pPixelShader = nullptr;
+        UINT m_indexCount = 0;
+    };
+
+    void ReleaseRasterScene(RasterScene& scene)
+    {
+        IUnknown* pObjects[] = { scene.m_pVertexBuffer, scene.m_pIndexBuffer, scene.m_pViewConstants, scene.m_pObjectConstants, scene.m_pInputLayout, scene.m_pVertexShader, scene.m_pPixelShader };
+        for (IUnknown* pObject : pObjects)
+        {
+            if (pObject)
+            {
+                pObject->Release();
+            }
+        }
+
+        scene = RasterScene();
+    }
+
+    //-----------------------------------------------------------------
+    // Layers of small quads over the whole target, straight in clip
+    // space with identity matrices. The layers are drawn in a mixed
+    // depth order, so some of them pass the depth test everywhere and
+    // some fail it. A fixed seed so every thread count draws the same.
+    //-----------------------------------------------------------------
+    bool CreateRasterScene(RenderDevice& device, RasterScene& scene)
+    {
+        static const float kLayerDepths[kRasterLayers] = { 0.6f, 0.2f, 0.8f, 0.4f };
+
+        SeededRandom random(13579);
+
+        std::vector<RasterVertex> vertices;
+        std::vector<uint32_t> indices;
+        vertices.reserve(kRasterLayers * (kRasterColumns + 1) * (kRasterRows + 1));
+        indices.reserve(kRasterLayers * kRasterColumns * kRasterRows * 6);
+
+        for (unsigned int layer = 0; layer < kRasterLayers; ++layer)
+        {
+            uint32_t firstVertex = static_cast<uint32_t>(vertices.size());
+
+            for (unsigned int row = 0; row <= kRasterRows; ++row)
+            {
+                for (unsigned int column = 0; column <= kRasterColumns; ++column)
+                {
+                    RasterVertex vertex;
+                    vertex.m_position = XMFLOAT3(static_cast<float>(column) / kRasterColumns * 2.0f - 1.0f, 1.0f - static_cast<float>(row) / kRasterRows * 2.0f,
+                        kLayerDepths[layer] + (random.Next() - 0.5f) * 0.1f);
+                    vertex.m_color = XMFLOAT4(random.Next(), random.Next(), random.Next(), 1.0f);
+                    vertices.push_back(vertex);
+                }
+            }
+
+            // Top left, top right, bottom right and top left, bottom right, bottom left: clockwise on screen.
+            for (unsigned int row = 0; row < kRasterRows; ++row)
+            {
+                for (unsigned int column = 0; column < kRasterColumns; ++column)
+                {
+                    uint32_t topLeft = firstVertex + row * (kRasterColumns + 1) + column;
+                    uint32_t bottomLeft = topLeft + kRasterColumns + 1;
+                    uint32_t quad[6] = { topLeft, topLeft + 1, bottomLeft + 1, topLeft, bottomLeft + 1, bottomLeft };
+                    indices.insert(indices.end(), quad, quad + 6);
+                }
+            }
+        }
+
+        ViewConstants viewConstants;
+        ObjectConstants objectConstants;
+        XMStoreFloat4x4(&viewConstants.m_view, XMMatrixIdentity());
+        XMStoreFloat4x4(&viewConstants.m_projection, XMMatrixIdentity());
+        XMStoreFloat4x4(&viewConstants.m_viewProjection, XMMatrixIdentity());
+        XMStoreFloat4x4(&objectConstants.m_world, XMMatrixIdentity());
+
+        D3D11_BUFFER_DESC bufferDesc;
+        D3D11_SUBRESOURCE_DATA data;
+        ZeroMemory(&bufferDesc, sizeof(bufferDesc));
+        ZeroMemory(&data, sizeof(data));
+        bufferDesc.Usage = D3D11_USAGE_DEFAULT;
+
+        bufferDesc.ByteWidth = static_cast<UINT>(vertices.size() * sizeof(RasterVertex));
+        bufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+        data.pSysMem = vertices.data();
+        if (FAILED(device.CreateBuffer(&bufferDesc, &data, &scene.m_pVertexBuffer)))
+        {
+            return false;
+        }
+
+        bufferDesc.ByteWidth = static_cast<UINT>(indices.size() * sizeof(uint32_t));
+        bufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+        data.pSysMem = indices.data();
+        if (FAILED(device.CreateBuffer(&bufferDesc, &data, &scene.m_pIndexBuffer)))
+        {
+            return false;
+        }
+
+        bufferDesc.ByteWidth = sizeof(ViewConstants);
+        bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+        data.pSysMem = &viewConstants;
+        if (FAILED(device.CreateBuffer(&bufferDesc, &data, &scene.m_pViewConstants)))
+        {
+            return false;
+        }
+
+        bufferDesc.ByteWidth = sizeof(ObjectConstants);
+        data.pSysMem = &objectConstants;
+        if (FAILED(device.CreateBuffer(&bufferDesc, &data, &scene.m_pObjectConstants)))
+        {
+            return false;
+        }
+
+        // The software device looks shaders up by entry point name.
+        const char kVertexShaderEntry[] = "ColorVertexShader";
+        const char kPixelShaderEntry[] = "ColorPixelShader";
+        if (FAILED(device.CreateVertexShader(kVertexShaderEntry, sizeof(kVertexShaderEntry) - 1, nullptr, &scene.m_pVertexShader)) ||
+            FAILED(device.CreatePixelShader(kPixelShaderEntry, sizeof(kPixelShaderEntry) - 1, nullptr, &scene.m_pPixelShader)))
+        {
+            return false;
+        }
+
+        const D3D11_INPUT_ELEMENT_DESC kLayout[2] =
+        {
+            { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+            { "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+        };
+        if (FAILED(device.CreateInputLayout(kLayout, 2, kVertexShaderEntry, sizeof(kVertexShaderEntry) - 1, &scene.m_pInputLayout)))
+        {
+            return false;
+        }
+
+        scene.m_indexCount = static_cast<UINT>(indices.size());
+
+        return true;
+    }
+
+    class SoftwareRasterWorkload : public JobSystemWorkload
+    {
+    public:
+        explicit SoftwareRasterWorkload()
+            : m_device(RenderBackend::Software)
+        {
+        }
+
+        const char* GetName() const override
+        {
+            return "software_raster";
+        }
+
+        bool Initialize(unsigned int) override
+        {
+            if (!CreateRasterScene(m_device, m_scene))
+            {
+                ReleaseRasterScene(m_scene);
+                return false;
+            }
+
+            return true;
+        }
+
+        void Shutdown() override
+        {
+            ReleaseRasterScene(m_scene);
+        }
+
+        //-----------------------------------------------------------------
+        // The context rasterizes on the job system it was made with, so
+        // every run makes its own. The draw runs the vertex stage and bins
+        // on the calling thread. Only the Flush() that rasterizes the
+        // tiles is timed.
+        //-----------------------------------------------------------------
+        double Run(JobSystem& jobSystem) override
+        {
+            SoftwareRenderContext context(kRasterWidth, kRasterHeight, &jobSystem);
+
+            const FLOAT kClearColor[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+            UINT stride = sizeof(RasterVertex);
+            UINT offset = 0;
+
+            context.ClearRenderTargetView(nullptr, kClearColor);
+            context.ClearDepthStencilView(nullptr, D3D11_CLEAR_DEPTH, 1.0f, 0);
+
+            ID3D11Buffer* pVertexBuffer = m_scene.m_pVertexBuffer;
+            ID3D11Buffer* pViewConstants = m_scene.m_pViewConstants;
+            ID3D11Buffer* pObjectConstants = m_scene.m_pObjectConstants;
+            context.IASetInputLayout(m_scene.m_pInputLayout);
+            context.IASetVertexBuffers(0, 1, &pVertexBuffer, &stride, &offset);
+            context.IASetIndexBuffer(m_scene.m_pIndexBuffer, DXGI_FORMAT_R32_UINT, 0);
+            context.IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+            context.VSSetShader(m_scene.m_pVertexShader, nullptr, 0);
+            context.PSSetShader(m_scene.m_pPixelShader, nullptr, 0);
+            context.VSSetConstantBuffers(VIEW_CONSTANTS_SLOT, 1, &pViewConstants);
+            context.VSSetConstantBuffers(OBJECT_CONSTANTS_SLOT, 1, &pObjectConstants);
+            context.DrawIndexed(m_scene.m_indexCount, 0, 0);
+
+            std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+            context.Flush();
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        }
+
+    private:
+        SoftwareRenderDevice m_device;
+        RasterScene m_scene;
+    };
+}
+
+std::unique_ptr<JobSystemWorkload> CreateSoftwareRasterWorkload()
+{
+    return std::make_unique<SoftwareRasterWorkload>();
+}
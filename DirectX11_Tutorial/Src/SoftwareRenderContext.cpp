@@ -0,0 +1,812 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: SoftwareRenderContext.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#include "Graphics/SoftwareRenderContext.h"
+#include "System/Profiler.h"
+
+using namespace DirectX;
+
+namespace
+{
+    // Vertices closer to the eye plane than this are treated as behind it.
+    constexpr float kMinW = 1.0e-5f;
+
+    // Indices above this are transformed every time they are referenced.
+    constexpr size_t kMaxCachedVertices = 65536;
+
+    constexpr uint32_t kMaxDepth = 0xFFFFFF;
+
+    // DXGI_FORMAT_D24_UNORM_S8_UINT depth, kept in the low 24 bits.
+    uint32_t QuantizeDepth(float depth)
+    {
+        depth = std::min(std::max(depth, 0.0f), 1.0f);
+        return static_cast<uint32_t>(depth * static_cast<float>(kMaxDepth) + 0.5f);
+    }
+
+    // DXGI_FORMAT_R8G8B8A8_UNORM.
+    uint32_t PackColor(float red, float green, float blue, float alpha)
+    {
+        auto toByte = [](float value)
+        {
+            value = std::min(std::max(value, 0.0f), 1.0f);
+            return static_cast<uint32_t>(value * 255.0f + 0.5f);
+        };
+
+        return toByte(red) | (toByte(green) << 8) | (toByte(blue) << 16) | (toByte(alpha) << 24);
+    }
+
+    bool DepthTest(D3D11_COMPARISON_FUNC func, uint32_t source, uint32_t destination)
+    {
+        switch (func)
+        {
+        case D3D11_COMPARISON_NEVER:
+            return false;
+        case D3D11_COMPARISON_LESS:
+            return source < destination;
+        case D3D11_COMPARISON_EQUAL:
+            return source == destination;
+        case D3D11_COMPARISON_LESS_EQUAL:
+            return source <= destination;
+        case D3D11_COMPARISON_GREATER:
+            return source > destination;
+        case D3D11_COMPARISON_NOT_EQUAL:
+            return source != destination;
+        case D3D11_COMPARISON_GREATER_EQUAL:
+            return source >= destination;
+        default:
+            return true;
+        }
+    }
+
+    // Edge function of the edge a->b for the point p.
+    // Positive on the inside of a triangle with positive area.
+    struct Edge
+    {
+        float m_stepX;
+        float m_stepY;
+        float m_origin;
+        bool m_topLeft;
+
+        Edge(float ax, float ay, float bx, float by)
+        {
+            // Always set up from the same end of the edge, then flipped. The triangle on the
+            // other side of a shared edge then gets exactly the negated values, so every
+            // pixel center on the edge belongs to exactly one of the two.
+            bool flip = by < ay || (by == ay && bx < ax);
+            if (flip)
+            {
+                std::swap(ax, bx);
+                std::swap(ay, by);
+            }
+
+            float dx = bx - ax;
+            float dy = by - ay;
+
+            // E(x, y) = dx * (y - ay) - dy * (x - ax)
+            m_stepX = -dy;
+            m_stepY = dx;
+            m_origin = dy * ax - dx * ay;
+
+            if (flip)
+            {
+                m_stepX = -m_stepX;
+                m_stepY = -m_stepY;
+                m_origin = -m_origin;
+            }
+
+            // Top-left fill rule for clockwise triangles in y-down screen space:
+            // a top edge is horizontal going right, a left edge goes up.
+            m_topLeft = m_stepX > 0.0f || (m_stepX == 0.0f && m_stepY > 0.0f);
+        }
+
+        // The part of E that only depends on the row.
+        float EvaluateRow(float y) const
+        {
+            return m_stepY * y + m_origin;
+        }
+
+        // Evaluated from scratch for every pixel, values stepped along a row would drift
+        // apart from the ones of the neighbouring triangle.
+        float Evaluate(float x, float rowValue) const
+        {
+            return m_stepX * x + rowValue;
+        }
+
+        bool Inside(float value) const
+        {
+            return value > 0.0f || (value == 0.0f && m_topLeft);
+        }
+    };
+}
+
+SoftwareRenderContext::SoftwareRenderContext(int width, int height, JobSystem* pJobSystem)
+    : m_width(width)
+    , m_height(height)
+    , m_tilesX((width + kTileSize - 1) / kTileSize)
+    , m_tilesY((height + kTileSize - 1) / kTileSize)
+    , m_colorBuffer(static_cast<size_t>(width) * height, 0)
+    , m_depthBuffer(static_cast<size_t>(width) * height, kMaxDepth)
+    , m_clearColorPending(false)
+    , m_clearDepthPending(false)
+    , m_clearColor(0)
+    , m_clearDepth(kMaxDepth)
+    , m_pInputLayout(nullptr)
+    , m_pVertexBuffers()
+    , m_vertexStrides()
+    , m_vertexOffsets()
+    , m_pIndexBuffer(nullptr)
+    , m_indexFormat(DXGI_FORMAT_R32_UINT)
+    , m_indexOffset(0)
+    , m_topology(D3D11_PRIMITIVE_TOPOLOGY_UNDEFINED)
+    , m_pVertexShader(nullptr)
+    , m_pPixelShader(nullptr)
+    , m_pConstantBuffers()
+    , m_constantBufferOffsets()
+    , m_drawTag(0)
+    , m_pJobSystem(pJobSystem)
+{
+    // Start with the D3D11 default depth stencil and rasterizer states.
+    ZeroMemory(&m_depthStencilDesc, sizeof(m_depthStencilDesc));
+    m_depthStencilDesc.DepthEnable = true;
+    m_depthStencilDesc.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ALL;
+    m_depthStencilDesc.DepthFunc = D3D11_COMPARISON_LESS;
+
+    ZeroMemory(&m_rasterDesc, sizeof(m_rasterDesc));
+    m_rasterDesc.FillMode = D3D11_FILL_SOLID;
+    m_rasterDesc.CullMode = D3D11_CULL_BACK;
+    m_rasterDesc.DepthClipEnable = true;
+
+    m_viewport.TopLeftX = 0.0f;
+    m_viewport.TopLeftY = 0.0f;
+    m_viewport.Width = static_cast<float>(width);
+    m_viewport.Height = static_cast<float>(height);
+    m_viewport.MinDepth = 0.0f;
+    m_viewport.MaxDepth = 1.0f;
+
+    // Split the render target into tiles.
+    m_tiles.resize(static_cast<size_t>(m_tilesX) * m_tilesY);
+    m_tileTimings.resize(m_tiles.size());
+    for (int tileY = 0; tileY < m_tilesY; ++tileY)
+    {
+        for (int tileX = 0; tileX < m_tilesX; ++tileX)
+        {
+            Tile& tile = m_tiles[static_cast<size_t>(tileY) * m_tilesX + tileX];
+            tile.m_x0 = tileX * kTileSize;
+            tile.m_y0 = tileY * kTileSize;
+            tile.m_x1 = std::min(tile.m_x0 + kTileSize, width);
+            tile.m_y1 = std::min(tile.m_y0 + kTileSize, height);
+
+            SoftwareTileTiming& timing = m_tileTimings[static_cast<size_t>(tileY) * m_tilesX + tileX];
+            timing.m_tileX = tileX;
+            timing.m_tileY = tileY;
+            timing.m_threadIndex = 0;
+            timing.m_triangleCount = 0;
+            timing.m_milliseconds = 0.0;
+        }
+    }
+}
+
+void SoftwareRenderContext::ClearRenderTargetView(ID3D11RenderTargetView*, const FLOAT color[4])
+{
+    // Anything drawn before the clear has to land first.
+    if (!m_triangles.empty())
+    {
+        Flush();
+    }
+
+    m_clearColor = PackColor(color[0], color[1], color[2], color[3]);
+    m_clearColorPending = true;
+}
+
+void SoftwareRenderContext::ClearDepthStencilView(ID3D11DepthStencilView*, UINT clearFlags, FLOAT depth, UINT8)
+{
+    if (!(clearFlags & D3D11_CLEAR_DEPTH))
+    {
+        return;
+    }
+
+    if (!m_triangles.empty())
+    {
+        Flush();
+    }
+
+    m_clearDepth = QuantizeDepth(depth);
+    m_clearDepthPending = true;
+}
+
+void SoftwareRenderContext::OMSetRenderTargets(UINT, ID3D11RenderTargetView* const*, ID3D11DepthStencilView*)
+{
+    // Always renders into the context owned color and depth buffers.
+}
+
+void SoftwareRenderContext::OMSetDepthStencilState(ID3D11DepthStencilState* pState, UINT)
+{
+    if (pState)
+    {
+        m_depthStencilDesc = static_cast<SoftwareDepthStencilState*>(pState)->GetDescRef();
+    }
+}
+
+void SoftwareRenderContext::RSSetState(ID3D11RasterizerState* pState)
+{
+    if (pState)
+    {
+        m_rasterDesc = static_cast<SoftwareRasterizerState*>(pState)->GetDescRef();
+    }
+}
+
+void SoftwareRenderContext::RSSetViewports(UINT numViewports, const D3D11_VIEWPORT* pViewports)
+{
+    if (numViewports > 0)
+    {
+        m_viewport = pViewports[0];
+    }
+}
+
+void SoftwareRenderContext::IASetInputLayout(ID3D11InputLayout* pLayout)
+{
+    m_pInputLayout = static_cast<SoftwareInputLayout*>(pLayout);
+}
+
+void SoftwareRenderContext::IASetVertexBuffers(UINT startSlot, UINT numBuffers, ID3D11Buffer* const* ppBuffers, const UINT* pStrides, const UINT* pOffsets)
+{
+    for (UINT i = 0; i < numBuffers && startSlot + i < D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT; ++i)
+    {
+        m_pVertexBuffers[startSlot + i] = static_cast<SoftwareBuffer*>(ppBuffers[i]);
+        m_vertexStrides[startSlot + i] = pStrides[i];
+        m_vertexOffsets[startSlot + i] = pOffsets[i];
+    }
+}
+
+void SoftwareRenderContext::IASetIndexBuffer(ID3D11Buffer* pBuffer, DXGI_FORMAT format, UINT offset)
+{
+    m_pIndexBuffer = static_cast<SoftwareBuffer*>(pBuffer);
+    m_indexFormat = format;
+    m_indexOffset = offset;
+}
+
+void SoftwareRenderContext::IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY topology)
+{
+    m_topology = topology;
+}
+
+void SoftwareRenderContext::VSSetShader(ID3D11VertexShader* pShader, ID3D11ClassInstance* const*, UINT)
+{
+    m_pVertexShader = static_cast<SoftwareVertexShader*>(pShader);
+}
+
+void SoftwareRenderContext::PSSetShader(ID3D11PixelShader* pShader, ID3D11ClassInstance* const*, UINT)
+{
+    m_pPixelShader = static_cast<SoftwarePixelShader*>(pShader);
+}
+
+void SoftwareRenderContext::VSSetConstantBuffers(UINT startSlot, UINT numBuffers, ID3D11Buffer* const* ppBuffers)
+{
+    for (UINT i = 0; i < numBuffers && startSlot + i < D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT; ++i)
+    {
+        m_pConstantBuffers[startSlot + i] = static_cast<SoftwareBuffer*>(ppBuffers[i]);
+        m_constantBufferOffsets[startSlot + i] = 0;
+    }
+}
+
+void SoftwareRenderContext::VSSetConstantBuffers1(UINT startSlot, UINT numBuffers, ID3D11Buffer* const* ppBuffers, const UINT* pFirstConstant, const UINT*)
+{
+    for (UINT i = 0; i < numBuffers && startSlot + i < D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT; ++i)
+    {
+        SoftwareBuffer* pBuffer = static_cast<SoftwareBuffer*>(ppBuffers[i]);
+        UINT offset = pFirstConstant ? pFirstConstant[i] * 16 : 0;
+
+        // A window past the end of the buffer reads as unbound.
+        m_pConstantBuffers[startSlot + i] = (pBuffer && offset < pBuffer->GetByteWidth()) ? pBuffer : nullptr;
+        m_constantBufferOffsets[startSlot + i] = offset;
+    }
+}
+
+HRESULT SoftwareRenderContext::Map(ID3D11Resource* pResource, UINT, D3D11_MAP, UINT, D3D11_MAPPED_SUBRESOURCE* pMappedResource)
+{
+    if (!pResource || !pMappedResource)
+    {
+        return E_INVALIDARG;
+    }
+
+    D3D11_RESOURCE_DIMENSION dimension;
+    pResource->GetType(&dimension);
+    if (dimension != D3D11_RESOURCE_DIMENSION_BUFFER)
+    {
+        return E_INVALIDARG;
+    }
+
+    // Vertices are transformed when they are drawn, so the old contents are never
+    // needed again and WRITE_DISCARD can hand out the same memory.
+    SoftwareBuffer* pBuffer = static_cast<SoftwareBuffer*>(pResource);
+    pMappedResource->pData = pBuffer->GetData();
+    pMappedResource->RowPitch = pBuffer->GetByteWidth();
+    pMappedResource->DepthPitch = pBuffer->GetByteWidth();
+
+    return S_OK;
+}
+
+void SoftwareRenderContext::Unmap(ID3D11Resource*, UINT)
+{
+}
+
+// Nothing to record, the query is answered from what is still queued when it is asked.
+void SoftwareRenderContext::End(ID3D11Asynchronous*)
+{
+}
+
+//-----------------------------------------------------------------
+// Vertices (and with them constant buffers) are consumed when they
+// are drawn, so only the queued triangles can still be in flight.
+// They are rasterized here unless the caller asked not to flush.
+//-----------------------------------------------------------------
+HRESULT SoftwareRenderContext::GetData(ID3D11Asynchronous*, void* pData, UINT dataSize, UINT getDataFlags)
+{
+    if (!m_triangles.empty())
+    {
+        if (getDataFlags & D3D11_ASYNC_GETDATA_DONOTFLUSH)
+        {
+            return S_FALSE;
+        }
+
+        Flush();
+    }
+
+    if (pData && dataSize >= sizeof(BOOL))
+    {
+        *static_cast<BOOL*>(pData) = TRUE;
+    }
+
+    return S_OK;
+}
+
+// Draws already ran their vertex shader, so the new contents only affect later draws like on the GPU.
+void SoftwareRenderContext::UpdateSubresource(ID3D11Resource* pResource, UINT, const D3D11_BOX* pBox, const void* pSourceData, UINT, UINT)
+{
+    if (!pResource || !pSourceData)
+    {
+        return;
+    }
+
+    D3D11_RESOURCE_DIMENSION dimension;
+    pResource->GetType(&dimension);
+    if (dimension != D3D11_RESOURCE_DIMENSION_BUFFER)
+    {
+        return;
+    }
+
+    static_cast<SoftwareBuffer*>(pResource)->Update(pBox, pSourceData);
+}
+
+void SoftwareRenderContext::DrawIndexed(UINT indexCount, UINT startIndexLocation, INT baseVertexLocation)
+{
+    DrawIndexedInstanced(indexCount, 1, startIndexLocation, baseVertexLocation, 0);
+}
+
+//-----------------------------------------------------------------
+// Every instance is drawn like a draw of its own, in order. The
+// vertex cache is keyed by index so it is reset between instances.
+//-----------------------------------------------------------------
+void SoftwareRenderContext::DrawIndexedInstanced(UINT indexCount, UINT instanceCount, UINT startIndexLocation, INT baseVertexLocation, UINT startInstanceLocation)
+{
+    if (!m_pInputLayout || !m_pVertexShader || !m_pPixelShader || !m_pIndexBuffer)
+    {
+        return;
+    }
+
+    if (m_topology != D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST)
+    {
+        return;
+    }
+
+    // Make sure the whole index range is inside the index buffer.
+    size_t indexSize = (m_indexFormat == DXGI_FORMAT_R16_UINT) ? sizeof(uint16_t) : sizeof(uint32_t);
+    size_t indexEnd = m_indexOffset + (static_cast<size_t>(startIndexLocation) + indexCount) * indexSize;
+    if (indexEnd > m_pIndexBuffer->GetByteWidth())
+    {
+        return;
+    }
+
+    const uint8_t* pIndices = m_pIndexBuffer->GetData() + m_indexOffset + static_cast<size_t>(startIndexLocation) * indexSize;
+
+    for (UINT instance = 0; instance < instanceCount; ++instance)
+    {
+        // A new tag invalidates every cached vertex from the previous draw or instance.
+        ++m_drawTag;
+        if (m_drawTag == 0)
+        {
+            std::fill(m_vertexCacheTag.begin(), m_vertexCacheTag.end(), 0);
+            m_drawTag = 1;
+        }
+
+        for (UINT i = 0; i + 2 < indexCount; i += 3)
+        {
+            SoftwareVertex vertices[3];
+            bool valid = true;
+
+            for (UINT corner = 0; corner < 3 && valid; ++corner)
+            {
+                uint32_t index;
+                if (indexSize == sizeof(uint16_t))
+                {
+                    uint16_t shortIndex;
+                    memcpy(&shortIndex, pIndices + (i + corner) * indexSize, sizeof(shortIndex));
+                    index = shortIndex;
+                }
+                else
+                {
+                    memcpy(&index, pIndices + (i + corner) * indexSize, sizeof(index));
+                }
+
+                if (index < m_vertexCacheTag.size() && m_vertexCacheTag[index] == m_drawTag)
+                {
+                    vertices[corner] = m_vertexCache[index];
+                    continue;
+                }
+
+                int64_t vertexIndex = static_cast<int64_t>(index) + baseVertexLocation;
+                if (vertexIndex < 0 || !FetchVertex(static_cast<UINT>(vertexIndex), instance, startInstanceLocation, vertices[corner]))
+                {
+                    valid = false;
+                    break;
+                }
+
+                if (index < kMaxCachedVertices)
+                {
+                    if (index >= m_vertexCacheTag.size())
+                    {
+                        m_vertexCache.resize(index + 1);
+                        m_vertexCacheTag.resize(index + 1, 0);
+                    }
+
+                    m_vertexCache[index] = vertices[corner];
+                    m_vertexCacheTag[index] = m_drawTag;
+                }
+            }
+
+            if (valid)
+            {
+                SetupTriangle(vertices[0], vertices[1], vertices[2]);
+            }
+        }
+    }
+}
+
+// There are no deferred contexts on this backend, so never a command list.
+HRESULT SoftwareRenderContext::FinishCommandList(BOOL, ID3D11CommandList**)
+{
+    return E_NOTIMPL;
+}
+
+void SoftwareRenderContext::ExecuteCommandList(ID3D11CommandList*, BOOL)
+{
+}
+
+void SoftwareRenderContext::Flush()
+{
+    PROFILE_SCOPE("SoftwareRenderContext::Flush");
+
+    if (m_triangles.empty() && !m_clearColorPending && !m_clearDepthPending)
+    {
+        return;
+    }
+
+    // One tile per job, they differ too much in cost for bigger chunks to balance.
+    if (m_pJobSystem)
+    {
+        m_pJobSystem->ParallelFor(static_cast<unsigned int>(m_tiles.size()), 1, [this](unsigned int begin, unsigned int end)
+        {
+            PROFILE_SCOPE("SoftwareRenderContext::RasterizeTiles");
+
+            unsigned int threadIndex = m_pJobSystem->GetCallingThreadIndex();
+            for (unsigned int i = begin; i < end; ++i)
+            {
+                RasterizeTile(m_tiles[i], threadIndex, m_tileTimings[i]);
+            }
+        });
+    }
+    else
+    {
+        PROFILE_SCOPE("SoftwareRenderContext::RasterizeTiles");
+
+        for (size_t i = 0; i < m_tiles.size(); ++i)
+        {
+            RasterizeTile(m_tiles[i], 0, m_tileTimings[i]);
+        }
+    }
+
+    // Every tile is done, start binning the next batch.
+    for (Tile& tile : m_tiles)
+    {
+        tile.m_triangles.clear();
+    }
+    m_triangles.clear();
+
+    m_clearColorPending = false;
+    m_clearDepthPending = false;
+}
+
+int SoftwareRenderContext::GetWidth() const
+{
+    return m_width;
+}
+
+int SoftwareRenderContext::GetHeight() const
+{
+    return m_height;
+}
+
+unsigned int SoftwareRenderContext::GetThreadCount() const
+{
+    return m_pJobSystem ? m_pJobSystem->GetWorkerCount() + 1 : 1;
+}
+
+const uint32_t* SoftwareRenderContext::GetColorBuffer() const
+{
+    return m_colorBuffer.data();
+}
+
+const std::vector<SoftwareTileTiming>& SoftwareRenderContext::GetTileTimings() const
+{
+    return m_tileTimings;
+}
+
+// Runs the input assembler and vertex shader for one vertex.
+bool SoftwareRenderContext::FetchVertex(UINT vertexIndex, UINT instance, UINT startInstance, SoftwareVertex& output)
+{
+    XMFLOAT4 attributes[D3D11_IA_VERTEX_INPUT_STRUCTURE_ELEMENT_COUNT];
+
+    const std::vector<SoftwareInputLayout::Element>& kElements = m_pInputLayout->GetElements();
+    for (size_t i = 0; i < kElements.size(); ++i)
+    {
+        const SoftwareInputLayout::Element& kElement = kElements[i];
+
+        SoftwareBuffer* pBuffer = m_pVertexBuffers[kElement.m_inputSlot];
+        if (!pBuffer)
+        {
+            return false;
+        }
+
+        // Per-instance elements advance every step rate instances, a step rate of 0 never advances.
+        size_t element = vertexIndex;
+        if (kElement.m_classification == D3D11_INPUT_PER_INSTANCE_DATA)
+        {
+            element = static_cast<size_t>(startInstance) + (kElement.m_instanceStepRate ? (instance / kElement.m_instanceStepRate) : 0);
+        }
+        size_t byteOffset = m_vertexOffsets[kElement.m_inputSlot] + element * m_vertexStrides[kElement.m_inputSlot] + kElement.m_byteOffset;
+        size_t byteCount = kElement.m_componentCount * sizeof(float);
+        if (byteOffset + byteCount > pBuffer->GetByteWidth())
+        {
+            return false;
+        }
+
+        // Missing components default to (0, 0, 0, 1) like the input assembler.
+        float components[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+        memcpy(components, pBuffer->GetData() + byteOffset, byteCount);
+        attributes[i] = XMFLOAT4(components[0], components[1], components[2], components[3]);
+    }
+
+    const uint8_t* pConstantBuffers[D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT];
+    for (size_t i = 0; i < D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT; ++i)
+    {
+        pConstantBuffers[i] = m_pConstantBuffers[i] ? (m_pConstantBuffers[i]->GetData() + m_constantBufferOffsets[i]) : nullptr;
+    }
+
+    m_pVertexShader->GetFunction()(attributes, pConstantBuffers, output);
+
+    return true;
+}
+
+// Viewport transform, culling and binning of one triangle.
+void SoftwareRenderContext::SetupTriangle(const SoftwareVertex& kVertex0, const SoftwareVertex& kVertex1, const SoftwareVertex& kVertex2)
+{
+    const SoftwareVertex* pVertices[3] = { &kVertex0, &kVertex1, &kVertex2 };
+    Triangle triangle;
+
+    for (int i = 0; i < 3; ++i)
+    {
+        const XMFLOAT4& kPosition = pVertices[i]->m_position;
+        if (kPosition.w <= kMinW)
+        {
+            return;
+        }
+
+        float invW = 1.0f / kPosition.w;
+
+        triangle.m_x[i] = m_viewport.TopLeftX + (kPosition.x * invW + 1.0f) * 0.5f * m_viewport.Width;
+        triangle.m_y[i] = m_viewport.TopLeftY + (1.0f - kPosition.y * invW) * 0.5f * m_viewport.Height;
+        triangle.m_z[i] = m_viewport.MinDepth + kPosition.z * invW * (m_viewport.MaxDepth - m_viewport.MinDepth);
+        triangle.m_invW[i] = invW;
+
+        const XMFLOAT4& kColor = pVertices[i]->m_color;
+        triangle.m_colorOverW[i] = XMFLOAT4(kColor.x * invW, kColor.y * invW, kColor.z * invW, kColor.w * invW);
+    }
+
+    float area = (triangle.m_x[1] - triangle.m_x[0]) * (triangle.m_y[2] - triangle.m_y[0])
+               - (triangle.m_x[2] - triangle.m_x[0]) * (triangle.m_y[1] - triangle.m_y[0]);
+    if (area == 0.0f)
+    {
+        return;
+    }
+
+    // In y-down screen space a clockwise triangle has positive area.
+    bool frontFacing = m_rasterDesc.FrontCounterClockwise ? (area < 0.0f) : (area > 0.0f);
+    if ((m_rasterDesc.CullMode == D3D11_CULL_BACK && !frontFacing) || (m_rasterDesc.CullMode == D3D11_CULL_FRONT && frontFacing))
+    {
+        return;
+    }
+
+    // The tile back-end expects positive area, so flip the winding of the others.
+    if (area < 0.0f)
+    {
+        std::swap(triangle.m_x[1], triangle.m_x[2]);
+        std::swap(triangle.m_y[1], triangle.m_y[2]);
+        std::swap(triangle.m_z[1], triangle.m_z[2]);
+        std::swap(triangle.m_invW[1], triangle.m_invW[2]);
+        std::swap(triangle.m_colorOverW[1], triangle.m_colorOverW[2]);
+    }
+
+    // Bounding box in pixels, clipped to the viewport and the render target.
+    int viewportMinX = std::max(0, static_cast<int>(m_viewport.TopLeftX));
+    int viewportMinY = std::max(0, static_cast<int>(m_viewport.TopLeftY));
+    int viewportMaxX = std::min(m_width, static_cast<int>(m_viewport.TopLeftX + m_viewport.Width)) - 1;
+    int viewportMaxY = std::min(m_height, static_cast<int>(m_viewport.TopLeftY + m_viewport.Height)) - 1;
+
+    float minX = std::min({ triangle.m_x[0], triangle.m_x[1], triangle.m_x[2] });
+    float minY = std::min({ triangle.m_y[0], triangle.m_y[1], triangle.m_y[2] });
+    float maxX = std::max({ triangle.m_x[0], triangle.m_x[1], triangle.m_x[2] });
+    float maxY = std::max({ triangle.m_y[0], triangle.m_y[1], triangle.m_y[2] });
+
+    triangle.m_minX = std::max(viewportMinX, static_cast<int>(std::floor(std::max(minX, -1.0f))));
+    triangle.m_minY = std::max(viewportMinY, static_cast<int>(std::floor(std::max(minY, -1.0f))));
+    triangle.m_maxX = std::min(viewportMaxX, static_cast<int>(std::ceil(std::min(maxX, static_cast<float>(m_width)))));
+    triangle.m_maxY = std::min(viewportMaxY, static_cast<int>(std::ceil(std::min(maxY, static_cast<float>(m_height)))));
+    if (triangle.m_minX > triangle.m_maxX || triangle.m_minY > triangle.m_maxY)
+    {
+        return;
+    }
+
+    // Snapshot the state the back-end needs, it may change before the next Flush().
+    triangle.m_pPixelShader = m_pPixelShader->GetFunction();
+    triangle.m_depthEnable = m_depthStencilDesc.DepthEnable != FALSE;
+    triangle.m_depthWrite = m_depthStencilDesc.DepthWriteMask == D3D11_DEPTH_WRITE_MASK_ALL;
+    triangle.m_depthFunc = m_depthStencilDesc.DepthFunc;
+    triangle.m_depthClip = m_rasterDesc.DepthClipEnable != FALSE;
+
+    uint32_t triangleIndex = static_cast<uint32_t>(m_triangles.size());
+    m_triangles.push_back(triangle);
+
+    // Bin the triangle into every tile its bounding box touches.
+    for (int tileY = triangle.m_minY / kTileSize; tileY <= triangle.m_maxY / kTileSize; ++tileY)
+    {
+        for (int tileX = triangle.m_minX / kTileSize; tileX <= triangle.m_maxX / kTileSize; ++tileX)
+        {
+            m_tiles[static_cast<size_t>(tileY) * m_tilesX + tileX].m_triangles.push_back(triangleIndex);
+        }
+    }
+}
+
+void SoftwareRenderContext::RasterizeTile(Tile& tile, unsigned int threadIndex, SoftwareTileTiming& timing)
+{
+    auto startTime = std::chrono::steady_clock::now();
+
+    // Apply pending clears to this tile.
+    if (m_clearColorPending || m_clearDepthPending)
+    {
+        for (int y = tile.m_y0; y < tile.m_y1; ++y)
+        {
+            size_t rowStart = static_cast<size_t>(y) * m_width;
+            if (m_clearColorPending)
+            {
+                std::fill(m_colorBuffer.begin() + rowStart + tile.m_x0, m_colorBuffer.begin() + rowStart + tile.m_x1, m_clearColor);
+            }
+            if (m_clearDepthPending)
+            {
+                std::fill(m_depthBuffer.begin() + rowStart + tile.m_x0, m_depthBuffer.begin() + rowStart + tile.m_x1, m_clearDepth);
+            }
+        }
+    }
+
+    for (uint32_t triangleIndex : tile.m_triangles)
+    {
+        const Triangle& kTriangle = m_triangles[triangleIndex];
+
+        int startX = std::max(kTriangle.m_minX, tile.m_x0);
+        int startY = std::max(kTriangle.m_minY, tile.m_y0);
+        int endX = std::min(kTriangle.m_maxX, tile.m_x1 - 1);
+        int endY = std::min(kTriangle.m_maxY, tile.m_y1 - 1);
+        if (startX > endX || startY > endY)
+        {
+            continue;
+        }
+
+        // Edge i is opposite vertex i, so its value is the barycentric weight of vertex i.
+        Edge edges[3] =
+        {
+            Edge(kTriangle.m_x[1], kTriangle.m_y[1], kTriangle.m_x[2], kTriangle.m_y[2]),
+            Edge(kTriangle.m_x[2], kTriangle.m_y[2], kTriangle.m_x[0], kTriangle.m_y[0]),
+            Edge(kTriangle.m_x[0], kTriangle.m_y[0], kTriangle.m_x[1], kTriangle.m_y[1]),
+        };
+
+        float invArea = 1.0f / (edges[0].Evaluate(kTriangle.m_x[0], edges[0].EvaluateRow(kTriangle.m_y[0])));
+
+        for (int y = startY; y <= endY; ++y)
+        {
+            // Sample at pixel centers.
+            float sampleY = static_cast<float>(y) + 0.5f;
+
+            float rowValues[3] =
+            {
+                edges[0].EvaluateRow(sampleY),
+                edges[1].EvaluateRow(sampleY),
+                edges[2].EvaluateRow(sampleY),
+            };
+
+            size_t pixelIndex = static_cast<size_t>(y) * m_width + startX;
+
+            for (int x = startX; x <= endX; ++x, ++pixelIndex)
+            {
+                float sampleX = static_cast<float>(x) + 0.5f;
+
+                float weights[3] =
+                {
+                    edges[0].Evaluate(sampleX, rowValues[0]),
+                    edges[1].Evaluate(sampleX, rowValues[1]),
+                    edges[2].Evaluate(sampleX, rowValues[2]),
+                };
+
+                if (!edges[0].Inside(weights[0]) || !edges[1].Inside(weights[1]) || !edges[2].Inside(weights[2]))
+                {
+                    continue;
+                }
+
+                float b0 = weights[0] * invArea;
+                float b1 = weights[1] * invArea;
+                float b2 = weights[2] * invArea;
+
+                // Depth is affine in screen space.
+                float depth = b0 * kTriangle.m_z[0] + b1 * kTriangle.m_z[1] + b2 * kTriangle.m_z[2];
+                if (kTriangle.m_depthClip && (depth < 0.0f || depth > 1.0f))
+                {
+                    continue;
+                }
+
+                if (kTriangle.m_depthEnable)
+                {
+                    uint32_t quantizedDepth = QuantizeDepth(depth);
+                    if (!DepthTest(kTriangle.m_depthFunc, quantizedDepth, m_depthBuffer[pixelIndex]))
+                    {
+                        continue;
+                    }
+
+                    if (kTriangle.m_depthWrite)
+                    {
+                        m_depthBuffer[pixelIndex] = quantizedDepth;
+                    }
+                }
+
+                // Perspective correct color.
+                float w = 1.0f / (b0 * kTriangle.m_invW[0] + b1 * kTriangle.m_invW[1] + b2 * kTriangle.m_invW[2]);
+                XMFLOAT4 color(
+                    (b0 * kTriangle.m_colorOverW[0].x + b1 * kTriangle.m_colorOverW[1].x + b2 * kTriangle.m_colorOverW[2].x) * w,
+                    (b0 * kTriangle.m_colorOverW[0].y + b1 * kTriangle.m_colorOverW[1].y + b2 * kTriangle.m_colorOverW[2].y) * w,
+                    (b0 * kTriangle.m_colorOverW[0].z + b1 * kTriangle.m_colorOverW[1].z + b2 * kTriangle.m_colorOverW[2].z) * w,
+                    (b0 * kTriangle.m_colorOverW[0].w + b1 * kTriangle.m_colorOverW[1].w + b2 * kTriangle.m_colorOverW[2].w) * w);
+
+                XMFLOAT4 output = kTriangle.m_pPixelShader(color);
+                m_colorBuffer[pixelIndex] = PackColor(output.x, output.y, output.z, output.w);
+            }
+        }
+    }
+
+    auto endTime = std::chrono::steady_clock::now();
+
+    timing.m_threadIndex = threadIndex;
+    timing.m_triangleCount = static_cast<unsigned int>(tile.m_triangles.size());
+    timing.m_milliseconds = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+}
@@ -0,0 +1,246 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: SoftwareRenderDevice.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include <string_view>
+#include <new>
+
+#include "Graphics/SoftwareRenderDevice.h"
+#include "Graphics/ShaderConstants.h"
+
+using namespace DirectX;
+
+namespace
+{
+    // C++ version of ColorVertexShader in Src/Shaders/ColorVS.hlsl.
+    // The constant buffers hold transposed matrices (see ShaderConstants.h),
+    // so they are transposed back before transforming the row vector like mul() does.
+    void ColorVertexShader(const XMFLOAT4* pAttributes, const uint8_t* const* ppConstantBuffers, SoftwareVertex& output)
+    {
+        const ViewConstants* pView = reinterpret_cast<const ViewConstants*>(ppConstantBuffers[VIEW_CONSTANTS_SLOT]);
+        const ObjectConstants* pObject = reinterpret_cast<const ObjectConstants*>(ppConstantBuffers[OBJECT_CONSTANTS_SLOT]);
+        if (!pView || !pObject)
+        {
+            // Without the matrices the vertex ends up on the eye plane and gets dropped.
+            output = SoftwareVertex();
+            return;
+        }
+
+        XMMATRIX worldMatrix = XMMatrixTranspose(XMLoadFloat4x4(&pObject->m_world));
+        XMMATRIX viewProjectionMatrix = XMMatrixTranspose(XMLoadFloat4x4(&pView->m_viewProjection));
+
+        // Change the position vector to be 4 units for proper matrix calculations.
+        XMVECTOR position = XMVectorSetW(XMLoadFloat4(&pAttributes[0]), 1.0f);
+
+        position = XMVector4Transform(position, worldMatrix);
+        position = XMVector4Transform(position, viewProjectionMatrix);
+
+        XMStoreFloat4(&output.m_position, position);
+        output.m_color = pAttributes[1];
+    }
+
+    // C++ version of ColorInstancedVertexShader in Src/Shaders/ColorInstancedVS.hlsl.
+    // Attributes 2 to 5 are the rows of the instance's world matrix, 6 is its tint.
+    void ColorInstancedVertexShader(const XMFLOAT4* pAttributes, const uint8_t* const* ppConstantBuffers, SoftwareVertex& output)
+    {
+        const ViewConstants* pView = reinterpret_cast<const ViewConstants*>(ppConstantBuffers[VIEW_CONSTANTS_SLOT]);
+        if (!pView)
+        {
+            output = SoftwareVertex();
+            return;
+        }
+
+        XMMATRIX instanceWorldMatrix(XMLoadFloat4(&pAttributes[2]), XMLoadFloat4(&pAttributes[3]), XMLoadFloat4(&pAttributes[4]), XMLoadFloat4(&pAttributes[5]));
+        XMMATRIX viewProjectionMatrix = XMMatrixTranspose(XMLoadFloat4x4(&pView->m_viewProjection));
+
+        XMVECTOR position = XMVectorSetW(XMLoadFloat4(&pAttributes[0]), 1.0f);
+
+        position = XMVector4Transform(position, instanceWorldMatrix);
+        position = XMVector4Transform(position, viewProjectionMatrix);
+
+        XMStoreFloat4(&output.m_position, position);
+        XMStoreFloat4(&output.m_color, XMVectorMultiply(XMLoadFloat4(&pAttributes[1]), XMLoadFloat4(&pAttributes[6])));
+    }
+
+    // C++ version of ColorPixelShader in Src/Shaders/ColorPS.hlsl.
+    XMFLOAT4 ColorPixelShader(const XMFLOAT4& color)
+    {
+        return XMFLOAT4(color.x * 0.5f, color.y * 0.5f, color.z * 0.5f, color.w * 0.5f);
+    }
+
+    struct VertexShaderEntry
+    {
+        std::string_view m_name;
+        SoftwareVertexShaderFunc m_pFunction;
+    };
+
+    struct PixelShaderEntry
+    {
+        std::string_view m_name;
+        SoftwarePixelShaderFunc m_pFunction;
+    };
+
+    constexpr VertexShaderEntry kVertexShaders[] =
+    {
+        { "ColorVertexShader", ColorVertexShader },
+        { "ColorInstancedVertexShader", ColorInstancedVertexShader },
+    };
+
+    constexpr PixelShaderEntry kPixelShaders[] =
+    {
+        { "ColorPixelShader", ColorPixelShader },
+    };
+
+    UINT GetComponentCount(DXGI_FORMAT format)
+    {
+        switch (format)
+        {
+        case DXGI_FORMAT_R32G32B32A32_FLOAT:
+            return 4;
+        case DXGI_FORMAT_R32G32B32_FLOAT:
+            return 3;
+        case DXGI_FORMAT_R32G32_FLOAT:
+            return 2;
+        case DXGI_FORMAT_R32_FLOAT:
+            return 1;
+        default:
+            return 0;
+        }
+    }
+}
+
+SoftwareRenderDevice::SoftwareRenderDevice(RenderBackend backend)
+    : m_backend(backend)
+{
+}
+
+RenderBackend SoftwareRenderDevice::GetBackend() const
+{
+    return m_backend;
+}
+
+HRESULT SoftwareRenderDevice::CreateBuffer(const D3D11_BUFFER_DESC* pDesc, const D3D11_SUBRESOURCE_DATA* pInitialData, ID3D11Buffer** ppBuffer)
+{
+    if (!pDesc || !ppBuffer || pDesc->ByteWidth == 0)
+    {
+        return E_INVALIDARG;
+    }
+
+    *ppBuffer = new (std::nothrow) SoftwareBuffer(*pDesc, pInitialData ? pInitialData->pSysMem : nullptr);
+    if (!*ppBuffer)
+    {
+        return E_OUTOFMEMORY;
+    }
+
+    return S_OK;
+}
+
+HRESULT SoftwareRenderDevice::CreateVertexShader(const void* pBytecode, SIZE_T bytecodeLength, ID3D11ClassLinkage*, ID3D11VertexShader** ppShader)
+{
+    std::string_view entryPoint(static_cast<const char*>(pBytecode), bytecodeLength);
+
+    for (const VertexShaderEntry& kEntry : kVertexShaders)
+    {
+        if (kEntry.m_name == entryPoint)
+        {
+            *ppShader = new (std::nothrow) SoftwareVertexShader(kEntry.m_pFunction);
+            return *ppShader ? S_OK : E_OUTOFMEMORY;
+        }
+    }
+
+    return E_INVALIDARG;
+}
+
+HRESULT SoftwareRenderDevice::CreatePixelShader(const void* pBytecode, SIZE_T bytecodeLength, ID3D11ClassLinkage*, ID3D11PixelShader** ppShader)
+{
+    std::string_view entryPoint(static_cast<const char*>(pBytecode), bytecodeLength);
+
+    for (const PixelShaderEntry& kEntry : kPixelShaders)
+    {
+        if (kEntry.m_name == entryPoint)
+        {
+            *ppShader = new (std::nothrow) SoftwarePixelShader(kEntry.m_pFunction);
+            return *ppShader ? S_OK : E_OUTOFMEMORY;
+        }
+    }
+
+    return E_INVALIDARG;
+}
+
+HRESULT SoftwareRenderDevice::CreateInputLayout(const D3D11_INPUT_ELEMENT_DESC* pElements, UINT numElements, const void*, SIZE_T, ID3D11InputLayout** ppLayout)
+{
+    if (numElements > D3D11_IA_VERTEX_INPUT_STRUCTURE_ELEMENT_COUNT)
+    {
+        return E_INVALIDARG;
+    }
+
+    std::vector<SoftwareInputLayout::Element> elements;
+    UINT appendOffsets[D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT] = {};
+
+    // Resolve D3D11_APPEND_ALIGNED_ELEMENT the same way the input assembler does,
+    // each slot keeps its own running offset.
+    for (UINT i = 0; i < numElements; ++i)
+    {
+        const D3D11_INPUT_ELEMENT_DESC& kDesc = pElements[i];
+
+        UINT componentCount = GetComponentCount(kDesc.Format);
+        if (componentCount == 0 || kDesc.InputSlot >= D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT)
+        {
+            return E_INVALIDARG;
+        }
+
+        SoftwareInputLayout::Element element;
+        element.m_inputSlot = kDesc.InputSlot;
+        element.m_byteOffset = (kDesc.AlignedByteOffset == D3D11_APPEND_ALIGNED_ELEMENT) ? appendOffsets[kDesc.InputSlot] : kDesc.AlignedByteOffset;
+        element.m_componentCount = componentCount;
+        element.m_classification = kDesc.InputSlotClass;
+        element.m_instanceStepRate = kDesc.InstanceDataStepRate;
+
+        appendOffsets[kDesc.InputSlot] = element.m_byteOffset + componentCount * sizeof(float);
+        elements.push_back(element);
+    }
+
+    *ppLayout = new (std::nothrow) SoftwareInputLayout(std::move(elements));
+    return *ppLayout ? S_OK : E_OUTOFMEMORY;
+}
+
+HRESULT SoftwareRenderDevice::CreateDepthStencilState(const D3D11_DEPTH_STENCIL_DESC* pDesc, ID3D11DepthStencilState** ppState)
+{
+    *ppState = new (std::nothrow) SoftwareDepthStencilState(*pDesc);
+    return *ppState ? S_OK : E_OUTOFMEMORY;
+}
+
+HRESULT SoftwareRenderDevice::CreateRasterizerState(const D3D11_RASTERIZER_DESC* pDesc, ID3D11RasterizerState** ppState)
+{
+    *ppState = new (std::nothrow) SoftwareRasterizerState(*pDesc);
+    return *ppState ? S_OK : E_OUTOFMEMORY;
+}
+
+HRESULT SoftwareRenderDevice::CreateBlendState(const D3D11_BLEND_DESC* pDesc, ID3D11BlendState** ppState)
+{
+    *ppState = new (std::nothrow) SoftwareBlendState(*pDesc);
+    return *ppState ? S_OK : E_OUTOFMEMORY;
+}
+
+HRESULT SoftwareRenderDevice::CreateSamplerState(const D3D11_SAMPLER_DESC* pDesc, ID3D11SamplerState** ppState)
+{
+    *ppState = new (std::nothrow) SoftwareSamplerState(*pDesc);
+    return *ppState ? S_OK : E_OUTOFMEMORY;
+}
+
+HRESULT SoftwareRenderDevice::CreateQuery(const D3D11_QUERY_DESC* pDesc, ID3D11Query** ppQuery)
+{
+    // Event queries are the only kind the engine uses.
+    if (pDesc->Query != D3D11_QUERY_EVENT)
+    {
+        return E_INVALIDARG;
+    }
+
+    *ppQuery = new (std::nothrow) SoftwareQuery(*pDesc);
+    return *ppQuery ? S_OK : E_OUTOFMEMORY;
+}
+
+// The CPU backends have one context each, command lists are replayed onto it.
+HRESULT SoftwareRenderDevice::CreateDeferredContext(UINT, RenderContext**)
+{
+    return E_NOTIMPL;
+}
@@ -0,0 +1,305 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: StateObjectCache.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include <cstring>
+#include <iterator>
+
+#include "Graphics/StateObjectCache.h"
+
+namespace
+{
+    // The descriptions have padding (the UINT8 masks), so they are rebuilt field by field
+    // into zeroed memory before they are hashed or compared byte for byte.
+    D3D11_RASTERIZER_DESC MakeKey(const D3D11_RASTERIZER_DESC& kDesc)
+    {
+        D3D11_RASTERIZER_DESC key;
+        memset(&key, 0, sizeof(key));
+        key.FillMode = kDesc.FillMode;
+        key.CullMode = kDesc.CullMode;
+        key.FrontCounterClockwise = kDesc.FrontCounterClockwise ? TRUE : FALSE;
+        key.DepthBias = kDesc.DepthBias;
+        key.DepthBiasClamp = kDesc.DepthBiasClamp;
+        key.SlopeScaledDepthBias = kDesc.SlopeScaledDepthBias;
+        key.DepthClipEnable = kDesc.DepthClipEnable ? TRUE : FALSE;
+        key.ScissorEnable = kDesc.ScissorEnable ? TRUE : FALSE;
+        key.MultisampleEnable = kDesc.MultisampleEnable ? TRUE : FALSE;
+        key.AntialiasedLineEnable = kDesc.AntialiasedLineEnable ? TRUE : FALSE;
+        return key;
+    }
+
+    D3D11_DEPTH_STENCILOP_DESC MakeKey(const D3D11_DEPTH_STENCILOP_DESC& kDesc)
+    {
+        D3D11_DEPTH_STENCILOP_DESC key;
+        memset(&key, 0, sizeof(key));
+        key.StencilFailOp = kDesc.StencilFailOp;
+        key.StencilDepthFailOp = kDesc.StencilDepthFailOp;
+        key.StencilPassOp = kDesc.StencilPassOp;
+        key.StencilFunc = kDesc.StencilFunc;
+        return key;
+    }
+
+    D3D11_DEPTH_STENCIL_DESC MakeKey(const D3D11_DEPTH_STENCIL_DESC& kDesc)
+    {
+        D3D11_DEPTH_STENCIL_DESC key;
+        memset(&key, 0, sizeof(key));
+        key.DepthEnable = kDesc.DepthEnable ? TRUE : FALSE;
+        key.DepthWriteMask = kDesc.DepthWriteMask;
+        key.DepthFunc = kDesc.DepthFunc;
+        key.StencilEnable = kDesc.StencilEnable ? TRUE : FALSE;
+
+        // The stencil fields mean nothing with stencil off.
+        if (key.StencilEnable)
+        {
+            key.StencilReadMask = kDesc.StencilReadMask;
+            key.StencilWriteMask = kDesc.StencilWriteMask;
+            key.FrontFace = MakeKey(kDesc.FrontFace);
+            key.BackFace = MakeKey(kDesc.BackFace);
+        }
+        return key;
+    }
+
+    D3D11_RENDER_TARGET_BLEND_DESC MakeKey(const D3D11_RENDER_TARGET_BLEND_DESC& kDesc)
+    {
+        D3D11_RENDER_TARGET_BLEND_DESC key;
+        memset(&key, 0, sizeof(key));
+        key.BlendEnable = kDesc.BlendEnable ? TRUE : FALSE;
+        key.RenderTargetWriteMask = kDesc.RenderTargetWriteMask;
+
+        // The factors and operations mean nothing with blending off.
+        if (key.BlendEnable)
+        {
+            key.SrcBlend = kDesc.SrcBlend;
+            key.DestBlend = kDesc.DestBlend;
+            key.BlendOp = kDesc.BlendOp;
+            key.SrcBlendAlpha = kDesc.SrcBlendAlpha;
+            key.DestBlendAlpha = kDesc.DestBlendAlpha;
+            key.BlendOpAlpha = kDesc.BlendOpAlpha;
+        }
+        return key;
+    }
+
+    D3D11_BLEND_DESC MakeKey(const D3D11_BLEND_DESC& kDesc)
+    {
+        D3D11_BLEND_DESC key;
+        memset(&key, 0, sizeof(key));
+        key.AlphaToCoverageEnable = kDesc.AlphaToCoverageEnable ? TRUE : FALSE;
+        key.IndependentBlendEnable = kDesc.IndependentBlendEnable ? TRUE : FALSE;
+
+        // Without independent blending every target uses the first one.
+        unsigned int targetCount = key.IndependentBlendEnable ? 8 : 1;
+        for (unsigned int i = 0; i < targetCount; ++i)
+        {
+            key.RenderTarget[i] = MakeKey(kDesc.RenderTarget[i]);
+        }
+        return key;
+    }
+
+    D3D11_SAMPLER_DESC MakeKey(const D3D11_SAMPLER_DESC& kDesc)
+    {
+        D3D11_SAMPLER_DESC key;
+        memset(&key, 0, sizeof(key));
+        key.Filter = kDesc.Filter;
+        key.AddressU = kDesc.AddressU;
+        key.AddressV = kDesc.AddressV;
+        key.AddressW = kDesc.AddressW;
+        key.MipLODBias = kDesc.MipLODBias;
+        key.MaxAnisotropy = kDesc.MaxAnisotropy;
+        key.ComparisonFunc = kDesc.ComparisonFunc;
+        key.BorderColor[0] = kDesc.BorderColor[0];
+        key.BorderColor[1] = kDesc.BorderColor[1];
+        key.BorderColor[2] = kDesc.BorderColor[2];
+        key.BorderColor[3] = kDesc.BorderColor[3];
+        key.MinLOD = kDesc.MinLOD;
+        key.MaxLOD = kDesc.MaxLOD;
+        return key;
+    }
+
+    // 64 bit FNV-1a.
+    uint64_t HashBytes(const void* pData, size_t size)
+    {
+        const uint8_t* pBytes = static_cast<const uint8_t*>(pData);
+
+        uint64_t hash = 14695981039346656037ull;
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash ^= pBytes[i];
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+}
+
+StateObjectCache::StateObjectCache()
+    : m_pDevice(nullptr)
+    , m_hits(0)
+    , m_misses(0)
+    , m_objectCount(0)
+{
+}
+
+StateObjectCache::~StateObjectCache()
+{
+    Shutdown();
+}
+
+void StateObjectCache::Initialize(RenderDevice* pDevice)
+{
+    m_pDevice = pDevice;
+}
+
+void StateObjectCache::Shutdown()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    ReleaseTable(m_rasterizerStates);
+    ReleaseTable(m_depthStencilStates);
+    ReleaseTable(m_blendStates);
+    ReleaseTable(m_samplerStates);
+    m_objectCount = 0;
+}
+
+HRESULT StateObjectCache::GetRasterizerState(const D3D11_RASTERIZER_DESC& kDesc, ID3D11RasterizerState** ppState)
+{
+    return GetOrCreate(m_rasterizerStates, kDesc, ppState, [this](const D3D11_RASTERIZER_DESC* pDesc, ID3D11RasterizerState** ppNewState)
+    {
+        return m_pDevice->CreateRasterizerState(pDesc, ppNewState);
+    });
+}
+
+HRESULT StateObjectCache::GetDepthStencilState(const D3D11_DEPTH_STENCIL_DESC& kDesc, ID3D11DepthStencilState** ppState)
+{
+    return GetOrCreate(m_depthStencilStates, kDesc, ppState, [this](const D3D11_DEPTH_STENCIL_DESC* pDesc, ID3D11DepthStencilState** ppNewState)
+    {
+        return m_pDevice->CreateDepthStencilState(pDesc, ppNewState);
+    });
+}
+
+HRESULT StateObjectCache::GetBlendState(const D3D11_BLEND_DESC& kDesc, ID3D11BlendState** ppState)
+{
+    return GetOrCreate(m_blendStates, kDesc, ppState, [this](const D3D11_BLEND_DESC* pDesc, ID3D11BlendState** ppNewState)
+    {
+        return m_pDevice->CreateBlendState(pDesc, ppNewState);
+    });
+}
+
+HRESULT StateObjectCache::GetSamplerState(const D3D11_SAMPLER_DESC& kDesc, ID3D11SamplerState** ppState)
+{
+    return GetOrCreate(m_samplerStates, kDesc, ppState, [this](const D3D11_SAMPLER_DESC* pDesc, ID3D11SamplerState** ppNewState)
+    {
+        return m_pDevice->CreateSamplerState(pDesc, ppNewState);
+    });
+}
+
+unsigned int StateObjectCache::Trim()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    unsigned int releasedCount = TrimTable(m_rasterizerStates) + TrimTable(m_depthStencilStates) + TrimTable(m_blendStates) + TrimTable(m_samplerStates);
+    m_objectCount -= releasedCount;
+
+    return releasedCount;
+}
+
+StateObjectCacheStats StateObjectCache::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    StateObjectCacheStats stats;
+    stats.m_hits = m_hits;
+    stats.m_misses = m_misses;
+    stats.m_objectCount = m_objectCount;
+    return stats;
+}
+
+template<typename Desc, typename State, typename CreateFunction>
+HRESULT StateObjectCache::GetOrCreate(Table<Desc, State>& table, const Desc& kDesc, State** ppState, CreateFunction create)
+{
+    Desc key = MakeKey(kDesc);
+    uint64_t hash = HashBytes(&key, sizeof(key));
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::vector<Entry<Desc, State>>& entries = table[hash];
+    for (const Entry<Desc, State>& kEntry : entries)
+    {
+        if (memcmp(&kEntry.m_desc, &key, sizeof(key)) == 0)
+        {
+            ++m_hits;
+            kEntry.m_pState->AddRef();
+            *ppState = kEntry.m_pState;
+            return S_OK;
+        }
+    }
+
+    ++m_misses;
+
+    // Create from the caller's description, the key has the ignored fields zeroed.
+    State* pState = nullptr;
+    HRESULT result = create(&kDesc, &pState);
+    if (FAILED(result))
+    {
+        *ppState = nullptr;
+        return result;
+    }
+
+    Entry<Desc, State> entry;
+    entry.m_desc = key;
+    entry.m_pState = pState;
+    entries.push_back(entry);
+    ++m_objectCount;
+
+    // One reference for the cache, one for the caller.
+    pState->AddRef();
+    *ppState = pState;
+
+    return S_OK;
+}
+
+//-----------------------------------------------------------------
+// Release() returns what is left, so a reference taken and given
+// back tells whether the cache holds the only other one.
+//-----------------------------------------------------------------
+template<typename Desc, typename State>
+unsigned int StateObjectCache::TrimTable(Table<Desc, State>& table)
+{
+    unsigned int releasedCount = 0;
+
+    for (typename Table<Desc, State>::iterator it = table.begin(); it != table.end();)
+    {
+        std::vector<Entry<Desc, State>>& entries = it->second;
+        for (size_t i = 0; i < entries.size();)
+        {
+            State* pState = entries[i].m_pState;
+            pState->AddRef();
+            if (pState->Release() == 1)
+            {
+                pState->Release();
+                entries[i] = entries.back();
+                entries.pop_back();
+                ++releasedCount;
+            }
+            else
+            {
+                ++i;
+            }
+        }
+
+        it = entries.empty() ? table.erase(it) : std::next(it);
+    }
+
+    return releasedCount;
+}
+
+template<typename Desc, typename State>
+void StateObjectCache::ReleaseTable(Table<Desc, State>& table)
+{
+    for (std::pair<const uint64_t, std::vector<Entry<Desc, State>>>& bucket : table)
+    {
+        for (Entry<Desc, State>& entry : bucket.second)
+        {
+            entry.m_pState->Release();
+        }
+    }
+
+    table.clear();
+}
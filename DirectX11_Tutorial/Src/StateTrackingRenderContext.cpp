@@ -0,0 +1,367 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: StateTrackingRenderContext.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include <cstring>
+
+#include "Graphics/StateTrackingRenderContext.h"
+#include "Graphics/RenderStats.h"
+
+StateTrackingRenderContext::StateTrackingRenderContext(RenderContext* pContext)
+    : m_pContext(pContext)
+{
+    Invalidate();
+    ResetCounters();
+}
+
+void StateTrackingRenderContext::ClearRenderTargetView(ID3D11RenderTargetView* pView, const FLOAT color[4])
+{
+    m_pContext->ClearRenderTargetView(pView, color);
+}
+
+void StateTrackingRenderContext::ClearDepthStencilView(ID3D11DepthStencilView* pView, UINT clearFlags, FLOAT depth, UINT8 stencil)
+{
+    m_pContext->ClearDepthStencilView(pView, clearFlags, depth, stencil);
+}
+
+void StateTrackingRenderContext::OMSetRenderTargets(UINT numViews, ID3D11RenderTargetView* const* ppViews, ID3D11DepthStencilView* pDepthStencilView)
+{
+    bool changed = !m_renderTargetsKnown || numViews != m_renderTargetCount || pDepthStencilView != m_pDepthStencilView || numViews > kMaxRenderTargets;
+    for (UINT i = 0; !changed && i < numViews; ++i)
+    {
+        changed = (ppViews[i] != m_pRenderTargets[i]);
+    }
+
+    if (!ShouldIssue(changed))
+    {
+        return;
+    }
+
+    m_renderTargetsKnown = (numViews <= kMaxRenderTargets);
+    m_renderTargetCount = numViews;
+    m_pDepthStencilView = pDepthStencilView;
+    for (UINT i = 0; i < numViews && i < kMaxRenderTargets; ++i)
+    {
+        m_pRenderTargets[i] = ppViews[i];
+    }
+
+    m_pContext->OMSetRenderTargets(numViews, ppViews, pDepthStencilView);
+}
+
+void StateTrackingRenderContext::OMSetDepthStencilState(ID3D11DepthStencilState* pState, UINT stencilRef)
+{
+    if (!ShouldIssue(!m_depthStencilStateKnown || pState != m_pDepthStencilState || stencilRef != m_stencilRef))
+    {
+        return;
+    }
+
+    m_depthStencilStateKnown = true;
+    m_pDepthStencilState = pState;
+    m_stencilRef = stencilRef;
+
+    m_pContext->OMSetDepthStencilState(pState, stencilRef);
+}
+
+void StateTrackingRenderContext::RSSetState(ID3D11RasterizerState* pState)
+{
+    if (!ShouldIssue(!m_rasterizerStateKnown || pState != m_pRasterizerState))
+    {
+        return;
+    }
+
+    m_rasterizerStateKnown = true;
+    m_pRasterizerState = pState;
+
+    m_pContext->RSSetState(pState);
+}
+
+void StateTrackingRenderContext::RSSetViewports(UINT numViewports, const D3D11_VIEWPORT* pViewports)
+{
+    bool changed = !m_viewportsKnown || numViewports != m_viewportCount || numViewports > kMaxViewports ||
+        memcmp(pViewports, m_viewports, sizeof(D3D11_VIEWPORT) * numViewports) != 0;
+
+    if (!ShouldIssue(changed))
+    {
+        return;
+    }
+
+    m_viewportsKnown = (numViewports <= kMaxViewports);
+    m_viewportCount = numViewports;
+    if (m_viewportsKnown)
+    {
+        memcpy(m_viewports, pViewports, sizeof(D3D11_VIEWPORT) * numViewports);
+    }
+
+    m_pContext->RSSetViewports(numViewports, pViewports);
+}
+
+void StateTrackingRenderContext::IASetInputLayout(ID3D11InputLayout* pLayout)
+{
+    if (!ShouldIssue(!m_inputLayoutKnown || pLayout != m_pInputLayout))
+    {
+        return;
+    }
+
+    m_inputLayoutKnown = true;
+    m_pInputLayout = pLayout;
+
+    m_pContext->IASetInputLayout(pLayout);
+}
+
+//-----------------------------------------------------------------
+// The whole range goes through when any slot in it changes, D3D11
+// binds a range in one call anyway.
+//-----------------------------------------------------------------
+void StateTrackingRenderContext::IASetVertexBuffers(UINT startSlot, UINT numBuffers, ID3D11Buffer* const* ppBuffers, const UINT* pStrides, const UINT* pOffsets)
+{
+    bool changed = (startSlot + numBuffers > kVertexBufferSlots);
+    for (UINT i = 0; !changed && i < numBuffers; ++i)
+    {
+        const VertexBufferBinding& kBinding = m_vertexBuffers[startSlot + i];
+        changed = !m_vertexBuffersKnown[startSlot + i] || ppBuffers[i] != kBinding.m_pBuffer || pStrides[i] != kBinding.m_stride || pOffsets[i] != kBinding.m_offset;
+    }
+
+    if (!ShouldIssue(changed))
+    {
+        return;
+    }
+
+    for (UINT i = 0; i < numBuffers && startSlot + i < kVertexBufferSlots; ++i)
+    {
+        VertexBufferBinding& binding = m_vertexBuffers[startSlot + i];
+        binding.m_pBuffer = ppBuffers[i];
+        binding.m_stride = pStrides[i];
+        binding.m_offset = pOffsets[i];
+        m_vertexBuffersKnown[startSlot + i] = true;
+    }
+
+    m_pContext->IASetVertexBuffers(startSlot, numBuffers, ppBuffers, pStrides, pOffsets);
+}
+
+void StateTrackingRenderContext::IASetIndexBuffer(ID3D11Buffer* pBuffer, DXGI_FORMAT format, UINT offset)
+{
+    if (!ShouldIssue(!m_indexBufferKnown || pBuffer != m_pIndexBuffer || format != m_indexFormat || offset != m_indexOffset))
+    {
+        return;
+    }
+
+    m_indexBufferKnown = true;
+    m_pIndexBuffer = pBuffer;
+    m_indexFormat = format;
+    m_indexOffset = offset;
+
+    m_pContext->IASetIndexBuffer(pBuffer, format, offset);
+}
+
+void StateTrackingRenderContext::IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY topology)
+{
+    if (!ShouldIssue(!m_topologyKnown || topology != m_topology))
+    {
+        return;
+    }
+
+    m_topologyKnown = true;
+    m_topology = topology;
+
+    m_pContext->IASetPrimitiveTopology(topology);
+}
+
+void StateTrackingRenderContext::VSSetShader(ID3D11VertexShader* pShader, ID3D11ClassInstance* const* ppClassInstances, UINT numClassInstances)
+{
+    if (!ShouldIssue(!m_vertexShaderKnown || pShader != m_pVertexShader || numClassInstances > 0))
+    {
+        return;
+    }
+
+    m_vertexShaderKnown = (numClassInstances == 0);
+    m_pVertexShader = pShader;
+
+    m_pContext->VSSetShader(pShader, ppClassInstances, numClassInstances);
+}
+
+void StateTrackingRenderContext::PSSetShader(ID3D11PixelShader* pShader, ID3D11ClassInstance* const* ppClassInstances, UINT numClassInstances)
+{
+    if (!ShouldIssue(!m_pixelShaderKnown || pShader != m_pPixelShader || numClassInstances > 0))
+    {
+        return;
+    }
+
+    m_pixelShaderKnown = (numClassInstances == 0);
+    m_pPixelShader = pShader;
+
+    m_pContext->PSSetShader(pShader, ppClassInstances, numClassInstances);
+}
+
+//-----------------------------------------------------------------
+// A constant buffer rewritten with Map(WRITE_DISCARD) stays bound,
+// so binding the same buffer again every draw is never needed.
+//-----------------------------------------------------------------
+void StateTrackingRenderContext::VSSetConstantBuffers(UINT startSlot, UINT numBuffers, ID3D11Buffer* const* ppBuffers)
+{
+    if (!ShouldIssue(ConstantBuffersChanged(startSlot, numBuffers, ppBuffers, nullptr, nullptr)))
+    {
+        return;
+    }
+
+    StoreConstantBuffers(startSlot, numBuffers, ppBuffers, nullptr, nullptr);
+    m_pContext->VSSetConstantBuffers(startSlot, numBuffers, ppBuffers);
+}
+
+//-----------------------------------------------------------------
+// Binds into the constant upload ring use the same buffer with a
+// new window almost every draw, the window is part of the binding.
+//-----------------------------------------------------------------
+void StateTrackingRenderContext::VSSetConstantBuffers1(UINT startSlot, UINT numBuffers, ID3D11Buffer* const* ppBuffers, const UINT* pFirstConstant, const UINT* pNumConstants)
+{
+    if (!ShouldIssue(ConstantBuffersChanged(startSlot, numBuffers, ppBuffers, pFirstConstant, pNumConstants)))
+    {
+        return;
+    }
+
+    StoreConstantBuffers(startSlot, numBuffers, ppBuffers, pFirstConstant, pNumConstants);
+    m_pContext->VSSetConstantBuffers1(startSlot, numBuffers, ppBuffers, pFirstConstant, pNumConstants);
+}
+
+HRESULT StateTrackingRenderContext::Map(ID3D11Resource* pResource, UINT subresource, D3D11_MAP mapType, UINT mapFlags, D3D11_MAPPED_SUBRESOURCE* pMappedResource)
+{
+    return m_pContext->Map(pResource, subresource, mapType, mapFlags, pMappedResource);
+}
+
+void StateTrackingRenderContext::Unmap(ID3D11Resource* pResource, UINT subresource)
+{
+    m_pContext->Unmap(pResource, subresource);
+}
+
+void StateTrackingRenderContext::UpdateSubresource(ID3D11Resource* pResource, UINT subresource, const D3D11_BOX* pBox, const void* pSourceData, UINT sourceRowPitch, UINT sourceDepthPitch)
+{
+    m_pContext->UpdateSubresource(pResource, subresource, pBox, pSourceData, sourceRowPitch, sourceDepthPitch);
+}
+
+void StateTrackingRenderContext::DrawIndexed(UINT indexCount, UINT startIndexLocation, INT baseVertexLocation)
+{
+    m_pContext->DrawIndexed(indexCount, startIndexLocation, baseVertexLocation);
+}
+
+void StateTrackingRenderContext::DrawIndexedInstanced(UINT indexCountPerInstance, UINT instanceCount, UINT startIndexLocation, INT baseVertexLocation, UINT startInstanceLocation)
+{
+    m_pContext->DrawIndexedInstanced(indexCountPerInstance, instanceCount, startIndexLocation, baseVertexLocation, startInstanceLocation);
+}
+
+void StateTrackingRenderContext::End(ID3D11Asynchronous* pAsync)
+{
+    m_pContext->End(pAsync);
+}
+
+HRESULT StateTrackingRenderContext::GetData(ID3D11Asynchronous* pAsync, void* pData, UINT dataSize, UINT getDataFlags)
+{
+    return m_pContext->GetData(pAsync, pData, dataSize, getDataFlags);
+}
+
+HRESULT StateTrackingRenderContext::FinishCommandList(BOOL restoreDeferredContextState, ID3D11CommandList** ppCommandList)
+{
+    // Without the restore a deferred context starts over from the default state.
+    if (!restoreDeferredContextState)
+    {
+        Invalidate();
+    }
+
+    return m_pContext->FinishCommandList(restoreDeferredContextState, ppCommandList);
+}
+
+// Executing without the restore leaves the context in the default state,
+// with it the state is put back. The binds in the list aren't known either way.
+void StateTrackingRenderContext::ExecuteCommandList(ID3D11CommandList* pCommandList, BOOL restoreContextState)
+{
+    if (!restoreContextState)
+    {
+        Invalidate();
+    }
+
+    m_pContext->ExecuteCommandList(pCommandList, restoreContextState);
+}
+
+void StateTrackingRenderContext::Flush()
+{
+    m_pContext->Flush();
+}
+
+void StateTrackingRenderContext::Invalidate()
+{
+    m_renderTargetsKnown = false;
+    m_depthStencilStateKnown = false;
+    m_rasterizerStateKnown = false;
+    m_viewportsKnown = false;
+    m_inputLayoutKnown = false;
+    m_indexBufferKnown = false;
+    m_topologyKnown = false;
+    m_vertexShaderKnown = false;
+    m_pixelShaderKnown = false;
+
+    for (bool& known : m_vertexBuffersKnown)
+    {
+        known = false;
+    }
+
+    for (bool& known : m_constantBuffersKnown)
+    {
+        known = false;
+    }
+}
+
+const StateTrackingCounters& StateTrackingRenderContext::GetCounters() const
+{
+    return m_counters;
+}
+
+void StateTrackingRenderContext::ResetCounters()
+{
+    m_counters = StateTrackingCounters();
+}
+
+bool StateTrackingRenderContext::ShouldIssue(bool changed)
+{
+    if (changed)
+    {
+        ++m_counters.m_issuedBinds;
+        RenderStats::AddIssuedStateBinds(1);
+    }
+    else
+    {
+        ++m_counters.m_elidedBinds;
+    }
+
+    return changed;
+}
+
+bool StateTrackingRenderContext::ConstantBuffersChanged(UINT startSlot, UINT numBuffers, ID3D11Buffer* const* ppBuffers, const UINT* pFirstConstant, const UINT* pNumConstants) const
+{
+    if (startSlot + numBuffers > kConstantBufferSlots)
+    {
+        return true;
+    }
+
+    for (UINT i = 0; i < numBuffers; ++i)
+    {
+        UINT slot = startSlot + i;
+        UINT first = pFirstConstant ? pFirstConstant[i] : 0;
+        UINT count = pNumConstants ? pNumConstants[i] : kWholeConstantBuffer;
+
+        if (!m_constantBuffersKnown[slot] || ppBuffers[i] != m_pConstantBuffers[slot] || first != m_constantBufferFirst[slot] || count != m_constantBufferCount[slot])
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void StateTrackingRenderContext::StoreConstantBuffers(UINT startSlot, UINT numBuffers, ID3D11Buffer* const* ppBuffers, const UINT* pFirstConstant, const UINT* pNumConstants)
+{
+    for (UINT i = 0; i < numBuffers && startSlot + i < kConstantBufferSlots; ++i)
+    {
+        UINT slot = startSlot + i;
+        m_pConstantBuffers[slot] = ppBuffers[i];
+        m_constantBufferFirst[slot] = pFirstConstant ? pFirstConstant[i] : 0;
+        m_constantBufferCount[slot] = pNumConstants ? pNumConstants[i] : kWholeConstantBuffer;
+        m_constantBuffersKnown[slot] = true;
+    }
+}
@@ -2,14 +2,42 @@
 // Filename: System.cpp
 //////////////////////////////////////////////////////////////////////
 
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include <windowsx.h>
+
 #include "System/System.h"
+#include "System/Win32Platform.h"
+#include "System/HeadlessPlatform.h"
+#include "System/Profiler.h"
+#include "Graphics/RenderStats.h"
+
+namespace
+{
+    // When windows posted the message being handled. The message time is only
+    // millisecond accurate but tells how long the message sat in the queue.
+    std::chrono::steady_clock::time_point GetMessageTimestamp()
+    {
+        DWORD messageAge = GetTickCount() - static_cast<DWORD>(GetMessageTime());
+        return std::chrono::steady_clock::now() - std::chrono::milliseconds(messageAge);
+    }
+}
 
 System::System()
-    : m_applicationName(nullptr)
-    , m_hInstance(nullptr)
-    , m_hwnd(nullptr)
+    : m_pPlatform(nullptr)
+    , m_pJobSystem(nullptr)
     , m_pInput(nullptr)
     , m_pGraphics(nullptr)
+    , m_pMetricsExporter(nullptr)
+    , m_quitRequested(false)
+    , m_renderThreadRunning(false)
+    , m_runFailed(false)
+    , m_syntheticInputRate(0)
+    , m_syntheticInputCount(0)
+    , m_profileFirstFrame(0)
+    , m_profileLastFrame(0)
 {
 }
 
@@ -24,16 +52,26 @@ System::~System()
 {
 }
 
-bool System::Initialize()
+bool System::Initialize(const SystemSettings& kSettings)
 {
     // Initialize the width and height of the screen to zero before sending the variables into the function.
     int screenWidth(0);
     int screenHeight(0);
 
-    // Initialize the windows api.
-    InitializeWindows(screenWidth, screenHeight);
+    // Create the job system object. Every subsystem can split its work into jobs with it.
+    m_pJobSystem = std::make_unique<JobSystem>();
+    if (!m_pJobSystem)
+    {
+        return false;
+    }
 
-    // Create the input object. This object will be used to handle reading the keyboard input from the user.
+    if (!m_pJobSystem->Initialize(kSettings.m_jobWorkers ? kSettings.m_jobWorkers : JobSystem::GetDefaultWorkerCount()))
+    {
+        return false;
+    }
+
+    // Create the input object. This object will be used to handle reading the keyboard and mouse input from the user.
+    // It is created before the window so no message finds it missing.
     m_pInput = std::make_unique<Input>();
     if (!m_pInput)
     {
@@ -42,6 +80,50 @@ bool System::Initialize()
 
     // Initialize the input objects.
     m_pInput->Initialize();
+    m_syntheticInputRate = kSettings.m_syntheticInputRate;
+    m_syntheticInputCount = 0;
+
+    // Create the metrics exporter if the run should write its frame time percentiles as it goes.
+    if (!kSettings.m_metricsFileName.empty())
+    {
+        m_pMetricsExporter = std::make_unique<MetricsExporter>();
+        if (!m_pMetricsExporter->Initialize(kSettings.m_metricsFileName, kSettings.m_metricsFormat, kSettings.m_metricsInterval, m_pJobSystem.get()))
+        {
+            return false;
+        }
+    }
+
+    m_profileFileName = kSettings.m_profileFileName;
+    m_profileFirstFrame = kSettings.m_profileFirstFrame;
+    m_profileLastFrame = kSettings.m_profileLastFrame;
+
+    if (!kSettings.m_recordFileName.empty() && !m_pInput->StartRecording(kSettings.m_recordFileName.c_str()))
+    {
+        return false;
+    }
+
+    if (!kSettings.m_replayFileName.empty() && !m_pInput->StartReplay(kSettings.m_replayFileName.c_str()))
+    {
+        return false;
+    }
+
+    // Create the platform object. A headless run has no window and stops by itself.
+    if (kSettings.m_headless)
+    {
+        m_pPlatform = std::make_unique<HeadlessPlatform>(kSettings.m_screenWidth, kSettings.m_screenHeight,
+            kSettings.m_frameCount, kSettings.m_seconds, kSettings.m_resultsFileName);
+    }
+    else
+    {
+        m_pPlatform = std::make_unique<Win32Platform>(*this, kSettings.m_screenWidth, kSettings.m_screenHeight);
+    }
+
+    // Initialize the windows api.
+    if (!m_pPlatform->Initialize(screenWidth, screenHeight))
+    {
+        return false;
+    }
+
 
     // Create the graphics object. This object will handle rendering all the graphics for this application.
     m_pGraphics = std::make_unique<Graphics>();
@@ -50,12 +132,24 @@ bool System::Initialize()
         return false;
     }
 
-    // Initialize the graphics object.
-    if(!m_pGraphics->Initialize(screenWidth, screenHeight, m_hwnd))
+    // Initialize the graphics object with the size the platform ended up with.
+    GraphicsSettings graphicsSettings;
+    graphicsSettings.m_screenWidth = screenWidth;
+    graphicsSettings.m_screenHeight = screenHeight;
+    graphicsSettings.m_backend = kSettings.m_backend;
+    graphicsSettings.m_pipelineDepth = kSettings.m_pipelineDepth;
+    graphicsSettings.m_simulationRate = kSettings.m_simulationRate;
+    graphicsSettings.m_pacing = kSettings.m_pacing;
+    graphicsSettings.m_instanceCount = kSettings.m_instanceCount;
+    graphicsSettings.m_separateDraws = kSettings.m_separateDraws;
+
+    if(!m_pGraphics->Initialize(m_pPlatform->GetWindowHandle(), m_pJobSystem.get(), graphicsSettings))
     {
         return false;
     }
 
+    m_pGraphics->SetFixedFrameTime(kSettings.m_fixedFrameSeconds);
+
     return true;
 }
 
@@ -65,6 +159,26 @@ bool System::Initialize()
 //-----------------------------------------------------------------
 void System::Shutdown()
 {
+    // End the recording first, it is the one thing a failed write makes useless.
+    if (m_pInput && !m_pInput->StopRecording())
+    {
+        char line[128];
+        sprintf_s(line, sizeof(line), "input: writing the recording failed, it is incomplete (%llu frames run)\n", m_pInput->GetFrameIndex());
+        fputs(line, stdout);
+        OutputDebugStringA(line);
+    }
+
+    ReportStats();
+    ReportProfile();
+
+    // Write the final metrics while the job system is still there.
+    if (m_pMetricsExporter)
+    {
+        m_pMetricsExporter->Shutdown(m_frameMetrics);
+        m_pMetricsExporter.reset();
+        m_pMetricsExporter = nullptr;
+    }
+
     // Release the graphics object.
     if (m_pGraphics)
     {
@@ -73,265 +187,495 @@ void System::Shutdown()
         m_pGraphics = nullptr;
     }
 
-    // Release the input object
+    // Shutdown the window.
+    if (m_pPlatform)
+    {
+        m_pPlatform->Shutdown();
+        m_pPlatform.reset();
+        m_pPlatform = nullptr;
+    }
+
+    // Release the input object once the window can't send it anything.
     if (m_pInput)
     {
+        m_pInput->Shutdown();
         m_pInput.reset();
         m_pInput = nullptr;
     }
 
-    // Shutdown the window.
-    ShutdownWindows();
+    // Release the job system object.
+    if (m_pJobSystem)
+    {
+        m_pJobSystem->Shutdown();
+        m_pJobSystem.reset();
+        m_pJobSystem = nullptr;
+    }
+
+    // Every profiled thread has stopped by now.
+    Profiler::Shutdown();
 }
 
 //-----------------------------------------------------------------
 // Where our application will loop and to all the
 // application processing until we decide to quit.
 //
+// The calling thread handles the windows messages and the frames
+// run on a render thread.
+//
 // While not done
-//    - Check for windows system message
-//    - Process system messages
-//    - Process application loop
-//    - Check if user wanted to quit during the
-//      frame processing.
+//    - Handle every waiting system message
+//    - Wait for more messages (or the render thread to stop)
+//    - Check if the window or the render thread wants to quit
+//-----------------------------------------------------------------
+bool System::Run()
+{
+    m_quitRequested = false;
+    m_renderThreadRunning = true;
+    m_runFailed = false;
+
+    std::thread renderThread(&System::RenderThreadMain, this);
+
+    // Loop until there is a quit message from the window or the render thread stops.
+    while (m_renderThreadRunning)
+    {
+        if (!m_pPlatform->PumpMessages())
+        {
+            break;
+        }
+
+        if (m_syntheticInputRate > 0)
+        {
+            InjectSyntheticInput();
+        }
+
+        m_pPlatform->WaitForMessages(1);
+    }
+
+    m_quitRequested = true;
+
+    // Keep the messages moving while the render thread finishes, Present() can
+    // send messages to the window and would wait for us otherwise.
+    while (m_renderThreadRunning)
+    {
+        m_pPlatform->PumpMessages();
+        m_pPlatform->WaitForMessages(1);
+    }
+
+    renderThread.join();
+
+    // A recording that couldn't be written fails the run, its last writes only fail now.
+    // Shutdown() reports it.
+    if (!m_pInput->StopRecording())
+    {
+        m_runFailed = true;
+    }
+
+    return !m_runFailed;
+}
+
+//-----------------------------------------------------------------
+// Runs frames until the window thread asks to quit, the user
+// quits during the frame processing, the platform ends the run,
+// a replay runs out or the input can't be recorded.
 //-----------------------------------------------------------------
-void System::Run()
+void System::RenderThreadMain()
 {
-    MSG msg;
-    bool done(false);
-    bool result(false);
+    PROFILE_THREAD("Render");
 
-    // Initialize the message structure
-    ZeroMemory(&msg, sizeof(MSG));
+    std::chrono::steady_clock::time_point lastFrameEndTime = std::chrono::steady_clock::now();
+    bool firstFrame = true;
 
-    // Loop until there is a quit message from the window or the user.
-    while (!done)
+    while (!m_quitRequested)
     {
-        // Handle the windows message.
-        if (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE))
+        // A replay stops on the frame the recorded run stopped at.
+        if (m_pInput->IsReplayFinished())
+        {
+            char line[128];
+            sprintf_s(line, sizeof(line), "input: replay finished after %llu frames\n", m_pInput->GetFrameIndex());
+            fputs(line, stdout);
+            OutputDebugStringA(line);
+            break;
+        }
+
+        PROFILE_FRAME();
+        PROFILE_SCOPE("Frame");
+        RenderStats::BeginFrame();
+
+        // Let the frame pacer hold the frame back before it reads any input.
+        m_pGraphics->BeginFrame();
+
+        // Take the input that arrived since the last frame. A frame that couldn't be recorded
+        // ends the run, Shutdown() reports it.
+        if (!m_pInput->BeginFrame())
+        {
+            m_runFailed = true;
+            break;
+        }
+
+        // Check if the user pressed escape and wants to exit the application.
+        if (m_pInput->IsKeyDown(VK_ESCAPE))
         {
-            TranslateMessage(&msg);
-            DispatchMessage(&msg);
+            break;
         }
 
-        // If windows signals to end the application then exit out.
-        if (msg.message == WM_QUIT)
+        if (!Frame())
         {
-            done = true;
+            m_runFailed = true;
+            break;
         }
-        else
+
+        m_pInput->EndFrame();
+
+        // The first frame also pays for everything that warms up, leave it out.
+        std::chrono::steady_clock::time_point frameEndTime = std::chrono::steady_clock::now();
+        if (!firstFrame)
         {
-            // Otherwise do the frame processing.
-            result = Frame();
-            if (!result)
+            const FrameTimes& kFrameTimes = m_pGraphics->GetLastFrameTimes();
+            m_frameMetrics.Record(std::chrono::duration<double>(frameEndTime - lastFrameEndTime).count(), kFrameTimes.m_updateSeconds, kFrameTimes.m_submitSeconds);
+
+            if (m_pMetricsExporter)
             {
-                done = true;
+                m_pMetricsExporter->Update(m_frameMetrics);
             }
         }
+        lastFrameEndTime = frameEndTime;
+        firstFrame = false;
+
+        if (!m_pPlatform->FrameCompleted())
+        {
+            break;
+        }
     }
+
+    m_renderThreadRunning = false;
 }
 
 //-----------------------------------------------------------------
-// Where all the processing for our application is done.
+// Queues keyboard and mouse events the way a busy window would,
+// for measuring input latency on a headless run. Only letter keys
+// are used so escape never ends the run.
 //-----------------------------------------------------------------
-bool System::Frame()
+void System::InjectSyntheticInput()
 {
-    // Check if the user pressed excape and wants to exti the application.
-    if (m_pInput->IsKeyDown(VK_ESCAPE))
-    {
-        return false;
-    }
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
 
-    // Do the frame processing for the graphics object.
-    if (!m_pGraphics->Frame())
+    for (unsigned int i = 0; i < m_syntheticInputRate; ++i)
     {
-        return false;
-    }
+        unsigned int index = m_syntheticInputCount++;
 
-    return true;
+        InputEvent event;
+        event.m_code = 'A' + (index / 2) % 26;
+        event.m_x = static_cast<int>(index % 800);
+        event.m_y = static_cast<int>(index % 600);
+        event.m_timestamp = now;
+
+        // Alternate key presses and releases with mouse moves in between.
+        switch (index % 3)
+        {
+        case 0:
+            event.m_type = InputEvent::Type::KeyDown;
+            break;
+        case 1:
+            event.m_type = InputEvent::Type::MouseMove;
+            break;
+        default:
+            event.m_type = InputEvent::Type::KeyUp;
+            break;
+        }
+
+        m_pInput->PushEvent(event);
+    }
 }
 
 //-----------------------------------------------------------------
-// Where we direct the windows system message into.
+// Prints the input-to-submit and update-to-submit latencies,
+// the simulation step cost, the frame pacing, the frame time
+// percentiles, on the null backend its calls per frame and on
+// the software backend how long the last frame's tiles took.
 //-----------------------------------------------------------------
-LRESULT System::MessageHandler(HWND hwnd, UINT umsg, WPARAM wparam, LPARAM lparam)
+void System::ReportStats() const
 {
-    switch (umsg)
+    char report[8192];
+    int length = 0;
+
+    if (m_pInput)
     {
-    // Check if a key has been pressed on the keyboard.
-    case WM_KEYDOWN:
+        InputLatencyStats stats = m_pInput->GetLatencyStats();
+
+        length += sprintf_s(report + length, sizeof(report) - length,
+            "input_events: %llu\n"
+            "input_events_dropped: %u\n"
+            "input_latency_average_ms: %.4f\n"
+            "input_latency_max_ms: %.4f\n",
+            stats.m_eventCount, stats.m_droppedEventCount, stats.m_averageLatencySeconds * 1000.0, stats.m_maxLatencySeconds * 1000.0);
+    }
+
+    if (m_pGraphics)
     {
-        // If a key is pressed send it to the input object so it can recore that state.
-        m_pInput->KeyDown(static_cast<unsigned int>(wparam));
-        return 0;
+        FramePipelineStats stats = m_pGraphics->GetPipelineStats();
+
+        length += sprintf_s(report + length, sizeof(report) - length,
+            "pipeline_depth: %u\n"
+            "pipeline_latency_average_ms: %.4f\n"
+            "pipeline_latency_max_ms: %.4f\n",
+            stats.m_pipelineDepth, stats.m_averageLatencySeconds * 1000.0, stats.m_maxLatencySeconds * 1000.0);
+
+        FixedTimestepStats simulationStats = m_pGraphics->GetSimulationStats();
+
+        length += sprintf_s(report + length, sizeof(report) - length,
+            "simulation_rate_hz: %.2f\n"
+            "simulation_steps: %llu\n"
+            "simulation_step_average_ms: %.4f\n"
+            "simulation_step_max_ms: %.4f\n"
+            "simulation_dropped_ms: %.4f\n",
+            1.0 / simulationStats.m_stepSeconds, simulationStats.m_stepCount,
+            simulationStats.m_averageStepCostSeconds * 1000.0, simulationStats.m_maxStepCostSeconds * 1000.0,
+            simulationStats.m_droppedSeconds * 1000.0);
+
+        FramePacingStats pacingStats = m_pGraphics->GetPacingStats();
+
+        length += sprintf_s(report + length, sizeof(report) - length,
+            "frame_time_average_ms: %.4f\n"
+            "frame_time_stddev_ms: %.4f\n"
+            "queued_latency_average_ms: %.4f\n"
+            "queued_latency_max_ms: %.4f\n",
+            pacingStats.m_averageFrameSeconds * 1000.0, std::sqrt(pacingStats.m_frameTimeVariance) * 1000.0,
+            pacingStats.m_averageQueuedLatencySeconds * 1000.0, pacingStats.m_maxQueuedLatencySeconds * 1000.0);
     }
-    break;
 
-    // Check if a key has been released on the keyboard.
-    case WM_KEYUP:
+    FrameMetricsSnapshot snapshot = m_frameMetrics.GetSnapshot();
+    const char* kSeriesNames[] = { "frame", "update", "submit" };
+    const FrameTimeSummary* kSeries[] = { &snapshot.m_frame, &snapshot.m_update, &snapshot.m_submit };
+
+    for (size_t i = 0; i < 3 && snapshot.m_frame.m_count > 0; ++i)
     {
-        // If a key is release then send it to the input object so it can unset the state for that key.
-        m_pInput->KeyUp(static_cast<unsigned int>(wparam));
-        return 0;
+        const FrameTimeSummary& kSummary = *kSeries[i];
+        const char* pName = kSeriesNames[i];
+
+        length += sprintf_s(report + length, sizeof(report) - length,
+            "%s_p50_ms: %.4f\n"
+            "%s_p95_ms: %.4f\n"
+            "%s_p99_ms: %.4f\n"
+            "%s_p999_ms: %.4f\n"
+            "%s_stutters: %llu\n",
+            pName, kSummary.m_p50Seconds * 1000.0, pName, kSummary.m_p95Seconds * 1000.0, pName, kSummary.m_p99Seconds * 1000.0,
+            pName, kSummary.m_p999Seconds * 1000.0, pName, static_cast<unsigned long long>(kSummary.m_stutterCount));
     }
-    break;
 
-    // Any other messages sned to the default message handler as our application won't make use of them.
-    default:
+    // What the null backend was asked to do per frame, by kind of call.
+    const NullRenderContext* pNullContext = m_pGraphics ? m_pGraphics->GetNullRenderContext() : nullptr;
+    if (pNullContext && pNullContext->GetFrameCount() > 0)
     {
-        return DefWindowProc(hwnd, umsg, wparam, lparam);
+        const NullRenderCounters& kTotals = pNullContext->GetTotals();
+        double frames = static_cast<double>(pNullContext->GetFrameCount());
+
+        length += sprintf_s(report + length, sizeof(report) - length,
+            "null_frames: %llu\n"
+            "null_draw_calls_per_frame: %.2f\n"
+            "null_indices_submitted_per_frame: %.1f\n"
+            "null_instances_submitted_per_frame: %.1f\n"
+            "null_clears_per_frame: %.2f\n"
+            "null_output_merger_binds_per_frame: %.2f\n"
+            "null_rasterizer_binds_per_frame: %.2f\n"
+            "null_input_layout_binds_per_frame: %.2f\n"
+            "null_vertex_buffer_binds_per_frame: %.2f\n"
+            "null_index_buffer_binds_per_frame: %.2f\n"
+            "null_topology_binds_per_frame: %.2f\n"
+            "null_shader_binds_per_frame: %.2f\n"
+            "null_constant_buffer_binds_per_frame: %.2f\n"
+            "null_maps_per_frame: %.2f\n"
+            "null_unmaps_per_frame: %.2f\n"
+            "null_bytes_mapped_per_frame: %.1f\n"
+            "null_updates_per_frame: %.2f\n"
+            "null_bytes_updated_per_frame: %.1f\n"
+            "null_flushes_per_frame: %.2f\n"
+            "null_queries_per_frame: %.2f\n",
+            pNullContext->GetFrameCount(),
+            kTotals.m_drawCalls / frames, kTotals.m_indicesSubmitted / frames, kTotals.m_instancesSubmitted / frames,
+            kTotals.m_clears / frames, kTotals.m_outputMergerBinds / frames, kTotals.m_rasterizerBinds / frames,
+            kTotals.m_inputLayoutBinds / frames, kTotals.m_vertexBufferBinds / frames, kTotals.m_indexBufferBinds / frames,
+            kTotals.m_topologyBinds / frames, kTotals.m_shaderBinds / frames, kTotals.m_constantBufferBinds / frames,
+            kTotals.m_maps / frames, kTotals.m_unmaps / frames, kTotals.m_bytesMapped / frames,
+            kTotals.m_updates / frames, kTotals.m_bytesUpdated / frames, kTotals.m_flushes / frames, kTotals.m_queries / frames);
     }
-    break;
+
+    // How the last frame's tiles were spread over the software rasterizer's threads.
+    const SoftwareRenderContext* pSoftwareContext = m_pGraphics ? m_pGraphics->GetSoftwareRenderContext() : nullptr;
+    if (pSoftwareContext)
+    {
+        const std::vector<SoftwareTileTiming>& kTimings = pSoftwareContext->GetTileTimings();
+        std::vector<double> threadMilliseconds(pSoftwareContext->GetThreadCount(), 0.0);
+        unsigned long long triangleCount = 0;
+        double totalMilliseconds = 0.0;
+        const SoftwareTileTiming* pSlowest = nullptr;
+
+        for (const SoftwareTileTiming& kTiming : kTimings)
+        {
+            if (kTiming.m_threadIndex < threadMilliseconds.size())
+            {
+                threadMilliseconds[kTiming.m_threadIndex] += kTiming.m_milliseconds;
+            }
+            triangleCount += kTiming.m_triangleCount;
+            totalMilliseconds += kTiming.m_milliseconds;
+
+            if (!pSlowest || kTiming.m_milliseconds > pSlowest->m_milliseconds)
+            {
+                pSlowest = &kTiming;
+            }
+        }
+
+        if (pSlowest)
+        {
+            length += sprintf_s(report + length, sizeof(report) - length,
+                "software_threads: %u\n"
+                "software_tiles: %u\n"
+                "software_tile_triangles: %llu\n"
+                "software_tile_total_ms: %.4f\n"
+                "software_tile_average_ms: %.4f\n"
+                "software_tile_max_ms: %.4f\n"
+                "software_tile_max_x: %d\n"
+                "software_tile_max_y: %d\n",
+                pSoftwareContext->GetThreadCount(), static_cast<unsigned int>(kTimings.size()), triangleCount,
+                totalMilliseconds, totalMilliseconds / kTimings.size(), pSlowest->m_milliseconds, pSlowest->m_tileX, pSlowest->m_tileY);
+
+            for (size_t i = 0; i < threadMilliseconds.size(); ++i)
+            {
+                length += sprintf_s(report + length, sizeof(report) - length, "software_thread_%u_ms: %.4f\n", static_cast<unsigned int>(i), threadMilliseconds[i]);
+            }
+        }
     }
 
-    return 0;
+    if (length > 0)
+    {
+        fputs(report, stdout);
+        OutputDebugStringA(report);
+    }
 }
 
-//-----------------------------------------------------------------------------
-// Where we put the code to build the window we will use to render to.
-// Returns screenWidth and screenHeight back to the calling function 
-// so we can make use of them throughout the application.
-//
-// We are creating the window with some default setting to initialize
-// a plain black window with no borders.
-//
-// Window will me made depending on the global variable called FULL_SCREEN.
-// If it is set to true, then we make the screen cover the entire users desktop
-// window. If it is set to false we just make a 800x600 window in the middle
-// of the screen.
-//-----------------------------------------------------------------------------
-void System::InitializeWindows(int& screenWidth, int& screenHeight)
+//-----------------------------------------------------------------
+// Prints where the last frames went, scope by scope, and writes
+// the trace if one was asked for. The render counters are printed
+// in every build.
+//-----------------------------------------------------------------
+void System::ReportProfile() const
 {
-    WNDCLASSEX wc;
-    DEVMODE dmScreenSettings;
-    int posX;
-    int posY;
-
-    // Get an external pointer to this object.
-    s_pApplicationHandle = this;
-
-    // Get the instance of this application.
-    m_hInstance = GetModuleHandle(nullptr);
-
-    // Give the application a name.
-    m_applicationName = L"Engine";
-
-    // Setup the windows class with default settings.
-    wc.style            = CS_HREDRAW | CS_VREDRAW | CS_OWNDC;
-    wc.lpfnWndProc      = WndProc;
-    wc.cbClsExtra       = 0;
-    wc.cbWndExtra       = 0;
-    wc.hInstance        = m_hInstance;
-    wc.hIcon            = LoadIcon(nullptr, IDI_WINLOGO);
-    wc.hIconSm          = wc.hIcon;
-    wc.hCursor          = LoadCursor(nullptr, IDC_ARROW);
-    wc.hbrBackground    = static_cast<HBRUSH>(GetStockObject(BLACK_BRUSH));
-    wc.lpszMenuName     = nullptr;
-    wc.lpszClassName    = m_applicationName;
-    wc.cbSize           = sizeof(WNDCLASSEX);
-
-    // Register the window class.
-    RegisterClassEx(&wc);
-
-    // Determine the rsolution of the clients desktop screen.
-    screenWidth  = GetSystemMetrics(SM_CXSCREEN);
-    screenHeight = GetSystemMetrics(SM_CYSCREEN);
-
-    // Setup the screen settings depending ton whether it is running in full screen or in windowed mode.
-    if (FULL_SCREEN)
-    {
-        // If full screen set the screen to maximum size of the users desktop and 32bit.
-        memset(&dmScreenSettings, 0, sizeof(dmScreenSettings));
-        dmScreenSettings.dmSize = sizeof(dmScreenSettings);
-        dmScreenSettings.dmPelsWidth = static_cast<unsigned long>(screenWidth);
-        dmScreenSettings.dmPelsHeight = static_cast<unsigned long>(screenHeight);
-        dmScreenSettings.dmBitsPerPel = 32;
-        dmScreenSettings.dmFields = DM_BITSPERPEL | DM_PELSWIDTH | DM_PELSHEIGHT;
-
-        // Change the display settings to full screen.
-        ChangeDisplaySettings(&dmScreenSettings, CDS_FULLSCREEN);
-
-        // Set the position of the window to the top left corner.
-        posX = posY = 0;
-    }
-    else
-    {
-        // If windowed then set it to 800x600 resolution.
-        screenWidth = 800;
-        screenHeight = 600;
+    char line[512];
 
-        // Place the window in the middle of the screen.
-        posX = (GetSystemMetrics(SM_CXSCREEN) - screenWidth) / 2;
-        posY = (GetSystemMetrics(SM_CYSCREEN) - screenHeight) / 2;
+    unsigned long long renderLastFrame = RenderStats::GetFrameIndex();
+    unsigned long long renderFirstFrame = (renderLastFrame > PROFILE_SUMMARY_FRAMES) ? (renderLastFrame - PROFILE_SUMMARY_FRAMES) : 0;
+
+    RenderFrameStats renderTotal;
+    unsigned long long renderFrameCount = RenderStats::GetSummary(renderFirstFrame, renderLastFrame, renderTotal);
+    if (renderFrameCount > 0)
+    {
+        double frames = static_cast<double>(renderFrameCount);
+        sprintf_s(line, sizeof(line), "profile: render per frame: %.2f draws %.1f instances %.1f indices %.1f triangles %.2f state_binds (%.2f issued) %.1f cbuffer_bytes (%.2f maps) %.1f geometry_bytes %.2f clears %.2f frustum_tested (%.2f culled) %.2f occlusion_tested (%.2f culled)\n",
+            renderTotal.m_drawCalls / frames, renderTotal.m_instances / frames, renderTotal.m_indices / frames, renderTotal.m_triangles / frames,
+            renderTotal.m_stateBinds / frames, renderTotal.m_issuedStateBinds / frames, renderTotal.m_constantBufferBytes / frames, renderTotal.m_constantBufferMaps / frames, renderTotal.m_geometryBytes / frames, renderTotal.m_clears / frames,
+            renderTotal.m_frustumTested / frames, renderTotal.m_frustumCulled / frames, renderTotal.m_occlusionTested / frames, renderTotal.m_occlusionCulled / frames);
+        fputs(line, stdout);
+        OutputDebugStringA(line);
     }
 
-    // Create the window with the screen settings and get the handle to it.
-    m_hwnd = CreateWindowEx(WS_EX_APPWINDOW, m_applicationName, m_applicationName,
-                        WS_CLIPSIBLINGS | WS_CLIPCHILDREN | WS_POPUP, posX, posY, 
-                        screenWidth, screenHeight, nullptr, nullptr, m_hInstance, nullptr);
+#if PROFILER_ENABLED
+    unsigned long long lastFrame = Profiler::GetFrameIndex();
+    unsigned long long firstFrame = (lastFrame > PROFILE_SUMMARY_FRAMES) ? (lastFrame - PROFILE_SUMMARY_FRAMES + 1) : 0;
+
+    std::vector<ProfileScopeStats> scopes;
+    unsigned long long frameCount = Profiler::GetSummary(firstFrame, lastFrame, scopes);
 
-    // Bring the window up on the screen and set it as main focus.
-    ShowWindow(m_hwnd, SW_SHOW);
-    SetForegroundWindow(m_hwnd);
-    SetFocus(m_hwnd);
+    for (const ProfileScopeStats& kScope : scopes)
+    {
+        sprintf_s(line, sizeof(line), "profile: %*s%s %.4f ms %.2f calls\n", static_cast<int>(kScope.m_depth * 2), "",
+            kScope.m_pName, kScope.m_totalSeconds * 1000.0 / frameCount, static_cast<double>(kScope.m_callCount) / frameCount);
+        fputs(line, stdout);
+        OutputDebugStringA(line);
+    }
 
-    // Hide the mouse cursor.
-    ShowCursor(false);
+    if (!m_profileFileName.empty())
+    {
+        unsigned long long traceLastFrame = m_profileLastFrame ? m_profileLastFrame : lastFrame;
+        unsigned long long traceFirstFrame = m_profileLastFrame ? m_profileFirstFrame : firstFrame;
+        Profiler::ExportChromeTrace(m_profileFileName.c_str(), traceFirstFrame, traceLastFrame);
+    }
+#endif
 }
 
-//-----------------------------------------------------------------------------
-// Returns the screen settings back to normal and releases the window and
-// handles associated with it.
-//-----------------------------------------------------------------------------
-void System::ShutdownWindows()
+//-----------------------------------------------------------------
+// Where all the processing for our application is done.
+//-----------------------------------------------------------------
+bool System::Frame()
 {
-    // Show the mouse cursor.
-    ShowCursor(true);
+    PROFILE_SCOPE("System::Frame");
 
-    // Fix the display settings if leaving full screen mode.
-    if (FULL_SCREEN)
+    // Do the frame processing for the graphics object.
+    if (!m_pGraphics->Frame())
     {
-        ChangeDisplaySettings(nullptr, 0);
+        return false;
     }
 
-    // Remove the window.
-    DestroyWindow(m_hwnd);
-    m_hwnd = nullptr;
-
-    // Remove the application instance.
-    UnregisterClass(m_applicationName, m_hInstance);
-    m_hInstance = nullptr;
-
-    // Release the pointer to this class.
-    s_pApplicationHandle = nullptr;
+    return true;
 }
 
-//-----------------------------------------------------------------------------
-// Where windows sends its messages to.
-//-----------------------------------------------------------------------------
-LRESULT CALLBACK WndProc(HWND hwnd, UINT umessage, WPARAM wparam, LPARAM lparam)
+//-----------------------------------------------------------------
+// Where we direct the windows system message into.
+//-----------------------------------------------------------------
+LRESULT System::MessageHandler(HWND hwnd, UINT umsg, WPARAM wparam, LPARAM lparam)
 {
-    switch (umessage)
+    switch (umsg)
     {
-    // Check if the window is being destroyed.
-    case WM_DESTROY:
+    // Check if a key has been pressed or released on the keyboard.
+    case WM_KEYDOWN:
+    case WM_KEYUP:
     {
-        PostQuitMessage(0);
+        // Send it to the input object so it can record that state before the next frame.
+        InputEvent event;
+        event.m_type = (umsg == WM_KEYDOWN) ? InputEvent::Type::KeyDown : InputEvent::Type::KeyUp;
+        event.m_code = static_cast<unsigned int>(wparam);
+        event.m_x = 0;
+        event.m_y = 0;
+        event.m_timestamp = GetMessageTimestamp();
+
+        m_pInput->PushEvent(event);
         return 0;
     }
-        break;
+    break;
 
-    // Check if the window is being closed.
-    case WM_CLOSE:
+    // Check if the mouse moved or a button changed over the window.
+    case WM_MOUSEMOVE:
+    case WM_LBUTTONDOWN:
+    case WM_LBUTTONUP:
+    case WM_RBUTTONDOWN:
+    case WM_RBUTTONUP:
     {
-        PostQuitMessage(0);
+        InputEvent event;
+        event.m_type = InputEvent::Type::MouseMove;
+        event.m_code = (umsg == WM_RBUTTONDOWN || umsg == WM_RBUTTONUP) ? InputEvent::kRightButton : InputEvent::kLeftButton;
+        event.m_x = GET_X_LPARAM(lparam);
+        event.m_y = GET_Y_LPARAM(lparam);
+        event.m_timestamp = GetMessageTimestamp();
+
+        if (umsg == WM_LBUTTONDOWN || umsg == WM_RBUTTONDOWN)
+        {
+            event.m_type = InputEvent::Type::MouseButtonDown;
+        }
+        else if (umsg == WM_LBUTTONUP || umsg == WM_RBUTTONUP)
+        {
+            event.m_type = InputEvent::Type::MouseButtonUp;
+        }
+
+        m_pInput->PushEvent(event);
         return 0;
     }
-        break;
+    break;
 
-    // All other messages pass to the mesage handler in the systme class.
+    // Any other messages sned to the default message handler as our application won't make use of them.
     default:
-        return s_pApplicationHandle->MessageHandler(hwnd, umessage, wparam, lparam);
-        break;
+    {
+        return DefWindowProc(hwnd, umsg, wparam, lparam);
+    }
+    break;
     }
-}
\ No newline at end of file
+
+    return 0;
+}
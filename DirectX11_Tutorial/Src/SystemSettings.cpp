@@ -0,0 +1,292 @@
+//////////////////////////////////////////////////////////////////////
+// Filename: SystemSettings.cpp
+//////////////////////////////////////////////////////////////////////
+#include <sstream>
+
+#include "System/SystemSettings.h"
+
+//-----------------------------------------------------------------
+// Reads the switches listed in SystemSettings.h.
+// Returns false on an unknown switch or a missing/bad value.
+//-----------------------------------------------------------------
+bool SystemSettings::ParseCommandLine(const char* pCommandLine)
+{
+    if (!pCommandLine)
+    {
+        return true;
+    }
+
+    std::istringstream stream(pCommandLine);
+    std::string token;
+    bool pacingSet = false;
+
+    while (stream >> token)
+    {
+        if (token == "-headless")
+        {
+            m_headless = true;
+        }
+        else if (token == "-frames")
+        {
+            if (!(stream >> m_frameCount))
+            {
+                return false;
+            }
+        }
+        else if (token == "-seconds")
+        {
+            if (!(stream >> m_seconds) || m_seconds < 0.0)
+            {
+                return false;
+            }
+        }
+        else if (token == "-width")
+        {
+            if (!(stream >> m_screenWidth) || m_screenWidth <= 0)
+            {
+                return false;
+            }
+        }
+        else if (token == "-height")
+        {
+            if (!(stream >> m_screenHeight) || m_screenHeight <= 0)
+            {
+                return false;
+            }
+        }
+        else if (token == "-backend")
+        {
+            std::string name;
+            stream >> name;
+
+            if (name == "hardware")
+            {
+                m_backend = RenderBackend::Hardware;
+            }
+            else if (name == "software")
+            {
+                m_backend = RenderBackend::Software;
+            }
+            else if (name == "null")
+            {
+                m_backend = RenderBackend::Null;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        else if (token == "-jobs")
+        {
+            if (!(stream >> m_jobWorkers))
+            {
+                return false;
+            }
+        }
+        else if (token == "-jobbenchmark")
+        {
+            m_jobBenchmark = true;
+        }
+        else if (token == "-scenebenchmark")
+        {
+            m_sceneBenchmark = true;
+        }
+        else if (token == "-occlusioncheck")
+        {
+            m_occlusionCheck = true;
+        }
+        else if (token == "-transformcheck")
+        {
+            m_transformCheck = true;
+        }
+        else if (token == "-pipeline")
+        {
+            if (!(stream >> m_pipelineDepth) || m_pipelineDepth == 0)
+            {
+                return false;
+            }
+        }
+        else if (token == "-simrate")
+        {
+            if (!(stream >> m_simulationRate) || m_simulationRate <= 0.0)
+            {
+                return false;
+            }
+        }
+        else if (token == "-syntheticinput")
+        {
+            if (!(stream >> m_syntheticInputRate))
+            {
+                return false;
+            }
+        }
+        else if (token == "-results")
+        {
+            if (!(stream >> m_resultsFileName))
+            {
+                return false;
+            }
+        }
+        else if (token == "-record")
+        {
+            if (!(stream >> m_recordFileName))
+            {
+                return false;
+            }
+        }
+        else if (token == "-replay")
+        {
+            if (!(stream >> m_replayFileName))
+            {
+                return false;
+            }
+        }
+        else if (token == "-frametime")
+        {
+            double milliseconds = 0.0;
+            if (!(stream >> milliseconds) || milliseconds <= 0.0)
+            {
+                return false;
+            }
+
+            m_fixedFrameSeconds = milliseconds / 1000.0;
+        }
+        else if (token == "-profile")
+        {
+            if (!(stream >> m_profileFileName))
+            {
+                return false;
+            }
+        }
+        else if (token == "-profileframes")
+        {
+            if (!(stream >> m_profileFirstFrame >> m_profileLastFrame) || m_profileLastFrame < m_profileFirstFrame || m_profileLastFrame == 0)
+            {
+                return false;
+            }
+        }
+        else if (token == "-metrics")
+        {
+            if (!(stream >> m_metricsFileName))
+            {
+                return false;
+            }
+        }
+        else if (token == "-metricsformat")
+        {
+            std::string name;
+            stream >> name;
+
+            if (name == "prometheus")
+            {
+                m_metricsFormat = MetricsFormat::Prometheus;
+            }
+            else if (name == "csv")
+            {
+                m_metricsFormat = MetricsFormat::Csv;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        else if (token == "-metricsinterval")
+        {
+            if (!(stream >> m_metricsInterval) || m_metricsInterval <= 0.0)
+            {
+                return false;
+            }
+        }
+        else if (token == "-pacing")
+        {
+            std::string name;
+            stream >> name;
+
+            if (name == "uncapped")
+            {
+                m_pacing.m_mode = PacingMode::Uncapped;
+            }
+            else if (name == "vsync")
+            {
+                m_pacing.m_mode = PacingMode::VSync;
+            }
+            else if (name == "cap")
+            {
+                m_pacing.m_mode = PacingMode::FrameCap;
+            }
+            else if (name == "jit")
+            {
+                m_pacing.m_mode = PacingMode::JustInTime;
+            }
+            else
+            {
+                return false;
+            }
+
+            pacingSet = true;
+        }
+        else if (token == "-fpscap")
+        {
+            if (!(stream >> m_pacing.m_frameCapHz) || m_pacing.m_frameCapHz <= 0.0)
+            {
+                return false;
+            }
+        }
+        else if (token == "-queuedframes")
+        {
+            if (!(stream >> m_pacing.m_queuedFrames) || m_pacing.m_queuedFrames == 0 || m_pacing.m_queuedFrames > 16)
+            {
+                return false;
+            }
+        }
+        else if (token == "-refresh")
+        {
+            if (!(stream >> m_pacing.m_simulatedRefreshHz) || m_pacing.m_simulatedRefreshHz <= 0.0)
+            {
+                return false;
+            }
+        }
+        else if (token == "-instances")
+        {
+            if (!(stream >> m_instanceCount))
+            {
+                return false;
+            }
+        }
+        else if (token == "-separatedraws")
+        {
+            m_separateDraws = true;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    // The hardware device presents through a swap chain on a window,
+    // so a headless run draws with the software rasterizer instead.
+    if (m_headless && m_backend == RenderBackend::Hardware)
+    {
+        m_backend = RenderBackend::Software;
+    }
+
+    // Without a window there is no escape key, a headless run has to end on its own.
+    if (m_headless && m_frameCount == 0 && m_seconds == 0.0 && m_replayFileName.empty())
+    {
+        return false;
+    }
+
+    // A benchmark wants every frame it can get unless it asked to be paced.
+    if (m_headless && !pacingSet)
+    {
+        m_pacing.m_mode = PacingMode::Uncapped;
+    }
+
+    // Recording the run that is being replayed would only copy the file.
+    if (!m_recordFileName.empty() && !m_replayFileName.empty())
+    {
+        return false;
+    }
+
+    return true;
+}
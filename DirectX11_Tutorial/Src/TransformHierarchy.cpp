@@ -0,0 +1,417 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: TransformHierarchy.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <type_traits>
+
+#include "Graphics/TransformHierarchy.h"
+#include "System/Profiler.h"
+
+using namespace DirectX;
+
+TransformHierarchy::TransformHierarchy()
+    : m_freeHandle(INVALID_TRANSFORM_HANDLE)
+    , m_needsReorder(false)
+    , m_stats()
+{
+    m_levelStarts.push_back(0);
+}
+
+void TransformHierarchy::Reserve(unsigned int count)
+{
+    m_positions.reserve(count);
+    m_rotations.reserve(count);
+    m_scales.reserve(count);
+    m_worldMatrices.reserve(count);
+    m_parents.reserve(count);
+    m_firstChildren.reserve(count);
+    m_childCounts.reserve(count);
+    m_dirty.reserve(count);
+    m_handles.reserve(count);
+    m_handleIndices.reserve(count);
+    m_destroyed.reserve(count);
+}
+
+void TransformHierarchy::Clear()
+{
+    m_positions.clear();
+    m_rotations.clear();
+    m_scales.clear();
+    m_worldMatrices.clear();
+    m_parents.clear();
+    m_firstChildren.clear();
+    m_childCounts.clear();
+    m_dirty.clear();
+    m_handles.clear();
+    m_levelStarts.assign(1, 0);
+    m_dirtyLevels.clear();
+    m_handleIndices.clear();
+    m_freeHandle = INVALID_TRANSFORM_HANDLE;
+    m_needsReorder = false;
+    m_destroyed.clear();
+    m_stats = TransformUpdateStats();
+}
+
+//-----------------------------------------------------------------
+// Appends the node, it finds its place at the next Update(). The
+// parent was created earlier, so it is in front of the node until
+// then as well.
+//-----------------------------------------------------------------
+TransformHandle TransformHierarchy::Create(TransformHandle parent, const XMFLOAT3& kPosition, const XMFLOAT4& kRotation, const XMFLOAT3& kScale)
+{
+    uint32_t index = static_cast<uint32_t>(m_positions.size());
+
+    TransformHandle handle = m_freeHandle;
+    if (handle != INVALID_TRANSFORM_HANDLE)
+    {
+        m_freeHandle = m_handleIndices[handle];
+        m_handleIndices[handle] = index;
+    }
+    else
+    {
+        handle = static_cast<TransformHandle>(m_handleIndices.size());
+        m_handleIndices.push_back(index);
+    }
+
+    XMFLOAT4X4 identity;
+    XMStoreFloat4x4(&identity, XMMatrixIdentity());
+
+    m_positions.push_back(kPosition);
+    m_rotations.push_back(kRotation);
+    m_scales.push_back(kScale);
+    m_worldMatrices.push_back(identity);
+    m_parents.push_back((parent != INVALID_TRANSFORM_HANDLE) ? m_handleIndices[parent] : kNoParent);
+    m_firstChildren.push_back(0);
+    m_childCounts.push_back(0);
+    m_dirty.push_back(1);
+    m_handles.push_back(handle);
+    m_destroyed.push_back(0);
+
+    m_needsReorder = true;
+
+    return handle;
+}
+
+void TransformHierarchy::Destroy(TransformHandle handle)
+{
+    m_destroyed[m_handleIndices[handle]] = 1;
+    m_needsReorder = true;
+}
+
+void TransformHierarchy::SetLocal(TransformHandle handle, const XMFLOAT3& kPosition, const XMFLOAT4& kRotation, const XMFLOAT3& kScale)
+{
+    uint32_t index = m_handleIndices[handle];
+    m_positions[index] = kPosition;
+    m_rotations[index] = kRotation;
+    m_scales[index] = kScale;
+    MarkDirty(index);
+}
+
+void TransformHierarchy::SetPosition(TransformHandle handle, const XMFLOAT3& kPosition)
+{
+    uint32_t index = m_handleIndices[handle];
+    m_positions[index] = kPosition;
+    MarkDirty(index);
+}
+
+void TransformHierarchy::SetRotation(TransformHandle handle, const XMFLOAT4& kRotation)
+{
+    uint32_t index = m_handleIndices[handle];
+    m_rotations[index] = kRotation;
+    MarkDirty(index);
+}
+
+void TransformHierarchy::SetScale(TransformHandle handle, const XMFLOAT3& kScale)
+{
+    uint32_t index = m_handleIndices[handle];
+    m_scales[index] = kScale;
+    MarkDirty(index);
+}
+
+//-----------------------------------------------------------------
+// Goes down the levels in order. A level is skipped when nothing
+// in it changed and nothing above it was updated, otherwise its
+// chunks run on the job system. Updating a node marks its children
+// in the next level, so the dirt flows down one level at a time.
+//-----------------------------------------------------------------
+void TransformHierarchy::Update(JobSystem* pJobSystem)
+{
+    PROFILE_SCOPE("TransformHierarchy::Update");
+
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+    bool reordered = m_needsReorder;
+    if (m_needsReorder)
+    {
+        Reorder();
+    }
+
+    uint64_t updatedNodes = 0;
+    bool parentsUpdated = false;
+    unsigned int levelCount = static_cast<unsigned int>(m_levelStarts.size() - 1);
+
+    for (unsigned int level = 0; level < levelCount; ++level)
+    {
+        if (!m_dirtyLevels[level] && !parentsUpdated)
+        {
+            continue;
+        }
+        m_dirtyLevels[level] = 0;
+
+        uint32_t begin = m_levelStarts[level];
+        uint32_t end = m_levelStarts[level + 1];
+        unsigned int chunkCount = (end - begin + kUpdateChunkSize - 1) / kUpdateChunkSize;
+
+        std::atomic<uint64_t> levelUpdated(0);
+        auto updateChunks = [this, begin, end, &levelUpdated](unsigned int chunkBegin, unsigned int chunkEnd)
+        {
+            uint64_t updated = 0;
+            UpdateRange(begin + chunkBegin * kUpdateChunkSize, std::min(end, begin + chunkEnd * kUpdateChunkSize), updated);
+            levelUpdated.fetch_add(updated, std::memory_order_relaxed);
+        };
+
+        if (pJobSystem && chunkCount > 1)
+        {
+            pJobSystem->ParallelFor(chunkCount, 1, updateChunks);
+        }
+        else
+        {
+            updateChunks(0, chunkCount);
+        }
+
+        updatedNodes += levelUpdated.load(std::memory_order_relaxed);
+        parentsUpdated = levelUpdated.load(std::memory_order_relaxed) > 0;
+    }
+
+    m_stats.m_nodes = m_positions.size();
+    m_stats.m_updatedNodes = updatedNodes;
+    m_stats.m_levels = levelCount;
+    m_stats.m_reordered = reordered;
+    m_stats.m_updateSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+const XMFLOAT4X4& TransformHierarchy::GetWorldMatrix(TransformHandle handle) const
+{
+    return m_worldMatrices[m_handleIndices[handle]];
+}
+
+TransformHandle TransformHierarchy::GetParent(TransformHandle handle) const
+{
+    uint32_t parent = m_parents[m_handleIndices[handle]];
+    return (parent != kNoParent) ? m_handles[parent] : INVALID_TRANSFORM_HANDLE;
+}
+
+unsigned int TransformHierarchy::GetCount() const
+{
+    return static_cast<unsigned int>(m_positions.size());
+}
+
+const TransformUpdateStats& TransformHierarchy::GetStats() const
+{
+    return m_stats;
+}
+
+// Before the first sort after a change the levels aren't known, the sort finds the dirty ones itself.
+void TransformHierarchy::MarkDirty(uint32_t index)
+{
+    m_dirty[index] = 1;
+
+    if (!m_needsReorder)
+    {
+        unsigned int level = static_cast<unsigned int>(std::upper_bound(m_levelStarts.begin(), m_levelStarts.end(), index) - m_levelStarts.begin()) - 1;
+        m_dirtyLevels[level] = 1;
+    }
+}
+
+//-----------------------------------------------------------------
+// Sorts the nodes breadth first: the roots in the order they were
+// created, then level by level the children of each node in turn.
+// Destroyed nodes are never reached, and neither is anything under
+// them, so they drop out here and their handles are freed.
+//-----------------------------------------------------------------
+void TransformHierarchy::Reorder()
+{
+    uint32_t count = static_cast<uint32_t>(m_positions.size());
+
+    // The children of every node by their current index, in the order they were created.
+    std::vector<uint32_t> childStarts(count + 1, 0);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (m_parents[i] != kNoParent)
+        {
+            ++childStarts[m_parents[i] + 1];
+        }
+    }
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        childStarts[i + 1] += childStarts[i];
+    }
+
+    std::vector<uint32_t> children(childStarts[count]);
+    std::vector<uint32_t> nextChild(childStarts.begin(), childStarts.end() - 1);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (m_parents[i] != kNoParent)
+        {
+            children[nextChild[m_parents[i]]++] = i;
+        }
+    }
+
+    // order[new index] = old index.
+    std::vector<uint32_t> order;
+    order.reserve(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (m_parents[i] == kNoParent && !m_destroyed[i])
+        {
+            order.push_back(i);
+        }
+    }
+
+    std::vector<uint32_t> newParents(order.size(), kNoParent);
+    std::vector<uint32_t> newFirstChildren;
+    std::vector<uint32_t> newChildCounts;
+    newParents.reserve(count);
+    newFirstChildren.reserve(count);
+    newChildCounts.reserve(count);
+
+    m_levelStarts.assign(1, 0);
+    uint32_t levelEnd = static_cast<uint32_t>(order.size());
+
+    for (uint32_t newIndex = 0; newIndex < order.size(); ++newIndex)
+    {
+        if (newIndex == levelEnd)
+        {
+            m_levelStarts.push_back(levelEnd);
+            levelEnd = static_cast<uint32_t>(order.size());
+        }
+
+        uint32_t oldIndex = order[newIndex];
+        uint32_t firstChild = static_cast<uint32_t>(order.size());
+        for (uint32_t child = childStarts[oldIndex]; child < childStarts[oldIndex + 1]; ++child)
+        {
+            if (!m_destroyed[children[child]])
+            {
+                order.push_back(children[child]);
+                newParents.push_back(newIndex);
+            }
+        }
+
+        newFirstChildren.push_back(firstChild);
+        newChildCounts.push_back(static_cast<uint32_t>(order.size()) - firstChild);
+    }
+    m_levelStarts.push_back(static_cast<uint32_t>(order.size()));
+
+    // Hand back the handles of everything that wasn't reached.
+    std::vector<uint8_t> reached(count, 0);
+    for (uint32_t oldIndex : order)
+    {
+        reached[oldIndex] = 1;
+    }
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (!reached[i])
+        {
+            m_handleIndices[m_handles[i]] = m_freeHandle;
+            m_freeHandle = m_handles[i];
+        }
+    }
+
+    // Move every field into the new order.
+    auto permute = [&order](auto& values)
+    {
+        typename std::remove_reference<decltype(values)>::type sorted(order.size());
+        for (uint32_t newIndex = 0; newIndex < order.size(); ++newIndex)
+        {
+            sorted[newIndex] = values[order[newIndex]];
+        }
+        values.swap(sorted);
+    };
+
+    permute(m_positions);
+    permute(m_rotations);
+    permute(m_scales);
+    permute(m_worldMatrices);
+    permute(m_dirty);
+    permute(m_handles);
+
+    m_parents.swap(newParents);
+    m_firstChildren.swap(newFirstChildren);
+    m_childCounts.swap(newChildCounts);
+    m_destroyed.assign(order.size(), 0);
+
+    for (uint32_t newIndex = 0; newIndex < order.size(); ++newIndex)
+    {
+        m_handleIndices[m_handles[newIndex]] = newIndex;
+    }
+
+    unsigned int levelCount = static_cast<unsigned int>(m_levelStarts.size() - 1);
+    m_dirtyLevels.assign(levelCount, 0);
+    for (unsigned int level = 0; level < levelCount; ++level)
+    {
+        for (uint32_t i = m_levelStarts[level]; i < m_levelStarts[level + 1]; ++i)
+        {
+            if (m_dirty[i])
+            {
+                m_dirtyLevels[level] = 1;
+                break;
+            }
+        }
+    }
+
+    m_needsReorder = false;
+}
+
+//-----------------------------------------------------------------
+// Recomputes the dirty nodes of a range within one level. Clean
+// runs are skipped 8 flags at a time, most of a large scene doesn't
+// move. The children's flags are set for the next level, the ranges
+// of two parents never overlap so chunks don't share any.
+//-----------------------------------------------------------------
+void TransformHierarchy::UpdateRange(uint32_t begin, uint32_t end, uint64_t& updated)
+{
+    uint32_t i = begin;
+    while (i < end)
+    {
+        if (i + 8 <= end)
+        {
+            uint64_t flags;
+            memcpy(&flags, &m_dirty[i], sizeof(flags));
+            if (flags == 0)
+            {
+                i += 8;
+                continue;
+            }
+        }
+
+        if (m_dirty[i])
+        {
+            // scale * rotation * translation, the rotation's rows scaled and the position as the last row.
+            XMMATRIX local = XMMatrixRotationQuaternion(XMLoadFloat4(&m_rotations[i]));
+            XMVECTOR scale = XMLoadFloat3(&m_scales[i]);
+            local.r[0] = XMVectorMultiply(local.r[0], XMVectorSplatX(scale));
+            local.r[1] = XMVectorMultiply(local.r[1], XMVectorSplatY(scale));
+            local.r[2] = XMVectorMultiply(local.r[2], XMVectorSplatZ(scale));
+            local.r[3] = XMVectorSetW(XMLoadFloat3(&m_positions[i]), 1.0f);
+
+            if (m_parents[i] != kNoParent)
+            {
+                local = XMMatrixMultiply(local, XMLoadFloat4x4(&m_worldMatrices[m_parents[i]]));
+            }
+            XMStoreFloat4x4(&m_worldMatrices[i], local);
+
+            if (m_childCounts[i] > 0)
+            {
+                memset(&m_dirty[m_firstChildren[i]], 1, m_childCounts[i]);
+            }
+
+            m_dirty[i] = 0;
+            ++updated;
+        }
+
+        ++i;
+    }
+}
@@ -0,0 +1,438 @@
+//////////////////////////////////////////////////////////////////////
+// Filename: TransformHierarchyBenchmark.cpp
+//////////////////////////////////////////////////////////////////////
+#include <windows.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "Graphics/TransformHierarchy.h"
+#include "Graphics/TransformHierarchyBenchmark.h"
+#include "System/SeededRandom.h"
+
+using namespace DirectX;
+
+namespace
+{
+    constexpr unsigned int kTransformNodes = 1 << 20;
+    constexpr unsigned int kTransformChildren = 8;
+    constexpr unsigned int kMovedTransforms = kTransformNodes / 100;
+
+    class TransformUpdateWorkload : public JobSystemWorkload
+    {
+    public:
+        const char* GetName() const override
+        {
+            return "transform_update";
+        }
+
+        // One tree with kTransformChildren children per node, node i under node (i - 1) / kTransformChildren.
+        bool Initialize(unsigned int) override
+        {
+            XMFLOAT4 identityRotation;
+            XMStoreFloat4(&identityRotation, XMQuaternionIdentity());
+
+            m_hierarchy.Clear();
+            m_hierarchy.Reserve(kTransformNodes);
+            m_handles.resize(kTransformNodes);
+            for (unsigned int i = 0; i < kTransformNodes; ++i)
+            {
+                TransformHandle parent = (i > 0) ? m_handles[(i - 1) / kTransformChildren] : INVALID_TRANSFORM_HANDLE;
+                float offset = static_cast<float>(i % kTransformChildren);
+                m_handles[i] = m_hierarchy.Create(parent, XMFLOAT3(offset, 1.0f, 0.0f), identityRotation, XMFLOAT3(1.0f, 1.0f, 1.0f));
+            }
+
+            // Sorts the nodes and computes every world matrix once, that isn't part of a frame.
+            m_hierarchy.Update(nullptr);
+            return true;
+        }
+
+        void Shutdown() override
+        {
+            m_hierarchy.Clear();
+            m_handles.clear();
+        }
+
+        // Moves and turns a hundredth of the nodes, the same ones every run, most of them leaves like
+        // in a real scene.
+        double Run(JobSystem& jobSystem) override
+        {
+            SeededRandom random(24680);
+            for (unsigned int i = 0; i < kMovedTransforms; ++i)
+            {
+                uint32_t bits = random.NextBits();
+                float angle = static_cast<float>(bits) / 16777216.0f * XM_2PI;
+
+                XMFLOAT4 rotation;
+                XMStoreFloat4(&rotation, XMQuaternionRotationRollPitchYaw(0.0f, angle, 0.0f));
+                m_hierarchy.SetRotation(m_handles[bits % kTransformNodes], rotation);
+            }
+
+            m_hierarchy.Update(&jobSystem);
+            return m_hierarchy.GetStats().m_updateSeconds;
+        }
+
+    private:
+        TransformHierarchy m_hierarchy;
+        std::vector<TransformHandle> m_handles;
+    };
+
+    constexpr uint32_t kCheckSeed = 13570;
+    // Enough that the widest levels of a random tree take several chunks of a parallel Update().
+    constexpr unsigned int kCheckNodes = 200000;
+    constexpr unsigned int kCheckRoots = 16;
+    // Under the first root, the random tree alone is only a few dozen levels deep.
+    constexpr unsigned int kCheckChainLength = 64;
+    constexpr unsigned int kCheckSteps = 35;
+    constexpr unsigned int kCreatedPerStep = 2000;
+    constexpr unsigned int kDestroyedPerStep = 20;
+    // Relative to the larger of 1 and the reference's value. The reference multiplies the
+    // matrices out, the hierarchy scales the rotation's rows.
+    constexpr float kMatrixTolerance = 1.0e-4f;
+
+    // A node as the check remembers it, by handle.
+    struct CheckNode
+    {
+        TransformHandle m_parent;
+        XMFLOAT3 m_position;
+        XMFLOAT4 m_rotation;
+        XMFLOAT3 m_scale;
+        bool m_alive;
+        // Since the last Update().
+        bool m_destroyed;
+        bool m_changed;
+    };
+
+    struct CheckErrors
+    {
+        uint64_t m_worldMismatches = 0;
+        uint64_t m_structureMismatches = 0;
+        uint64_t m_updatedCountMismatches = 0;
+    };
+
+    struct CheckState
+    {
+        explicit CheckState(uint32_t seed) : m_random(seed) {}
+
+        SeededRandom m_random;
+        // Updated on the calling thread and on the job system.
+        TransformHierarchy m_serial;
+        TransformHierarchy m_parallel;
+        std::vector<CheckNode> m_nodes;
+        // Alive at the last Update() or created since, destroyed ones aren't taken out until the next.
+        std::vector<TransformHandle> m_alive;
+        bool m_structureChanged = false;
+        CheckErrors m_errors;
+    };
+
+    void RandomLocal(SeededRandom& random, CheckNode& node)
+    {
+        node.m_position = XMFLOAT3(random.Next(-5.0f, 5.0f), random.Next(-5.0f, 5.0f), random.Next(-5.0f, 5.0f));
+        XMStoreFloat4(&node.m_rotation, XMQuaternionRotationRollPitchYaw(random.Next(0.0f, XM_2PI), random.Next(0.0f, XM_2PI), random.Next(0.0f, XM_2PI)));
+        node.m_scale = XMFLOAT3(random.Next(0.5f, 1.5f), random.Next(0.5f, 1.5f), random.Next(0.5f, 1.5f));
+    }
+
+    TransformHandle CreateNode(CheckState& state, TransformHandle parent)
+    {
+        CheckNode node;
+        node.m_parent = parent;
+        RandomLocal(state.m_random, node);
+        node.m_alive = true;
+        node.m_destroyed = false;
+        node.m_changed = true;
+
+        TransformHandle handle = state.m_serial.Create(parent, node.m_position, node.m_rotation, node.m_scale);
+        if (state.m_parallel.Create(parent, node.m_position, node.m_rotation, node.m_scale) != handle)
+        {
+            ++state.m_errors.m_structureMismatches;
+        }
+
+        if (handle >= state.m_nodes.size())
+        {
+            state.m_nodes.resize(handle + 1);
+        }
+        state.m_nodes[handle] = node;
+        state.m_alive.push_back(handle);
+        state.m_structureChanged = true;
+
+        return handle;
+    }
+
+    // One of the setters at random, with a new local transform.
+    void ChangeNode(CheckState& state, TransformHandle handle)
+    {
+        CheckNode& node = state.m_nodes[handle];
+        RandomLocal(state.m_random, node);
+        node.m_changed = true;
+
+        for (TransformHierarchy* pHierarchy : { &state.m_serial, &state.m_parallel })
+        {
+            switch (state.m_random.NextBits() % 4)
+            {
+            case 0:
+                pHierarchy->SetLocal(handle, node.m_position, node.m_rotation, node.m_scale);
+                break;
+
+            case 1:
+                pHierarchy->SetPosition(handle, node.m_position);
+                pHierarchy->SetRotation(handle, node.m_rotation);
+                pHierarchy->SetScale(handle, node.m_scale);
+                break;
+
+            case 2:
+                pHierarchy->SetRotation(handle, node.m_rotation);
+                pHierarchy->SetScale(handle, node.m_scale);
+                pHierarchy->SetPosition(handle, node.m_position);
+                break;
+
+            default:
+                pHierarchy->SetScale(handle, node.m_scale);
+                pHierarchy->SetPosition(handle, node.m_position);
+                pHierarchy->SetRotation(handle, node.m_rotation);
+                break;
+            }
+        }
+    }
+
+    void ChangeNodes(CheckState& state, unsigned int count)
+    {
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            ChangeNode(state, state.m_alive[state.m_random.NextBits() % state.m_alive.size()]);
+        }
+    }
+
+    // Whether the node is still alive and whether it or a node above it changed, by handle:
+    // 0 when not worked out yet, then 1 | alive 2 | changed 4.
+    uint8_t ResolveNode(const std::vector<CheckNode>& kNodes, TransformHandle handle, std::vector<uint8_t>& states)
+    {
+        if (states[handle] == 0)
+        {
+            const CheckNode& kNode = kNodes[handle];
+            bool alive = kNode.m_alive && !kNode.m_destroyed;
+            bool changed = kNode.m_changed;
+            if (kNode.m_parent != INVALID_TRANSFORM_HANDLE)
+            {
+                uint8_t parentState = ResolveNode(kNodes, kNode.m_parent, states);
+                alive = alive && (parentState & 2) != 0;
+                changed = changed || (parentState & 4) != 0;
+            }
+            states[handle] = 1 | (alive ? 2 : 0) | (changed ? 4 : 0);
+        }
+
+        return states[handle];
+    }
+
+    // scale * rotation * translation * the parent's world, as the header puts it.
+    const XMFLOAT4X4& ReferenceWorld(const std::vector<CheckNode>& kNodes, TransformHandle handle, std::vector<XMFLOAT4X4>& worlds, std::vector<uint8_t>& computed)
+    {
+        if (!computed[handle])
+        {
+            const CheckNode& kNode = kNodes[handle];
+            XMMATRIX world = XMMatrixMultiply(XMMatrixMultiply(
+                XMMatrixScaling(kNode.m_scale.x, kNode.m_scale.y, kNode.m_scale.z),
+                XMMatrixRotationQuaternion(XMLoadFloat4(&kNode.m_rotation))),
+                XMMatrixTranslation(kNode.m_position.x, kNode.m_position.y, kNode.m_position.z));
+            if (kNode.m_parent != INVALID_TRANSFORM_HANDLE)
+            {
+                world = XMMatrixMultiply(world, XMLoadFloat4x4(&ReferenceWorld(kNodes, kNode.m_parent, worlds, computed)));
+            }
+            XMStoreFloat4x4(&worlds[handle], world);
+            computed[handle] = 1;
+        }
+
+        return worlds[handle];
+    }
+
+    bool MatricesMatch(const XMFLOAT4X4& kMatrix, const XMFLOAT4X4& kReference)
+    {
+        for (unsigned int row = 0; row < 4; ++row)
+        {
+            for (unsigned int column = 0; column < 4; ++column)
+            {
+                float reference = kReference.m[row][column];
+                if (std::fabs(kMatrix.m[row][column] - reference) > kMatrixTolerance * std::max(1.0f, std::fabs(reference)))
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // Updates both hierarchies and compares them with the nodes worked out from scratch, then
+    // forgets what changed.
+    void UpdateAndCompare(CheckState& state, JobSystem& jobSystem)
+    {
+        state.m_serial.Update(nullptr);
+        state.m_parallel.Update(&jobSystem);
+
+        std::vector<uint8_t> states(state.m_nodes.size(), 0);
+        std::vector<XMFLOAT4X4> worlds(state.m_nodes.size());
+        std::vector<uint8_t> computed(state.m_nodes.size(), 0);
+
+        std::vector<TransformHandle> alive;
+        uint64_t changedNodes = 0;
+        for (TransformHandle handle = 0; handle < state.m_nodes.size(); ++handle)
+        {
+            if (!state.m_nodes[handle].m_alive)
+            {
+                continue;
+            }
+
+            uint8_t nodeState = ResolveNode(state.m_nodes, handle, states);
+            if (nodeState & 2)
+            {
+                alive.push_back(handle);
+                changedNodes += (nodeState & 4) ? 1 : 0;
+            }
+        }
+
+        for (const TransformHierarchy* pHierarchy : { &state.m_serial, &state.m_parallel })
+        {
+            const TransformUpdateStats& kStats = pHierarchy->GetStats();
+            if (pHierarchy->GetCount() != alive.size() || kStats.m_reordered != state.m_structureChanged)
+            {
+                ++state.m_errors.m_structureMismatches;
+            }
+            if (kStats.m_updatedNodes != changedNodes)
+            {
+                ++state.m_errors.m_updatedCountMismatches;
+            }
+
+            for (TransformHandle handle : alive)
+            {
+                if (pHierarchy->GetParent(handle) != state.m_nodes[handle].m_parent)
+                {
+                    ++state.m_errors.m_structureMismatches;
+                }
+                if (!MatricesMatch(pHierarchy->GetWorldMatrix(handle), ReferenceWorld(state.m_nodes, handle, worlds, computed)))
+                {
+                    ++state.m_errors.m_worldMismatches;
+                }
+            }
+        }
+
+        for (CheckNode& node : state.m_nodes)
+        {
+            node.m_alive = false;
+            node.m_destroyed = false;
+            node.m_changed = false;
+        }
+        for (TransformHandle handle : alive)
+        {
+            state.m_nodes[handle].m_alive = true;
+        }
+        state.m_alive.swap(alive);
+        state.m_structureChanged = false;
+    }
+}
+
+std::unique_ptr<JobSystemWorkload> CreateTransformUpdateWorkload()
+{
+    return std::make_unique<TransformUpdateWorkload>();
+}
+
+bool RunTransformHierarchyCheck()
+{
+    JobSystem jobSystem;
+    if (!jobSystem.Initialize(JobSystem::GetDefaultWorkerCount()))
+    {
+        return false;
+    }
+
+    CheckState state(kCheckSeed);
+    state.m_serial.Reserve(kCheckNodes);
+    state.m_parallel.Reserve(kCheckNodes);
+
+    // Every node under one in the first quarter of those before it, which puts levels of
+    // tens of thousands of nodes a few steps down.
+    for (unsigned int i = 0; i < kCheckRoots; ++i)
+    {
+        CreateNode(state, INVALID_TRANSFORM_HANDLE);
+    }
+    TransformHandle chainEnd = state.m_alive[0];
+    for (unsigned int i = 0; i < kCheckChainLength; ++i)
+    {
+        chainEnd = CreateNode(state, chainEnd);
+    }
+    while (state.m_alive.size() < kCheckNodes)
+    {
+        CreateNode(state, state.m_alive[state.m_random.NextBits() % ((state.m_alive.size() + 3) / 4)]);
+    }
+    UpdateAndCompare(state, jobSystem);
+
+    for (unsigned int step = 0; step < kCheckSteps; ++step)
+    {
+        unsigned int nodeCount = static_cast<unsigned int>(state.m_alive.size());
+
+        switch (step % 7)
+        {
+        case 0:
+            ChangeNodes(state, 1);
+            break;
+
+        case 1:
+            ChangeNodes(state, 7);
+            break;
+
+        case 2:
+            ChangeNodes(state, nodeCount / 100);
+            break;
+
+        case 3:
+            ChangeNodes(state, nodeCount / 10);
+            break;
+
+        case 4:
+            ChangeNodes(state, nodeCount / 2);
+            break;
+
+        case 5:
+            // Destroyed subtrees, new nodes under old and new ones and a few roots, and changes to
+            // all of them, all before the same Update().
+            for (unsigned int i = 0; i < kDestroyedPerStep; ++i)
+            {
+                TransformHandle handle = state.m_alive[state.m_random.NextBits() % nodeCount];
+                state.m_serial.Destroy(handle);
+                state.m_parallel.Destroy(handle);
+                state.m_nodes[handle].m_destroyed = true;
+                state.m_structureChanged = true;
+            }
+            for (unsigned int i = 0; i < kCreatedPerStep; ++i)
+            {
+                bool root = state.m_random.NextBits() % 100 == 0;
+                CreateNode(state, root ? INVALID_TRANSFORM_HANDLE : state.m_alive[state.m_random.NextBits() % state.m_alive.size()]);
+            }
+            ChangeNodes(state, nodeCount / 100);
+            break;
+
+        default:
+            // Nothing changed, nothing should be updated.
+            break;
+        }
+
+        UpdateAndCompare(state, jobSystem);
+    }
+
+    jobSystem.Shutdown();
+
+    char results[512];
+    sprintf_s(results, sizeof(results),
+        "transform_check_steps: %u\n"
+        "transform_check_nodes: %u\n"
+        "world_mismatches: %llu\n"
+        "structure_mismatches: %llu\n"
+        "updated_count_mismatches: %llu\n",
+        kCheckSteps + 1,
+        state.m_serial.GetCount(),
+        static_cast<unsigned long long>(state.m_errors.m_worldMismatches),
+        static_cast<unsigned long long>(state.m_errors.m_structureMismatches),
+        static_cast<unsigned long long>(state.m_errors.m_updatedCountMismatches));
+
+    fputs(results, stdout);
+    OutputDebugStringA(results);
+
+    return state.m_errors.m_worldMismatches == 0 && state.m_errors.m_structureMismatches == 0 && state.m_errors.m_updatedCountMismatches == 0;
+}
@@ -0,0 +1,235 @@
+//////////////////////////////////////////////////////////////////////
+// Filename: Win32Platform.cpp
+//////////////////////////////////////////////////////////////////////
+#include "System/Win32Platform.h"
+#include "System/System.h"
+
+/////////////////////////
+// FUNCTION PROTOTYPES //
+/////////////////////////
+static LRESULT CALLBACK WndProc(HWND, UINT, WPARAM, LPARAM);
+
+/////////////
+// GLOBALS //
+/////////////
+static Win32Platform* s_pApplicationHandle = nullptr;
+
+Win32Platform::Win32Platform(System& system, int windowedWidth, int windowedHeight)
+    : m_system(system)
+    , m_windowedWidth(windowedWidth)
+    , m_windowedHeight(windowedHeight)
+    , m_applicationName(nullptr)
+    , m_hInstance(nullptr)
+    , m_hwnd(nullptr)
+{
+}
+
+//-----------------------------------------------------------------------------
+// Where we put the code to build the window we will use to render to.
+// Returns screenWidth and screenHeight back to the calling function
+// so we can make use of them throughout the application.
+//
+// We are creating the window with some default setting to initialize
+// a plain black window with no borders.
+//
+// Window will me made depending on the global variable called FULL_SCREEN.
+// If it is set to true, then we make the screen cover the entire users desktop
+// window. If it is set to false we just make a window of the windowed size
+// (800x600 by default) in the middle of the screen.
+//-----------------------------------------------------------------------------
+bool Win32Platform::Initialize(int& screenWidth, int& screenHeight)
+{
+    WNDCLASSEX wc;
+    DEVMODE dmScreenSettings;
+    int posX;
+    int posY;
+
+    // Get an external pointer to this object.
+    s_pApplicationHandle = this;
+
+    // Get the instance of this application.
+    m_hInstance = GetModuleHandle(nullptr);
+
+    // Give the application a name.
+    m_applicationName = L"Engine";
+
+    // Setup the windows class with default settings.
+    wc.style            = CS_HREDRAW | CS_VREDRAW | CS_OWNDC;
+    wc.lpfnWndProc      = WndProc;
+    wc.cbClsExtra       = 0;
+    wc.cbWndExtra       = 0;
+    wc.hInstance        = m_hInstance;
+    wc.hIcon            = LoadIcon(nullptr, IDI_WINLOGO);
+    wc.hIconSm          = wc.hIcon;
+    wc.hCursor          = LoadCursor(nullptr, IDC_ARROW);
+    wc.hbrBackground    = static_cast<HBRUSH>(GetStockObject(BLACK_BRUSH));
+    wc.lpszMenuName     = nullptr;
+    wc.lpszClassName    = m_applicationName;
+    wc.cbSize           = sizeof(WNDCLASSEX);
+
+    // Register the window class.
+    RegisterClassEx(&wc);
+
+    // Determine the rsolution of the clients desktop screen.
+    screenWidth  = GetSystemMetrics(SM_CXSCREEN);
+    screenHeight = GetSystemMetrics(SM_CYSCREEN);
+
+    // Setup the screen settings depending ton whether it is running in full screen or in windowed mode.
+    if (FULL_SCREEN)
+    {
+        // If full screen set the screen to maximum size of the users desktop and 32bit.
+        memset(&dmScreenSettings, 0, sizeof(dmScreenSettings));
+        dmScreenSettings.dmSize = sizeof(dmScreenSettings);
+        dmScreenSettings.dmPelsWidth = static_cast<unsigned long>(screenWidth);
+        dmScreenSettings.dmPelsHeight = static_cast<unsigned long>(screenHeight);
+        dmScreenSettings.dmBitsPerPel = 32;
+        dmScreenSettings.dmFields = DM_BITSPERPEL | DM_PELSWIDTH | DM_PELSHEIGHT;
+
+        // Change the display settings to full screen.
+        ChangeDisplaySettings(&dmScreenSettings, CDS_FULLSCREEN);
+
+        // Set the position of the window to the top left corner.
+        posX = posY = 0;
+    }
+    else
+    {
+        // If windowed then set it to the windowed resolution.
+        screenWidth = m_windowedWidth;
+        screenHeight = m_windowedHeight;
+
+        // Place the window in the middle of the screen.
+        posX = (GetSystemMetrics(SM_CXSCREEN) - screenWidth) / 2;
+        posY = (GetSystemMetrics(SM_CYSCREEN) - screenHeight) / 2;
+    }
+
+    // Create the window with the screen settings and get the handle to it.
+    m_hwnd = CreateWindowEx(WS_EX_APPWINDOW, m_applicationName, m_applicationName,
+                        WS_CLIPSIBLINGS | WS_CLIPCHILDREN | WS_POPUP, posX, posY,
+                        screenWidth, screenHeight, nullptr, nullptr, m_hInstance, nullptr);
+    if (!m_hwnd)
+    {
+        return false;
+    }
+
+    // Bring the window up on the screen and set it as main focus.
+    ShowWindow(m_hwnd, SW_SHOW);
+    SetForegroundWindow(m_hwnd);
+    SetFocus(m_hwnd);
+
+    // Hide the mouse cursor.
+    ShowCursor(false);
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Returns the screen settings back to normal and releases the window and
+// handles associated with it.
+//-----------------------------------------------------------------------------
+void Win32Platform::Shutdown()
+{
+    // Show the mouse cursor.
+    ShowCursor(true);
+
+    // Fix the display settings if leaving full screen mode.
+    if (FULL_SCREEN)
+    {
+        ChangeDisplaySettings(nullptr, 0);
+    }
+
+    // Remove the window.
+    DestroyWindow(m_hwnd);
+    m_hwnd = nullptr;
+
+    // Remove the application instance.
+    UnregisterClass(m_applicationName, m_hInstance);
+    m_hInstance = nullptr;
+
+    // Release the pointer to this class.
+    s_pApplicationHandle = nullptr;
+}
+
+//-----------------------------------------------------------------
+// Handles every waiting windows message, not just one, so a burst
+// of input isn't spread over several iterations of the loop.
+// Returns false once windows signals to end the application.
+//-----------------------------------------------------------------
+bool Win32Platform::PumpMessages()
+{
+    MSG msg;
+
+    // Initialize the message structure
+    ZeroMemory(&msg, sizeof(MSG));
+
+    // Handle the windows messages.
+    while (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE))
+    {
+        if (msg.message == WM_QUIT)
+        {
+            return false;
+        }
+
+        TranslateMessage(&msg);
+        DispatchMessage(&msg);
+    }
+
+    return true;
+}
+
+void Win32Platform::WaitForMessages(unsigned int milliseconds)
+{
+    MsgWaitForMultipleObjects(0, nullptr, FALSE, milliseconds, QS_ALLINPUT);
+}
+
+bool Win32Platform::FrameCompleted()
+{
+    // The window decides when the application ends.
+    return true;
+}
+
+HWND Win32Platform::GetWindowHandle() const
+{
+    return m_hwnd;
+}
+
+//-----------------------------------------------------------------------------
+// Messages the window itself doesn't handle go to the system class.
+//-----------------------------------------------------------------------------
+LRESULT Win32Platform::MessageHandler(HWND hwnd, UINT umsg, WPARAM wparam, LPARAM lparam)
+{
+    return m_system.MessageHandler(hwnd, umsg, wparam, lparam);
+}
+
+//-----------------------------------------------------------------------------
+// Where windows sends its messages to.
+//-----------------------------------------------------------------------------
+LRESULT CALLBACK WndProc(HWND hwnd, UINT umessage, WPARAM wparam, LPARAM lparam)
+{
+    switch (umessage)
+    {
+    // Check if the window is being destroyed.
+    case WM_DESTROY:
+    {
+        PostQuitMessage(0);
+        return 0;
+    }
+        break;
+
+    // Check if the window is being closed.
+    case WM_CLOSE:
+    {
+        PostQuitMessage(0);
+        return 0;
+    }
+        break;
+
+    // All other messages pass to the mesage handler in the platform class.
+    default:
+        if (!s_pApplicationHandle)
+        {
+            return DefWindowProc(hwnd, umessage, wparam, lparam);
+        }
+        return s_pApplicationHandle->MessageHandler(hwnd, umessage, wparam, lparam);
+        break;
+    }
+}